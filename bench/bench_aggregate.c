@@ -0,0 +1,235 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for message aggregation.
+ *
+ * A sensor produces 1000 messages of 8 to 20 bytes, on average one every 200 ms with exponential
+ * gaps. Each message is sent as a packet of its own, or packed with others by an aggregator that
+ * flushes on size, on a deadline, or once the frame's fixed cost has dropped to 25% of its time on
+ * air. Every frame the chip sends is unpacked in place from the simulated chip's buffer, and its
+ * messages are checked against those produced.
+ *
+ * Airtime is per message, saved is against one packet per message, latency runs from adding a
+ * message to the TxDone of its frame, and busy counts messages that had to be offered again
+ * because the frame was full while the radio was still sending the previous one.
+ */
+
+#include "bench_util.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/aggregate.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_MESSAGES 1000
+#define BENCH_MIN_LEN 8
+#define BENCH_MAX_LEN 20
+#define BENCH_MEAN_GAP_US 200000.0
+
+typedef struct
+{
+  const char *name;
+  uint32_t max_delay_us;
+  uint8_t overhead_pct;
+} bench_setup_t;
+
+static const bench_setup_t bench_setups[] = {
+    {"immediate", 0, 0},
+    {"deadline 1 s", 1000000, 0},
+    {"deadline 5 s", 5000000, 0},
+    {"overhead 25%", 5000000, 25},
+};
+
+static const sx126x_lora_spreading_factor_t bench_sfs[] = {SX126X_LORA_SF_7, SX126X_LORA_SF_10};
+
+static sx126x_hal_t bench_sim;
+static uint64_t bench_added_ns[BENCH_MESSAGES];
+static uint8_t bench_len[BENCH_MESSAGES];
+static uint32_t bench_sent;      // messages in the frames started so far
+static uint32_t bench_done_upto; // messages whose frame has finished
+static uint32_t bench_decoded;
+static uint32_t bench_mismatched;
+static double bench_latency_s;
+static double bench_latency_max_s;
+
+static void bench_fill(uint8_t *msg, uint32_t seq)
+{
+  msg[0] = (uint8_t)(seq >> 8);
+  msg[1] = (uint8_t)seq;
+  for (uint8_t i = 2; i < bench_len[seq]; i++)
+    msg[i] = (uint8_t)(seq + i);
+}
+
+// Receiving side: walk the frame the chip is sending without copying it.
+static void bench_on_air(void *arg, const sx126x_hal_t *hal, uint64_t start_ns, uint64_t end_ns)
+{
+  (void)arg;
+  (void)start_ns;
+  (void)end_ns;
+
+  sx126x_agg_iter_t it;
+  const uint8_t *msg;
+  uint8_t len;
+  uint8_t expect[BENCH_MAX_LEN];
+
+  sx126x_agg_iter_init(&it, &hal->chip.buffer[hal->chip.tx_base], hal->chip.pkt_params[3]);
+  while (sx126x_agg_next(&it, &msg, &len))
+  {
+    uint32_t seq = bench_decoded++;
+    bench_fill(expect, seq);
+    if (seq >= BENCH_MESSAGES || len != bench_len[seq] || memcmp(msg, expect, len) != 0)
+      bench_mismatched++;
+  }
+  if (it.pos != it.len)
+    bench_mismatched++;
+}
+
+static void bench_tx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  (void)dev;
+  (void)arg;
+
+  if (result != SX126X_OK)
+  {
+    fprintf(stderr, "a frame failed: %d\n", result);
+    exit(1);
+  }
+
+  uint64_t now_ns = sx126x_hal_sim_now_ns(&bench_sim);
+  for (; bench_done_upto < bench_sent; bench_done_upto++)
+  {
+    double s = (double)(now_ns - bench_added_ns[bench_done_upto]) / 1e9;
+    bench_latency_s += s;
+    if (s > bench_latency_max_s)
+      bench_latency_max_s = s;
+  }
+}
+
+static void bench_run(const bench_setup_t *setup, sx126x_lora_spreading_factor_t sf)
+{
+  sx126x_config_t cfg;
+  sx126x_agg_t agg;
+
+  bench_default_config(&cfg);
+  cfg.lora_sf = sf;
+
+  sx126x_hal_sim_init(&bench_sim, NULL);
+  sx126x_hal_sim_medium_t medium = {.tx = bench_on_air};
+  sx126x_hal_sim_set_medium(&bench_sim, &medium);
+  sx126x_t *dev = sx126x_hal_get_device(&bench_sim);
+  if (sx126x_init(dev, sx126x_hal_get_bus(&bench_sim), &cfg) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to initialize the radio\n");
+    exit(1);
+  }
+
+  sx126x_agg_cfg_t agg_cfg = {
+      .max_delay_us = setup->max_delay_us,
+      .overhead_pct = setup->overhead_pct,
+      .done = bench_tx_done,
+  };
+  if (sx126x_agg_init(&agg, dev, &agg_cfg) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to set up the aggregator\n");
+    exit(1);
+  }
+
+  bench_sent = bench_done_upto = bench_decoded = bench_mismatched = 0;
+  bench_latency_s = bench_latency_max_s = 0;
+
+  uint32_t rng = 7, busy = 0, next = 0;
+  uint64_t next_ns = 0;
+  bool is_made = false;    // message next has been produced and is waiting to be taken
+  bool is_refused = false; // and the aggregator has already turned it away
+  uint8_t msg[BENCH_MAX_LEN];
+
+  while (next < BENCH_MESSAGES || agg.count || bench_done_upto < bench_sent)
+  {
+    uint64_t now_ns = sx126x_hal_sim_now_ns(&bench_sim);
+    uint32_t now_us = (uint32_t)(now_ns / 1000);
+
+    if (next < BENCH_MESSAGES && now_ns >= next_ns)
+    {
+      if (!is_made)
+      {
+        rng = rng * 1103515245u + 12345u;
+        uint32_t spread = BENCH_MAX_LEN - BENCH_MIN_LEN + 1;
+        bench_len[next] = (uint8_t)(BENCH_MIN_LEN + (rng >> 8) % spread);
+        bench_added_ns[next] = now_ns;
+        is_made = true;
+      }
+      bench_fill(msg, next);
+
+      sx126x_status_t st = sx126x_agg_add(&agg, msg, bench_len[next], now_us);
+      if (st == SX126X_OK)
+      {
+        rng = rng * 1103515245u + 12345u;
+        double gap = -BENCH_MEAN_GAP_US * log(((rng >> 8) + 1.0) / 16777217.0);
+        next_ns = bench_added_ns[next] + (uint64_t)(gap * 1000.0) + 1;
+        next++;
+        is_made = false;
+        is_refused = false;
+      }
+      else if (st == SX126X_ERR_BUSY)
+      {
+        if (!is_refused)
+          busy++;
+        is_refused = true;
+      }
+      else
+      {
+        fprintf(stderr, "failed to add message %u\n", next);
+        exit(1);
+      }
+    }
+
+    if (next == BENCH_MESSAGES)
+      sx126x_agg_flush(&agg);
+    else
+      sx126x_agg_poll(&agg, now_us, NULL);
+
+    // Messages of the frame just started, if any, are all but those left in the new one.
+    bench_sent = agg.stats.messages - agg.count;
+    sx126x_hal_sim_advance(&bench_sim, 1000000);
+  }
+
+  const sx126x_agg_stats_t *s = &agg.stats;
+  bool is_ok = bench_decoded == BENCH_MESSAGES && !bench_mismatched;
+  bench_expect(is_ok);
+  printf("SF%-2d %-13s frames=%4u airtime=%6.2f ms/msg saved=%5.1f%% latency avg=%6.3f s "
+         "max=%6.3f s busy=%u flushes size/deadline/overhead/explicit=%u/%u/%u/%u %s\n",
+         sf,
+         setup->name,
+         s->frames,
+         (double)s->airtime_us / 1e3 / BENCH_MESSAGES,
+         s->single_us ? 100.0 * (1.0 - (double)s->airtime_us / (double)s->single_us) : 0.0,
+         bench_latency_s / BENCH_MESSAGES,
+         bench_latency_max_s,
+         busy,
+         s->flush_size,
+         s->flush_deadline,
+         s->flush_overhead,
+         s->flush_explicit,
+         is_ok ? "ok" : "MISMATCH");
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&bench_sim);
+}
+
+int main(void)
+{
+  printf("%d messages of %d to %d bytes, one every %.0f ms on average\n",
+         BENCH_MESSAGES,
+         BENCH_MIN_LEN,
+         BENCH_MAX_LEN,
+         BENCH_MEAN_GAP_US / 1e3);
+
+  for (size_t f = 0; f < sizeof(bench_sfs) / sizeof(bench_sfs[0]); f++)
+  {
+    for (size_t s = 0; s < sizeof(bench_setups) / sizeof(bench_setups[0]); s++)
+      bench_run(&bench_setups[s], bench_sfs[f]);
+  }
+
+  return bench_exit_status;
+}
@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for the bus lock hooks under contention.
+ *
+ * Several radios share one POSIX HAL bus, each driven by its own thread that retunes the radio,
+ * queues a packet and has its DIO1 thread finish the transmission. Every radio is backed by its
+ * own simulated chip behind a stand-in for a blocking SPI driver. Runs compare per-transfer
+ * locking (hooks left NULL) against the lock hooks, with and without batched transfers in the
+ * backend; without batching the core issues one transfer per frame. Switches count frames issued
+ * by a different radio than the frame before, so interleaved operations push them up.
+ */
+
+// pthreads and sched_yield() under strict ISO C builds.
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "bench_util.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/hal_posix.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_RADIOS 4
+#define BENCH_ITERATIONS 500
+#define BENCH_PAYLOAD_LEN 32
+// Operations per iteration: reconfigure, transmit and the TX done interrupt.
+#define BENCH_OPS_PER_ITERATION 3
+
+typedef struct
+{
+  sx126x_hal_t sim;
+  sx126x_bus_t spi;
+  sx126x_hal_posix_t posix;
+  pthread_t thread;
+  int is_tx_done;
+  uint32_t failures;
+} bench_radio_t;
+
+// Stand-in for a blocking SPI driver: the thread sleeps while the controller clocks the frames, so
+// other threads get the CPU between transfers even on a single core.
+static sx126x_status_t
+bench_spi_transfer(sx126x_bus_t *bus, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len)
+{
+  sx126x_bus_t *sim_bus = sx126x_hal_get_bus(&((bench_radio_t *)bus->ctx)->sim);
+  sx126x_status_t st = sim_bus->transfer(sim_bus, tx, tx_len, rx, rx_len);
+  sched_yield();
+  return st;
+}
+
+static sx126x_status_t
+bench_spi_transfer_batch(sx126x_bus_t *bus, const sx126x_bus_frame_t *frames, size_t count)
+{
+  sx126x_bus_t *sim_bus = sx126x_hal_get_bus(&((bench_radio_t *)bus->ctx)->sim);
+  sx126x_status_t st = sim_bus->transfer_batch(sim_bus, frames, count);
+  sched_yield();
+  return st;
+}
+
+static uint32_t bench_spi_now_us(sx126x_bus_t *bus)
+{
+  sx126x_bus_t *sim_bus = sx126x_hal_get_bus(&((bench_radio_t *)bus->ctx)->sim);
+  return sim_bus->now_us(sim_bus);
+}
+
+static void bench_tx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  bench_radio_t *radio = (bench_radio_t *)arg;
+  (void)dev;
+
+  if (result != SX126X_OK)
+    __atomic_add_fetch(&radio->failures, 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&radio->is_tx_done, 1, __ATOMIC_RELEASE);
+}
+
+static void *bench_worker(void *arg)
+{
+  bench_radio_t *radio = (bench_radio_t *)arg;
+  sx126x_t *dev = sx126x_hal_posix_get_device(&radio->posix);
+  uint8_t payload[BENCH_PAYLOAD_LEN];
+  sx126x_config_t cfg;
+
+  memset(payload, 0xA5, sizeof(payload));
+  bench_default_config(&cfg);
+
+  for (int i = 0; i < BENCH_ITERATIONS; i++)
+  {
+    cfg.frequency_hz = (i & 1) ? 916000000 : 915000000;
+    cfg.power_dbm = (i & 2) ? 14 : 22;
+    cfg.lora_sf = (i & 4) ? SX126X_LORA_SF_8 : SX126X_LORA_SF_7;
+
+    __atomic_store_n(&radio->is_tx_done, 0, __ATOMIC_RELAXED);
+    if (sx126x_reconfigure(dev, &cfg) != SX126X_OK ||
+        sx126x_transmit_async(dev, payload, sizeof(payload), 0, bench_tx_done, radio) != SX126X_OK)
+    {
+      radio->failures++;
+      continue;
+    }
+
+    // The DIO1 thread is idle until notified, so the chip model can be advanced without the bus.
+    uint64_t airtime_ns = sx126x_hal_sim_airtime_ns(&radio->sim, BENCH_PAYLOAD_LEN);
+    sx126x_hal_sim_advance(&radio->sim, airtime_ns + 1000000);
+    sx126x_hal_posix_notify_dio1(&radio->posix);
+
+    while (!__atomic_load_n(&radio->is_tx_done, __ATOMIC_ACQUIRE))
+      sched_yield();
+  }
+
+  return NULL;
+}
+
+static void bench_run(bool use_lock_hooks, bool disable_batch)
+{
+  static bench_radio_t radios[BENCH_RADIOS];
+  static sx126x_hal_posix_bus_t shared;
+
+  sx126x_hal_posix_bus_init(&shared);
+
+  for (int r = 0; r < BENCH_RADIOS; r++)
+  {
+    bench_radio_t *radio = &radios[r];
+    sx126x_hal_sim_cfg_t sim_cfg = {0};
+    sx126x_hal_posix_cfg_t posix_cfg = {
+        .shared = &shared,
+        .backend = &radio->spi,
+        .disable_lock_hooks = !use_lock_hooks,
+    };
+
+    memset(radio, 0, sizeof(*radio));
+    radio->spi.transfer = bench_spi_transfer;
+    radio->spi.transfer_batch = disable_batch ? NULL : bench_spi_transfer_batch;
+    radio->spi.now_us = bench_spi_now_us;
+    radio->spi.ctx = radio;
+    sx126x_config_t cfg;
+    bench_default_config(&cfg);
+
+    if (sx126x_hal_sim_init(&radio->sim, &sim_cfg) != SX126X_OK ||
+        sx126x_hal_posix_init(&radio->posix, &posix_cfg) != SX126X_OK ||
+        sx126x_init(sx126x_hal_posix_get_device(&radio->posix),
+                    sx126x_hal_posix_get_bus(&radio->posix),
+                    &cfg) != SX126X_OK)
+    {
+      fprintf(stderr, "failed to initialize radio %d\n", r);
+      exit(1);
+    }
+  }
+
+  memset(&shared.stats, 0, sizeof(shared.stats));
+  uint64_t t0 = bench_now_ns();
+
+  for (int r = 0; r < BENCH_RADIOS; r++)
+    pthread_create(&radios[r].thread, NULL, bench_worker, &radios[r]);
+
+  uint32_t failures = 0;
+  for (int r = 0; r < BENCH_RADIOS; r++)
+  {
+    pthread_join(radios[r].thread, NULL);
+    failures += radios[r].failures;
+  }
+  bench_expect(failures == 0);
+
+  uint64_t wall_ns = bench_now_ns() - t0;
+  sx126x_hal_posix_bus_stats_t stats = shared.stats;
+  double ops = (double)BENCH_RADIOS * BENCH_ITERATIONS * BENCH_OPS_PER_ITERATION;
+
+  printf("%-5s %-8s acq/op=%5.2f contended/op=%5.3f switches/op=%5.2f frames/op=%5.2f "
+         "wall/op=%6.2f us failures=%u\n",
+         use_lock_hooks ? "hooks" : "none",
+         disable_batch ? "no-batch" : "batch",
+         (double)stats.acquisitions / ops,
+         (double)stats.contended / ops,
+         (double)stats.switches / ops,
+         (double)stats.frames / ops,
+         (double)wall_ns / ops / 1000.0,
+         failures);
+
+  for (int r = 0; r < BENCH_RADIOS; r++)
+  {
+    sx126x_deinit(sx126x_hal_posix_get_device(&radios[r].posix));
+    sx126x_hal_posix_deinit(&radios[r].posix);
+    sx126x_hal_sim_deinit(&radios[r].sim);
+  }
+
+  sx126x_hal_posix_bus_deinit(&shared);
+}
+
+int main(void)
+{
+  printf("Shared bus: %d radios, %d iterations each (reconfigure + transmit + TX done)\n",
+         BENCH_RADIOS,
+         BENCH_ITERATIONS);
+
+  bench_run(false, false);
+  bench_run(true, false);
+  bench_run(false, true);
+  bench_run(true, true);
+
+  return bench_exit_status;
+}
@@ -0,0 +1,376 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for time on air and duty-cycle scheduling.
+ *
+ * First checks sx126x_time_on_air_us against the simulator's floating-point airtime model across
+ * spreading factors, bandwidths and payload lengths, and times it. Then runs one modelled hour of
+ * saturated EU868 traffic on the three default 1% channels and the 10% channel at 869.525 MHz,
+ * comparing the token-bucket scheduler against a fixed off-time of 99 times the worst-case packet
+ * after every transmission. Every band's transmissions are checked against its budget over every
+ * window of consecutive packets.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/airtime.h>
+#include <sx126x/duty_cycle.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_HOUR_US 3600000000ull
+#define BENCH_CHANNELS 4
+#define BENCH_BANDS 2
+#define BENCH_MIN_LEN 10
+#define BENCH_MAX_LEN 51
+#define BENCH_LOG_MAX 8192
+#define BENCH_TOA_CALLS 1000000
+
+static const uint32_t bench_channel_hz[BENCH_CHANNELS] = {
+    868100000, 868300000, 868500000, 869525000};
+static const uint8_t bench_channel_band[BENCH_CHANNELS] = {0, 0, 0, 1};
+
+typedef struct
+{
+  uint32_t start_us;
+  uint32_t airtime_us;
+} bench_tx_log_t;
+
+static bench_tx_log_t bench_log[BENCH_BANDS][BENCH_LOG_MAX];
+static uint32_t bench_log_len[BENCH_BANDS];
+
+static sx126x_hal_t bench_sim;
+static sx126x_duty_t bench_sched;
+static sx126x_duty_tx_t bench_txs[BENCH_CHANNELS];
+static uint8_t bench_payload[UINT8_MAX];
+static uint32_t bench_rng = 1;
+static uint32_t bench_failures;
+
+static uint8_t bench_next_len(void)
+{
+  bench_rng = bench_rng * 1103515245u + 12345u;
+  return (uint8_t)(BENCH_MIN_LEN + (bench_rng >> 16) % (BENCH_MAX_LEN - BENCH_MIN_LEN + 1));
+}
+
+static uint32_t bench_now_us(void)
+{
+  return (uint32_t)(sx126x_hal_sim_now_ns(&bench_sim) / 1000);
+}
+
+static void bench_lora_config(sx126x_config_t *cfg)
+{
+  bench_default_config(cfg);
+  cfg->frequency_hz = bench_channel_hz[0];
+  cfg->power_dbm = 14;
+  cfg->lora_sf = SX126X_LORA_SF_9;
+  cfg->lora_crc_on = true;
+}
+
+static void bench_validate(void)
+{
+  static const sx126x_lora_bandwidth_t bws[] = {
+      SX126X_LORA_BW_7,
+      SX126X_LORA_BW_41,
+      SX126X_LORA_BW_125,
+      SX126X_LORA_BW_250,
+      SX126X_LORA_BW_500,
+  };
+  static const uint8_t lens[] = {1, 16, 51, 255};
+  sx126x_config_t cfg;
+  double max_err = 0.0;
+  uint32_t cases = 0;
+
+  bench_lora_config(&cfg);
+  sx126x_hal_sim_init(&bench_sim, NULL);
+  sx126x_t *dev = sx126x_hal_get_device(&bench_sim);
+  if (sx126x_init(dev, sx126x_hal_get_bus(&bench_sim), &cfg) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to initialize the radio\n");
+    exit(1);
+  }
+
+  for (int sf = SX126X_LORA_SF_5; sf <= SX126X_LORA_SF_12; sf++)
+  {
+    for (size_t b = 0; b < sizeof(bws) / sizeof(bws[0]); b++)
+    {
+      for (int variant = 0; variant < 4; variant++)
+      {
+        cfg.lora_sf = (sx126x_lora_spreading_factor_t)sf;
+        cfg.lora_bw = bws[b];
+        cfg.lora_implicit_header = variant & 1;
+        cfg.lora_cr = (variant & 2) ? SX126X_LORA_CR_4_8 : SX126X_LORA_CR_4_5;
+        if (sx126x_reconfigure(dev, &cfg) != SX126X_OK)
+        {
+          fprintf(stderr, "reconfigure failed\n");
+          exit(1);
+        }
+
+        for (size_t l = 0; l < sizeof(lens); l++)
+        {
+          // Packet parameters reach the chip with the transmission, so send one to compare against.
+          if (sx126x_transmit_async(dev, bench_payload, lens[l], 0, NULL, NULL) != SX126X_OK)
+          {
+            fprintf(stderr, "transmit failed\n");
+            exit(1);
+          }
+
+          double ref = (double)sx126x_hal_sim_airtime_ns(&bench_sim, lens[l]) / 1000.0;
+          double got = sx126x_time_on_air_us(&cfg, lens[l]);
+          double err = (got - ref) / ref;
+
+          if (err < 0)
+            err = -err;
+          if (err > max_err)
+            max_err = err;
+          cases++;
+
+          uint64_t airtime_ns = sx126x_hal_sim_airtime_ns(&bench_sim, lens[l]);
+          sx126x_hal_sim_advance(&bench_sim, airtime_ns + 1000000);
+        }
+      }
+    }
+  }
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&bench_sim);
+
+  // The simulator rounds the narrow bandwidths to 10 Hz, so agreement is only to within that.
+  bench_expect(max_err < 0.001);
+  printf("time on air vs simulator: %u cases, max relative error %.4f%%\n", cases, max_err * 100.0);
+
+  volatile uint32_t sink = 0;
+  uint64_t t0 = bench_now_ns();
+  for (uint32_t i = 0; i < BENCH_TOA_CALLS; i++)
+  {
+    cfg.lora_sf = (sx126x_lora_spreading_factor_t)(SX126X_LORA_SF_7 + (i & 3));
+    sink += sx126x_time_on_air_us(&cfg, (uint8_t)i);
+  }
+  uint64_t elapsed_ns = bench_now_ns() - t0;
+  (void)sink;
+
+  printf("time on air: %.1f ns/call\n", (double)elapsed_ns / BENCH_TOA_CALLS);
+}
+
+static void bench_record(uint16_t channel, uint32_t start_us, uint32_t airtime_us)
+{
+  uint8_t band = bench_channel_band[channel];
+  if (bench_log_len[band] < BENCH_LOG_MAX)
+  {
+    bench_log[band][bench_log_len[band]++] = (bench_tx_log_t){start_us, airtime_us};
+  }
+}
+
+// Worst excess over burst + duty * window across every run of consecutive packets of a band.
+static int64_t bench_check_band(uint8_t band, uint32_t duty_ppm, uint32_t burst_us)
+{
+  int64_t worst = INT64_MIN;
+
+  for (uint32_t i = 0; i < bench_log_len[band]; i++)
+  {
+    uint64_t sum = 0;
+    for (uint32_t j = i; j < bench_log_len[band]; j++)
+    {
+      sum += bench_log[band][j].airtime_us;
+      const bench_tx_log_t *last = &bench_log[band][j];
+      uint64_t window = last->start_us + last->airtime_us - bench_log[band][i].start_us;
+      int64_t excess = (int64_t)sum - (int64_t)(burst_us + window * duty_ppm / 1000000);
+      if (excess > worst)
+        worst = excess;
+    }
+  }
+
+  return worst;
+}
+
+static void bench_tx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  sx126x_duty_tx_t *tx = (sx126x_duty_tx_t *)arg;
+  (void)dev;
+
+  if (result != SX126X_OK)
+    bench_failures++;
+
+  // Saturated source: every channel always has its next packet waiting.
+  sx126x_status_t st = sx126x_duty_submit(
+      &bench_sched, tx, tx->channel, bench_payload, bench_next_len(), bench_tx_done, tx);
+  if (st != SX126X_OK)
+    bench_failures++;
+}
+
+static void bench_setup(sx126x_t **dev, sx126x_channel_plan_t *plan, sx126x_channel_t *storage)
+{
+  sx126x_config_t cfg;
+
+  bench_lora_config(&cfg);
+  memset(bench_log_len, 0, sizeof(bench_log_len));
+  bench_rng = 1;
+  bench_failures = 0;
+
+  sx126x_hal_sim_init(&bench_sim, NULL);
+  *dev = sx126x_hal_get_device(&bench_sim);
+  if (sx126x_init(*dev, sx126x_hal_get_bus(&bench_sim), &cfg) != SX126X_OK ||
+      sx126x_channel_plan_build(plan, storage, bench_channel_hz, BENCH_CHANNELS) != SX126X_OK ||
+      sx126x_set_channel_plan(*dev, plan) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to initialize the radio\n");
+    exit(1);
+  }
+}
+
+static void bench_report(const char *name, const uint32_t *packets, const uint64_t *airtime_us,
+                         const uint32_t *duty_ppm, const uint32_t *burst_us)
+{
+  printf("%-10s", name);
+  for (uint8_t b = 0; b < BENCH_BANDS; b++)
+  {
+    int64_t excess = bench_check_band(b, duty_ppm[b], burst_us[b]);
+    bench_expect(excess <= 0);
+    printf(" band%u: %5u pkts %6.3f%% on air %s",
+           b,
+           packets[b],
+           (double)airtime_us[b] * 100.0 / BENCH_HOUR_US,
+           excess > 0 ? "OVER BUDGET" : "within budget");
+  }
+  bench_expect(bench_failures == 0);
+  printf(" failures=%u\n", bench_failures);
+}
+
+static void bench_fixed_off_time(void)
+{
+  static const uint32_t duty_ppm[BENCH_BANDS] = {
+      SX126X_DUTY_PPM_1_PERCENT,
+      SX126X_DUTY_PPM_10_PERCENT,
+  };
+  sx126x_channel_t storage[BENCH_CHANNELS];
+  sx126x_channel_plan_t plan;
+  sx126x_t *dev;
+  uint32_t packets[BENCH_BANDS] = {0};
+  uint64_t airtime_us[BENCH_BANDS] = {0};
+
+  bench_setup(&dev, &plan, storage);
+
+  // Without airtime tracking the off-time has to assume the longest packet and the strictest band.
+  uint32_t worst_us = sx126x_time_on_air_us(&dev->shadow, BENCH_MAX_LEN);
+  uint64_t off_ns = (uint64_t)worst_us * 99 * 1000;
+  // An off-time after every packet is a bucket that holds exactly one packet.
+  uint32_t burst_us[BENCH_BANDS] = {worst_us, worst_us};
+  uint32_t t0 = bench_now_us();
+
+  for (uint16_t ch = 0; bench_now_us() - t0 < BENCH_HOUR_US;
+       ch = (uint16_t)((ch + 1) % BENCH_CHANNELS))
+  {
+    uint8_t len = bench_next_len();
+    uint32_t airtime = sx126x_time_on_air_us(&dev->shadow, len);
+    uint32_t start = bench_now_us() - t0;
+
+    if (sx126x_set_channel(dev, ch) != SX126X_OK ||
+        sx126x_transmit_async(dev, bench_payload, len, 0, NULL, NULL) != SX126X_OK)
+      bench_failures++;
+
+    bench_record(ch, start, airtime);
+    packets[bench_channel_band[ch]]++;
+    airtime_us[bench_channel_band[ch]] += airtime;
+    sx126x_hal_sim_advance(&bench_sim, (uint64_t)airtime * 1000 + 1000000 + off_ns);
+  }
+
+  bench_report("fixed", packets, airtime_us, duty_ppm, burst_us);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&bench_sim);
+}
+
+static void bench_scheduler(uint32_t burst_ms)
+{
+  sx126x_channel_t storage[BENCH_CHANNELS];
+  sx126x_channel_plan_t plan;
+  sx126x_duty_band_t bands[BENCH_BANDS] = {
+      {.duty_ppm = SX126X_DUTY_PPM_1_PERCENT, .burst_us = burst_ms * 1000},
+      {.duty_ppm = SX126X_DUTY_PPM_10_PERCENT, .burst_us = burst_ms * 1000},
+  };
+  uint32_t duty_ppm[BENCH_BANDS];
+  uint32_t burst_us[BENCH_BANDS];
+  uint32_t packets[BENCH_BANDS] = {0};
+  uint64_t airtime_us[BENCH_BANDS] = {0};
+  sx126x_t *dev;
+
+  bench_setup(&dev, &plan, storage);
+
+  uint32_t t0 = bench_now_us();
+  sx126x_status_t st = sx126x_duty_init(
+      &bench_sched, dev, bands, BENCH_BANDS, bench_channel_band, BENCH_CHANNELS, t0);
+  if (st != SX126X_OK)
+  {
+    fprintf(stderr, "failed to initialize the scheduler\n");
+    exit(1);
+  }
+
+  for (uint16_t ch = 0; ch < BENCH_CHANNELS; ch++)
+  {
+    memset(&bench_txs[ch], 0, sizeof(bench_txs[ch]));
+    sx126x_duty_tx_t *tx = &bench_txs[ch];
+    sx126x_duty_submit(&bench_sched, tx, ch, bench_payload, bench_next_len(), bench_tx_done, tx);
+  }
+
+  while (bench_now_us() - t0 < BENCH_HOUR_US)
+  {
+    uint32_t wait_us;
+    uint32_t now = bench_now_us();
+
+    if (sx126x_duty_poll(&bench_sched, now, &wait_us))
+    {
+      // The request just released is the only one not queued until its done callback requeues it.
+      sx126x_duty_tx_t *sent = NULL;
+      for (uint16_t ch = 0; ch < BENCH_CHANNELS; ch++)
+      {
+        if (!bench_txs[ch].req.queued)
+          sent = &bench_txs[ch];
+      }
+
+      uint32_t airtime = sent->airtime_us;
+      bench_record(sent->channel, now - t0, airtime);
+      packets[bench_channel_band[sent->channel]]++;
+      airtime_us[bench_channel_band[sent->channel]] += airtime;
+      sx126x_hal_sim_advance(&bench_sim, (uint64_t)airtime * 1000 + 1000000);
+    }
+    else
+    {
+      uint64_t left_us = BENCH_HOUR_US - (bench_now_us() - t0);
+      sx126x_hal_sim_advance(&bench_sim, (wait_us < left_us ? wait_us : left_us) * 1000 + 1000);
+    }
+  }
+
+  for (uint8_t b = 0; b < BENCH_BANDS; b++)
+  {
+    duty_ppm[b] = bands[b].duty_ppm;
+    burst_us[b] = bands[b].burst_us;
+  }
+
+  char name[32];
+  snprintf(name, sizeof(name), "bucket %us", burst_ms / 1000);
+  bench_report(name, packets, airtime_us, duty_ppm, burst_us);
+  printf("%-10s released=%u deferred=%u\n",
+         "",
+         bench_sched.stats.released,
+         bench_sched.stats.deferred);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&bench_sim);
+}
+
+int main(void)
+{
+  memset(bench_payload, 0x3C, sizeof(bench_payload));
+
+  bench_validate();
+
+  printf("EU868, one modelled hour, SF9/125 kHz, %d-%d byte packets, saturated source\n",
+         BENCH_MIN_LEN,
+         BENCH_MAX_LEN);
+
+  bench_fixed_off_time();
+  bench_scheduler(2000);
+  bench_scheduler(10000);
+
+  return bench_exit_status;
+}
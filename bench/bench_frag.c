@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for fragmentation and reassembly over a lossy link.
+ *
+ * The radio sends 20 messages of 4000 bytes, gathered from a 32 byte header, the body and a 4 byte
+ * trailer, in 16 fragments of up to 250 bytes at SF7/125 kHz. The receiving side runs in the
+ * simulator's medium hook: it loses each fragment with a fixed probability, reassembles the others
+ * in a pool of two slots, and answers fragments that ask for an ACK 1 ms after they end. ACKs are
+ * lost with the same probability. The sender opens the ACK window with sx126x_transmit_receive.
+ *
+ * Without a window every fragment goes out once, and a message arrives only if all of its
+ * fragments do. With one, the selective ACKs have only the missing fragments sent again. Goodput
+ * is message bytes delivered intact per second of elapsed time, ACK windows included.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/airtime.h>
+#include <sx126x/frag.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/rx_ring.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_MESSAGES 20
+#define BENCH_HEADER_LEN 32
+#define BENCH_BODY_LEN 3964
+#define BENCH_TRAILER_LEN 4
+#define BENCH_MSG_LEN (BENCH_HEADER_LEN + BENCH_BODY_LEN + BENCH_TRAILER_LEN)
+#define BENCH_ACK_DELAY_NS 1000000ull
+#define BENCH_MAX_RETRIES 20
+
+static const uint16_t bench_windows[] = {0, 4, 16};
+static const uint32_t bench_loss_pct[] = {0, 5, 10, 20, 30};
+
+static sx126x_hal_t bench_sim;
+static sx126x_frag_tx_t bench_tx;
+static sx126x_frag_pool_t bench_pool;
+static sx126x_frag_slot_t bench_slots[2];
+static uint8_t bench_storage[2 * BENCH_MSG_LEN];
+static sx126x_rx_ring_t bench_ring;
+static sx126x_rx_packet_t bench_ring_slots[2];
+static uint8_t bench_header[BENCH_HEADER_LEN];
+static uint8_t bench_body[BENCH_BODY_LEN];
+static uint8_t bench_trailer[BENCH_TRAILER_LEN];
+static uint8_t bench_msg[BENCH_MSG_LEN];
+static uint32_t bench_loss;
+static uint32_t bench_rng;
+static uint32_t bench_ack_us;
+static uint32_t bench_delivered;
+static uint32_t bench_corrupt;
+static bool bench_waiting;
+
+static bool bench_lost(void)
+{
+  bench_rng = bench_rng * 1103515245u + 12345u;
+  return (bench_rng >> 8) % 100 < bench_loss;
+}
+
+// Receiving side, run as each fragment goes on air.
+static void bench_on_air(void *arg, const sx126x_hal_t *hal, uint64_t start_ns, uint64_t end_ns)
+{
+  (void)arg;
+  (void)start_ns;
+
+  if (bench_lost())
+    return;
+
+  sx126x_frag_slot_t *slot;
+  const uint8_t *frame = &hal->chip.buffer[hal->chip.tx_base];
+  uint32_t now_us = (uint32_t)(end_ns / 1000);
+  if (sx126x_frag_rx(&bench_pool, 0, frame, hal->chip.pkt_params[3], now_us, &slot) != SX126X_OK)
+    return;
+
+  if (slot->ack_requested && !bench_lost())
+  {
+    uint8_t ack[SX126X_FRAG_ACK_MAX_LEN];
+    uint8_t len;
+    sx126x_frag_ack(slot, ack, &len);
+    uint64_t at_ns = end_ns + BENCH_ACK_DELAY_NS +
+                     sx126x_time_on_air_us(&bench_sim.dev.shadow, len) * 1000ull;
+    sx126x_hal_sim_schedule_rx(&bench_sim, at_ns, ack, len, -80, 8, true);
+  }
+
+  if (sx126x_frag_complete(slot))
+  {
+    if (slot->total == BENCH_MSG_LEN && memcmp(slot->buf, bench_msg, BENCH_MSG_LEN) == 0)
+      bench_delivered++;
+    else
+      bench_corrupt++;
+    sx126x_frag_release(&bench_pool, slot);
+  }
+}
+
+static void bench_tx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  (void)dev;
+  (void)arg;
+
+  if (result != SX126X_OK)
+  {
+    fprintf(stderr, "a fragment failed: %d\n", result);
+    exit(1);
+  }
+}
+
+static void bench_ack_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  (void)dev;
+  (void)arg;
+
+  sx126x_rx_packet_t pkt;
+  bool is_acked = false;
+
+  while (sx126x_rx_ring_pop(&bench_ring, &pkt))
+  {
+    if (result == SX126X_OK && sx126x_frag_tx_ack(&bench_tx, pkt.payload, pkt.len) == SX126X_OK)
+      is_acked = true;
+  }
+
+  if (!is_acked)
+    sx126x_frag_tx_timeout(&bench_tx);
+  bench_waiting = false;
+}
+
+static void bench_run(uint16_t window, uint32_t loss)
+{
+  sx126x_config_t cfg;
+
+  bench_default_config(&cfg);
+  bench_loss = loss;
+  bench_rng = 11;
+  bench_delivered = bench_corrupt = 0;
+  bench_waiting = false;
+
+  sx126x_hal_sim_init(&bench_sim, NULL);
+  sx126x_hal_sim_medium_t medium = {.tx = bench_on_air};
+  sx126x_hal_sim_set_medium(&bench_sim, &medium);
+  sx126x_t *dev = sx126x_hal_get_device(&bench_sim);
+  if (sx126x_init(dev, sx126x_hal_get_bus(&bench_sim), &cfg) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to initialize the radio\n");
+    exit(1);
+  }
+
+  sx126x_rx_ring_init(&bench_ring, bench_ring_slots, 2);
+  sx126x_frag_pool_init(&bench_pool, bench_slots, 2, bench_storage, BENCH_MSG_LEN);
+  sx126x_frag_tx_cfg_t tx_cfg = {.window = window, .max_retries = BENCH_MAX_RETRIES};
+  sx126x_frag_tx_init(&bench_tx, &tx_cfg);
+
+  // Room for the ACK of a whole message, plus slack for the start of the window.
+  bench_ack_us = (uint32_t)(BENCH_ACK_DELAY_NS / 1000) +
+                 sx126x_time_on_air_us(&cfg, SX126X_FRAG_ACK_MAX_LEN) + 2000;
+
+  const sx126x_frag_seg_t segs[] = {
+      {bench_header, BENCH_HEADER_LEN},
+      {bench_body, BENCH_BODY_LEN},
+      {bench_trailer, BENCH_TRAILER_LEN},
+  };
+  uint32_t sent = 0, resent = 0, acks = 0, gave_up = 0;
+  uint64_t start_ns = sx126x_hal_sim_now_ns(&bench_sim);
+
+  for (uint32_t m = 0; m < BENCH_MESSAGES; m++)
+  {
+    uint8_t frame[SX126X_MAX_PAYLOAD_LEN];
+    uint8_t len;
+
+    if (sx126x_frag_tx_start(&bench_tx, (uint8_t)m, segs, 3) != SX126X_OK)
+    {
+      fprintf(stderr, "failed to start message %u\n", m);
+      exit(1);
+    }
+
+    while (bench_tx.is_active && !sx126x_frag_tx_done(&bench_tx))
+    {
+      if (!bench_waiting && sx126x_is_idle(dev) &&
+          sx126x_frag_tx_next(&bench_tx, frame, &len))
+      {
+        sx126x_status_t st;
+        if (frame[0] & SX126X_FRAG_FLAG_ACK_REQ)
+        {
+          bench_waiting = true;
+          st = sx126x_transmit_receive(
+              dev, frame, len, 0, &bench_ring, bench_ack_us, 0, bench_ack_done, NULL);
+        }
+        else
+        {
+          st = sx126x_transmit_async(dev, frame, len, 0, bench_tx_done, NULL);
+        }
+
+        if (st != SX126X_OK)
+        {
+          fprintf(stderr, "failed to send a fragment: %d\n", st);
+          exit(1);
+        }
+      }
+
+      sx126x_hal_sim_advance(&bench_sim, 1000000);
+    }
+
+    while (!sx126x_is_idle(dev))
+      sx126x_hal_sim_advance(&bench_sim, 1000000);
+
+    if (!bench_tx.is_active)
+      gave_up++;
+    sent += bench_tx.stats.sent;
+    resent += bench_tx.stats.resent;
+    acks += bench_tx.stats.acks;
+    bench_tx.stats = (sx126x_frag_tx_stats_t){0};
+  }
+
+  double elapsed_s = (double)(sx126x_hal_sim_now_ns(&bench_sim) - start_ns) / 1e9;
+  bench_expect(!bench_corrupt);
+  printf("window=%-2u loss=%2u%% delivered=%2u/%d goodput=%6.1f B/s fragments=%4u resent=%4u "
+         "acks=%3u gave-up=%u evicted=%u%s\n",
+         window,
+         loss,
+         bench_delivered,
+         BENCH_MESSAGES,
+         bench_delivered * (double)BENCH_MSG_LEN / elapsed_s,
+         sent,
+         resent,
+         acks,
+         gave_up,
+         bench_pool.stats.evicted,
+         bench_corrupt ? " CORRUPT" : "");
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&bench_sim);
+}
+
+int main(void)
+{
+  for (uint32_t i = 0; i < BENCH_MSG_LEN; i++)
+    bench_msg[i] = (uint8_t)(i * 7 + (i >> 8));
+  memcpy(bench_header, bench_msg, BENCH_HEADER_LEN);
+  memcpy(bench_body, bench_msg + BENCH_HEADER_LEN, BENCH_BODY_LEN);
+  memcpy(bench_trailer, bench_msg + BENCH_HEADER_LEN + BENCH_BODY_LEN, BENCH_TRAILER_LEN);
+
+  printf("%d messages of %d bytes in fragments of %d bytes, SF7/125 kHz\n",
+         BENCH_MESSAGES,
+         BENCH_MSG_LEN,
+         SX126X_FRAG_MAX_LEN);
+
+  for (size_t w = 0; w < sizeof(bench_windows) / sizeof(bench_windows[0]); w++)
+  {
+    for (size_t l = 0; l < sizeof(bench_loss_pct) / sizeof(bench_loss_pct[0]); l++)
+      bench_run(bench_windows[w], bench_loss_pct[l]);
+  }
+
+  return bench_exit_status;
+}
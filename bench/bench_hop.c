@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for channel hopping.
+ *
+ * Hops over the 64 US915 uplink channels on the simulated chip, once through sx126x_reconfigure
+ * (frequency converted on every hop) and once through sx126x_set_channel with a pre-encoded plan,
+ * and reports transactions, bytes, modelled bus latency and host wall time per hop.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_ITERATIONS 20000
+#define BENCH_CHANNELS 64
+#define BENCH_FIRST_HZ 902300000UL
+#define BENCH_SPACING_HZ 200000UL
+
+// Pseudo-random but repeatable hop sequence, identical for both runs.
+static uint16_t bench_next_channel(uint32_t *seed)
+{
+  *seed = *seed * 1103515245u + 12345u;
+  return (uint16_t)((*seed >> 16) % BENCH_CHANNELS);
+}
+
+static void bench_run(const char *name, bool use_plan)
+{
+  static sx126x_hal_t sim;
+  static sx126x_channel_t storage[BENCH_CHANNELS];
+  sx126x_hal_sim_init(&sim, NULL);
+
+  sx126x_config_t cfg;
+  bench_default_config(&cfg);
+
+  sx126x_t *dev = sx126x_hal_get_device(&sim);
+  sx126x_bus_t *bus = sx126x_hal_get_bus(&sim);
+
+  sx126x_channel_plan_t plan;
+  sx126x_status_t st = sx126x_init(dev, bus, &cfg);
+  if (st == SX126X_OK)
+    st = sx126x_channel_plan_build_linear(
+        &plan, storage, BENCH_FIRST_HZ, BENCH_SPACING_HZ, BENCH_CHANNELS);
+  if (st == SX126X_OK)
+    st = sx126x_set_channel_plan(dev, &plan);
+  if (st != SX126X_OK)
+  {
+    fprintf(stderr, "%s: setup failed with status %d\n", name, st);
+    exit(1);
+  }
+
+  sx126x_hal_sim_reset_stats(&sim);
+
+  uint32_t seed = 1;
+  uint64_t wall_ns = 0;
+
+  for (int i = 0; i < BENCH_ITERATIONS; i++)
+  {
+    uint16_t idx = bench_next_channel(&seed);
+
+    uint64_t start = bench_now_ns();
+    if (use_plan)
+    {
+      st = sx126x_set_channel(dev, idx);
+    }
+    else
+    {
+      cfg.frequency_hz = BENCH_FIRST_HZ + BENCH_SPACING_HZ * idx;
+      st = sx126x_reconfigure(dev, &cfg);
+    }
+    wall_ns += bench_now_ns() - start;
+
+    if (st != SX126X_OK)
+    {
+      fprintf(stderr, "%s: hop failed with status %d\n", name, st);
+      exit(1);
+    }
+
+    // Let BUSY settle so each hop is measured on its own.
+    sx126x_hal_sim_advance(&sim, 100000);
+  }
+
+  printf("%-12s txn/hop=%5.2f bytes/hop=%5.2f bus/hop=%7.2f us wall/hop=%7.1f ns\n",
+         name,
+         (double)sim.stats.transactions / BENCH_ITERATIONS,
+         (double)sim.stats.bytes / BENCH_ITERATIONS,
+         (double)sim.stats.bus_ns / BENCH_ITERATIONS / 1000.0,
+         (double)wall_ns / BENCH_ITERATIONS);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&sim);
+}
+
+int main(void)
+{
+  printf("channel hop: %d hops over %d channels on the simulated chip\n",
+         BENCH_ITERATIONS,
+         BENCH_CHANNELS);
+  bench_run("reconfigure", false);
+  bench_run("set_channel", true);
+  return bench_exit_status;
+}
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for sx126x_init.
+ *
+ * Runs the init sequence against the simulated chip, once with the batch entry point, once with
+ * the per-command fallback and once replayed from a compile-time image, and reports bus
+ * transactions, frames, bytes, modelled bus latency and host wall time per init.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/init_image.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_ITERATIONS 2000
+
+// Same configuration as bench_default_config, plus the public sync word.
+SX126X_INIT_IMAGE_DEFINE(bench_image,
+                         SX126X_CHIP_SX1262,
+                         915000000,
+                         SX126X_PA_HIGH_POWER,
+                         22,
+                         SX126X_PWR_RAMP_TIME_200U,
+                         SX126X_LORA_SF_7,
+                         SX126X_LORA_BW_125,
+                         SX126X_LORA_CR_4_5,
+                         false,
+                         0x34);
+
+static void bench_run(const char *name, bool batch, bool image)
+{
+  static sx126x_hal_t sim;
+  sx126x_hal_sim_cfg_t sim_cfg = {.disable_batch = !batch};
+  sx126x_hal_sim_init(&sim, &sim_cfg);
+
+  sx126x_config_t cfg;
+  bench_default_config(&cfg);
+  cfg.lora_sync_word = 0x34;
+
+  sx126x_t *dev = sx126x_hal_get_device(&sim);
+  sx126x_bus_t *bus = sx126x_hal_get_bus(&sim);
+
+  sx126x_hal_sim_stats_t totals;
+  memset(&totals, 0, sizeof(totals));
+  uint64_t wall_ns = 0;
+
+  for (int i = 0; i < BENCH_ITERATIONS; i++)
+  {
+    sx126x_hal_sim_reset_stats(&sim);
+
+    uint64_t start = bench_now_ns();
+    sx126x_status_t st =
+        image ? sx126x_init_from_image(dev, bus, &bench_image) : sx126x_init(dev, bus, &cfg);
+    wall_ns += bench_now_ns() - start;
+
+    if (st != SX126X_OK)
+    {
+      fprintf(stderr, "%s: sx126x_init failed with status %d\n", name, st);
+      exit(1);
+    }
+
+    totals.transactions += sim.stats.transactions;
+    totals.frames += sim.stats.frames;
+    totals.bytes += sim.stats.bytes;
+    totals.bus_ns += sim.stats.bus_ns;
+
+    // Deinit traffic is not part of the measurement; let BUSY settle between runs.
+    sx126x_deinit(dev);
+    sx126x_hal_sim_advance(&sim, 1000000);
+  }
+
+  printf("%-10s txn/init=%5.2f frames/init=%5.2f bytes/init=%6.2f bus/init=%8.2f us "
+         "wall/init=%6.3f us\n",
+         name,
+         (double)totals.transactions / BENCH_ITERATIONS,
+         (double)totals.frames / BENCH_ITERATIONS,
+         (double)totals.bytes / BENCH_ITERATIONS,
+         (double)totals.bus_ns / BENCH_ITERATIONS / 1000.0,
+         (double)wall_ns / BENCH_ITERATIONS / 1000.0);
+
+  sx126x_hal_sim_deinit(&sim);
+}
+
+int main(void)
+{
+  printf("sx126x_init: %d iterations on the simulated chip\n", BENCH_ITERATIONS);
+  bench_run("fallback", false, false);
+  bench_run("batch", true, false);
+  bench_run("image", true, true);
+  return bench_exit_status;
+}
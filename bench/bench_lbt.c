@@ -0,0 +1,298 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for CAD listen-before-talk on a shared channel.
+ *
+ * Sixteen simulated nodes send 24-byte SF7 packets on one channel. Each node waits an
+ * exponentially distributed idle time after its previous packet, sized for a given offered load.
+ * The simulators run in lockstep on a common clock and share a medium model. It records every
+ * transmission and lets a CAD detect any other node's packet on air while it listens. A
+ * transmission collides if another one overlaps it. There is no capture effect, and no hidden
+ * nodes.
+ *
+ * The same traffic is run three ways: blind transmissions (pure ALOHA), CAD then SetTx from the
+ * host, and CAD chained into TX on the chip. Deferrals and drops come from the LBT counters.
+ * CAD->TX is the gap between the end of a clear CAD and the start of the packet. On the host path
+ * it includes up to one 100 us lockstep step before the next poll.
+ */
+
+#include "bench_util.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/airtime.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/lbt.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_NODES 16
+#define BENCH_PAYLOAD_LEN 24
+#define BENCH_DURATION_NS 120000000000ull
+#define BENCH_STEP_NS 100000u
+#define BENCH_MEDIUM_LOG 64
+#define BENCH_MAX_ATTEMPTS 8
+
+typedef enum
+{
+  BENCH_ALOHA,
+  BENCH_LBT_HOST,
+  BENCH_LBT_CHAINED,
+} bench_mode_t;
+
+static const char *const bench_mode_names[] = {"ALOHA", "LBT host", "LBT chained"};
+static const double bench_loads[] = {0.2, 0.5, 1.0};
+
+typedef struct
+{
+  int node;
+  uint64_t start_ns;
+  uint64_t end_ns;
+  bool collided;
+} bench_air_t;
+
+typedef struct
+{
+  sx126x_lbt_t lbt;
+  sx126x_lbt_tx_t tx;
+  bool has_packet;
+  uint64_t gen_ns;
+  uint64_t next_gen_ns;
+  uint64_t cad_end_ns;
+  bool cad_clear;
+} bench_node_t;
+
+static sx126x_hal_t bench_sims[BENCH_NODES];
+static bench_node_t bench_nodes[BENCH_NODES];
+static bench_air_t bench_air[BENCH_MEDIUM_LOG];
+static uint32_t bench_air_count;
+static uint8_t bench_payload[BENCH_PAYLOAD_LEN];
+static uint32_t bench_rng = 1;
+static double bench_idle_mean_ns;
+
+// Totals of one run.
+static uint32_t bench_sent;
+static uint32_t bench_collided;
+static uint32_t bench_done;
+static uint64_t bench_delay_ns;
+static uint64_t bench_gap_ns;
+static uint32_t bench_gaps;
+
+static int bench_node_of(const sx126x_hal_t *hal)
+{
+  return (int)(hal - bench_sims);
+}
+
+static double bench_uniform(void)
+{
+  bench_rng = bench_rng * 1103515245u + 12345u;
+  return ((bench_rng >> 8) + 1.0) / 16777217.0;
+}
+
+static uint64_t bench_idle_ns(void)
+{
+  return (uint64_t)(-bench_idle_mean_ns * log(bench_uniform()));
+}
+
+// Count a transmission once it leaves the medium log.
+static void bench_air_retire(const bench_air_t *air)
+{
+  bench_sent++;
+  if (air->collided)
+    bench_collided++;
+}
+
+static void bench_medium_tx(void *arg, const sx126x_hal_t *hal, uint64_t start_ns, uint64_t end_ns)
+{
+  (void)arg;
+  int node = bench_node_of(hal);
+  bench_air_t *air = &bench_air[bench_air_count % BENCH_MEDIUM_LOG];
+
+  if (bench_air_count >= BENCH_MEDIUM_LOG)
+    bench_air_retire(air);
+  *air = (bench_air_t){.node = node, .start_ns = start_ns, .end_ns = end_ns};
+  bench_air_count++;
+
+  uint32_t live = bench_air_count < BENCH_MEDIUM_LOG ? bench_air_count : BENCH_MEDIUM_LOG;
+  for (uint32_t i = 0; i < live; i++)
+  {
+    bench_air_t *other = &bench_air[i];
+    if (other != air && other->start_ns < end_ns && start_ns < other->end_ns)
+    {
+      other->collided = true;
+      air->collided = true;
+    }
+  }
+
+  if (bench_nodes[node].cad_clear)
+  {
+    bench_gap_ns += start_ns - bench_nodes[node].cad_end_ns;
+    bench_gaps++;
+    bench_nodes[node].cad_clear = false;
+  }
+}
+
+static bool bench_medium_cad(void *arg, const sx126x_hal_t *hal, uint64_t start_ns, uint64_t end_ns)
+{
+  (void)arg;
+  int node = bench_node_of(hal);
+  uint32_t live = bench_air_count < BENCH_MEDIUM_LOG ? bench_air_count : BENCH_MEDIUM_LOG;
+  bool detected = false;
+
+  for (uint32_t i = 0; i < live && !detected; i++)
+  {
+    const bench_air_t *air = &bench_air[i];
+    detected = air->node != node && air->start_ns < end_ns && start_ns < air->end_ns;
+  }
+
+  bench_nodes[node].cad_end_ns = end_ns;
+  bench_nodes[node].cad_clear = !detected;
+  return detected;
+}
+
+static void bench_tx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  (void)dev;
+  (void)result;
+  bench_node_t *node = (bench_node_t *)arg;
+  sx126x_hal_t *hal = &bench_sims[node - bench_nodes];
+  uint64_t now = sx126x_hal_sim_now_ns(hal);
+
+  bench_done++;
+  bench_delay_ns += now - node->gen_ns;
+  node->has_packet = false;
+  node->next_gen_ns = now + bench_idle_ns();
+}
+
+static void bench_run(bench_mode_t mode, double load, uint32_t airtime_us)
+{
+  static const sx126x_hal_sim_medium_t medium = {
+      .tx = bench_medium_tx, .cad = bench_medium_cad, .arg = NULL};
+  sx126x_config_t cfg;
+  uint64_t t = 0;
+
+  bench_default_config(&cfg);
+  memset(bench_payload, 0x5A, sizeof(bench_payload));
+  bench_rng = 1;
+  bench_air_count = 0;
+  bench_sent = bench_collided = bench_done = 0;
+  bench_delay_ns = bench_gap_ns = 0;
+  bench_gaps = 0;
+
+  // Each node offers load / nodes, and is idle for the rest of the time.
+  double airtime_ns = airtime_us * 1000.0;
+  bench_idle_mean_ns = airtime_ns * BENCH_NODES / load - airtime_ns;
+
+  sx126x_lbt_cfg_t lbt_cfg = {
+      .backoff_min_us = airtime_us,
+      .backoff_max_us = airtime_us * 8,
+      .max_attempts = BENCH_MAX_ATTEMPTS,
+      .chain = mode == BENCH_LBT_CHAINED,
+  };
+
+  for (int i = 0; i < BENCH_NODES; i++)
+  {
+    sx126x_hal_t *hal = &bench_sims[i];
+    bench_node_t *node = &bench_nodes[i];
+
+    sx126x_hal_sim_init(hal, NULL);
+    sx126x_hal_sim_set_medium(hal, &medium);
+    sx126x_t *dev = sx126x_hal_get_device(hal);
+    if (sx126x_init(dev, sx126x_hal_get_bus(hal), &cfg) != SX126X_OK)
+    {
+      fprintf(stderr, "failed to initialize node %d\n", i);
+      exit(1);
+    }
+
+    memset(node, 0, sizeof(*node));
+    lbt_cfg.seed = (uint32_t)i + 1;
+    sx126x_lbt_init(&node->lbt, dev, &lbt_cfg);
+    node->next_gen_ns = bench_idle_ns();
+    if (sx126x_hal_sim_now_ns(hal) > t)
+      t = sx126x_hal_sim_now_ns(hal);
+  }
+
+  uint64_t start = t;
+  uint64_t end = start + BENCH_DURATION_NS;
+
+  for (; t < end; t += BENCH_STEP_NS)
+  {
+    for (int i = 0; i < BENCH_NODES; i++)
+    {
+      sx126x_hal_t *hal = &bench_sims[i];
+      bench_node_t *node = &bench_nodes[i];
+      sx126x_t *dev = sx126x_hal_get_device(hal);
+
+      if (sx126x_hal_sim_now_ns(hal) < t)
+        sx126x_hal_sim_advance(hal, t - sx126x_hal_sim_now_ns(hal));
+
+      uint64_t now = sx126x_hal_sim_now_ns(hal);
+      if (!node->has_packet && now >= start + node->next_gen_ns)
+      {
+        node->has_packet = true;
+        node->gen_ns = now;
+        if (mode == BENCH_ALOHA)
+          sx126x_transmit_async(dev, bench_payload, BENCH_PAYLOAD_LEN, 0, bench_tx_done, node);
+        else
+          sx126x_lbt_submit(
+              &node->lbt, &node->tx, bench_payload, BENCH_PAYLOAD_LEN, bench_tx_done, node);
+      }
+
+      if (mode != BENCH_ALOHA)
+        sx126x_lbt_poll(&node->lbt, (uint32_t)(now / 1000), NULL);
+    }
+  }
+
+  uint32_t live = bench_air_count < BENCH_MEDIUM_LOG ? bench_air_count : BENCH_MEDIUM_LOG;
+  for (uint32_t i = 0; i < live; i++)
+    bench_air_retire(&bench_air[i]);
+
+  sx126x_lbt_stats_t lbt = {0};
+  for (int i = 0; i < BENCH_NODES; i++)
+  {
+    lbt.cads += bench_nodes[i].lbt.stats.cads;
+    lbt.deferrals += bench_nodes[i].lbt.stats.deferrals;
+    lbt.dropped += bench_nodes[i].lbt.stats.dropped;
+    sx126x_deinit(sx126x_hal_get_device(&bench_sims[i]));
+    sx126x_hal_sim_deinit(&bench_sims[i]);
+  }
+
+  uint32_t delivered = bench_sent - bench_collided;
+  double throughput = delivered * airtime_ns / (double)BENCH_DURATION_NS;
+
+  printf("G=%.1f %-11s tx=%5u collided=%5.1f%% delivered=%5u S=%.3f deferrals=%5u dropped=%4u "
+         "delay=%7.1f ms",
+         load,
+         bench_mode_names[mode],
+         bench_sent,
+         bench_sent ? 100.0 * bench_collided / bench_sent : 0.0,
+         delivered,
+         throughput,
+         lbt.deferrals,
+         lbt.dropped,
+         bench_done ? (double)bench_delay_ns / 1e6 / bench_done : 0.0);
+  if (bench_gaps)
+    printf(" CAD->TX=%6.1f us", (double)bench_gap_ns / 1e3 / bench_gaps);
+  printf("\n");
+}
+
+int main(void)
+{
+  sx126x_config_t cfg;
+  bench_default_config(&cfg);
+  uint32_t airtime_us = sx126x_time_on_air_us(&cfg, BENCH_PAYLOAD_LEN);
+
+  printf("%d nodes, %d-byte SF7/125 kHz packets (%u us on air), %llu s per run\n",
+         BENCH_NODES,
+         BENCH_PAYLOAD_LEN,
+         airtime_us,
+         BENCH_DURATION_NS / 1000000000ull);
+
+  for (size_t l = 0; l < sizeof(bench_loads) / sizeof(bench_loads[0]); l++)
+  {
+    bench_run(BENCH_ALOHA, bench_loads[l], airtime_us);
+    bench_run(BENCH_LBT_HOST, bench_loads[l], airtime_us);
+    bench_run(BENCH_LBT_CHAINED, bench_loads[l], airtime_us);
+  }
+
+  return bench_exit_status;
+}
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for the LR-FHSS hop path.
+ *
+ * Sends LR-FHSS packets of three header blocks of 114 symbols followed by payload fragments of 50
+ * symbols (233 and 102 ms at 488 bit/s), hopping on a 3.9 kHz grid around 868.1 MHz. Packets with
+ * more than 16 hops rely on the hop IRQ to refill the chip's hop table, and every hop IRQ must be
+ * answered before the next one is raised, i.e. within the shortest hop. The simulator times each
+ * refill from its hop IRQ and counts hops sent from an entry that was never refilled.
+ *
+ * The DIO1 handler is run as soon as the line goes high, as an interrupt task would, on the default
+ * bus and on a slow one. The polled runs instead call sx126x_handle_irq at a fixed interval, to
+ * show what a late answer does. Margin is the shortest hop over the worst refill time; bus calls
+ * per hop IRQ include the final TxDone and, when polled, polls that found nothing.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/lr_fhss.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_HEADER_BLOCKS 3
+#define BENCH_HEADER_SYMBOLS 114
+#define BENCH_FRAGMENT_SYMBOLS 50
+#define BENCH_FRAGMENT_BYTES 6
+#define BENCH_CENTER_HZ 868100000
+#define BENCH_GRID_HZ 3906
+#define BENCH_GRID_CHANNELS 35
+
+typedef struct
+{
+  const char *name;
+  sx126x_hal_sim_cfg_t sim;
+  uint32_t poll_ms; // 0 to run the DIO1 handler as soon as the line goes high
+} bench_setup_t;
+
+static const bench_setup_t bench_setups[] = {
+    {"DIO1", {0}, 0},
+    {"DIO1 slow bus",
+     {.spi_clock_hz = 1000000, .txn_overhead_ns = 200000, .disable_batch = true},
+     0},
+    {"polled 50 ms", {0}, 50},
+    {"polled 250 ms", {0}, 250},
+};
+
+static const uint16_t bench_hop_counts[] = {12, 40, 120, 255};
+
+static sx126x_hal_t bench_sim;
+static sx126x_lr_fhss_hop_t bench_hops[SX126X_LR_FHSS_MAX_HOPS];
+static uint8_t bench_payload[SX126X_MAX_PAYLOAD_LEN];
+static bool bench_done;
+static sx126x_status_t bench_result;
+
+static void bench_tx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  (void)dev;
+  (void)arg;
+
+  bench_done = true;
+  bench_result = result;
+}
+
+static void bench_build(sx126x_lr_fhss_table_t *table, uint16_t count)
+{
+  static uint32_t hz[SX126X_LR_FHSS_MAX_HOPS];
+  static uint16_t symbols[SX126X_LR_FHSS_MAX_HOPS];
+  uint32_t rng = count;
+
+  for (uint16_t i = 0; i < count; i++)
+  {
+    rng = rng * 1103515245u + 12345u;
+    int channel = (int)((rng >> 8) % BENCH_GRID_CHANNELS) - BENCH_GRID_CHANNELS / 2;
+    hz[i] = (uint32_t)(BENCH_CENTER_HZ + channel * BENCH_GRID_HZ);
+    symbols[i] = i < BENCH_HEADER_BLOCKS ? BENCH_HEADER_SYMBOLS : BENCH_FRAGMENT_SYMBOLS;
+  }
+
+  if (sx126x_lr_fhss_build(table, bench_hops, hz, symbols, count) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to build a hop table of %u hops\n", count);
+    exit(1);
+  }
+}
+
+static void bench_run(const bench_setup_t *setup, uint16_t count)
+{
+  sx126x_lr_fhss_table_t table;
+  sx126x_config_t cfg;
+
+  bench_default_config(&cfg);
+  bench_build(&table, count);
+
+  sx126x_hal_sim_init(&bench_sim, &setup->sim);
+  if (setup->poll_ms)
+    bench_sim.bus.attach_dio1 = NULL;
+  sx126x_t *dev = sx126x_hal_get_device(&bench_sim);
+  if (sx126x_init(dev, sx126x_hal_get_bus(&bench_sim), &cfg) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to initialize the radio\n");
+    exit(1);
+  }
+
+  uint32_t fragments = count > BENCH_HEADER_BLOCKS ? count - BENCH_HEADER_BLOCKS : 1;
+  uint32_t len = fragments * BENCH_FRAGMENT_BYTES;
+  if (len > SX126X_MAX_PAYLOAD_LEN)
+    len = SX126X_MAX_PAYLOAD_LEN;
+
+  sx126x_hal_sim_reset_stats(&bench_sim);
+  bench_done = false;
+  uint64_t start_ns = sx126x_hal_sim_now_ns(&bench_sim);
+  if (sx126x_transmit_lr_fhss(dev, &table, bench_payload, len, 0, bench_tx_done, NULL) !=
+      SX126X_OK)
+  {
+    fprintf(stderr, "failed to start an LR-FHSS packet\n");
+    exit(1);
+  }
+  uint64_t setup_txns = bench_sim.stats.transactions;
+
+  // Hops last at least 102 ms, so a packet is over well within this bound.
+  for (int i = 0; i < 200000 && !bench_done; i++)
+  {
+    sx126x_hal_sim_advance(&bench_sim, setup->poll_ms ? setup->poll_ms * 1000000ull : 1000000);
+    if (setup->poll_ms)
+      sx126x_handle_irq(dev);
+  }
+
+  const sx126x_hal_sim_stats_t *st = &bench_sim.stats;
+  double worst_us = (double)st->lr_fhss_refill_max_ns / 1e3;
+  bool is_ok = bench_done && bench_result == SX126X_OK;
+
+  // Polling slower than the shortest hop is expected to miss refills; interrupts are not.
+  bench_expect(is_ok && (setup->poll_ms || st->lr_fhss_stale_hops == 0));
+
+  printf("%-13s hops=%3u elapsed=%6.2f s hop-irqs=%3llu refills=%3llu stale=%3llu "
+         "worst-refill=%9.1f us shortest-hop=%6.1f ms margin=%6.0fx bus-calls/irq=%.2f %s\n",
+         setup->name,
+         count,
+         (double)(sx126x_hal_sim_now_ns(&bench_sim) - start_ns) / 1e9,
+         (unsigned long long)st->lr_fhss_hops,
+         (unsigned long long)st->lr_fhss_refills,
+         (unsigned long long)st->lr_fhss_stale_hops,
+         worst_us,
+         (double)st->lr_fhss_hop_min_ns / 1e6,
+         worst_us > 0 ? (double)st->lr_fhss_hop_min_ns / 1e3 / worst_us : 0.0,
+         st->lr_fhss_hops ? (double)(st->transactions - setup_txns) / (st->lr_fhss_hops + 1) : 0.0,
+         is_ok ? "ok" : "FAILED");
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&bench_sim);
+}
+
+int main(void)
+{
+  memset(bench_payload, 0x3C, sizeof(bench_payload));
+
+  printf("LR-FHSS: %d header blocks of %d symbols, fragments of %d symbols, 488 bit/s\n",
+         BENCH_HEADER_BLOCKS,
+         BENCH_HEADER_SYMBOLS,
+         BENCH_FRAGMENT_SYMBOLS);
+
+  for (size_t s = 0; s < sizeof(bench_setups) / sizeof(bench_setups[0]); s++)
+  {
+    for (size_t c = 0; c < sizeof(bench_hop_counts) / sizeof(bench_hop_counts[0]); c++)
+      bench_run(&bench_setups[s], bench_hop_counts[c]);
+  }
+
+  return bench_exit_status;
+}
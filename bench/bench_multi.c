@@ -0,0 +1,212 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for several radios on one shared SPI bus.
+ *
+ * Each radio is a simulated chip, and the multi-radio manager serializes their bus traffic: time
+ * spent on the bus by one radio passes for all of them. Every radio transmits back to back, and
+ * the aggregate packet rate is reported for 1 to 32 radios together with bus utilization. A second
+ * run floods radio 0 with received packets to show that its RX drain does not starve TX on the
+ * other radios.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/multi.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_MAX_RADIOS 32
+#define BENCH_DURATION_NS 2000000000ull
+#define BENCH_IDLE_STEP_NS 5000
+#define BENCH_PAYLOAD_LEN 16
+#define BENCH_RING_SLOTS 16
+
+typedef struct
+{
+  sx126x_multi_t *mgr;
+  uint8_t index;
+  sx126x_multi_job_t job;
+  uint32_t sent;
+} bench_radio_t;
+
+static sx126x_hal_t sims[BENCH_MAX_RADIOS];
+static bench_radio_t radios[BENCH_MAX_RADIOS];
+static uint8_t payload[BENCH_PAYLOAD_LEN];
+
+static sx126x_status_t bench_tx_fn(sx126x_t *radio, void *arg);
+
+static void bench_tx_done(sx126x_t *radio, sx126x_status_t result, void *arg)
+{
+  bench_radio_t *r = (bench_radio_t *)arg;
+  (void)radio;
+
+  if (result == SX126X_OK)
+    r->sent++;
+
+  // Queue the next packet straight away.
+  sx126x_multi_submit(r->mgr, r->index, &r->job, SX126X_MULTI_PRIO_NORMAL, bench_tx_fn, NULL, r);
+}
+
+static sx126x_status_t bench_tx_fn(sx126x_t *radio, void *arg)
+{
+  return sx126x_transmit_async(radio, payload, sizeof(payload), 0, bench_tx_done, arg);
+}
+
+// Bring every chip's clock up to the furthest one, as the bus time spent by one radio passes for
+// all of them.
+static uint64_t bench_sync(uint8_t n)
+{
+  uint64_t now = 0;
+
+  for (uint8_t i = 0; i < n; i++)
+  {
+    uint64_t t = sx126x_hal_sim_now_ns(&sims[i]);
+    if (t > now)
+      now = t;
+  }
+
+  for (uint8_t i = 0; i < n; i++)
+  {
+    uint64_t t = sx126x_hal_sim_now_ns(&sims[i]);
+    if (t < now)
+      sx126x_hal_sim_advance(&sims[i], now - t);
+  }
+
+  return now;
+}
+
+static void bench_run(uint8_t n, bool flood)
+{
+  static sx126x_multi_slot_t slots[BENCH_MAX_RADIOS];
+  static sx126x_rx_packet_t rx_slots[BENCH_RING_SLOTS];
+  sx126x_t *devs[BENCH_MAX_RADIOS];
+  sx126x_multi_t mgr;
+  sx126x_rx_ring_t ring;
+  sx126x_rx_packet_t pkt;
+  uint32_t received = 0;
+
+  sx126x_config_t cfg;
+  bench_default_config(&cfg);
+  cfg.lora_sf = SX126X_LORA_SF_5;
+  cfg.lora_bw = SX126X_LORA_BW_500;
+
+  for (uint8_t i = 0; i < n; i++)
+  {
+    sx126x_hal_sim_init(&sims[i], NULL);
+    devs[i] = sx126x_hal_get_device(&sims[i]);
+    if (sx126x_init(devs[i], sx126x_hal_get_bus(&sims[i]), &cfg) != SX126X_OK)
+    {
+      fprintf(stderr, "radio %u: init failed\n", i);
+      exit(1);
+    }
+  }
+
+  if (sx126x_multi_init(&mgr, slots, devs, n) != SX126X_OK)
+  {
+    fprintf(stderr, "multi init failed\n");
+    exit(1);
+  }
+
+  uint8_t first_tx = 0;
+  if (flood)
+  {
+    sx126x_rx_ring_init(&ring, rx_slots, BENCH_RING_SLOTS);
+    sx126x_receive_continuous(devs[0], &ring);
+    first_tx = 1;
+  }
+
+  uint64_t t0 = bench_sync(n);
+  for (uint8_t i = 0; i < n; i++)
+    sx126x_hal_sim_reset_stats(&sims[i]);
+
+  for (uint8_t i = first_tx; i < n; i++)
+  {
+    radios[i] = (bench_radio_t){.mgr = &mgr, .index = i};
+    sx126x_multi_submit(
+        &mgr, i, &radios[i].job, SX126X_MULTI_PRIO_NORMAL, bench_tx_fn, NULL, &radios[i]);
+  }
+
+  // Back-to-back arrivals on radio 0, as fast as the air allows.
+  uint64_t airtime = sx126x_hal_sim_airtime_ns(&sims[0], BENCH_PAYLOAD_LEN);
+  uint64_t next_rx = t0 + airtime;
+  uint64_t now = t0;
+
+  while (now < t0 + BENCH_DURATION_NS)
+  {
+    while (flood && sims[0].rx_queue_len < SX126X_HAL_SIM_RX_QUEUE)
+    {
+      sx126x_hal_sim_schedule_rx(&sims[0], next_rx, payload, sizeof(payload), -80, 8, true);
+      next_rx += airtime;
+    }
+
+    if (!sx126x_multi_run_one(&mgr))
+    {
+      for (uint8_t i = 0; i < n; i++)
+        sx126x_hal_sim_advance(&sims[i], BENCH_IDLE_STEP_NS);
+    }
+
+    now = bench_sync(n);
+
+    while (flood && sx126x_rx_ring_pop(&ring, &pkt))
+      received++;
+  }
+
+  uint64_t elapsed = now - t0;
+  uint64_t bus_ns = 0;
+  uint32_t total = 0;
+  uint32_t min = UINT32_MAX;
+
+  for (uint8_t i = 0; i < n; i++)
+    bus_ns += sims[i].stats.bus_ns;
+
+  for (uint8_t i = first_tx; i < n; i++)
+  {
+    total += radios[i].sent;
+    if (radios[i].sent < min)
+      min = radios[i].sent;
+  }
+
+  double secs = (double)elapsed / 1e9;
+  if (flood)
+  {
+    printf("%u radios, radio 0 flooded: rx=%7.1f pkt/s, tx per other radio min=%6.1f avg=%6.1f "
+           "pkt/s, bus=%5.1f%%\n",
+           n,
+           received / secs,
+           min / secs,
+           (double)total / (n - first_tx) / secs,
+           100.0 * (double)bus_ns / (double)elapsed);
+  }
+  else
+  {
+    printf("%u radios: aggregate=%7.1f pkt/s per radio min=%6.1f pkt/s bus=%5.1f%%\n",
+           n,
+           total / secs,
+           min / secs,
+           100.0 * (double)bus_ns / (double)elapsed);
+  }
+
+  sx126x_multi_deinit(&mgr);
+  for (uint8_t i = 0; i < n; i++)
+  {
+    sx126x_deinit(devs[i]);
+    sx126x_hal_sim_deinit(&sims[i]);
+  }
+}
+
+int main(void)
+{
+  memset(payload, 0x5A, sizeof(payload));
+
+  printf("shared bus: %d-byte packets at SF5/BW500, %.1f s per run on the simulated chips\n",
+         BENCH_PAYLOAD_LEN,
+         (double)BENCH_DURATION_NS / 1e9);
+
+  for (uint8_t n = 1; n <= BENCH_MAX_RADIOS; n *= 2)
+    bench_run(n, false);
+
+  bench_run(8, true);
+  return bench_exit_status;
+}
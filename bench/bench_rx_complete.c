@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for reading one RX completion.
+ *
+ * Compares the naive five-transfer sequence (GetIrqStatus, ClearIrqStatus, GetRxBufferStatus,
+ * GetPacketStatus, ReadBuffer) against sx126x_rx_complete, which chains them into one submission.
+ * The chained read prefetches as many payload bytes as the previous packet had, so it is run both
+ * with a steady frame size and with sizes alternating between a short and a long frame, where
+ * every long frame needs an extra transfer for its tail.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_PACKETS 2000
+#define BENCH_SHORT_LEN 16
+#define BENCH_RING_SLOTS 4
+
+typedef enum
+{
+  BENCH_NAIVE,
+  BENCH_CHAINED,
+  BENCH_CHAINED_ALTERNATING,
+} bench_mode_t;
+
+static const char *const bench_mode_names[] = {"naive", "chained", "chained-alt"};
+
+// The hand-written sequence a driver without batching issues for every packet.
+static sx126x_status_t bench_naive_read(sx126x_bus_t *bus, sx126x_rx_packet_t *pkt)
+{
+  uint8_t irq_tx[] = {SX126X_OP_GET_IRQ_STATUS, 0x00, 0x00, 0x00};
+  uint8_t irq_rx[sizeof(irq_tx)];
+  uint8_t buf_tx[] = {SX126X_OP_GET_RX_BUFFER_STATUS, 0x00, 0x00, 0x00};
+  uint8_t buf_rx[sizeof(buf_tx)];
+  uint8_t pkt_tx[] = {SX126X_OP_GET_PACKET_STATUS, 0x00, 0x00, 0x00, 0x00};
+  uint8_t pkt_rx[sizeof(pkt_tx)];
+  uint8_t read_rx[3 + SX126X_MAX_PAYLOAD_LEN];
+  sx126x_status_t st;
+
+  st = bus->transfer(bus, irq_tx, sizeof(irq_tx), irq_rx, sizeof(irq_rx));
+  if (st != SX126X_OK)
+    return st;
+  pkt->irq = ((uint16_t)irq_rx[2] << 8) | irq_rx[3];
+
+  uint8_t clear_tx[] = {SX126X_OP_CLEAR_IRQ_STATUS, (uint8_t)(pkt->irq >> 8), (uint8_t)pkt->irq};
+  st = bus->transfer(bus, clear_tx, sizeof(clear_tx), NULL, 0);
+  if (st == SX126X_OK)
+    st = bus->transfer(bus, buf_tx, sizeof(buf_tx), buf_rx, sizeof(buf_rx));
+  if (st == SX126X_OK)
+    st = bus->transfer(bus, pkt_tx, sizeof(pkt_tx), pkt_rx, sizeof(pkt_rx));
+  if (st != SX126X_OK)
+    return st;
+
+  uint8_t read_tx[] = {SX126X_OP_READ_BUFFER, buf_rx[3], 0x00};
+  st = bus->transfer(bus, read_tx, sizeof(read_tx), read_rx, 3 + (size_t)buf_rx[2]);
+  if (st != SX126X_OK)
+    return st;
+
+  pkt->len = buf_rx[2];
+  pkt->rssi_dbm = -(int16_t)pkt_rx[2] / 2;
+  pkt->snr_db = (int8_t)((int8_t)pkt_rx[3] / 4);
+  pkt->signal_rssi_dbm = -(int16_t)pkt_rx[4] / 2;
+  memcpy(pkt->payload, &read_rx[3], pkt->len);
+
+  return SX126X_OK;
+}
+
+static void bench_run(bench_mode_t mode, uint8_t len)
+{
+  static sx126x_hal_t sim;
+  static sx126x_rx_packet_t slots[BENCH_RING_SLOTS];
+  sx126x_rx_ring_t ring;
+  sx126x_rx_packet_t pkt;
+
+  sx126x_hal_sim_init(&sim, NULL);
+  sx126x_rx_ring_init(&ring, slots, BENCH_RING_SLOTS);
+
+  sx126x_config_t cfg;
+  bench_default_config(&cfg);
+  cfg.lora_sf = SX126X_LORA_SF_7;
+  cfg.lora_bw = SX126X_LORA_BW_500;
+
+  sx126x_t *dev = sx126x_hal_get_device(&sim);
+  sx126x_bus_t *bus = sx126x_hal_get_bus(&sim);
+  if (sx126x_init(dev, bus, &cfg) != SX126X_OK ||
+      sx126x_receive_continuous(dev, &ring) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to start continuous RX\n");
+    exit(1);
+  }
+
+  // Service completions by hand instead of through the driver's DIO1 handler.
+  bus->attach_dio1(bus, NULL, NULL);
+
+  uint8_t payload[SX126X_MAX_PAYLOAD_LEN];
+  for (int i = 0; i < SX126X_MAX_PAYLOAD_LEN; i++)
+    payload[i] = (uint8_t)(i * 7 + 1);
+
+  uint64_t transactions = 0;
+  uint64_t bus_ns = 0;
+  uint64_t wall_ns = 0;
+  uint32_t bad = 0;
+
+  for (int i = 0; i < BENCH_PACKETS; i++)
+  {
+    uint8_t n = (mode == BENCH_CHAINED_ALTERNATING && (i & 1)) ? BENCH_SHORT_LEN : len;
+
+    sx126x_hal_sim_schedule_rx(
+        &sim, sx126x_hal_sim_now_ns(&sim) + 1000000, payload, n, -80, 8, true);
+    sx126x_hal_sim_advance(&sim, 2000000);
+
+    uint64_t txn0 = sim.stats.transactions;
+    uint64_t bus0 = sim.stats.bus_ns;
+    uint64_t t0 = bench_now_ns();
+
+    sx126x_status_t st =
+        mode == BENCH_NAIVE ? bench_naive_read(bus, &pkt) : sx126x_rx_complete(dev, &pkt);
+
+    wall_ns += bench_now_ns() - t0;
+    transactions += sim.stats.transactions - txn0;
+    bus_ns += sim.stats.bus_ns - bus0;
+
+    if (st != SX126X_OK || pkt.len != n || memcmp(pkt.payload, payload, n) != 0)
+      bad++;
+  }
+
+  bench_expect(bad == 0);
+  printf("%-12s len=%3u txn/pkt=%4.2f bus/pkt=%7.2f us wall/pkt=%6.3f us bad=%u\n",
+         bench_mode_names[mode],
+         len,
+         (double)transactions / BENCH_PACKETS,
+         (double)bus_ns / BENCH_PACKETS / 1000.0,
+         (double)wall_ns / BENCH_PACKETS / 1000.0,
+         bad);
+
+  sx126x_receive_stop(dev);
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&sim);
+}
+
+int main(void)
+{
+  static const uint8_t lens[] = {16, 64, 255};
+
+  printf("RX completion read: %d packets per run, alternating runs mix in %d-byte frames\n",
+         BENCH_PACKETS,
+         BENCH_SHORT_LEN);
+
+  for (size_t i = 0; i < sizeof(lens); i++)
+  {
+    bench_run(BENCH_NAIVE, lens[i]);
+    bench_run(BENCH_CHAINED, lens[i]);
+    bench_run(BENCH_CHAINED_ALTERNATING, lens[i]);
+  }
+
+  return bench_exit_status;
+}
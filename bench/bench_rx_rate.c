@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for continuous RX.
+ *
+ * Schedules a steady stream of packets on the simulated chip and lets the driver's DIO1 handler
+ * drain them into the RX ring while a consumer empties the ring periodically. The offered rate is
+ * swept upwards; the highest rate with no lost packets is the maximum sustained rate of the drain
+ * path. Over-the-air timing is deliberately ignored here: the point is the host/bus side.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/rx_ring.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_PACKETS 2000
+#define BENCH_PAYLOAD_LEN 16
+#define BENCH_RING_SLOTS 16
+#define BENCH_CONSUMER_PERIOD_NS 1000000ull // consumer wakes every 1ms
+
+typedef struct
+{
+  uint32_t offered;
+  uint32_t consumed;
+  uint64_t transactions;
+  uint64_t bus_ns;
+  sx126x_rx_stats_t rx_stats;
+  uint64_t overwritten;
+} bench_result_t;
+
+static void bench_run(uint32_t pps, bench_result_t *res)
+{
+  static sx126x_hal_t sim;
+  static sx126x_rx_packet_t slots[BENCH_RING_SLOTS];
+  sx126x_rx_ring_t ring;
+  sx126x_rx_packet_t pkt;
+
+  sx126x_hal_sim_init(&sim, NULL);
+  sx126x_rx_ring_init(&ring, slots, BENCH_RING_SLOTS);
+
+  sx126x_config_t cfg;
+  bench_default_config(&cfg);
+  cfg.lora_sf = SX126X_LORA_SF_5;
+  cfg.lora_bw = SX126X_LORA_BW_500;
+
+  sx126x_t *dev = sx126x_hal_get_device(&sim);
+  if (sx126x_init(dev, sx126x_hal_get_bus(&sim), &cfg) != SX126X_OK ||
+      sx126x_receive_continuous(dev, &ring) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to start continuous RX\n");
+    exit(1);
+  }
+
+  sx126x_hal_sim_advance(&sim, 1000000);
+  sx126x_hal_sim_reset_stats(&sim);
+
+  uint8_t payload[BENCH_PAYLOAD_LEN];
+  memset(payload, 0xA5, sizeof(payload));
+
+  uint64_t interval = 1000000000ull / pps;
+  uint64_t t0 = sx126x_hal_sim_now_ns(&sim);
+  uint64_t next_consume = t0 + BENCH_CONSUMER_PERIOD_NS;
+
+  memset(res, 0, sizeof(*res));
+
+  // Keep arrivals scheduled ahead of the clock so they land at their exact time, even in the
+  // middle of the handler draining the previous packet.
+  uint32_t scheduled = 0;
+  uint64_t end = t0 + (BENCH_PACKETS + 1) * interval;
+
+  while (sx126x_hal_sim_now_ns(&sim) < end)
+  {
+    while (scheduled < BENCH_PACKETS && sim.rx_queue_len < SX126X_HAL_SIM_RX_QUEUE)
+    {
+      scheduled++;
+      sx126x_hal_sim_schedule_rx(
+          &sim, t0 + scheduled * interval, payload, sizeof(payload), -80, 8, true);
+      res->offered++;
+    }
+
+    sx126x_hal_sim_advance(&sim, interval);
+
+    if (sx126x_hal_sim_now_ns(&sim) >= next_consume)
+    {
+      while (sx126x_rx_ring_pop(&ring, &pkt))
+        res->consumed++;
+      next_consume += BENCH_CONSUMER_PERIOD_NS;
+    }
+  }
+
+  sx126x_hal_sim_advance(&sim, 10 * BENCH_CONSUMER_PERIOD_NS);
+  while (sx126x_rx_ring_pop(&ring, &pkt))
+    res->consumed++;
+
+  res->transactions = sim.stats.transactions;
+  res->bus_ns = sim.stats.bus_ns;
+  res->rx_stats = dev->rx_stats;
+  res->overwritten = sim.stats.rx_overwritten;
+
+  sx126x_receive_stop(dev);
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&sim);
+}
+
+int main(void)
+{
+  bench_result_t res;
+  uint32_t best = 0;
+
+  printf("continuous RX: %d packets of %d bytes per rate, %d ring slots, consumer every %llu us\n",
+         BENCH_PACKETS,
+         BENCH_PAYLOAD_LEN,
+         BENCH_RING_SLOTS,
+         BENCH_CONSUMER_PERIOD_NS / 1000);
+
+  for (uint32_t pps = 1000; pps <= 64000; pps = pps * 5 / 4)
+  {
+    bench_run(pps, &res);
+
+    uint32_t lost = res.offered - res.consumed;
+    printf("%6u pkt/s: lost=%5u (overrun=%u overwritten=%llu) txn/pkt=%4.2f drain/pkt=%7.2f us\n",
+           pps,
+           lost,
+           res.rx_stats.overruns,
+           (unsigned long long)res.overwritten,
+           (double)res.transactions / res.offered,
+           (double)res.bus_ns / res.offered / 1000.0);
+
+    if (lost == 0)
+      best = pps;
+    else
+      break;
+  }
+
+  printf("max sustained rate without drops: %u pkt/s\n", best);
+  return bench_exit_status;
+}
@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for single receive windows, e.g. the downlink slots of a LoRaWAN class A
+ * device.
+ *
+ * Every window is opened ahead of a packet that is expected at a known time, give or take a timing
+ * uncertainty; only some windows actually carry a packet. A fixed, hand-picked RX timeout that is
+ * long enough for the slowest spreading factor is compared against sx126x_receive_window, which
+ * derives the symbol-number timeout and the RX timeout from the modulation and the preamble.
+ * RX-on time is modelled time from SetRx to the end of the window; charge assumes the SX1262's
+ * 4.6 mA receive current.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sx126x/airtime.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/rx_ring.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_WINDOWS 300
+#define BENCH_PAYLOAD_LEN 16
+#define BENCH_RING_SLOTS 4
+// Every third window carries a packet.
+#define BENCH_PACKET_EVERY 3
+#define BENCH_UNCERTAINTY_US 1000
+#define BENCH_FIXED_TIMEOUT_US 1000000
+#define BENCH_RX_CURRENT_MA 4.6
+
+typedef enum
+{
+  BENCH_FIXED,
+  BENCH_DERIVED,
+} bench_mode_t;
+
+static const char *const bench_mode_names[] = {"fixed 1 s", "derived"};
+
+static sx126x_hal_t bench_sim;
+static bool bench_closed;
+static sx126x_status_t bench_result;
+static uint64_t bench_closed_ns;
+static uint32_t bench_rng = 1;
+
+static int32_t bench_offset_us(void)
+{
+  bench_rng = bench_rng * 1103515245u + 12345u;
+  return (int32_t)((bench_rng >> 8) % (2 * BENCH_UNCERTAINTY_US + 1)) - BENCH_UNCERTAINTY_US;
+}
+
+static void bench_rx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  (void)dev;
+  (void)arg;
+
+  bench_closed = true;
+  bench_result = result;
+  bench_closed_ns = sx126x_hal_sim_now_ns(&bench_sim);
+}
+
+static void bench_run(sx126x_lora_spreading_factor_t sf, bench_mode_t mode)
+{
+  static sx126x_rx_packet_t slots[BENCH_RING_SLOTS];
+  sx126x_rx_ring_t ring;
+  sx126x_rx_packet_t pkt;
+  uint8_t payload[BENCH_PAYLOAD_LEN];
+  sx126x_config_t cfg;
+
+  memset(payload, 0x6B, sizeof(payload));
+  bench_default_config(&cfg);
+  cfg.lora_sf = sf;
+  cfg.lora_crc_on = true;
+  bench_rng = 1;
+
+  sx126x_hal_sim_init(&bench_sim, NULL);
+  sx126x_rx_ring_init(&ring, slots, BENCH_RING_SLOTS);
+  sx126x_t *dev = sx126x_hal_get_device(&bench_sim);
+  if (sx126x_init(dev, sx126x_hal_get_bus(&bench_sim), &cfg) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to initialize the radio\n");
+    exit(1);
+  }
+
+  uint64_t empty_ns = 0;
+  uint64_t full_ns = 0;
+  uint32_t sent = 0;
+  uint32_t received = 0;
+  uint32_t bad = 0;
+
+  for (int i = 0; i < BENCH_WINDOWS; i++)
+  {
+    bool has_packet = i % BENCH_PACKET_EVERY == 0;
+    uint64_t expected_ns =
+        sx126x_hal_sim_now_ns(&bench_sim) + 10000000 + BENCH_UNCERTAINTY_US * 1000;
+
+    // Open the window early by the uncertainty.
+    sx126x_hal_sim_advance(&bench_sim, 10000000);
+    uint64_t open_ns = sx126x_hal_sim_now_ns(&bench_sim);
+    bench_closed = false;
+
+    sx126x_status_t st = mode == BENCH_FIXED
+                             ? sx126x_receive_single(
+                                   dev, &ring, BENCH_FIXED_TIMEOUT_US, 0, bench_rx_done, NULL)
+                             : sx126x_receive_window(
+                                   dev, &ring, BENCH_UNCERTAINTY_US, bench_rx_done, NULL);
+    if (st != SX126X_OK)
+    {
+      bad++;
+      continue;
+    }
+
+    if (has_packet)
+    {
+      uint64_t start_ns = expected_ns + (int64_t)bench_offset_us() * 1000;
+      uint64_t end_ns = start_ns + sx126x_hal_sim_airtime_ns(&bench_sim, BENCH_PAYLOAD_LEN);
+      sx126x_hal_sim_schedule_rx(&bench_sim, end_ns, payload, BENCH_PAYLOAD_LEN, -90, 5, true);
+      sent++;
+    }
+
+    for (int k = 0; k < 100 && !bench_closed; k++)
+      sx126x_hal_sim_advance(&bench_sim, 100000000);
+
+    if (!bench_closed)
+    {
+      bad++;
+      sx126x_receive_stop(dev);
+      continue;
+    }
+
+    if (bench_result == SX126X_OK && sx126x_rx_ring_pop(&ring, &pkt))
+      received++;
+    else if (bench_result != SX126X_ERR_TIMEOUT)
+      bad++;
+
+    if (has_packet)
+      full_ns += bench_closed_ns - open_ns;
+    else
+      empty_ns += bench_closed_ns - open_ns;
+  }
+
+  uint32_t windows_empty = BENCH_WINDOWS - sent;
+  double total_ms = (double)(empty_ns + full_ns) / 1e6;
+  double charge_uc = total_ms * BENCH_RX_CURRENT_MA;
+
+  bench_expect(bad == 0);
+  printf("SF%-2d %-9s ldro=%d empty=%8.2f ms with-packet=%8.2f ms received=%3u/%3u "
+         "charge/packet=%8.1f uC bad=%u\n",
+         sf,
+         bench_mode_names[mode],
+         bench_sim.chip.mod_params[3],
+         (double)empty_ns / 1e6 / windows_empty,
+         sent ? (double)full_ns / 1e6 / sent : 0.0,
+         received,
+         sent,
+         received ? charge_uc / received : 0.0,
+         bad);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&bench_sim);
+}
+
+int main(void)
+{
+  printf("RX windows: %d per run, a packet in 1 of %d, +/-%d us timing uncertainty, 125 kHz\n",
+         BENCH_WINDOWS,
+         BENCH_PACKET_EVERY,
+         BENCH_UNCERTAINTY_US);
+
+  for (int sf = SX126X_LORA_SF_7; sf <= SX126X_LORA_SF_12; sf++)
+  {
+    bench_run((sx126x_lora_spreading_factor_t)sf, BENCH_FIXED);
+    bench_run((sx126x_lora_spreading_factor_t)sf, BENCH_DERIVED);
+  }
+
+  return bench_exit_status;
+}
@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for the TX to RX turnaround of an ACK exchange.
+ *
+ * Each exchange sends a 16 byte packet at SF7/125 kHz and opens a receive window for the 4 byte
+ * ACK, which the peer starts 1 ms after the packet ends. The simulator times every turnaround from
+ * TxDone to the moment the receiver runs, i.e. the DIO1 handler, the bus traffic it issues and the
+ * chip's own start-up from its fallback mode.
+ *
+ * The baseline answers the TX-done callback with sx126x_receive_single, so the chip falls back to
+ * STDBY_RC and the host sets up a new window. sx126x_transmit_receive instead sends a SetRx frame
+ * encoded before the packet went out, once with each fallback mode. All paths run on the default
+ * bus and on a slow one, with the DIO1 handler run as soon as the line goes high.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/airtime.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/rx_ring.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_EXCHANGES 100
+#define BENCH_PAYLOAD_LEN 16
+#define BENCH_ACK_LEN 4
+#define BENCH_ACK_DELAY_NS 1000000ull
+#define BENCH_WINDOW_US 50000
+
+typedef struct
+{
+  const char *name;
+  sx126x_fallback_mode_t fallback;
+  bool chained; // sx126x_transmit_receive rather than receive_single from the TX callback
+} bench_setup_t;
+
+static const bench_setup_t bench_setups[] = {
+    {"callback STDBY_RC", SX126X_FALLBACK_STDBY_RC, false},
+    {"callback FS", SX126X_FALLBACK_FS, false},
+    {"chained STDBY_RC", SX126X_FALLBACK_STDBY_RC, true},
+    {"chained STDBY_XOSC", SX126X_FALLBACK_STDBY_XOSC, true},
+    {"chained FS", SX126X_FALLBACK_FS, true},
+};
+
+static const struct
+{
+  const char *name;
+  sx126x_hal_sim_cfg_t sim;
+} bench_buses[] = {
+    {"default bus", {0}},
+    {"slow bus", {.spi_clock_hz = 1000000, .txn_overhead_ns = 200000, .disable_batch = true}},
+};
+
+static sx126x_hal_t bench_sim;
+static sx126x_rx_ring_t bench_ring;
+static sx126x_rx_packet_t bench_slots[4];
+static uint8_t bench_payload[BENCH_PAYLOAD_LEN];
+static const uint8_t bench_ack[BENCH_ACK_LEN] = {0xAC, 0x4B, 0x00, 0x01};
+static bool bench_done;
+static sx126x_status_t bench_result;
+
+static void bench_rx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  (void)dev;
+  (void)arg;
+
+  bench_done = true;
+  bench_result = result;
+}
+
+static void bench_tx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  (void)arg;
+
+  if (result != SX126X_OK ||
+      sx126x_receive_single(dev, &bench_ring, BENCH_WINDOW_US, 0, bench_rx_done, NULL) !=
+          SX126X_OK)
+  {
+    bench_done = true;
+    bench_result = result != SX126X_OK ? result : SX126X_ERR_BUSY;
+  }
+}
+
+static void bench_run(const bench_setup_t *setup, size_t bus)
+{
+  sx126x_config_t cfg;
+
+  bench_default_config(&cfg);
+  cfg.fallback_mode = setup->fallback;
+
+  sx126x_hal_sim_init(&bench_sim, &bench_buses[bus].sim);
+  sx126x_t *dev = sx126x_hal_get_device(&bench_sim);
+  if (sx126x_init(dev, sx126x_hal_get_bus(&bench_sim), &cfg) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to initialize the radio\n");
+    exit(1);
+  }
+  sx126x_rx_ring_init(&bench_ring, bench_slots, sizeof(bench_slots) / sizeof(bench_slots[0]));
+
+  uint64_t tx_ns = sx126x_time_on_air_us(&cfg, BENCH_PAYLOAD_LEN) * 1000ull;
+  uint64_t ack_ns = sx126x_time_on_air_us(&cfg, BENCH_ACK_LEN) * 1000ull;
+  uint32_t acks = 0;
+
+  sx126x_hal_sim_reset_stats(&bench_sim);
+
+  for (int i = 0; i < BENCH_EXCHANGES; i++)
+  {
+    uint64_t start_ns = sx126x_hal_sim_now_ns(&bench_sim);
+    sx126x_status_t st;
+
+    bench_done = false;
+    if (setup->chained)
+      st = sx126x_transmit_receive(dev,
+                                   bench_payload,
+                                   BENCH_PAYLOAD_LEN,
+                                   0,
+                                   &bench_ring,
+                                   BENCH_WINDOW_US,
+                                   0,
+                                   bench_rx_done,
+                                   NULL);
+    else
+      st = sx126x_transmit_async(dev, bench_payload, BENCH_PAYLOAD_LEN, 0, bench_tx_done, NULL);
+    if (st != SX126X_OK)
+    {
+      fprintf(stderr, "failed to start exchange %d\n", i);
+      exit(1);
+    }
+
+    // The packet goes on air once the bus has carried the TX setup; the simulator only checks that
+    // the receiver is on when the ACK ends, which the setup time does not move past.
+    uint64_t ack_end_ns = start_ns + tx_ns + BENCH_ACK_DELAY_NS + ack_ns;
+    sx126x_hal_sim_schedule_rx(&bench_sim, ack_end_ns, bench_ack, BENCH_ACK_LEN, -60, 8, true);
+
+    for (int n = 0; n < 1000 && !bench_done; n++)
+      sx126x_hal_sim_advance(&bench_sim, 1000000);
+
+    sx126x_rx_packet_t pkt;
+    while (sx126x_rx_ring_pop(&bench_ring, &pkt))
+    {
+      if (bench_done && bench_result == SX126X_OK && pkt.len == BENCH_ACK_LEN)
+        acks++;
+    }
+  }
+
+  const sx126x_hal_sim_stats_t *s = &bench_sim.stats;
+  bench_expect(acks == BENCH_EXCHANGES);
+  printf("%-18s %-11s turnaround avg=%6.1f us max=%6.1f us bus-calls/exchange=%.2f acks=%u/%d\n",
+         setup->name,
+         bench_buses[bus].name,
+         s->turnarounds ? (double)s->turnaround_total_ns / s->turnarounds / 1e3 : 0.0,
+         (double)s->turnaround_max_ns / 1e3,
+         (double)s->transactions / BENCH_EXCHANGES,
+         acks,
+         BENCH_EXCHANGES);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&bench_sim);
+}
+
+int main(void)
+{
+  memset(bench_payload, 0x5A, sizeof(bench_payload));
+
+  printf("%d exchanges of a %d byte packet and a %d byte ACK, SF7/125 kHz\n",
+         BENCH_EXCHANGES,
+         BENCH_PAYLOAD_LEN,
+         BENCH_ACK_LEN);
+
+  for (size_t b = 0; b < sizeof(bench_buses) / sizeof(bench_buses[0]); b++)
+  {
+    for (size_t s = 0; s < sizeof(bench_setups) / sizeof(bench_setups[0]); s++)
+      bench_run(&bench_setups[s], b);
+  }
+
+  return bench_exit_status;
+}
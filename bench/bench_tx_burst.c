@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Host-side benchmark for back-to-back transmission.
+ *
+ * Sends a burst of packets on the simulated chip, once by calling sx126x_transmit_async from each
+ * completion callback (the payload upload sits between TxDone and the next SetTx) and once through
+ * the double-buffered TX queue (the next payload is uploaded while the current packet is on air),
+ * and reports the average idle gap on air between consecutive packets.
+ */
+
+#include "bench_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/sx126x.h>
+
+#define BENCH_PACKETS 200
+#define BENCH_STEP_NS 10000
+
+typedef struct
+{
+  bool queued;
+  uint8_t len;
+  uint32_t started;
+  uint32_t done;
+  uint32_t failed;
+} bench_burst_t;
+
+static uint8_t payload[SX126X_MAX_PAYLOAD_LEN];
+
+static void bench_tx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  bench_burst_t *b = (bench_burst_t *)arg;
+
+  if (result == SX126X_OK)
+    b->done++;
+  else
+    b->failed++;
+
+  if (b->started == BENCH_PACKETS)
+    return;
+
+  sx126x_status_t st = b->queued
+                           ? sx126x_tx_queue_push(dev, payload, b->len, 0, bench_tx_done, b)
+                           : sx126x_transmit_async(dev, payload, b->len, 0, bench_tx_done, b);
+  if (st == SX126X_OK)
+    b->started++;
+}
+
+static void bench_run(const char *name, bool queued, uint8_t len)
+{
+  static sx126x_hal_t sim;
+  sx126x_hal_sim_init(&sim, NULL);
+
+  sx126x_config_t cfg;
+  bench_default_config(&cfg);
+  cfg.lora_sf = SX126X_LORA_SF_5;
+  cfg.lora_bw = SX126X_LORA_BW_500;
+
+  sx126x_t *dev = sx126x_hal_get_device(&sim);
+  if (sx126x_init(dev, sx126x_hal_get_bus(&sim), &cfg) != SX126X_OK)
+  {
+    fprintf(stderr, "%s: init failed\n", name);
+    exit(1);
+  }
+
+  sx126x_hal_sim_advance(&sim, 1000000);
+
+  bench_burst_t b = {.queued = queued, .len = len};
+  uint64_t airtime = 0;
+  uint64_t first_start = 0;
+
+  // The queue takes two packets up front: one on air, one staged behind it.
+  for (int i = 0; i < (queued ? 2 : 1); i++)
+  {
+    sx126x_status_t st = queued ? sx126x_tx_queue_push(dev, payload, len, 0, bench_tx_done, &b)
+                                : sx126x_transmit_async(dev, payload, len, 0, bench_tx_done, &b);
+    if (st != SX126X_OK)
+    {
+      fprintf(stderr, "%s: failed to start burst (%d)\n", name, st);
+      exit(1);
+    }
+    b.started++;
+
+    if (i == 0)
+    {
+      airtime = sx126x_hal_sim_airtime_ns(&sim, len);
+      first_start = sim.chip.tx_done_at_ns - airtime;
+    }
+  }
+
+  while (b.done + b.failed < BENCH_PACKETS)
+    sx126x_hal_sim_advance(&sim, BENCH_STEP_NS);
+
+  uint64_t span = sim.chip.tx_done_at_ns - first_start;
+  double gap_us = (double)(span - BENCH_PACKETS * airtime) / (BENCH_PACKETS - 1) / 1000.0;
+
+  bench_expect(b.failed == 0);
+  printf("%-8s len=%3u airtime=%7.1f us gap=%6.1f us throughput=%6.1f pkt/s failed=%u\n",
+         name,
+         len,
+         (double)airtime / 1000.0,
+         gap_us,
+         BENCH_PACKETS * 1e9 / (double)span,
+         b.failed);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&sim);
+}
+
+int main(void)
+{
+  memset(payload, 0xC3, sizeof(payload));
+
+  printf("TX burst: %d packets at SF5/BW500 on the simulated chip\n", BENCH_PACKETS);
+
+  static const uint8_t lens[] = {16, 64, 128};
+  for (size_t i = 0; i < sizeof(lens); i++)
+  {
+    bench_run("async", false, lens[i]);
+    bench_run("queue", true, lens[i]);
+  }
+
+  return bench_exit_status;
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file bench_util.h
+ * @brief Shared helpers for the host-side benchmarks.
+ */
+
+#ifndef SX126X_BENCH_UTIL_H
+#define SX126X_BENCH_UTIL_H
+
+// clock_gettime() under strict ISO C builds. Include this header first.
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sx126x/sx126x.h>
+#include <time.h>
+
+// Exit status of the benchmark, non-zero once a run's results failed their checks.
+static int bench_exit_status;
+
+static inline void bench_expect(bool ok)
+{
+  if (!ok)
+    bench_exit_status = 1;
+}
+
+static inline uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// A representative SX1262 LoRa configuration shared by the benchmarks.
+static inline void bench_default_config(sx126x_config_t *cfg)
+{
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->chip = SX126X_CHIP_SX1262;
+  cfg->frequency_hz = 915000000;
+  cfg->pa_profile = SX126X_PA_HIGH_POWER;
+  cfg->modem = SX126X_MODEM_LORA;
+  cfg->power_dbm = 22;
+  cfg->power_ramp_time = SX126X_PWR_RAMP_TIME_200U;
+  cfg->lora_sf = SX126X_LORA_SF_7;
+  cfg->lora_bw = SX126X_LORA_BW_125;
+  cfg->lora_cr = SX126X_LORA_CR_4_5;
+  cfg->lora_ldro = false;
+}
+
+#endif // SX126X_BENCH_UTIL_H
@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file adr.h
+ * @brief Adaptive data rate: per-peer LoRa spreading factor, bandwidth and power from link quality.
+ * @version 0.1
+ * @date 2025
+ */
+
+#ifndef SX126X_ADR_H
+#define SX126X_ADR_H
+
+#include "sx126x/rx_ring.h"
+#include "sx126x/sx126x.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Samples of link quality kept per peer. */
+#define SX126X_ADR_HISTORY 16
+
+/** Bit of a bandwidth in sx126x_adr_cfg_t.bw_mask. */
+#define SX126X_ADR_BW(bw) (1u << (bw))
+
+/** Reported LoRa SNR stops rising at about this level; above it the RSSI is used instead. */
+#define SX126X_ADR_SNR_SATURATION_DB 10
+
+/** Receiver noise figure assumed when estimating the SNR from the RSSI. */
+#define SX126X_ADR_NOISE_FIGURE_DB 6
+
+/**
+ * @brief ADR settings.
+ */
+typedef struct
+{
+  sx126x_lora_spreading_factor_t sf_min; /**< Fastest spreading factor allowed */
+  sx126x_lora_spreading_factor_t sf_max; /**< Most robust spreading factor allowed */
+  uint16_t bw_mask; /**< SX126X_ADR_BW() of each allowed bandwidth, 0 for the radio's current one */
+  int8_t power_min_dbm; /**< Lowest output power, within the range of the radio's PA */
+  int8_t power_max_dbm; /**< Highest output power, within the range of the radio's PA */
+  uint8_t power_step_db; /**< Power granularity above power_min_dbm, 0 for 1 dB */
+  uint8_t margin_db;     /**< Link margin kept above the demodulator floor, e.g. 10 */
+  uint8_t min_samples;   /**< Samples needed before a peer moves off its current setting */
+  uint8_t loss_limit;    /**< Unanswered packets in a row before stepping back, 0 for never */
+  uint8_t payload_len;   /**< Typical payload length, used to rank settings by time on air */
+} sx126x_adr_cfg_t;
+
+/**
+ * @brief The settings a peer is reached with.
+ */
+typedef struct
+{
+  sx126x_lora_spreading_factor_t sf;
+  sx126x_lora_bandwidth_t bw;
+  int8_t power_dbm;
+} sx126x_adr_setting_t;
+
+/**
+ * @brief Link state of one peer. Storage is owned by the caller; set it up with
+ * sx126x_adr_peer_init.
+ */
+typedef struct
+{
+  sx126x_adr_setting_t setting; /**< Current decision */
+  int16_t link_db10[SX126X_ADR_HISTORY]; // SNR at 125 kHz and 0 dBm, in 0.1 dB
+  int16_t rssi_dbm[SX126X_ADR_HISTORY];  /**< RSSI of each sample, as received */
+  uint8_t next;                          // history slot of the next sample
+  uint8_t count;                         /**< Samples in the history */
+  uint8_t losses;                        /**< Unanswered packets since the last sample */
+} sx126x_adr_peer_t;
+
+/**
+ * @brief ADR counters.
+ */
+typedef struct
+{
+  uint32_t samples;    /**< Packets recorded */
+  uint32_t changes;    /**< Decisions that moved a peer to another setting */
+  uint32_t step_backs; /**< Changes made after loss_limit unanswered packets */
+  uint32_t applied;    /**< Calls to sx126x_reconfigure made by sx126x_adr_apply */
+} sx126x_adr_stats_t;
+
+/**
+ * @brief ADR state.
+ */
+typedef struct
+{
+  sx126x_t *radio;
+  sx126x_adr_cfg_t cfg;
+  sx126x_adr_stats_t stats;
+} sx126x_adr_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Set up ADR for an initialized LoRa radio.
+ *
+ * @param cfg Settings; sf_min to sf_max must be a valid range, bw_mask may only name LoRa
+ * bandwidths and power_min_dbm must not exceed power_max_dbm.
+ * @return SX126X_OK if successful, SX126X_ERR_NOT_INIT if the radio is not initialized for LoRa,
+ * SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_adr_init(sx126x_adr_t *adr, sx126x_t *radio, const sx126x_adr_cfg_t *cfg);
+
+/**
+ * @brief Start a peer with an empty history at the most robust setting: sf_max, the narrowest
+ * allowed bandwidth and power_max_dbm.
+ */
+void sx126x_adr_peer_init(const sx126x_adr_t *adr, sx126x_adr_peer_t *peer);
+
+/**
+ * @brief Record a packet heard from a peer, sent with the peer's current setting. The oldest
+ * sample is dropped once the history is full.
+ */
+void sx126x_adr_record(sx126x_adr_t *adr, sx126x_adr_peer_t *peer, const sx126x_rx_packet_t *pkt);
+
+/**
+ * @brief Record a packet to a peer that went unanswered. After loss_limit in a row the peer's
+ * history is cleared and it steps back: to power_max_dbm first, then to the next spreading factor,
+ * then to the next narrower bandwidth.
+ *
+ * @return true if the peer's setting changed.
+ */
+bool sx126x_adr_lost(sx126x_adr_t *adr, sx126x_adr_peer_t *peer);
+
+/**
+ * @brief Pick a peer's setting from its history, once it holds at least min_samples samples.
+ *
+ * The average link quality of the history is used. If no allowed setting keeps margin_db, the
+ * peer gets the most robust one.
+ *
+ * @return true if the peer's setting changed.
+ */
+bool sx126x_adr_update(sx126x_adr_t *adr, sx126x_adr_peer_t *peer);
+
+/**
+ * @brief Switch the radio to a peer's setting before talking to it. Does nothing if the radio
+ * already uses it.
+ *
+ * @return SX126X_OK if successful, or the error from sx126x_reconfigure, e.g. SX126X_ERR_BUSY while
+ * the radio is not in standby.
+ */
+sx126x_status_t sx126x_adr_apply(sx126x_adr_t *adr, const sx126x_adr_peer_t *peer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_ADR_H
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file aggregate.h
+ * @brief Packing of short application messages into shared frames, and unpacking on receive.
+ * @version 0.1
+ * @date 2025
+ */
+
+#ifndef SX126X_AGGREGATE_H
+#define SX126X_AGGREGATE_H
+
+#include "sx126x/commands.h"
+#include "sx126x/sx126x.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Bytes each message adds to a frame besides its own. */
+#define SX126X_AGG_PREFIX_LEN 1
+
+/** Longest message, which fills a frame of SX126X_MAX_PAYLOAD_LEN on its own. */
+#define SX126X_AGG_MAX_MSG_LEN (SX126X_MAX_PAYLOAD_LEN - SX126X_AGG_PREFIX_LEN)
+
+/**
+ * @brief Aggregator settings.
+ */
+typedef struct
+{
+  uint8_t max_len;       /**< Frame size limit, at least 2 bytes; 0 for SX126X_MAX_PAYLOAD_LEN */
+  uint32_t max_delay_us; /**< Longest a message waits for others, 0 to send each one at once */
+  uint8_t overhead_pct;  /**< Send once the fixed cost is at most this share of a frame, 0 never */
+  sx126x_tx_done_cb_t done; /**< Called as each frame finishes or is dropped, may be NULL */
+  void *arg;                /**< Passed to done */
+} sx126x_agg_cfg_t;
+
+/**
+ * @brief Aggregator counters.
+ */
+typedef struct
+{
+  uint32_t messages;       /**< Messages added */
+  uint32_t frames;         /**< Frames started */
+  uint32_t failed;         /**< Frames dropped because the radio refused them */
+  uint32_t flush_size;     /**< Frames sent because the next message did not fit */
+  uint32_t flush_deadline; /**< Frames sent because the oldest message reached max_delay_us */
+  uint32_t flush_overhead; /**< Frames sent because their fixed cost fell to overhead_pct */
+  uint32_t flush_explicit; /**< Frames sent by sx126x_agg_flush */
+  uint64_t airtime_us;     /**< Time on air of the frames started */
+  uint64_t single_us;      /**< Time on air of the same messages one per packet */
+} sx126x_agg_stats_t;
+
+/**
+ * @brief Aggregator state. Storage, including the frame being filled, is owned by the caller.
+ */
+typedef struct
+{
+  sx126x_t *radio;
+  sx126x_agg_cfg_t cfg;
+  uint8_t frame[SX126X_MAX_PAYLOAD_LEN];
+  uint8_t len;        /**< Bytes in frame */
+  uint8_t count;      /**< Messages in frame */
+  uint32_t first_us;  // time the oldest message was added
+  uint32_t single_us; // time on air of the messages in frame as packets of their own
+  bool ready;         // frame goes out as soon as the radio is free
+  sx126x_agg_stats_t stats;
+} sx126x_agg_t;
+
+/**
+ * @brief Position within a received frame.
+ */
+typedef struct
+{
+  const uint8_t *frame;
+  uint8_t len;
+  uint8_t pos; /**< Offset of the next message's length byte */
+} sx126x_agg_iter_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Set up an aggregator for an initialized radio.
+ *
+ * @return SX126X_OK if successful, SX126X_ERR_NOT_INIT if the radio is not initialized,
+ * SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_agg_init(sx126x_agg_t *agg, sx126x_t *radio, const sx126x_agg_cfg_t *cfg);
+
+/**
+ * @brief Copy a message into the frame being filled, sending frames as the settings demand.
+ *
+ * Time on air is computed from the radio's current configuration.
+ *
+ * @param len Message length, 1 to max_len - 1 bytes.
+ * @param now_us Current time in microseconds; may wrap.
+ * @return SX126X_OK if the message was taken, SX126X_ERR_BUSY if the frame is full and the radio
+ * has not yet finished the previous one, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_agg_add(sx126x_agg_t *agg, const uint8_t *msg, uint8_t len, uint32_t now_us);
+
+/**
+ * @brief Send the frame being filled as soon as the radio is free, even if it holds one message.
+ *
+ * @return true if a frame was started.
+ */
+bool sx126x_agg_flush(sx126x_agg_t *agg);
+
+/**
+ * @brief Send the frame being filled if its oldest message has waited max_delay_us, or if it was
+ * due while the radio was busy.
+ *
+ * A frame the radio refuses for a reason other than being busy is dropped and the done callback
+ * runs with the error.
+ *
+ * @param now_us Current time in microseconds; may wrap.
+ * @param wait_us Optional. Time until the frame is due, 0 if it is waiting for the radio to
+ * become idle (sx126x_is_idle), UINT32_MAX if it is empty.
+ * @return true if a frame was started.
+ */
+bool sx126x_agg_poll(sx126x_agg_t *agg, uint32_t now_us, uint32_t *wait_us);
+
+/**
+ * @brief Start walking the messages of a received frame. The frame must stay valid while they are
+ * in use.
+ */
+void sx126x_agg_iter_init(sx126x_agg_iter_t *it, const uint8_t *frame, uint8_t len);
+
+/**
+ * @brief Get the next message of a frame, as a pointer into it.
+ *
+ * @return true if a message was found; false at the end of the frame, or at a length byte that
+ * is zero or runs past it, in which case pos stays short of len.
+ */
+bool sx126x_agg_next(sx126x_agg_iter_t *it, const uint8_t **msg, uint8_t *len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_AGGREGATE_H
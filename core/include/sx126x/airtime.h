@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file airtime.h
+ * @brief Integer time-on-air of a packet for a given configuration.
+ * @version 0.1
+ * @date 2025
+ *
+ * Follows the time-on-air formulas of the SX126x datasheet. Every LoRa bandwidth is an integer
+ * fraction of the 32 MHz crystal, so the symbol time comes from a small divider table and the
+ * calculation needs neither floating point nor a run-time division by the bandwidth. Cheap enough
+ * to run per packet, e.g. to charge a duty-cycle budget or to size a receive window.
+ */
+
+#ifndef SX126X_AIRTIME_H
+#define SX126X_AIRTIME_H
+
+#include "sx126x/sx126x.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Crystal divider of a LoRa bandwidth code (BW = 32 MHz / div), 0 for an unused code. A
+ * constant expression when bw is one. */
+#define SX126X_LORA_BW_DIV(bw)                                                                     \
+  ((bw) == SX126X_LORA_BW_7     ? 4096u                                                            \
+   : (bw) == SX126X_LORA_BW_10  ? 3072u                                                            \
+   : (bw) == SX126X_LORA_BW_15  ? 2048u                                                            \
+   : (bw) == SX126X_LORA_BW_20  ? 1536u                                                            \
+   : (bw) == SX126X_LORA_BW_32  ? 1024u                                                            \
+   : (bw) == SX126X_LORA_BW_41  ? 768u                                                             \
+   : (bw) == SX126X_LORA_BW_62  ? 512u                                                             \
+   : (bw) == SX126X_LORA_BW_125 ? 256u                                                             \
+   : (bw) == SX126X_LORA_BW_250 ? 128u                                                             \
+   : (bw) == SX126X_LORA_BW_500 ? 64u                                                              \
+                                : 0u)
+
+/** Symbol time above which the datasheet requires Low Data Rate Optimization. */
+#define SX126X_LORA_LDRO_SYMBOL_NS 16000000UL
+
+/** Whether sf and bw need LDRO: 2^SF * div / 32 MHz > 16 ms, i.e. 2^SF * div > 512000. A
+ * constant expression when sf and bw are. */
+#define SX126X_LORA_LDRO_REQUIRED(sf, bw) ((SX126X_LORA_BW_DIV(bw) << (sf)) > 512000u)
+
+/** Preamble symbols the LoRa receiver needs to see to lock onto a packet. */
+#define SX126X_LORA_RX_DETECT_SYMBOLS 6
+
+/** Largest symbol-number timeout the chip represents exactly (mantissa 31, exponent 1). */
+#define SX126X_LORA_RX_SYMBOLS_MAX 248
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Duration of one LoRa symbol, 2^SF / BW, in nanoseconds.
+ *
+ * @return Symbol time, or 0 if sf or bw is not a valid setting.
+ */
+uint32_t sx126x_lora_symbol_ns(sx126x_lora_spreading_factor_t sf, sx126x_lora_bandwidth_t bw);
+
+/**
+ * @brief Whether LDRO is in effect for a LoRa configuration: when lora_ldro forces it, or
+ * automatically when a symbol lasts longer than 16 ms.
+ */
+bool sx126x_lora_ldro_enabled(const sx126x_config_t *cfg);
+
+/**
+ * @brief Time on air of a payload_len byte packet with the modem settings of cfg.
+ *
+ * Covers the preamble, sync word, header and CRC as the configuration enables them. Rounded up
+ * to the next microsecond.
+ *
+ * @return Time on air in microseconds, or 0 if cfg holds no valid modem settings.
+ */
+uint32_t sx126x_time_on_air_us(const sx126x_config_t *cfg, uint8_t payload_len);
+
+/**
+ * @brief LoRa symbol-number timeout for a receive window.
+ *
+ * The window has to cover the uncertainty in when the preamble starts, on either side of the
+ * expected time, plus the symbols the receiver needs to detect it. The result is rounded up to a
+ * value the chip represents exactly and capped at SX126X_LORA_RX_SYMBOLS_MAX.
+ *
+ * @param uncertainty_us How early or late the preamble may start, each way.
+ * @return Symbols to wait for a preamble, or 0 if cfg is not a valid LoRa configuration.
+ */
+uint8_t sx126x_lora_rx_symbols(const sx126x_config_t *cfg, uint32_t uncertainty_us);
+
+/**
+ * @brief Shortest RX timeout that still catches a packet whose preamble starts within
+ * uncertainty_us of the expected time.
+ *
+ * The chip's RX timer stops once it sees a LoRa header or a GFSK sync word, so the timeout covers
+ * the uncertainty, the preamble and the sync word, plus the header for LoRa.
+ *
+ * @return Timeout in microseconds, or 0 if cfg holds no valid modem settings.
+ */
+uint32_t sx126x_rx_timeout_us(const sx126x_config_t *cfg, uint32_t uncertainty_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_AIRTIME_H
@@ -10,6 +10,7 @@
 #ifndef SX126X_BUS_H
 #define SX126X_BUS_H
 
+#include "sx126x/log_ring.h"
 #include "sx126x/types.h"
 #include <stddef.h>
 #include <stdint.h>
@@ -17,14 +18,111 @@
 // Forward declaration
 typedef struct sx126x_bus_t sx126x_bus_t;
 
+/**
+ * @brief A single command frame within a batched bus submission.
+ *
+ * Each frame is clocked out under its own chip-select assertion. The command phase follows the
+ * rules of sx126x_bus_t::transfer. An optional payload phase of data_len bytes follows it under
+ * the same assertion, so a buffer access can gather its header and a caller's payload without
+ * either being copied: data_tx is clocked out (0x00 when NULL) and MISO is stored to data_rx
+ * (discarded when NULL).
+ */
+typedef struct
+{
+  const uint8_t *tx;
+  size_t tx_len;
+  uint8_t *rx;
+  size_t rx_len;
+  const uint8_t *data_tx;
+  uint8_t *data_rx;
+  size_t data_len;
+} sx126x_bus_frame_t;
+
+/**
+ * @brief Handler invoked by the HAL when the DIO1 line rises.
+ *
+ * The HAL must call it from task context, never directly from an ISR, since the handler talks to
+ * the chip over the bus.
+ */
+typedef void (*sx126x_bus_irq_handler_t)(void *arg);
+
 /**
  * @brief Represents a message bus for the SX126x.
  */
 struct sx126x_bus_t
 {
+  /**
+   * Clocks max(tx_len, rx_len) bytes under one chip-select assertion. Past the end of tx (or
+   * throughout, when tx is NULL) the HAL clocks 0x00; only the first rx_len MISO bytes are stored,
+   * none when rx is NULL. rx may be the same buffer as tx, in which case the reply overwrites the
+   * command as it is clocked. The HAL must not need a scratch copy of either buffer. The core
+   * always asks for at least the status byte (the second MISO byte) of every command.
+   *
+   * The chip holds BUSY high while it is still processing the previous command, and ignores or
+   * corrupts a frame that starts before it drops. The HAL must wait for BUSY to be low before
+   * asserting chip select, and return SX126X_ERR_TIMEOUT if it stays high for longer than the
+   * slowest command (calibration, about 4 ms) plus a margin.
+   */
   sx126x_status_t (*transfer)(
       sx126x_bus_t *bus, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len);
+
+  /**
+   * Optional. Submits a sequence of frames as one bus transaction (one lock, one bus setup),
+   * including their payload phases. Every frame, not only the first, waits for BUSY to be low as
+   * transfer does: the core queues commands behind ones that keep the chip busy for milliseconds.
+   * The HAL must stop at the first frame that fails and return its status. When NULL, the core
+   * falls back to calling transfer once per frame and stages frames that have a payload phase in a
+   * buffer of its own.
+   */
+  sx126x_status_t (*transfer_batch)(sx126x_bus_t *bus,
+                                    const sx126x_bus_frame_t *frames,
+                                    size_t count);
+
+  /**
+   * Optional. Wakes the chip from sleep: asserts chip select without waiting for BUSY, which stays
+   * high while the chip sleeps, then waits for BUSY to drop, about 340 us after a warm sleep and
+   * 3.5 ms after a cold one. When NULL, the core wakes the chip with a one-byte frame through
+   * transfer instead, so a HAL whose transfer sees BUSY high during sleep must provide it.
+   */
+  sx126x_status_t (*wake)(sx126x_bus_t *bus);
+
+  /**
+   * Optional. Bracket a whole driver operation (init, transmit, RX drain, ...) so that its
+   * commands reach the chip without another task's commands in between, and the bus is locked
+   * once per operation instead of once per transfer. Both must be set for either to be used.
+   *
+   * The lock must be recursive: transfers are still issued from inside it, and completion
+   * callbacks run inside it and may start the next operation.
+   */
+  sx126x_status_t (*lock)(sx126x_bus_t *bus);
+  void (*unlock)(sx126x_bus_t *bus);
+
+  /**
+   * Optional. Registers the DIO1 interrupt handler, or detaches it when handler is NULL. Without
+   * it, interrupt-driven operations must be serviced by polling sx126x_handle_irq.
+   */
+  sx126x_status_t (*attach_dio1)(sx126x_bus_t *bus, sx126x_bus_irq_handler_t handler, void *arg);
+
+  /**
+   * Optional. Monotonic microsecond clock, free-running and wrapping at 2^32. Used to timestamp
+   * deferred log records.
+   */
+  uint32_t (*now_us)(sx126x_bus_t *bus);
+
+  /**
+   * Optional. Waits for about us microseconds, yielding to other tasks where the platform can.
+   * Blocking driver calls use it between polls of the chip, outside of lock.
+   */
+  void (*delay_us)(sx126x_bus_t *bus, uint32_t us);
+
   void (*log)(const char *fmt, ...);
+
+  /**
+   * Optional. When set, driver log messages are recorded here in binary form instead of being
+   * passed to log. The application drains and formats them, see log_ring.h.
+   */
+  sx126x_log_ring_t *log_ring;
+
   void *ctx;
 };
 
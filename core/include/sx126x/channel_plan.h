@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file channel_plan.h
+ * @brief Channel plans of ready-encoded SetRfFrequency frames for fast hopping.
+ * @version 0.1
+ * @date 2025
+ *
+ * Converting a frequency in Hz to the chip's frequency word needs a 64-bit divide, which is slow on
+ * MCUs without a hardware divider. A channel plan does that conversion once, either at compile
+ * time with SX126X_CHANNEL() or at setup time, so that sx126x_set_channel only sends bytes.
+ */
+
+#ifndef SX126X_CHANNEL_PLAN_H
+#define SX126X_CHANNEL_PLAN_H
+
+#include "sx126x/commands.h"
+#include "sx126x/types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/** Length of an encoded SetRfFrequency frame. */
+#define SX126X_CHANNEL_FRAME_LEN 5
+
+/** Frequency word for hz: hz * 2^25 / f_xtal. A constant expression when hz is one. */
+#define SX126X_RF_FREQ_WORD(hz) \
+  ((uint32_t)(((uint64_t)(hz) << 25) / SX126X_XTAL_HZ))
+
+/** Static initializer for an sx126x_channel_t, usable in const tables. */
+#define SX126X_CHANNEL(hz)                                  \
+  {                                                         \
+    (uint32_t)(hz),                                         \
+    {                                                       \
+      SX126X_OP_SET_RF_FREQUENCY,                           \
+      (uint8_t)((SX126X_RF_FREQ_WORD(hz) >> 24) & 0xFF),    \
+      (uint8_t)((SX126X_RF_FREQ_WORD(hz) >> 16) & 0xFF),    \
+      (uint8_t)((SX126X_RF_FREQ_WORD(hz) >> 8) & 0xFF),     \
+      (uint8_t)(SX126X_RF_FREQ_WORD(hz) & 0xFF),            \
+    }                                                       \
+  }
+
+/**
+ * @brief One channel and its encoded SetRfFrequency frame.
+ */
+typedef struct
+{
+  uint32_t hz;                             /**< Channel centre frequency */
+  uint8_t frame[SX126X_CHANNEL_FRAME_LEN]; /**< Opcode followed by the big-endian frequency word */
+} sx126x_channel_t;
+
+/**
+ * @brief A list of channels. The channel storage is owned by the caller.
+ */
+typedef struct
+{
+  const sx126x_channel_t *channels;
+  uint16_t count;
+} sx126x_channel_plan_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Encode a single channel at setup time.
+ */
+void sx126x_channel_encode(sx126x_channel_t *ch, uint32_t hz);
+
+/**
+ * @brief Wrap an already encoded table, e.g. a const array of SX126X_CHANNEL() entries.
+ *
+ * @return SX126X_OK if successful, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_channel_plan_init(sx126x_channel_plan_t *plan,
+                                         const sx126x_channel_t *channels,
+                                         uint16_t count);
+
+/**
+ * @brief Encode a list of frequencies into caller-owned storage and wrap it in a plan.
+ *
+ * @param storage Array of at least count channels.
+ * @param hz Array of count frequencies in Hz.
+ * @return SX126X_OK if successful, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_channel_plan_build(sx126x_channel_plan_t *plan,
+                                          sx126x_channel_t *storage,
+                                          const uint32_t *hz,
+                                          uint16_t count);
+
+/**
+ * @brief Encode count evenly spaced channels starting at first_hz, e.g. the 64 US915 125 kHz
+ * uplink channels (902.3 MHz, 200 kHz spacing).
+ *
+ * @param storage Array of at least count channels.
+ * @return SX126X_OK if successful, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_channel_plan_build_linear(sx126x_channel_plan_t *plan,
+                                                 sx126x_channel_t *storage,
+                                                 uint32_t first_hz,
+                                                 uint32_t spacing_hz,
+                                                 uint16_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_CHANNEL_PLAN_H
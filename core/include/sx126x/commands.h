@@ -0,0 +1,228 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file commands.h
+ * @brief SX126x command set: opcodes, IRQ flags and status byte fields.
+ * @version 0.1
+ * @date 2025
+ */
+
+#ifndef SX126X_COMMANDS_H
+#define SX126X_COMMANDS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Opcodes for the SX126x-class chip.
+ */
+typedef enum
+{
+  SX126X_OP_RESET_STATS = 0x00,
+  SX126X_OP_CLEAR_IRQ_STATUS = 0x02,
+  SX126X_OP_CLEAR_DEVICE_ERRORS = 0x07,
+  SX126X_OP_SET_DIO_IRQ_PARAMS = 0x08,
+  SX126X_OP_WRITE_REGISTER = 0x0D,
+  SX126X_OP_WRITE_BUFFER = 0x0E,
+  SX126X_OP_GET_STATS = 0x10,
+  SX126X_OP_GET_PACKET_TYPE = 0x11,
+  SX126X_OP_GET_IRQ_STATUS = 0x12,
+  SX126X_OP_GET_RX_BUFFER_STATUS = 0x13,
+  SX126X_OP_GET_PACKET_STATUS = 0x14,
+  SX126X_OP_GET_RSSI_INST = 0x15,
+  SX126X_OP_GET_DEVICE_ERRORS = 0x17,
+  SX126X_OP_READ_REGISTER = 0x1D,
+  SX126X_OP_READ_BUFFER = 0x1E,
+  SX126X_OP_SET_STANDBY = 0x80,
+  SX126X_OP_SET_RX = 0x82,
+  SX126X_OP_SET_TX = 0x83,
+  SX126X_OP_SET_SLEEP = 0x84,
+  SX126X_OP_SET_RF_FREQUENCY = 0x86,
+  SX126X_OP_SET_CAD_PARAMS = 0x88,
+  SX126X_OP_CALIBRATE = 0x89,
+  SX126X_OP_SET_PACKET_TYPE = 0x8A,
+  SX126X_OP_SET_MODULATION_PARAMS = 0x8B,
+  SX126X_OP_SET_PACKET_PARAMS = 0x8C,
+  SX126X_OP_SET_TX_PARAMS = 0x8E,
+  SX126X_OP_SET_BUFFER_BASE_ADDRESS = 0x8F,
+  SX126X_OP_SET_RX_TX_FALLBACK_MODE = 0x93,
+  SX126X_OP_SET_RX_DUTY_CYCLE = 0x94,
+  SX126X_OP_SET_PA_CONFIG = 0x95,
+  SX126X_OP_SET_REGULATOR_MODE = 0x96,
+  SX126X_OP_SET_DIO3_AS_TCXO_CTRL = 0x97,
+  SX126X_OP_CALIBRATE_IMAGE = 0x98,
+  SX126X_OP_SET_DIO2_AS_RF_SWITCH_CTRL = 0x9D,
+  SX126X_OP_STOP_TIMER_ON_PREAMBLE = 0x9F,
+  SX126X_OP_SET_LORA_SYMB_NUM_TIMEOUT = 0xA0,
+  SX126X_OP_GET_STATUS = 0xC0,
+  SX126X_OP_SET_FS = 0xC1,
+  SX126X_OP_SET_CAD = 0xC5,
+  SX126X_OP_SET_TX_CONTINUOUS_WAVE = 0xD1,
+  SX126X_OP_SET_TX_INFINITE_PREAMBLE = 0xD2,
+} sx126x_opcode_t;
+
+/**
+ * @brief Standby modes for the SX126x-class chip.
+ */
+typedef enum
+{
+  SX126X_STBY_RC = 0x00,
+  SX126X_STBY_XOSC = 0x01,
+} sx126x_standby_mode_t;
+
+/**
+ * @brief Mode the chip returns to after TX or RX (SetRxTxFallbackMode). The further up, the sooner
+ * the next TX or RX starts, at the cost of a higher idle current.
+ */
+typedef enum
+{
+  SX126X_FALLBACK_STDBY_RC = 0x20,   /**< Reset default */
+  SX126X_FALLBACK_STDBY_XOSC = 0x30, /**< Crystal kept running */
+  SX126X_FALLBACK_FS = 0x40,         /**< Synthesizer kept locked on the RF frequency */
+} sx126x_fallback_mode_t;
+
+/**
+ * @brief Packet types for the SX126x-class chip.
+ */
+typedef enum
+{
+  SX126X_PACKET_TYPE_GFSK = 0x00,
+  SX126X_PACKET_TYPE_LORA = 0x01,
+  SX126X_PACKET_TYPE_LR_FHSS = 0x03,
+} sx126x_packet_type_t;
+
+/**
+ * @brief Number of symbols a CAD listens for (SetCadParams cadSymbolNum).
+ */
+typedef enum
+{
+  SX126X_CAD_ON_1_SYMB = 0x00,
+  SX126X_CAD_ON_2_SYMB = 0x01,
+  SX126X_CAD_ON_4_SYMB = 0x02,
+  SX126X_CAD_ON_8_SYMB = 0x03,
+  SX126X_CAD_ON_16_SYMB = 0x04,
+} sx126x_cad_symbols_t;
+
+/**
+ * @brief What the chip does once a CAD finishes (SetCadParams cadExitMode).
+ */
+typedef enum
+{
+  SX126X_CAD_EXIT_ONLY = 0x00, /**< Back to STDBY_RC */
+  SX126X_CAD_EXIT_RX = 0x01,   /**< Into RX if activity was detected, STDBY_RC otherwise */
+  SX126X_CAD_EXIT_LBT = 0x10,  /**< Into TX if no activity was detected, STDBY_RC otherwise */
+} sx126x_cad_exit_t;
+
+/**
+ * @brief IRQ flags, as reported by GetIrqStatus.
+ */
+typedef enum
+{
+  SX126X_IRQ_TX_DONE = (1 << 0),
+  SX126X_IRQ_RX_DONE = (1 << 1),
+  SX126X_IRQ_PREAMBLE_DETECTED = (1 << 2),
+  SX126X_IRQ_SYNC_WORD_VALID = (1 << 3),
+  SX126X_IRQ_HEADER_VALID = (1 << 4),
+  SX126X_IRQ_HEADER_ERR = (1 << 5),
+  SX126X_IRQ_CRC_ERR = (1 << 6),
+  SX126X_IRQ_CAD_DONE = (1 << 7),
+  SX126X_IRQ_CAD_DETECTED = (1 << 8),
+  SX126X_IRQ_TIMEOUT = (1 << 9),
+  SX126X_IRQ_LR_FHSS_HOP = (1 << 14),
+
+  SX126X_IRQ_NONE = 0x0000,
+  SX126X_IRQ_ALL = 0xFFFF,
+} sx126x_irq_t;
+
+/**
+ * @brief Chip mode, as reported in bits 6:4 of the status byte.
+ */
+typedef enum
+{
+  SX126X_CHIP_MODE_UNUSED = 0x0,
+  SX126X_CHIP_MODE_STBY_RC = 0x2,
+  SX126X_CHIP_MODE_STBY_XOSC = 0x3,
+  SX126X_CHIP_MODE_FS = 0x4,
+  SX126X_CHIP_MODE_RX = 0x5,
+  SX126X_CHIP_MODE_TX = 0x6,
+} sx126x_chip_mode_t;
+
+/**
+ * @brief Command status, as reported in bits 3:1 of the status byte.
+ */
+typedef enum
+{
+  SX126X_CMD_STATUS_RESERVED = 0x0,
+  SX126X_CMD_STATUS_DATA_AVAILABLE = 0x2,
+  SX126X_CMD_STATUS_TIMEOUT = 0x3,
+  SX126X_CMD_STATUS_PROCESSING_ERROR = 0x4,
+  SX126X_CMD_STATUS_EXEC_FAILURE = 0x5,
+  SX126X_CMD_STATUS_TX_DONE = 0x6,
+} sx126x_cmd_status_t;
+
+// Status byte layout.
+#define SX126X_STATUS_CHIP_MODE_POS 4
+#define SX126X_STATUS_CHIP_MODE_MASK 0x70
+#define SX126X_STATUS_CMD_STATUS_POS 1
+#define SX126X_STATUS_CMD_STATUS_MASK 0x0E
+
+// Decode the fields of a status byte.
+#define SX126X_STATUS_CHIP_MODE(status)                                                            \
+  ((sx126x_chip_mode_t)(((status) & SX126X_STATUS_CHIP_MODE_MASK) >> SX126X_STATUS_CHIP_MODE_POS))
+#define SX126X_STATUS_CMD_STATUS(status)                                                           \
+  ((sx126x_cmd_status_t)(((status) & SX126X_STATUS_CMD_STATUS_MASK) >>                            \
+                         SX126X_STATUS_CMD_STATUS_POS))
+
+// Build a status byte from its chip mode and command status fields.
+#define SX126X_STATUS_BYTE(mode, cmd_status)                                                       \
+  ((uint8_t)((((mode) << SX126X_STATUS_CHIP_MODE_POS) & SX126X_STATUS_CHIP_MODE_MASK) |            \
+             (((cmd_status) << SX126X_STATUS_CMD_STATUS_POS) & SX126X_STATUS_CMD_STATUS_MASK)))
+
+// SetSleep configuration bit: retain the configuration across sleep (warm start).
+#define SX126X_SLEEP_WARM_START 0x04
+
+// Timeout argument of SetRx that keeps the receiver in continuous mode.
+#define SX126X_RX_TIMEOUT_CONTINUOUS 0xFFFFFF
+
+// Frame lengths: SetRx with its 24-bit timeout, and the longer, GFSK form of SetPacketParams.
+#define SX126X_SET_RX_FRAME_LEN 4
+#define SX126X_PACKET_PARAMS_FRAME_LEN 10
+
+// Crystal frequency that the RF frequency word and the GFSK bit rate and deviation refer to.
+#define SX126X_XTAL_HZ 32000000UL
+
+// Size of the chip's data buffer shared by TX and RX.
+#define SX126X_BUFFER_SIZE 256
+
+// Longest payload of a single packet.
+#define SX126X_MAX_PAYLOAD_LEN 255
+
+// Register holding the two-byte LoRa sync word, and the chip's reset value (private network).
+#define SX126X_REG_LORA_SYNC_WORD 0x0740
+#define SX126X_LORA_SYNC_WORD_DEFAULT 0x12
+
+// IQ polarity register and its reset value. Datasheet 15.4: bit 2 must be cleared while LoRa IQ
+// is inverted, or the receiver loses packets; it is set otherwise.
+#define SX126X_REG_IQ_POLARITY 0x0736
+#define SX126X_IQ_POLARITY_DEFAULT 0x0D
+#define SX126X_IQ_POLARITY_STANDARD_BIT 0x04
+
+// First of the eight GFSK sync word registers.
+#define SX126X_REG_GFSK_SYNC_WORD 0x06C0
+
+// LR-FHSS hopping registers: control, packet length and hop count, followed by the hop table of
+// SX126X_LR_FHSS_HOP_SLOTS entries, each a 2-byte symbol count and a 4-byte frequency word.
+#define SX126X_REG_LR_FHSS_CTRL 0x0385
+#define SX126X_REG_LR_FHSS_HOP_TABLE 0x0388
+#define SX126X_LR_FHSS_CTRL_HOPPING 0x01
+#define SX126X_LR_FHSS_HOP_SLOTS 16
+#define SX126X_LR_FHSS_HOP_ENTRY_LEN 6
+
+// LR-FHSS modulation: 488.28125 bit/s, i.e. 125000 / 256 flagged by bit 31, with BT 1 shaping.
+#define SX126X_LR_FHSS_BITRATE 0x8001E848UL
+#define SX126X_LR_FHSS_SHAPING 0x0B
+
+// Preamble lengths used when the configuration leaves them at 0: symbols for LoRa, bits for GFSK.
+#define SX126X_LORA_PREAMBLE_DEFAULT 8
+#define SX126X_GFSK_PREAMBLE_DEFAULT 32
+
+#endif // SX126X_COMMANDS_H
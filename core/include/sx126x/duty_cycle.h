@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file duty_cycle.h
+ * @brief Transmit scheduler that keeps each sub-band within its duty-cycle limit.
+ * @version 0.1
+ * @date 2025
+ */
+
+#ifndef SX126X_DUTY_CYCLE_H
+#define SX126X_DUTY_CYCLE_H
+
+#include "sx126x/sx126x.h"
+#include "sx126x/tx_request.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Most bands one scheduler can track. */
+#define SX126X_DUTY_MAX_BANDS 32
+
+/** Duty cycles in parts per million. */
+#define SX126X_DUTY_PPM_0_1_PERCENT 1000
+#define SX126X_DUTY_PPM_1_PERCENT 10000
+#define SX126X_DUTY_PPM_10_PERCENT 100000
+
+/**
+ * @brief A sub-band sharing one duty-cycle budget. duty_ppm and burst_us are set by the caller;
+ * sx126x_duty_init fills in the rest.
+ */
+typedef struct
+{
+  uint32_t duty_ppm; /**< Allowed share of time on air, in parts per million */
+  uint32_t burst_us; /**< Bucket size: airtime that may go out back to back after a quiet period */
+
+  uint64_t credit;     // airtime credit in microseconds times 10^6
+  uint32_t last_us;    // time credit was last added
+  uint64_t airtime_us; /**< Total airtime charged to the band */
+} sx126x_duty_band_t;
+
+/**
+ * @brief A transmission for a channel, queued as described in tx_request.h.
+ */
+typedef struct
+{
+  sx126x_tx_req_t req; // first, so that queue entries convert back
+  uint16_t channel;
+  uint32_t airtime_us; /**< Time on air, computed when the request is submitted */
+} sx126x_duty_tx_t;
+
+/**
+ * @brief Scheduler counters.
+ */
+typedef struct
+{
+  uint32_t released; /**< Transmissions started */
+  uint32_t deferred; /**< Polls that held back a queued request for lack of credit */
+  uint32_t failed;   /**< Requests dropped because the radio refused them */
+} sx126x_duty_stats_t;
+
+/**
+ * @brief Scheduler state.
+ */
+typedef struct
+{
+  sx126x_t *radio;
+  sx126x_duty_band_t *bands;
+  uint8_t band_count;
+  const uint8_t *channel_band; // band index of each channel of the radio's plan
+  uint16_t channel_count;
+  sx126x_tx_fifo_t queue;
+  sx126x_duty_stats_t stats;
+} sx126x_duty_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Set up a scheduler for an initialized radio. Every band starts with a full bucket.
+ *
+ * @param bands Caller-owned array of band_count bands, with duty_ppm (1 to 10^6) and burst_us
+ * set.
+ * @param channel_band Band index of each of the channel_count channels of the radio's plan.
+ * @param now_us Current time, from the same clock later passed to sx126x_duty_poll.
+ * @return SX126X_OK if successful, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_duty_init(sx126x_duty_t *sched,
+                                 sx126x_t *radio,
+                                 sx126x_duty_band_t *bands,
+                                 uint8_t band_count,
+                                 const uint8_t *channel_band,
+                                 uint16_t channel_count,
+                                 uint32_t now_us);
+
+/**
+ * @brief Queue a packet for a channel. Its time on air is computed from the radio's current
+ * configuration, so submit after any reconfiguration that affects it.
+ *
+ * @param tx Caller-owned request storage, not currently queued.
+ * @param done Called once the transmission finishes or the request is dropped, may be NULL.
+ * @return SX126X_OK if queued, SX126X_ERR_BUSY if tx is already queued, SX126X_ERR_INVALID_ARG if
+ * the channel is unknown or the packet needs more airtime than its band's bucket holds.
+ */
+sx126x_status_t sx126x_duty_submit(sx126x_duty_t *sched,
+                                   sx126x_duty_tx_t *tx,
+                                   uint16_t channel,
+                                   const uint8_t *payload,
+                                   uint8_t len,
+                                   sx126x_tx_done_cb_t done,
+                                   void *arg);
+
+/**
+ * @brief Start the oldest queued transmission whose band has the credit for it, if the radio is
+ * idle.
+ *
+ * Requests are sent in order within a band. A request the radio refuses for a reason other than
+ * being busy is dropped and its callback runs with the error.
+ *
+ * @param now_us Current time in microseconds; may wrap.
+ * @param wait_us Optional. Time until the next queued request has the credit it needs, 0 if one
+ * already does, UINT32_MAX if the queue is empty. While the radio is busy, poll again once its
+ * transmission is done.
+ * @return true if a transmission was started.
+ */
+bool sx126x_duty_poll(sx126x_duty_t *sched, uint32_t now_us, uint32_t *wait_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_DUTY_CYCLE_H
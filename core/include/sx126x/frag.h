@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file frag.h
+ * @brief Fragmentation of messages larger than a packet, and their reassembly.
+ * @version 0.1
+ * @date 2025
+ */
+
+#ifndef SX126X_FRAG_H
+#define SX126X_FRAG_H
+
+#include "sx126x/commands.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Bytes of each fragment before its share of the message. */
+#define SX126X_FRAG_HEADER_LEN 5
+
+/** Most message bytes one fragment carries. */
+#define SX126X_FRAG_MAX_LEN (SX126X_MAX_PAYLOAD_LEN - SX126X_FRAG_HEADER_LEN)
+
+/** Most fragments per message, as the index is one byte. */
+#define SX126X_FRAG_MAX_FRAGMENTS 256
+
+/** Bytes of a bitmap with one bit per fragment. */
+#define SX126X_FRAG_BITMAP_LEN (SX126X_FRAG_MAX_FRAGMENTS / 8)
+
+/** Bytes of an ACK before its bitmap. */
+#define SX126X_FRAG_ACK_HEADER_LEN 3
+
+/** Longest ACK, for a message of SX126X_FRAG_MAX_FRAGMENTS fragments. */
+#define SX126X_FRAG_ACK_MAX_LEN (SX126X_FRAG_ACK_HEADER_LEN + SX126X_FRAG_BITMAP_LEN)
+
+/** First header byte: frame type in the upper bits, flags in the lower ones. */
+#define SX126X_FRAG_TYPE_DATA 0x80
+#define SX126X_FRAG_TYPE_ACK 0x40
+#define SX126X_FRAG_TYPE_MASK 0xC0
+#define SX126X_FRAG_FLAG_LAST 0x01    /**< Last fragment of the message */
+#define SX126X_FRAG_FLAG_ACK_REQ 0x02 /**< The sender waits for an ACK after this fragment */
+
+/**
+ * @brief One piece of a message to send.
+ */
+typedef struct
+{
+  const uint8_t *data;
+  size_t len;
+} sx126x_frag_seg_t;
+
+/**
+ * @brief Sender settings.
+ */
+typedef struct
+{
+  uint8_t frag_len;    /**< Message bytes per fragment, 1 to SX126X_FRAG_MAX_LEN; 0 for the most */
+  uint16_t window;     /**< Fragments per burst before asking for an ACK, 0 for no ACKs */
+  uint8_t max_retries; /**< Missing ACKs in a row before giving up, 0 for no limit */
+} sx126x_frag_tx_cfg_t;
+
+/**
+ * @brief Sender counters.
+ */
+typedef struct
+{
+  uint32_t sent;     /**< Fragments built */
+  uint32_t resent;   /**< Fragments built again, after an ACK or for a missing one */
+  uint32_t acks;     /**< ACKs taken */
+  uint32_t timeouts; /**< Missing ACKs reported */
+} sx126x_frag_tx_stats_t;
+
+/**
+ * @brief Sender state. Storage, and the buffers of the message being sent, are owned by the
+ * caller.
+ */
+typedef struct
+{
+  sx126x_frag_tx_cfg_t cfg;
+  const sx126x_frag_seg_t *segs;
+  size_t seg_count;
+  uint16_t total;                         /**< Message length */
+  uint16_t count;                         /**< Fragments in the message */
+  uint8_t msg_id;                         /**< Id the receiver tells messages apart by */
+  uint8_t acked[SX126X_FRAG_BITMAP_LEN];  /**< Fragments the receiver has */
+  uint8_t sent_map[SX126X_FRAG_BITMAP_LEN]; // fragments built at least once
+  uint16_t acked_count;
+  uint16_t next;       // fragment the search for the next one to send starts at
+  uint16_t burst;      // fragments sent in the current burst
+  uint16_t burst_last; // last fragment sent, to ask again with if its ACK goes missing
+  uint8_t retries;     // missing ACKs in a row
+  bool is_waiting;     // the last fragment asked for an ACK
+  bool is_active;
+  sx126x_frag_tx_stats_t stats;
+} sx126x_frag_tx_t;
+
+/**
+ * @brief Reassembly of one message. Storage is carved out of the pool's buffer.
+ */
+typedef struct
+{
+  uint8_t *buf;
+  uint16_t cap;
+  bool is_used;
+  bool ack_requested; /**< The last fragment taken asked for an ACK */
+  uint32_t src;       /**< Sender, as passed to sx126x_frag_rx */
+  uint8_t msg_id;
+  uint16_t total;    /**< Message length; the message is in buf once complete */
+  uint8_t frag_len;  // length of every fragment but the last, 0 until one has been seen
+  uint16_t count;    // fragments in the message, 0 until the last has been seen
+  uint16_t span;     // highest fragment index seen, plus one
+  uint16_t received; // fragments taken, not counting repeats
+  uint8_t bitmap[SX126X_FRAG_BITMAP_LEN];
+  uint32_t last_us; // time of the latest fragment
+} sx126x_frag_slot_t;
+
+/**
+ * @brief Reassembly counters.
+ */
+typedef struct
+{
+  uint32_t fragments;  /**< Fragments taken */
+  uint32_t duplicates; /**< Fragments the slot already had */
+  uint32_t completed;  /**< Messages completed */
+  uint32_t evicted;    /**< Incomplete messages dropped to make room for new ones */
+  uint32_t rejected;   /**< Frames that were malformed, inconsistent or too large for a slot */
+} sx126x_frag_pool_stats_t;
+
+/**
+ * @brief Reassembly pool.
+ */
+typedef struct
+{
+  sx126x_frag_slot_t *slots;
+  uint8_t slot_count;
+  sx126x_frag_pool_stats_t stats;
+} sx126x_frag_pool_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Set up a sender.
+ *
+ * @return SX126X_OK if successful, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_frag_tx_init(sx126x_frag_tx_t *tx, const sx126x_frag_tx_cfg_t *cfg);
+
+/**
+ * @brief Start sending a message made of seg_count pieces, in order. Replaces any message still in
+ * progress.
+ *
+ * @param msg_id Id of the message; use a new one for each message to the same receiver.
+ * @param segs Pieces of the message, which must stay valid until it has been sent.
+ * @return SX126X_OK if successful, SX126X_ERR_NO_MEM if the message needs more than
+ * SX126X_FRAG_MAX_FRAGMENTS fragments or 65535 bytes, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_frag_tx_start(sx126x_frag_tx_t *tx,
+                                     uint8_t msg_id,
+                                     const sx126x_frag_seg_t *segs,
+                                     size_t seg_count);
+
+/**
+ * @brief Build the next fragment to send.
+ *
+ * @param frame Buffer of at least SX126X_MAX_PAYLOAD_LEN bytes.
+ * @param len Length of the fragment built.
+ * @return true if a fragment was built; false once the message is through, or while waiting for
+ * an ACK. A fragment with SX126X_FRAG_FLAG_ACK_REQ set in frame[0] ends a burst: pass the ACK to
+ * sx126x_frag_tx_ack, or call sx126x_frag_tx_timeout if none comes.
+ */
+bool sx126x_frag_tx_next(sx126x_frag_tx_t *tx, uint8_t *frame, uint8_t *len);
+
+/**
+ * @brief Take an ACK for the message being sent.
+ *
+ * @return SX126X_OK if it was taken, SX126X_ERR_INVALID_ARG if it is malformed or for another
+ * message.
+ */
+sx126x_status_t sx126x_frag_tx_ack(sx126x_frag_tx_t *tx, const uint8_t *frame, uint8_t len);
+
+/**
+ * @brief Report that the ACK asked for did not come. The next fragment built asks for it again.
+ *
+ * @return SX126X_OK, or SX126X_ERR_TIMEOUT once max_retries ACKs in a row went missing, which
+ * ends the message.
+ */
+sx126x_status_t sx126x_frag_tx_timeout(sx126x_frag_tx_t *tx);
+
+/**
+ * @brief Whether the message has been sent: every fragment acknowledged, or without a window,
+ * every fragment built once.
+ */
+bool sx126x_frag_tx_done(const sx126x_frag_tx_t *tx);
+
+/**
+ * @brief Set up a reassembly pool.
+ *
+ * @param slots Caller-owned array of slot_count slots.
+ * @param storage Caller-owned buffer of slot_count * slot_size bytes, one share per slot.
+ * @param slot_size Longest message a slot reassembles.
+ * @return SX126X_OK if successful, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_frag_pool_init(sx126x_frag_pool_t *pool,
+                                      sx126x_frag_slot_t *slots,
+                                      uint8_t slot_count,
+                                      uint8_t *storage,
+                                      uint16_t slot_size);
+
+/**
+ * @brief Take a received fragment.
+ *
+ * Fragments are matched to a slot by src and message id. The first fragment of a new message takes
+ * a free slot or, if there is none, the incomplete one that has gone longest without a fragment.
+ * A fragment whose total length differs from its slot's starts the slot over.
+ *
+ * @param src Caller's id of the sender, e.g. an address from the packet, or 0.
+ * @param now_us Current time in microseconds; may wrap.
+ * @param slot Set to the slot the fragment went to, which is complete once
+ * sx126x_frag_complete says so. Answer ack_requested with sx126x_frag_ack.
+ * @return SX126X_OK if taken, repeats included; SX126X_ERR_NO_MEM if the message does not fit a
+ * slot or every slot holds a complete message; SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_frag_rx(sx126x_frag_pool_t *pool,
+                               uint32_t src,
+                               const uint8_t *frame,
+                               uint8_t len,
+                               uint32_t now_us,
+                               sx126x_frag_slot_t **slot);
+
+/**
+ * @brief Whether a slot holds a complete message, total bytes at buf.
+ */
+bool sx126x_frag_complete(const sx126x_frag_slot_t *slot);
+
+/**
+ * @brief Build the ACK for a slot: its bitmap up to the highest fragment seen.
+ *
+ * @param frame Buffer of at least SX126X_FRAG_ACK_MAX_LEN bytes.
+ * @return SX126X_OK if successful, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_frag_ack(const sx126x_frag_slot_t *slot, uint8_t *frame, uint8_t *len);
+
+/**
+ * @brief Hand a slot back to the pool once its message has been used. Fragments of the message
+ * that arrive later start it over.
+ */
+void sx126x_frag_release(sx126x_frag_pool_t *pool, sx126x_frag_slot_t *slot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_FRAG_H
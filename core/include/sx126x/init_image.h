@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file init_image.h
+ * @brief Compile-time init command images for fixed-configuration products.
+ * @version 0.1
+ * @date 2025
+ *
+ * SX126X_INIT_IMAGE_DEFINE() expands a LoRa configuration given as constants into a const byte
+ * image of the whole init sequence, so it can live in flash. sx126x_init_from_image replays it
+ * without validating or encoding anything at runtime.
+ *
+ * The image is a run of frames, each a length byte followed by that many command bytes. Frames are
+ * handed to the bus in place, one chip-select per frame, as a single batch.
+ */
+
+#ifndef SX126X_INIT_IMAGE_H
+#define SX126X_INIT_IMAGE_H
+
+#include "sx126x/airtime.h"
+#include "sx126x/channel_plan.h"
+#include "sx126x/commands.h"
+#include "sx126x/sx126x.h"
+#include "sx126x/types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Sync word as written to its register, each nibble in the high nibble of one byte.
+#define SX126X_IMAGE_SYNC_WORD(sync) ((sync) ? (sync) : SX126X_LORA_SYNC_WORD_DEFAULT)
+
+/**
+ * @brief Byte image of the LoRa init sequence. All arguments must be constant expressions.
+ *
+ * Matches the sequence sent by sx126x_init, except that the sync word register is always written
+ * (0 selects the chip default).
+ */
+#define SX126X_INIT_IMAGE_BYTES(chip, hz, pa, pwr, ramp, sf, bw, cr, ldro, sync)                   \
+  2, SX126X_OP_SET_STANDBY, SX126X_STBY_RC,                                                        \
+  2, SX126X_OP_SET_PACKET_TYPE, SX126X_PACKET_TYPE_LORA,                                           \
+  5, SX126X_OP_SET_RF_FREQUENCY,                                                                   \
+      (uint8_t)((SX126X_RF_FREQ_WORD(hz) >> 24) & 0xFF),                                           \
+      (uint8_t)((SX126X_RF_FREQ_WORD(hz) >> 16) & 0xFF),                                           \
+      (uint8_t)((SX126X_RF_FREQ_WORD(hz) >> 8) & 0xFF),                                            \
+      (uint8_t)(SX126X_RF_FREQ_WORD(hz) & 0xFF),                                                   \
+  5, SX126X_OP_SET_PA_CONFIG, SX126X_PA_DUTY_CYCLE(chip, pa),                                      \
+      SX126X_PA_HP_MAX(chip, pa), SX126X_PA_DEVICE_SEL(chip), SX126X_PA_LUT,                       \
+  3, SX126X_OP_SET_TX_PARAMS, (uint8_t)(pwr), (ramp),                                              \
+  5, SX126X_OP_SET_MODULATION_PARAMS, (sf), (bw), (cr),                                            \
+      (((ldro) || SX126X_LORA_LDRO_REQUIRED(sf, bw)) ? 0x01 : 0x00),                               \
+  3, SX126X_OP_SET_BUFFER_BASE_ADDRESS, 0x00, 0x00,                                                \
+  9, SX126X_OP_SET_DIO_IRQ_PARAMS,                                                                 \
+      (SX126X_DIO1_IRQ_MASK >> 8) & 0xFF, SX126X_DIO1_IRQ_MASK & 0xFF,                             \
+      (SX126X_DIO1_IRQ_MASK >> 8) & 0xFF, SX126X_DIO1_IRQ_MASK & 0xFF,                             \
+      0x00, 0x00, 0x00, 0x00,                                                                      \
+  5, SX126X_OP_WRITE_REGISTER,                                                                     \
+      (SX126X_REG_LORA_SYNC_WORD >> 8) & 0xFF, SX126X_REG_LORA_SYNC_WORD & 0xFF,                   \
+      (SX126X_IMAGE_SYNC_WORD(sync) & 0xF0) | 0x04,                                                \
+      ((SX126X_IMAGE_SYNC_WORD(sync) & 0x0F) << 4) | 0x04
+
+/**
+ * @brief Define a static const sx126x_init_image_t called name.
+ *
+ * The frame format (preamble, header, CRC, IQ) starts at the defaults. Change it afterwards with
+ * sx126x_reconfigure, which only sends the IQ polarity register for frame format changes.
+ */
+#define SX126X_INIT_IMAGE_DEFINE(name, chip_, hz, pa, pwr, ramp, sf, bw, cr, ldro, sync)           \
+  static const uint8_t name##_data[] = {                                                           \
+      SX126X_INIT_IMAGE_BYTES(chip_, hz, pa, pwr, ramp, sf, bw, cr, ldro, sync)};                  \
+  static const sx126x_init_image_t name = {                                                        \
+      .data = name##_data,                                                                         \
+      .len = sizeof(name##_data),                                                                  \
+      .config = {                                                                                  \
+          .chip = (chip_),                                                                         \
+          .frequency_hz = (hz),                                                                    \
+          .pa_profile = (pa),                                                                      \
+          .modem = SX126X_MODEM_LORA,                                                              \
+          .power_dbm = (pwr),                                                                      \
+          .power_ramp_time = (ramp),                                                               \
+          .lora_sf = (sf),                                                                         \
+          .lora_bw = (bw),                                                                         \
+          .lora_cr = (cr),                                                                         \
+          .lora_ldro = (ldro),                                                                     \
+          .lora_sync_word = (sync),                                                                \
+      },                                                                                           \
+  }
+
+/**
+ * @brief A pre-encoded init sequence and the configuration it was generated from.
+ */
+typedef struct
+{
+  const uint8_t *data;    /**< Length-prefixed command frames */
+  size_t len;             /**< Image size in bytes */
+  sx126x_config_t config; /**< Configuration encoded by the image, used for the driver's state */
+} sx126x_init_image_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Initialize the SX126x driver by replaying a pre-encoded init image.
+ *
+ * Equivalent to sx126x_init with image->config, without building any commands at runtime. The
+ * same lifetime rules apply to bus.
+ *
+ * @param radio Pointer to the sx126x_t to initialize.
+ * @param bus Pointer to the sx126x_bus_t to initialize the radio with.
+ * @param image Image defined with SX126X_INIT_IMAGE_DEFINE.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t
+sx126x_init_from_image(sx126x_t *radio, sx126x_bus_t *bus, const sx126x_init_image_t *image);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_INIT_IMAGE_H
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file lbt.h
+ * @brief Listen-before-talk transmit queue with randomized exponential backoff.
+ * @version 0.1
+ * @date 2025
+ */
+
+#ifndef SX126X_LBT_H
+#define SX126X_LBT_H
+
+#include "sx126x/sx126x.h"
+#include "sx126x/tx_request.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Backoff settings.
+ */
+typedef struct
+{
+  uint32_t backoff_min_us; /**< First contention window, e.g. the time on air of a typical packet */
+  uint32_t backoff_max_us; /**< Largest contention window */
+  uint8_t max_attempts;    /**< CADs per packet before it is dropped, 0 for no limit */
+  bool chain;              /**< Chain CAD and TX on the chip instead of going through the host */
+  uint32_t seed;           /**< Backoff random seed, e.g. from the device ID; 0 for a fixed one */
+} sx126x_lbt_cfg_t;
+
+/**
+ * @brief A transmission preceded by CAD, queued as described in tx_request.h.
+ */
+typedef struct
+{
+  sx126x_tx_req_t req; // first, so that queue entries convert back
+  uint8_t attempts;    /**< Busy CADs so far */
+} sx126x_lbt_tx_t;
+
+/**
+ * @brief Listen-before-talk counters.
+ */
+typedef struct
+{
+  uint32_t cads;      /**< Channel activity detections run */
+  uint32_t deferrals; /**< CADs that found the channel busy and backed off */
+  uint32_t sent;      /**< Packets transmitted */
+  uint32_t dropped;   /**< Packets given up after max_attempts busy CADs */
+  uint32_t failed;    /**< Packets the radio refused or aborted */
+} sx126x_lbt_stats_t;
+
+/**
+ * @brief Listen-before-talk state.
+ */
+typedef struct
+{
+  sx126x_t *radio;
+  sx126x_lbt_cfg_t cfg;
+  uint32_t rng;
+  sx126x_tx_fifo_t queue;
+  bool is_running;        // the head's CAD or TX is on the radio
+  bool is_transmitting;   // unchained: the head's TX follows a clear CAD
+  volatile bool is_done;  // the radio reported the outcome of the running operation
+  sx126x_status_t result;
+  bool is_backing_off;
+  uint32_t ready_us; // end of the head's backoff
+  sx126x_lbt_stats_t stats;
+} sx126x_lbt_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Set up a listen-before-talk queue for an initialized LoRa radio.
+ *
+ * @param cfg Backoff settings; backoff_min_us must be non-zero and at most backoff_max_us.
+ * @return SX126X_OK if successful, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_lbt_init(sx126x_lbt_t *lbt, sx126x_t *radio, const sx126x_lbt_cfg_t *cfg);
+
+/**
+ * @brief Queue a packet.
+ *
+ * @param tx Caller-owned request storage, not currently queued.
+ * @param done Called from sx126x_lbt_poll once the packet is sent or dropped, may be NULL. The
+ * result is SX126X_ERR_CHANNEL_BUSY if it was dropped after max_attempts busy CADs.
+ * @return SX126X_OK if queued, SX126X_ERR_BUSY if tx is already queued, SX126X_ERR_INVALID_ARG
+ * otherwise.
+ */
+sx126x_status_t sx126x_lbt_submit(sx126x_lbt_t *lbt,
+                                  sx126x_lbt_tx_t *tx,
+                                  const uint8_t *payload,
+                                  uint8_t len,
+                                  sx126x_tx_done_cb_t done,
+                                  void *arg);
+
+/**
+ * @brief Act on the outcome of the running CAD or TX, then start the oldest queued packet's CAD if
+ * its backoff is over and the radio is idle.
+ *
+ * @param now_us Current time in microseconds; may wrap.
+ * @param wait_us Optional. Time until the oldest packet's backoff ends, 0 if it already has,
+ * UINT32_MAX if the queue is empty or a CAD or TX is running. In the latter case, poll again once
+ * the radio's DIO1 handler has run.
+ * @return true if a CAD or transmission was started.
+ */
+bool sx126x_lbt_poll(sx126x_lbt_t *lbt, uint32_t now_us, uint32_t *wait_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_LBT_H
@@ -10,6 +10,9 @@
 #ifndef SX126X_LOG_H
 #define SX126X_LOG_H
 
+#include "sx126x/log_ring.h"
+#include <stdint.h>
+
 // Log levels
 #define SX126X_LOG_LEVEL_ERROR 0
 #define SX126X_LOG_LEVEL_WARN 1
@@ -21,13 +24,63 @@
 #define SX126X_LOG_LEVEL SX126X_LOG_LEVEL_INFO
 #endif
 
-// Base macro - only emits code if level <= build level
+// Convert one log argument to a ring word: strings and other object pointers through uintptr_t,
+// integers by value, widened so that 64-bit ones survive on 32-bit targets.
+static inline uint64_t sx126x_log_ptr_arg(const void *p)
+{
+  return (uint64_t)(uintptr_t)p;
+}
+
+static inline uint64_t sx126x_log_int_arg(uint64_t v)
+{
+  return v;
+}
+
+#define SX126X_LOG_ARG(x)                                                                          \
+  _Generic((x),                                                                                    \
+      char *: sx126x_log_ptr_arg,                                                                  \
+      const char *: sx126x_log_ptr_arg,                                                            \
+      void *: sx126x_log_ptr_arg,                                                                  \
+      const void *: sx126x_log_ptr_arg,                                                            \
+      default: sx126x_log_int_arg)(x)
+
+// SX126X_LOG_MAP_n applies SX126X_LOG_ARG to each of n arguments, each preceded by a comma. The
+// count is taken where the arguments may still be omitted, so that ## drops the comma before them.
+#define SX126X_LOG_CAT_(a, b) SX126X_LOG_CAT2_(a, b)
+#define SX126X_LOG_CAT2_(a, b) a##b
+#define SX126X_LOG_NARGS_(...) SX126X_LOG_NARGS2_(__VA_ARGS__, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define SX126X_LOG_NARGS2_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, n, ...) n
+#define SX126X_LOG_MAP_0()
+#define SX126X_LOG_MAP_1(a) , SX126X_LOG_ARG(a)
+#define SX126X_LOG_MAP_2(a, ...) , SX126X_LOG_ARG(a) SX126X_LOG_MAP_1(__VA_ARGS__)
+#define SX126X_LOG_MAP_3(a, ...) , SX126X_LOG_ARG(a) SX126X_LOG_MAP_2(__VA_ARGS__)
+#define SX126X_LOG_MAP_4(a, ...) , SX126X_LOG_ARG(a) SX126X_LOG_MAP_3(__VA_ARGS__)
+#define SX126X_LOG_MAP_5(a, ...) , SX126X_LOG_ARG(a) SX126X_LOG_MAP_4(__VA_ARGS__)
+#define SX126X_LOG_MAP_6(a, ...) , SX126X_LOG_ARG(a) SX126X_LOG_MAP_5(__VA_ARGS__)
+#define SX126X_LOG_MAP_7(a, ...) , SX126X_LOG_ARG(a) SX126X_LOG_MAP_6(__VA_ARGS__)
+#define SX126X_LOG_MAP_8(a, ...) , SX126X_LOG_ARG(a) SX126X_LOG_MAP_7(__VA_ARGS__)
+#define SX126X_LOG_MAP_9(a, ...) , SX126X_LOG_ARG(a) SX126X_LOG_MAP_8(__VA_ARGS__)
+#define SX126X_LOG_MAP_10(a, ...) , SX126X_LOG_ARG(a) SX126X_LOG_MAP_9(__VA_ARGS__)
+
+// Base macro - only emits code if level <= build level. With a log ring attached to the bus the
+// message is recorded in binary form and formatted later, see log_ring.h.
 #define SX126X_LOG_INTERNAL(level, bus, tag, fmt, ...)                                             \
   do                                                                                               \
   {                                                                                                \
     if ((level) <= SX126X_LOG_LEVEL)                                                               \
     {                                                                                              \
-      if ((bus) && (bus)->log)                                                                     \
+      if ((bus) && (bus)->log_ring)                                                                \
+      {                                                                                            \
+        const uint64_t sx126x_log_args_[] = {                                                      \
+            0 SX126X_LOG_CAT_(SX126X_LOG_MAP_, SX126X_LOG_NARGS_(_, ##__VA_ARGS__))(__VA_ARGS__)}; \
+        sx126x_log_ring_record((bus)->log_ring,                                                    \
+                               (level),                                                            \
+                               (bus)->now_us ? (bus)->now_us(bus) : 0,                             \
+                               fmt,                                                                \
+                               &sx126x_log_args_[1],                                               \
+                               sizeof(sx126x_log_args_) / sizeof(sx126x_log_args_[0]) - 1);        \
+      }                                                                                            \
+      else if ((bus) && (bus)->log)                                                                \
         (bus)->log("[%s] " fmt, tag, ##__VA_ARGS__);                                              \
     }                                                                                              \
   } while (0)
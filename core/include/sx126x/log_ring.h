@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file log_ring.h
+ * @brief Deferred binary logging ring.
+ * @version 0.1
+ * @date 2025
+ *
+ * When a bus has a log ring attached, the SX126X_LOG_* macros record the format string pointer, a
+ * timestamp and the raw arguments instead of calling bus->log, so nothing is formatted on the hot
+ * path. A low-priority consumer (or a host tool, using the format pointer as the message ID) pops
+ * the records and formats them later.
+ *
+ * Any number of producers may record concurrently; there must be a single consumer. Arguments are
+ * stored as 64-bit words, so only integer conversions, %p and %s with pointers to static strings
+ * may be used in log messages. The formatter hands each word to its conversion as the type that
+ * conversion expects.
+ */
+
+#ifndef SX126X_LOG_RING_H
+#define SX126X_LOG_RING_H
+
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Most arguments a single log message may carry. */
+#define SX126X_LOG_MAX_ARGS 10
+
+/**
+ * @brief One deferred log message.
+ */
+typedef struct
+{
+  const char *fmt;                    /**< Format string, doubles as the message ID */
+  uint32_t timestamp_us;              /**< bus->now_us at record time, 0 without a clock */
+  uint8_t level;                      /**< SX126X_LOG_LEVEL_* */
+  uint8_t nargs;                      /**< Number of valid entries in args */
+  uint64_t args[SX126X_LOG_MAX_ARGS]; /**< Integers by value, pointers as addresses */
+} sx126x_log_record_t;
+
+/**
+ * @brief A record slot with its sequence number.
+ */
+typedef struct
+{
+  volatile uint32_t seq;
+  sx126x_log_record_t rec;
+} sx126x_log_slot_t;
+
+/**
+ * @brief Ring state. Treat as opaque and use the functions below.
+ */
+typedef struct sx126x_log_ring_t
+{
+  sx126x_log_slot_t *slots;
+  uint32_t capacity;         /**< Number of slots, a power of two */
+  volatile uint32_t head;    /**< Next slot to claim, shared by producers */
+  uint32_t tail;             /**< Next slot to consume, consumer only */
+  volatile uint32_t dropped; /**< Records lost because the ring was full */
+} sx126x_log_ring_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Initialize a ring over caller-owned slots.
+ *
+ * @param capacity Number of slots, must be a power of two.
+ * @return SX126X_OK if successful, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t
+sx126x_log_ring_init(sx126x_log_ring_t *ring, sx126x_log_slot_t *slots, uint32_t capacity);
+
+/**
+ * @brief Producer: record a message. Drops it and counts the loss if the ring is full.
+ */
+void sx126x_log_ring_record(sx126x_log_ring_t *ring,
+                            uint8_t level,
+                            uint32_t timestamp_us,
+                            const char *fmt,
+                            const uint64_t *args,
+                            size_t nargs);
+
+/**
+ * @brief Consumer: copy out and release the oldest record.
+ *
+ * @return true if a record was copied, false if the ring was empty.
+ */
+bool sx126x_log_ring_pop(sx126x_log_ring_t *ring, sx126x_log_record_t *out);
+
+/**
+ * @brief Format a record as "[LEVEL] message" into buf.
+ *
+ * @return The snprintf result for the message.
+ */
+int sx126x_log_format(const sx126x_log_record_t *rec, char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_LOG_RING_H
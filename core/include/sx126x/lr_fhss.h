@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file lr_fhss.h
+ * @brief Hop tables of ready-encoded register writes for LR-FHSS transmissions.
+ * @version 0.1
+ * @date 2025
+ *
+ * During an LR-FHSS transmission the chip hops through a table of SX126X_LR_FHSS_HOP_SLOTS
+ * entries, each a symbol count and a frequency word, and raises the hop IRQ each time it moves on.
+ * Longer packets need the entry the chip has just left to be refilled with a later hop before the
+ * chip wraps around to it. A hop table encodes every hop up front, as the complete WriteRegister
+ * frame for its slot, so that the hop IRQ only sends one of these frames as it is.
+ *
+ * The packet itself, i.e. the coded header and payload fragments, and its hopping sequence come
+ * from an LR-FHSS encoder such as Semtech's lr_fhss library; the driver does not implement one.
+ */
+
+#ifndef SX126X_LR_FHSS_H
+#define SX126X_LR_FHSS_H
+
+#include "sx126x/channel_plan.h"
+#include "sx126x/commands.h"
+#include "sx126x/types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/** Length of an encoded hop: WriteRegister header, 2-byte symbol count and frequency word. */
+#define SX126X_LR_FHSS_HOP_FRAME_LEN (3 + SX126X_LR_FHSS_HOP_ENTRY_LEN)
+
+/** Most hops in one packet, as the chip's hop counter is one byte. */
+#define SX126X_LR_FHSS_MAX_HOPS 255
+
+/**
+ * @brief One hop, encoded as the WriteRegister frame for its slot in the chip's hop table.
+ */
+typedef struct
+{
+  uint8_t frame[SX126X_LR_FHSS_HOP_FRAME_LEN];
+} sx126x_lr_fhss_hop_t;
+
+/**
+ * @brief The hops of one packet in the order they are sent. The hop storage is owned by the
+ * caller.
+ */
+typedef struct
+{
+  const sx126x_lr_fhss_hop_t *hops;
+  uint16_t count;
+} sx126x_lr_fhss_table_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Encode the hop at position index of a packet.
+ *
+ * @param index Position of the hop within the packet, which selects its slot.
+ * @param hz Frequency of the hop.
+ * @param symbols Symbols sent on it.
+ */
+void sx126x_lr_fhss_hop_encode(sx126x_lr_fhss_hop_t *hop,
+                               uint16_t index,
+                               uint32_t hz,
+                               uint16_t symbols);
+
+/**
+ * @brief Encode the hops of a packet into caller-owned storage and wrap them in a table.
+ *
+ * @param storage Array of at least count hops.
+ * @param hz Array of count hop frequencies in Hz.
+ * @param symbols Array of count symbol counts, e.g. a header block's then the payload fragments'.
+ * @param count Number of hops, 1 to SX126X_LR_FHSS_MAX_HOPS.
+ * @return SX126X_OK if successful, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t sx126x_lr_fhss_build(sx126x_lr_fhss_table_t *table,
+                                     sx126x_lr_fhss_hop_t *storage,
+                                     const uint32_t *hz,
+                                     const uint16_t *symbols,
+                                     uint16_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_LR_FHSS_H
@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file multi.h
+ * @brief Several radios sharing one SPI bus, with a fair, priority-aware job scheduler.
+ * @version 0.1
+ * @date 2025
+ *
+ * Each radio keeps its own sx126x_bus_t (its own chip select) on the shared physical bus. Instead
+ * of calling the driver directly, the application queues jobs against a radio; the manager runs
+ * them one at a time, so only one radio uses the bus at any moment.
+ *
+ * Jobs are picked by priority class with weighted credits, so a lower class always gets a share of
+ * the bus, and round-robin across radios within a class, so one radio's backlog cannot starve the
+ * others. DIO1 interrupts only flag the radio; the IRQ service (e.g. an RX drain) then runs as a
+ * job like any other.
+ *
+ * sx126x_multi_submit and sx126x_multi_run must be called from the same task. Only
+ * sx126x_multi_notify_irq may be called from another context.
+ */
+
+#ifndef SX126X_MULTI_H
+#define SX126X_MULTI_H
+
+#include "sx126x/sx126x.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Job priority classes, highest first.
+ */
+typedef enum
+{
+  SX126X_MULTI_PRIO_HIGH = 0,
+  SX126X_MULTI_PRIO_NORMAL,
+  SX126X_MULTI_PRIO_LOW,
+  SX126X_MULTI_PRIO_COUNT,
+} sx126x_multi_prio_t;
+
+/** Default number of jobs each class may run per scheduling round. */
+#define SX126X_MULTI_WEIGHT_HIGH 4
+#define SX126X_MULTI_WEIGHT_NORMAL 2
+#define SX126X_MULTI_WEIGHT_LOW 1
+
+typedef struct sx126x_multi_job_t sx126x_multi_job_t;
+typedef struct sx126x_multi_t sx126x_multi_t;
+
+/** Body of a job: one driver operation, or a short sequence of them, on radio. */
+typedef sx126x_status_t (*sx126x_multi_job_fn_t)(sx126x_t *radio, void *arg);
+
+/** Called once the job has run, with the status returned by its body. */
+typedef void (*sx126x_multi_done_cb_t)(sx126x_t *radio, sx126x_status_t result, void *arg);
+
+/**
+ * @brief A queued job. Storage is owned by the caller and must stay valid while queued; a job may
+ * be resubmitted from its own body or done callback.
+ */
+struct sx126x_multi_job_t
+{
+  sx126x_multi_job_fn_t fn;
+  sx126x_multi_done_cb_t done;
+  void *arg;
+  sx126x_multi_job_t *next;
+  bool queued;
+};
+
+/**
+ * @brief Per-radio queues and counters.
+ */
+typedef struct
+{
+  sx126x_t *radio;
+  sx126x_multi_t *mgr;
+  sx126x_multi_job_t *head[SX126X_MULTI_PRIO_COUNT];
+  sx126x_multi_job_t *tail[SX126X_MULTI_PRIO_COUNT];
+  sx126x_multi_job_t irq_job;              /**< Runs sx126x_handle_irq */
+  volatile uint32_t irq_pending;           /**< Set by the DIO1 handler */
+  uint32_t served[SX126X_MULTI_PRIO_COUNT]; /**< Jobs run, per class */
+} sx126x_multi_slot_t;
+
+/**
+ * @brief Manager state.
+ */
+struct sx126x_multi_t
+{
+  sx126x_multi_slot_t *slots;
+  uint8_t count;
+  uint8_t weight[SX126X_MULTI_PRIO_COUNT]; /**< Jobs per round per class, at least 1 each */
+  uint8_t credit[SX126X_MULTI_PRIO_COUNT];
+  uint8_t cursor[SX126X_MULTI_PRIO_COUNT];
+  sx126x_multi_prio_t irq_prio; /**< Class of IRQ service jobs, HIGH by default */
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Take over a set of initialized radios.
+ *
+ * The manager attaches its own DIO1 handler to each radio's bus, where supported. Radios on buses
+ * without a DIO1 hook must be flagged with sx126x_multi_notify_irq. If attaching fails, the radios
+ * already taken get the driver's handler back.
+ *
+ * @param slots Caller-owned array of count slots.
+ * @param radios Initialized radios, one per slot.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_multi_init(sx126x_multi_t *mgr,
+                                  sx126x_multi_slot_t *slots,
+                                  sx126x_t *const *radios,
+                                  uint8_t count);
+
+/**
+ * @brief Release the radios and give DIO1 back to the driver's handler. Queued jobs are dropped.
+ */
+sx126x_status_t sx126x_multi_deinit(sx126x_multi_t *mgr);
+
+/**
+ * @brief Queue a job for a radio.
+ *
+ * @param index Radio index.
+ * @param job Caller-owned job storage, not currently queued.
+ * @param prio Priority class.
+ * @param fn Job body.
+ * @param done Completion callback, may be NULL.
+ * @return SX126X_OK if queued, SX126X_ERR_BUSY if job is already queued, error code otherwise.
+ */
+sx126x_status_t sx126x_multi_submit(sx126x_multi_t *mgr,
+                                    uint8_t index,
+                                    sx126x_multi_job_t *job,
+                                    sx126x_multi_prio_t prio,
+                                    sx126x_multi_job_fn_t fn,
+                                    sx126x_multi_done_cb_t done,
+                                    void *arg);
+
+/**
+ * @brief Flag a pending DIO1 interrupt for a radio. Safe from any context.
+ */
+void sx126x_multi_notify_irq(sx126x_multi_t *mgr, uint8_t index);
+
+/**
+ * @brief Run the next job, if any.
+ *
+ * @return true if a job was run, false if all queues were empty.
+ */
+bool sx126x_multi_run_one(sx126x_multi_t *mgr);
+
+/**
+ * @brief Run jobs until the queues are empty or max jobs have run.
+ *
+ * @return Number of jobs run.
+ */
+size_t sx126x_multi_run(sx126x_multi_t *mgr, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_MULTI_H
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file rx_ring.h
+ * @brief Lock-free single-producer/single-consumer ring of received packets.
+ * @version 0.1
+ * @date 2025
+ *
+ * The driver's DIO1 handler is the only producer and the application is the only consumer, so
+ * neither side ever waits on the other. Slots are preallocated by the caller.
+ */
+
+#ifndef SX126X_RX_RING_H
+#define SX126X_RX_RING_H
+
+#include "sx126x/commands.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief A received packet.
+ */
+typedef struct
+{
+  uint8_t len;             /**< Payload length in bytes */
+  int16_t rssi_dbm;        /**< Average RSSI over the packet */
+  int16_t signal_rssi_dbm; /**< LoRa: signal RSSI after despreading. GFSK: RSSI at sync */
+  int8_t snr_db;           /**< SNR estimate, rounded towards zero (0 for GFSK) */
+  uint16_t irq;            /**< IRQ flags that accompanied RxDone */
+  uint8_t payload[SX126X_MAX_PAYLOAD_LEN];
+} sx126x_rx_packet_t;
+
+/**
+ * @brief Ring state. Treat as opaque and use the functions below.
+ */
+typedef struct
+{
+  sx126x_rx_packet_t *slots;
+  uint32_t capacity;      /**< Number of slots, a power of two */
+  volatile uint32_t head; /**< Next slot to fill, written by the producer only */
+  volatile uint32_t tail; /**< Next slot to consume, written by the consumer only */
+} sx126x_rx_ring_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Initialize a ring over caller-owned slots.
+ *
+ * @param capacity Number of slots, must be a power of two.
+ * @return SX126X_OK if successful, SX126X_ERR_INVALID_ARG otherwise.
+ */
+sx126x_status_t
+sx126x_rx_ring_init(sx126x_rx_ring_t *ring, sx126x_rx_packet_t *slots, uint32_t capacity);
+
+/**
+ * @brief Producer: the next free slot, or NULL if the ring is full.
+ */
+sx126x_rx_packet_t *sx126x_rx_ring_acquire(sx126x_rx_ring_t *ring);
+
+/**
+ * @brief Producer: publish the slot returned by sx126x_rx_ring_acquire.
+ */
+void sx126x_rx_ring_commit(sx126x_rx_ring_t *ring);
+
+/**
+ * @brief Consumer: the oldest packet, or NULL if the ring is empty. The slot stays valid until
+ * sx126x_rx_ring_release.
+ */
+const sx126x_rx_packet_t *sx126x_rx_ring_peek(sx126x_rx_ring_t *ring);
+
+/**
+ * @brief Consumer: hand the slot returned by sx126x_rx_ring_peek back to the producer.
+ */
+void sx126x_rx_ring_release(sx126x_rx_ring_t *ring);
+
+/**
+ * @brief Consumer: copy out and release the oldest packet.
+ *
+ * @return true if a packet was copied, false if the ring was empty.
+ */
+bool sx126x_rx_ring_pop(sx126x_rx_ring_t *ring, sx126x_rx_packet_t *out);
+
+/**
+ * @brief Number of packets waiting to be consumed.
+ */
+uint32_t sx126x_rx_ring_count(const sx126x_rx_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_RX_RING_H
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file stats.h
+ * @brief Optional per-opcode bus instrumentation.
+ * @version 0.1
+ * @date 2025
+ *
+ * Build with SX126X_ENABLE_STATS=1 (the SX126X_ENABLE_STATS CMake option) to count calls, failures,
+ * bytes and latency per opcode and to keep a latency histogram of bus calls. With it disabled, the
+ * hooks and the statistics storage are compiled out. The setting must be the same for the driver
+ * and every file that includes sx126x.h, since it changes the layout of sx126x_t.
+ *
+ * Latency is measured with bus->now_us and reads as zero on buses without a clock.
+ */
+
+#ifndef SX126X_STATS_H
+#define SX126X_STATS_H
+
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef SX126X_ENABLE_STATS
+#define SX126X_ENABLE_STATS 0
+#endif
+
+/** Number of distinct opcodes tracked; later opcodes are folded into the last slot. */
+#define SX126X_STATS_MAX_OPCODES 24
+
+/** Histogram buckets. Bucket 0 holds 0 us, bucket i holds [2^(i-1), 2^i) us, the last is open. */
+#define SX126X_STATS_HIST_BUCKETS 16
+
+/** Opcode reported for the overflow slot. */
+#define SX126X_STATS_OPCODE_OTHER 0xFF
+
+/**
+ * @brief Counters for one opcode.
+ *
+ * Frames sent in a batch share the batch latency evenly, and a failed batch counts as a failure
+ * for each of its frames since the HAL does not report which one failed. Command errors read from
+ * the status byte are not failures here: they belong to the previous command and are counted in
+ * the device's cmd_errors against error_opcode.
+ */
+typedef struct
+{
+  uint8_t opcode;    /**< Opcode, or SX126X_STATS_OPCODE_OTHER */
+  uint32_t calls;    /**< Frames sent */
+  uint32_t failures; /**< Frames whose bus call failed */
+  uint32_t bytes;    /**< Bytes clocked */
+  uint32_t total_us; /**< Cumulative latency */
+  uint32_t max_us;   /**< Worst single latency */
+} sx126x_op_stats_t;
+
+/**
+ * @brief Driver bus statistics.
+ */
+typedef struct
+{
+  uint32_t transfers;                            /**< Calls to bus->transfer */
+  uint32_t batches;                              /**< Calls to bus->transfer_batch */
+  uint32_t failures;                             /**< Bus calls that failed */
+  uint32_t hist[SX126X_STATS_HIST_BUCKETS];      /**< Latency of each bus call */
+  uint8_t op_count;                              /**< Used entries of ops */
+  sx126x_op_stats_t ops[SX126X_STATS_MAX_OPCODES]; /**< In order of first use */
+} sx126x_stats_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#if SX126X_ENABLE_STATS
+
+// Used by the core at its single bus entry point.
+void sx126x_stats_record_call(sx126x_stats_t *stats, bool batch, uint32_t elapsed_us, bool ok);
+void sx126x_stats_record_frame(
+    sx126x_stats_t *stats, uint8_t opcode, size_t bytes, uint32_t elapsed_us, bool ok);
+
+#endif
+
+/**
+ * @brief Print statistics through a printf-style function, one line per opcode.
+ */
+void sx126x_stats_dump(const sx126x_stats_t *stats, void (*print)(const char *fmt, ...));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_STATS_H
@@ -11,10 +11,30 @@
 #define SX126X_H
 
 #include "sx126x/bus.h"
+#include "sx126x/channel_plan.h"
+#include "sx126x/commands.h"
+#include "sx126x/lr_fhss.h"
+#include "sx126x/rx_ring.h"
+#include "sx126x/stats.h"
 #include "sx126x/types.h"
+#include <stdbool.h>
+
+/** IRQs enabled at init and routed to DIO1. */
+#define SX126X_DIO1_IRQ_MASK                                                                       \
+  (SX126X_IRQ_TX_DONE | SX126X_IRQ_RX_DONE | SX126X_IRQ_TIMEOUT | SX126X_IRQ_CRC_ERR |            \
+   SX126X_IRQ_HEADER_ERR | SX126X_IRQ_CAD_DONE | SX126X_IRQ_CAD_DETECTED | SX126X_IRQ_LR_FHSS_HOP)
+
+/** Largest payload accepted by sx126x_tx_queue_push, i.e. half of the data buffer. */
+#define SX126X_TX_QUEUE_MAX_LEN (SX126X_BUFFER_SIZE / 2)
 
 /**
  * @brief SX126X state.
+ *
+ * STANDBY is the only state from which a new operation may be started. TX is left when the DIO1
+ * handler sees TxDone or Timeout, at which point the chip has already fallen back to standby.
+ * SLEEP is entered from STANDBY by sx126x_sleep and left by sx126x_wake. CAD is left when the DIO1
+ * handler sees CadDone: back to STANDBY, or on to TX or RX when the CAD was chained with them.
+ * An LR-FHSS transmission stays in TX across its hop IRQs.
  */
 typedef enum {
   SX126X_STATE_INIT = 0,
@@ -22,6 +42,8 @@ typedef enum {
   SX126X_STATE_STANDBY,
   SX126X_STATE_TX,
   SX126X_STATE_RX,
+  SX126X_STATE_SLEEP,
+  SX126X_STATE_CAD,
 } sx126x_state_t;
 
 /**
@@ -43,6 +65,22 @@ typedef enum
   SX126X_PA_HIGH_POWER,   /**< ~22 dBm */
 } sx126x_pa_profile_t;
 
+/**
+ * SetPaConfig arguments for a chip and PA profile. The SX1261, like an unknown chip, only gets the
+ * low power setting. Constant expressions when the arguments are, so that init images and
+ * sx126x_init share this one table.
+ */
+#define SX126X_PA_DUTY_CYCLE(chip, pa)                                                             \
+  ((chip) == SX126X_CHIP_SX1262                                                                    \
+       ? ((pa) == SX126X_PA_HIGH_POWER ? 0x07 : (pa) == SX126X_PA_MEDIUM_POWER ? 0x06 : 0x04)      \
+       : 0x04)
+#define SX126X_PA_HP_MAX(chip, pa)                                                                 \
+  ((chip) == SX126X_CHIP_SX1262                                                                    \
+       ? ((pa) == SX126X_PA_HIGH_POWER ? 0x05 : (pa) == SX126X_PA_MEDIUM_POWER ? 0x03 : 0x00)      \
+       : 0x00)
+#define SX126X_PA_DEVICE_SEL(chip) ((chip) == SX126X_CHIP_SX1261 ? 0x01 : 0x00)
+#define SX126X_PA_LUT 0x01
+
 /**
  * @brief Modem type.
  */
@@ -112,6 +150,86 @@ typedef enum {
   SX126X_LORA_CR_4_8_LI = 0x07,
 } sx126x_lora_coding_rate_t;
 
+/**
+ * @brief GFSK pulse shaping (Gaussian filter BT).
+ */
+typedef enum
+{
+  SX126X_GFSK_SHAPING_NONE = 0x00,
+  SX126X_GFSK_SHAPING_BT_0_3 = 0x08,
+  SX126X_GFSK_SHAPING_BT_0_5 = 0x09,
+  SX126X_GFSK_SHAPING_BT_0_7 = 0x0A,
+  SX126X_GFSK_SHAPING_BT_1 = 0x0B,
+} sx126x_gfsk_shaping_t;
+
+/**
+ * @brief GFSK receiver bandwidth (double sideband).
+ */
+typedef enum
+{
+  SX126X_GFSK_BW_4800 = 0x1F,   /**< 4.8kHz */
+  SX126X_GFSK_BW_5800 = 0x17,   /**< 5.8kHz */
+  SX126X_GFSK_BW_7300 = 0x0F,   /**< 7.3kHz */
+  SX126X_GFSK_BW_9700 = 0x1E,   /**< 9.7kHz */
+  SX126X_GFSK_BW_11700 = 0x16,  /**< 11.7kHz */
+  SX126X_GFSK_BW_14600 = 0x0E,  /**< 14.6kHz */
+  SX126X_GFSK_BW_19500 = 0x1D,  /**< 19.5kHz */
+  SX126X_GFSK_BW_23400 = 0x15,  /**< 23.4kHz */
+  SX126X_GFSK_BW_29300 = 0x0D,  /**< 29.3kHz */
+  SX126X_GFSK_BW_39000 = 0x1C,  /**< 39kHz */
+  SX126X_GFSK_BW_46900 = 0x14,  /**< 46.9kHz */
+  SX126X_GFSK_BW_58600 = 0x0C,  /**< 58.6kHz */
+  SX126X_GFSK_BW_78200 = 0x1B,  /**< 78.2kHz */
+  SX126X_GFSK_BW_93800 = 0x13,  /**< 93.8kHz */
+  SX126X_GFSK_BW_117300 = 0x0B, /**< 117.3kHz */
+  SX126X_GFSK_BW_156200 = 0x1A, /**< 156.2kHz */
+  SX126X_GFSK_BW_187200 = 0x12, /**< 187.2kHz */
+  SX126X_GFSK_BW_234300 = 0x0A, /**< 234.3kHz */
+  SX126X_GFSK_BW_312000 = 0x19, /**< 312kHz */
+  SX126X_GFSK_BW_373600 = 0x11, /**< 373.6kHz */
+  SX126X_GFSK_BW_467000 = 0x09, /**< 467kHz */
+} sx126x_gfsk_bandwidth_t;
+
+/**
+ * @brief GFSK preamble detector length.
+ */
+typedef enum
+{
+  SX126X_GFSK_PREAMBLE_DETECT_OFF = 0x00,
+  SX126X_GFSK_PREAMBLE_DETECT_8 = 0x04,  /**< 8 bits */
+  SX126X_GFSK_PREAMBLE_DETECT_16 = 0x05, /**< 16 bits */
+  SX126X_GFSK_PREAMBLE_DETECT_24 = 0x06, /**< 24 bits */
+  SX126X_GFSK_PREAMBLE_DETECT_32 = 0x07, /**< 32 bits */
+} sx126x_gfsk_preamble_detect_t;
+
+/**
+ * @brief GFSK payload CRC.
+ */
+typedef enum
+{
+  SX126X_GFSK_CRC_OFF = 0,
+  SX126X_GFSK_CRC_1_BYTE,
+  SX126X_GFSK_CRC_2_BYTE,
+  SX126X_GFSK_CRC_1_BYTE_INV,
+  SX126X_GFSK_CRC_2_BYTE_INV,
+} sx126x_gfsk_crc_t;
+
+/**
+ * @brief LoRa channel activity detection settings.
+ *
+ * det_peak and det_min trade false detections against missed ones; see sx126x_cad_default_params
+ * for values that suit each spreading factor.
+ */
+typedef struct
+{
+  sx126x_cad_symbols_t symbols;
+  uint8_t det_peak;
+  uint8_t det_min;
+} sx126x_cad_params_t;
+
+/** Longest GFSK sync word in bytes. */
+#define SX126X_GFSK_SYNC_WORD_MAX_LEN 8
+
 /**
  * @brief Represents configuration options for the SX126x.
  */
@@ -121,6 +239,8 @@ typedef struct
   uint32_t frequency_hz;
   sx126x_pa_profile_t pa_profile;
   sx126x_modem_t modem;
+  sx126x_fallback_mode_t fallback_mode; /**< Mode the chip idles in after TX and RX, 0 for
+                                           STDBY_RC. FS makes the next TX or RX start sooner. */
 
   int power_dbm; /**< Output power in dBm. If low power PA is selected, then -17 to +14dBm. If high
                     power PA is selected, then -9 to +22dBm. */
@@ -129,20 +249,181 @@ typedef struct
   sx126x_lora_spreading_factor_t lora_sf;
   sx126x_lora_bandwidth_t lora_bw;
   sx126x_lora_coding_rate_t lora_cr;
-  bool lora_ldro; /**< Enable/Disable Low Data Rate Optimization (LDRO). */
+  bool lora_ldro; /**< Force Low Data Rate Optimization (LDRO) on. It is enabled automatically
+                     whenever a symbol lasts longer than 16 ms, as the datasheet requires. */
+
+  uint16_t lora_preamble_len; /**< Preamble length in symbols, 0 for the default of 8. */
+  bool lora_implicit_header;  /**< Implicit (fixed length) header instead of explicit. */
+  bool lora_crc_on;           /**< Append a payload CRC. */
+  bool lora_invert_iq;        /**< Invert IQ, e.g. for LoRaWAN downlinks. */
+  uint8_t lora_sync_word;     /**< 0x12 private, 0x34 public network, 0 keeps the chip default. */
+  uint8_t rx_payload_len;     /**< Length of received packets with an implicit header or of fixed
+                                   length GFSK packets, which do not carry it; 0 for 255. */
+
+  uint32_t gfsk_bitrate_bps; /**< 600 to 300000 bit/s. */
+  uint32_t gfsk_fdev_hz;     /**< Frequency deviation. */
+  sx126x_gfsk_shaping_t gfsk_shaping;
+  sx126x_gfsk_bandwidth_t gfsk_bw;
+  uint16_t gfsk_preamble_bits; /**< Preamble length in bits, 0 for the default of 32. */
+  sx126x_gfsk_preamble_detect_t gfsk_preamble_detect;
+  uint8_t gfsk_sync_word[SX126X_GFSK_SYNC_WORD_MAX_LEN];
+  uint8_t gfsk_sync_word_len; /**< Sync word length in bytes, 0 to 8. */
+  bool gfsk_fixed_length;     /**< Fixed length packets instead of a length byte. */
+  sx126x_gfsk_crc_t gfsk_crc;
+  bool gfsk_whitening; /**< Enable data whitening. */
 } sx126x_config_t;
 
 /**
- * @brief Represents a LoRa radio instance.
+ * @brief Receive-path counters, updated by the DIO1 handler.
+ */
+typedef struct
+{
+  uint32_t received;   /**< Packets pushed into the RX ring */
+  uint32_t crc_errors; /**< Packets discarded for a CRC or header error */
+  uint32_t overruns;   /**< Packets discarded because the RX ring was full */
+  uint32_t bus_errors; /**< Packets lost to a bus error while draining */
+} sx126x_rx_stats_t;
+
+/**
+ * @brief Bus savings from delta reconfiguration.
  */
 typedef struct
+{
+  uint32_t sent;    /**< Commands sent by sx126x_reconfigure */
+  uint32_t skipped; /**< Commands a full resync would have sent but were unchanged */
+  uint32_t resyncs; /**< Reconfigurations that had to resend everything */
+} sx126x_reconfig_stats_t;
+
+// Forward declaration
+typedef struct sx126x_s sx126x_t;
+
+/**
+ * @brief Called when an asynchronous transmission finishes.
+ *
+ * @param dev Radio that finished transmitting.
+ * @param result SX126X_OK on TxDone, SX126X_ERR_TIMEOUT if the chip timed out, or the bus error
+ * that aborted the operation.
+ * @param arg User argument passed to sx126x_transmit_async.
+ */
+typedef void (*sx126x_tx_done_cb_t)(sx126x_t *dev, sx126x_status_t result, void *arg);
+
+/**
+ * @brief Called when a single receive window closes.
+ *
+ * @param dev Radio whose window closed.
+ * @param result SX126X_OK if a packet was put in the ring, SX126X_ERR_TIMEOUT if the window closed
+ * without a good packet, SX126X_ERR_NO_MEM if the ring was full, or the bus error that aborted
+ * the window.
+ * @param arg User argument passed to sx126x_receive_single, sx126x_receive_window or
+ * sx126x_transmit_receive.
+ */
+typedef void (*sx126x_rx_done_cb_t)(sx126x_t *dev, sx126x_status_t result, void *arg);
+
+/**
+ * @brief Called when a channel activity detection finishes.
+ *
+ * @param dev Radio that ran the CAD.
+ * @param result SX126X_OK if the channel was clear, SX126X_ERR_CHANNEL_BUSY if activity was
+ * detected, or the bus error that aborted the CAD.
+ * @param arg User argument passed to sx126x_cad.
+ */
+typedef void (*sx126x_cad_done_cb_t)(sx126x_t *dev, sx126x_status_t result, void *arg);
+
+/**
+ * @brief Represents a LoRa radio instance.
+ */
+struct sx126x_s
 {
   bool is_initialized;
   sx126x_state_t state;
   sx126x_bus_t *bus;
   sx126x_chip_variant_t chip;
   sx126x_pa_profile_t pa_profile;
-} sx126x_t;
+
+  // Status byte clocked back by the most recent command, and the opcode it was sent with. The
+  // chip reports the outcome of a command in the status of the next one.
+  uint8_t status;
+  uint8_t status_opcode;
+  uint8_t error_opcode; // last command the chip reported as failed
+  uint32_t cmd_errors;
+
+  // Last configuration known to be applied to the chip. Invalidated by any failed bus transfer.
+  sx126x_config_t shadow;
+  bool shadow_valid;
+  bool is_warm_sleep; // the chip kept its configuration across the current sleep
+  sx126x_reconfig_stats_t reconfig_stats;
+
+  // Channel plan used by sx126x_set_channel.
+  const sx126x_channel_plan_t *channel_plan;
+
+  // Frame format applied by every transmission, for the configured modem.
+  sx126x_modem_t modem;
+  uint16_t lora_preamble_len;
+  bool lora_implicit_header;
+  bool lora_crc_on;
+  bool lora_invert_iq;
+  uint8_t rx_payload_len;
+  uint16_t gfsk_preamble_bits;
+  sx126x_gfsk_preamble_detect_t gfsk_preamble_detect;
+  uint8_t gfsk_sync_word_len;
+  bool gfsk_fixed_length;
+  sx126x_gfsk_crc_t gfsk_crc;
+  bool gfsk_whitening;
+
+  // Pending asynchronous transmission.
+  sx126x_tx_done_cb_t tx_cb;
+  void *tx_cb_arg;
+
+  // Outcome of a blocking sx126x_transmit, set by its completion callback.
+  volatile bool transmit_done;
+  sx126x_status_t transmit_result;
+
+  // Double-buffered TX queue. tx_base is the TX half currently programmed; the next packet is
+  // staged in the other half while the current one is on air.
+  uint8_t tx_base;
+  bool tx_queued; /**< Packet on air was started by the TX queue and fits in its half */
+  volatile bool tx_next_staged;
+  uint8_t tx_next_base;
+  uint8_t tx_next_len;
+  uint32_t tx_next_ticks;
+  sx126x_tx_done_cb_t tx_next_cb;
+  void *tx_next_arg;
+
+  // Reception. rx_single marks a window that ends with its first packet or its timeout.
+  sx126x_rx_ring_t *rx_ring;
+  bool rx_single;
+  sx126x_rx_done_cb_t rx_cb;
+  void *rx_cb_arg;
+  uint8_t lora_symb_timeout; // last SetLoRaSymbNumTimeout sent
+  sx126x_rx_stats_t rx_stats;
+  uint8_t rx_prefetch_len; /**< Payload bytes read speculatively with the RX status */
+
+  // Channel activity detection. cad_params with det_peak at 0 follow the spreading factor.
+  sx126x_cad_params_t cad_params;
+  sx126x_cad_exit_t cad_exit; // what the running CAD chains into
+  sx126x_cad_done_cb_t cad_cb;
+  void *cad_cb_arg;
+
+  // LR-FHSS transmission in TX state: the next hop to write into the chip's hop table, and the
+  // end of the table. lr_fhss_end is NULL for any other transmission.
+  const sx126x_lr_fhss_hop_t *lr_fhss_next;
+  const sx126x_lr_fhss_hop_t *lr_fhss_end;
+  // Set while the chip may still have the LR-FHSS packet type. The configured modem is restored
+  // before the next operation.
+  bool modem_stale;
+
+  // Receive window that sx126x_transmit_receive opens from TxDone, encoded before the packet goes
+  // out. rx_after_tx_params_len is 0 when the packet parameters of the TX serve the RX as well.
+  bool rx_after_tx;
+  uint8_t rx_after_tx_params[SX126X_PACKET_PARAMS_FRAME_LEN];
+  uint8_t rx_after_tx_params_len;
+  uint8_t rx_after_tx_set_rx[SX126X_SET_RX_FRAME_LEN];
+
+#if SX126X_ENABLE_STATS
+  // Bus instrumentation, see stats.h.
+  sx126x_stats_t stats;
+#endif
+};
 
 #ifdef __cplusplus
 extern "C"
@@ -168,6 +449,381 @@ sx126x_status_t sx126x_init(sx126x_t *radio, sx126x_bus_t *bus, sx126x_config_t
  */
 sx126x_status_t sx126x_deinit(sx126x_t *radio);
 
+/**
+ * @brief Apply a new configuration without a deinit/init cycle.
+ *
+ * Compares cfg against the shadow of the last applied configuration and sends only the commands
+ * whose parameters changed, in one submission. If the shadow is not trusted (after a bus error)
+ * or the modem changes, the full configuration is resent instead. Savings are accumulated in
+ * reconfig_stats.
+ *
+ * @param radio Pointer to an initialized sx126x_t in standby.
+ * @param cfg New configuration.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_reconfigure(sx126x_t *radio, const sx126x_config_t *cfg);
+
+/**
+ * @brief Decode the status byte captured from the most recent command.
+ *
+ * Every command clocks a status byte back on MISO; the driver keeps the latest one, so this costs
+ * no bus traffic. The command status describes the command before the latest one.
+ *
+ * @param radio Pointer to an initialized sx126x_t.
+ * @param mode Receives the chip mode. May be NULL.
+ * @param cmd_status Receives the command status. May be NULL.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_get_cached_status(const sx126x_t *radio,
+                                         sx126x_chip_mode_t *mode,
+                                         sx126x_cmd_status_t *cmd_status);
+
+/**
+ * @brief Put the chip to sleep.
+ *
+ * In a warm sleep the chip keeps the configuration set by commands, and sx126x_wake only rewrites
+ * what it does not retain: registers such as the sync word. A cold sleep draws less current but
+ * loses everything, and sx126x_wake replays the whole cached configuration. Neither needs a new
+ * sx126x_init. The data buffer is lost in both.
+ *
+ * @param radio Pointer to an initialized sx126x_t in standby.
+ * @param warm Keep the configuration (warm start) instead of resetting it (cold start).
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_sleep(sx126x_t *radio, bool warm);
+
+/**
+ * @brief Wake the chip and restore what it lost while asleep, in one submission.
+ *
+ * On return the radio is in standby and a transmission or reception may be started. Does nothing
+ * when the radio is not asleep.
+ *
+ * @param radio Pointer to an initialized sx126x_t.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_wake(sx126x_t *radio);
+
+#if SX126X_ENABLE_STATS
+/**
+ * @brief Take a snapshot of the bus statistics, e.g. from a telemetry task.
+ *
+ * The copy is not atomic with respect to a concurrent bus call, so individual counters may be one
+ * call apart.
+ *
+ * @param radio Pointer to the sx126x_t.
+ * @param out Receives the statistics.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_get_stats(const sx126x_t *radio, sx126x_stats_t *out);
+
+/**
+ * @brief Clear the bus statistics.
+ * @param radio Pointer to the sx126x_t.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_reset_stats(sx126x_t *radio);
+#endif
+
+/**
+ * @brief Select the channel plan used by sx126x_set_channel.
+ *
+ * The plan and its channels must outlive the radio, or be replaced first.
+ *
+ * @param radio Pointer to an initialized sx126x_t.
+ * @param plan Channel plan, or NULL to detach.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_set_channel_plan(sx126x_t *radio, const sx126x_channel_plan_t *plan);
+
+/**
+ * @brief Tune to a channel of the current plan by sending its pre-encoded frame.
+ *
+ * @param radio Pointer to an initialized sx126x_t in standby.
+ * @param index Channel index within the plan.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_set_channel(sx126x_t *radio, uint16_t index);
+
+/**
+ * @brief Start transmitting a packet and return as soon as the chip is in TX mode.
+ *
+ * Completion is reported through cb once the DIO1 handler sees TxDone or Timeout. On buses without
+ * a DIO1 hook, the caller must poll sx126x_handle_irq until the callback fires.
+ *
+ * @param radio Pointer to an initialized sx126x_t in standby.
+ * @param tx_buffer Payload to send.
+ * @param tx_len Payload length, 1 to 255 bytes.
+ * @param timeout_ms TX timeout in milliseconds, 0 to disable.
+ * @param cb Completion callback, may be NULL.
+ * @param arg User argument passed to cb.
+ * @return SX126X_OK if the transmission was started, SX126X_ERR_BUSY if another operation is in
+ * progress, error code otherwise.
+ */
+sx126x_status_t sx126x_transmit_async(sx126x_t *radio,
+                                      const uint8_t *tx_buffer,
+                                      size_t tx_len,
+                                      uint32_t timeout_ms,
+                                      sx126x_tx_done_cb_t cb,
+                                      void *arg);
+
+/**
+ * @brief Queue a packet for a back-to-back burst.
+ *
+ * The data buffer is split into two halves. If the radio is idle the packet goes on air at once;
+ * if a queued packet is on air, this one is uploaded into the other half straight away and is
+ * started from the DIO1 handler as soon as TxDone arrives, with no payload transfer in between.
+ * At most one packet can wait behind the one on air. Push from a single task only, typically from
+ * the previous packet's callback.
+ *
+ * @param radio Pointer to an initialized sx126x_t.
+ * @param tx_buffer Payload to send.
+ * @param tx_len Payload length, 1 to SX126X_TX_QUEUE_MAX_LEN bytes.
+ * @param timeout_ms TX timeout in milliseconds, 0 to disable.
+ * @param cb Completion callback, may be NULL.
+ * @param arg Passed through to cb.
+ * @return SX126X_OK if started or staged, SX126X_ERR_BUSY if the queue is full or the radio is
+ * busy with something else, error code otherwise.
+ */
+sx126x_status_t sx126x_tx_queue_push(sx126x_t *radio,
+                                     const uint8_t *tx_buffer,
+                                     size_t tx_len,
+                                     uint32_t timeout_ms,
+                                     sx126x_tx_done_cb_t cb,
+                                     void *arg);
+
+/**
+ * @brief Transmit a packet only if the channel is clear, checked and sent in one chip operation.
+ *
+ * Payload, packet parameters and a CAD in listen-before-talk mode go out in one submission. If the
+ * CAD detects no activity the chip switches straight to TX without waiting on the host; otherwise
+ * it returns to standby and cb reports SX126X_ERR_CHANNEL_BUSY. LoRa only. See lbt.h for retries
+ * with backoff.
+ *
+ * @return As sx126x_transmit_async; SX126X_ERR_INVALID_ARG for a GFSK configuration.
+ */
+sx126x_status_t sx126x_transmit_lbt(sx126x_t *radio,
+                                    const uint8_t *tx_buffer,
+                                    size_t tx_len,
+                                    uint32_t timeout_ms,
+                                    sx126x_tx_done_cb_t cb,
+                                    void *arg);
+
+/**
+ * @brief Transmit an LR-FHSS packet, hopping as the table says.
+ *
+ * Switches the chip to the LR-FHSS packet type, uploads the payload and the first
+ * SX126X_LR_FHSS_HOP_SLOTS hops, and starts TX. From then on, the DIO1 handler answers each hop
+ * IRQ by sending the next pre-encoded hop frame, together with the IRQ clear, in one submission;
+ * it neither computes nor logs anything. Once the packet is sent, the configured packet type and
+ * modulation are restored before cb runs.
+ *
+ * @param radio Pointer to an initialized sx126x_t in standby.
+ * @param table Hop table; it and its hops must stay valid until cb has run.
+ * @param payload Encoded LR-FHSS packet: header blocks and payload fragments, as the chip sends it.
+ * @param len Payload length, 1 to 255 bytes.
+ * @param timeout_ms TX timeout in milliseconds, 0 to disable.
+ * @param cb Completion callback, may be NULL. A bus error while restoring the configuration is
+ * reported here; sx126x_reconfigure then resends the whole configuration.
+ * @return As sx126x_transmit_async.
+ */
+sx126x_status_t sx126x_transmit_lr_fhss(sx126x_t *radio,
+                                        const sx126x_lr_fhss_table_t *table,
+                                        const uint8_t *payload,
+                                        size_t len,
+                                        uint32_t timeout_ms,
+                                        sx126x_tx_done_cb_t cb,
+                                        void *arg);
+
+/**
+ * @brief Transmit a packet and wait for it to finish.
+ *
+ * Polls the chip's IRQ status over the bus until the packet is sent, with the bus's delay_us
+ * between polls when it has one; prefer sx126x_transmit_async. The chip's TX timeout is set from
+ * the packet's time on air, so a lost TxDone ends in SX126X_ERR_TIMEOUT rather than a hang.
+ *
+ * @return SX126X_OK on TxDone, SX126X_ERR_TIMEOUT on chip timeout, SX126X_ERR_NOT_INIT if the radio
+ * is not initialized, error code otherwise. On an error the TX is aborted.
+ */
+sx126x_status_t sx126x_transmit(sx126x_t *radio, const uint8_t *tx_buffer, size_t tx_len);
+
+/**
+ * @brief Put the receiver in continuous mode, feeding every good packet into ring.
+ *
+ * The DIO1 handler drains payload, RSSI and SNR into the ring as each packet arrives and never
+ * waits on the consumer: when the ring is full the packet is dropped and counted in
+ * rx_stats.overruns. The radio stays in RX until sx126x_receive_stop.
+ *
+ * @param radio Pointer to an initialized sx126x_t in standby.
+ * @param ring Initialized ring; the application must be its only consumer.
+ * @return SX126X_OK if successful, SX126X_ERR_BUSY if another operation is in progress, error
+ * code otherwise.
+ */
+sx126x_status_t sx126x_receive_continuous(sx126x_t *radio, sx126x_rx_ring_t *ring);
+
+/**
+ * @brief Open a single receive window that closes after one packet or a timeout.
+ *
+ * The chip returns to standby by itself when the window closes, and cb runs from the DIO1
+ * handler. A good packet goes into ring as in continuous RX.
+ *
+ * @param radio Pointer to an initialized sx126x_t in standby.
+ * @param ring Initialized ring; the application must be its only consumer.
+ * @param timeout_us RX timer, stopped by a LoRa header or GFSK sync word; 0 for none.
+ * @param symbols LoRa only: stop searching if no preamble is found within this many symbols,
+ * 0 to rely on timeout_us alone. Should be a value from sx126x_lora_rx_symbols.
+ * @param cb Called when the window closes, may be NULL.
+ * @return SX126X_OK if the window opened, SX126X_ERR_BUSY if another operation is in progress,
+ * error code otherwise.
+ */
+sx126x_status_t sx126x_receive_single(sx126x_t *radio,
+                                      sx126x_rx_ring_t *ring,
+                                      uint32_t timeout_us,
+                                      uint8_t symbols,
+                                      sx126x_rx_done_cb_t cb,
+                                      void *arg);
+
+/**
+ * @brief Open the shortest receive window that catches a packet expected now, give or take
+ * uncertainty_us.
+ *
+ * Derives the LoRa symbol-number timeout and the RX timeout from the configured modulation and
+ * preamble (see airtime.h), so that an empty window costs little more than the preamble. Open it
+ * uncertainty_us before the packet is expected.
+ *
+ * @return As sx126x_receive_single; SX126X_ERR_INVALID_ARG if no window can be derived.
+ */
+sx126x_status_t sx126x_receive_window(sx126x_t *radio,
+                                      sx126x_rx_ring_t *ring,
+                                      uint32_t uncertainty_us,
+                                      sx126x_rx_done_cb_t cb,
+                                      void *arg);
+
+/**
+ * @brief Send a packet and open a single receive window straight after it, e.g. for an ACK.
+ *
+ * The window's SetRx frame, and its packet parameters when those of the packet do not fit the
+ * receiver, are encoded before the packet goes out. The DIO1 handler then answers TxDone by
+ * clearing it and sending them in one submission, without going through standby or the host's
+ * RX setup. How soon the receiver listens also depends on the configured fallback_mode, since the
+ * chip starts RX faster from FS than from STDBY_RC.
+ *
+ * The window works as with sx126x_receive_single, with the same packet parameters as the packet
+ * apart from its length.
+ *
+ * @param radio Pointer to an initialized sx126x_t in standby.
+ * @param tx_timeout_ms TX timeout in milliseconds, 0 for none.
+ * @param cb Called once the window closes, or the transmission fails, may be NULL. A transmission
+ * that times out reports SX126X_ERR_TIMEOUT, like a window that closes empty.
+ * @return As sx126x_receive_single; SX126X_ERR_INVALID_ARG for a bad payload.
+ */
+sx126x_status_t sx126x_transmit_receive(sx126x_t *radio,
+                                        const uint8_t *tx_buffer,
+                                        size_t tx_len,
+                                        uint32_t tx_timeout_ms,
+                                        sx126x_rx_ring_t *ring,
+                                        uint32_t timeout_us,
+                                        uint8_t symbols,
+                                        sx126x_rx_done_cb_t cb,
+                                        void *arg);
+
+/**
+ * @brief Recommended CAD settings for a spreading factor, after Semtech AN1200.48.
+ *
+ * Longer symbols give the detector more to correlate on, so higher spreading factors use four
+ * symbols and a higher peak threshold.
+ */
+void sx126x_cad_default_params(sx126x_lora_spreading_factor_t sf, sx126x_cad_params_t *out);
+
+/**
+ * @brief Select the CAD settings used from now on.
+ *
+ * @param radio Pointer to an initialized sx126x_t.
+ * @param params Settings to use, or NULL to follow the configured spreading factor.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_set_cad_params(sx126x_t *radio, const sx126x_cad_params_t *params);
+
+/**
+ * @brief Run one LoRa channel activity detection; cb reports whether the channel is clear.
+ *
+ * @param radio Pointer to an initialized sx126x_t in standby.
+ * @param cb Called from the DIO1 handler once the CAD is done, may be NULL.
+ * @return SX126X_OK if the CAD started, SX126X_ERR_BUSY if another operation is in progress,
+ * SX126X_ERR_INVALID_ARG for a GFSK configuration, error code otherwise.
+ */
+sx126x_status_t sx126x_cad(sx126x_t *radio, sx126x_cad_done_cb_t cb, void *arg);
+
+/**
+ * @brief Listen for activity and open a single receive window only if there is some, in one chip
+ * operation.
+ *
+ * The window works as with sx126x_receive_single. When the CAD finds the channel quiet, it closes
+ * at once and cb reports SX126X_ERR_TIMEOUT, which keeps the receiver off for all but a few
+ * symbols when there is nothing to hear.
+ *
+ * @param timeout_us RX timer once activity was detected, 0 for none.
+ * @return As sx126x_receive_single; SX126X_ERR_INVALID_ARG for a GFSK configuration.
+ */
+sx126x_status_t sx126x_cad_receive(sx126x_t *radio,
+                                   sx126x_rx_ring_t *ring,
+                                   uint32_t timeout_us,
+                                   sx126x_rx_done_cb_t cb,
+                                   void *arg);
+
+/**
+ * @brief Leave continuous RX, or close a single window early, and return to standby. The window's
+ * callback does not run.
+ *
+ * @param radio Pointer to an initialized sx126x_t.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_receive_stop(sx126x_t *radio);
+
+/**
+ * @brief Read and acknowledge one RX completion in a single bus submission.
+ *
+ * Chains GetIrqStatus, ClearIrqStatus, GetRxBufferStatus, GetPacketStatus and ReadBuffer into one
+ * batch. The payload is read speculatively, sized after the previous packet; a longer packet
+ * costs one more transfer for its tail. This is the path the DIO1 handler takes in continuous RX.
+ *
+ * pkt->irq holds the IRQ flags that were pending, of which RxDone, CRC error, header error and
+ * timeout are cleared; others are left for whoever raised them. The payload is only valid when
+ * they include SX126X_IRQ_RX_DONE and neither CRC nor header error; otherwise pkt->len is 0.
+ *
+ * @param radio Pointer to an initialized sx126x_t.
+ * @param pkt Receives the packet.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_rx_complete(sx126x_t *radio, sx126x_rx_packet_t *pkt);
+
+/**
+ * @brief Service a DIO1 interrupt: read and clear the IRQ status and advance the state machine.
+ *
+ * Registered automatically with buses that provide attach_dio1; may also be polled.
+ *
+ * @param radio Pointer to an initialized sx126x_t.
+ * @return SX126X_OK if successful, error code otherwise.
+ */
+sx126x_status_t sx126x_handle_irq(sx126x_t *radio);
+
+/**
+ * @brief Whether the radio is in standby with no operation running, i.e. ready for a new one.
+ *
+ * Safe to call from any task while the DIO1 handler runs.
+ */
+bool sx126x_is_idle(const sx126x_t *radio);
+
+/**
+ * @brief Attach sx126x_handle_irq to the bus's DIO1 line, replacing any other handler.
+ *
+ * Done by initialization; call it to take DIO1 back after another handler was attached, e.g. by
+ * the multi-radio manager.
+ *
+ * @param radio Pointer to an sx126x_t with a bus.
+ * @return SX126X_OK if successful or the bus has no attach_dio1 hook, error code otherwise.
+ */
+sx126x_status_t sx126x_attach_irq(sx126x_t *radio);
+
 #ifdef __cplusplus
 }
 #endif
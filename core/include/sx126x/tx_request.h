@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file tx_request.h
+ * @brief Queue of caller-owned transmit requests shared by the transmit schedulers.
+ * @version 0.1
+ * @date 2025
+ */
+
+#ifndef SX126X_TX_REQUEST_H
+#define SX126X_TX_REQUEST_H
+
+#include "sx126x/sx126x.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct sx126x_tx_req_t sx126x_tx_req_t;
+
+/**
+ * @brief A queued transmission. Storage, including the payload, is owned by the caller and must
+ * stay valid until the done callback has run; a request may be resubmitted from its callback.
+ */
+struct sx126x_tx_req_t
+{
+  const uint8_t *payload;
+  uint8_t len;
+  sx126x_tx_done_cb_t done;
+  void *arg;
+  sx126x_tx_req_t *next;
+  bool queued;
+};
+
+/**
+ * @brief Requests in submission order.
+ */
+typedef struct
+{
+  sx126x_tx_req_t *head;
+  sx126x_tx_req_t *tail;
+} sx126x_tx_fifo_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Empty a queue, forgetting any requests in it.
+ */
+void sx126x_tx_fifo_init(sx126x_tx_fifo_t *fifo);
+
+/**
+ * @brief Fill in a request and append it to a queue.
+ *
+ * @return SX126X_OK if queued, SX126X_ERR_BUSY if req is already queued, SX126X_ERR_INVALID_ARG
+ * otherwise.
+ */
+sx126x_status_t sx126x_tx_fifo_push(sx126x_tx_fifo_t *fifo,
+                                    sx126x_tx_req_t *req,
+                                    const uint8_t *payload,
+                                    uint8_t len,
+                                    sx126x_tx_done_cb_t done,
+                                    void *arg);
+
+/**
+ * @brief Take a request out of a queue.
+ *
+ * @param prev Request before req, NULL if req is the head.
+ */
+void sx126x_tx_fifo_remove(sx126x_tx_fifo_t *fifo, sx126x_tx_req_t *prev, sx126x_tx_req_t *req);
+
+/**
+ * @brief Take a request out of a queue and run its done callback with result.
+ *
+ * @param prev Request before req, NULL if req is the head.
+ */
+void sx126x_tx_fifo_finish(sx126x_tx_fifo_t *fifo,
+                           sx126x_tx_req_t *prev,
+                           sx126x_tx_req_t *req,
+                           sx126x_t *radio,
+                           sx126x_status_t result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_TX_REQUEST_H
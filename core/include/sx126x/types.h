@@ -23,6 +23,8 @@ typedef enum
   SX126X_ERR_HAL,      /* underlying HAL reported an error */
   SX126X_ERR_IO, /* IO error*/
   SX126X_ERR_NOT_INIT, /* driver not initialized */
+  SX126X_ERR_CMD,      /* chip reported a command processing or execution failure */
+  SX126X_ERR_CHANNEL_BUSY, /* channel activity detection found the channel in use */
   SX126X_ERR_UNKNOWN,
 } sx126x_status_t;
 
@@ -1,7 +1,10 @@
 // SPDX-License-Identifier: MIT
 
 #include "sx126x/sx126x.h"
+#include "sx126x/airtime.h"
 #include "sx126x/bus.h"
+#include "sx126x/commands.h"
+#include "sx126x/init_image.h"
 #include "sx126x/log.h"
 #include "sx126x/types.h"
 #include <stdbool.h>
@@ -9,54 +12,49 @@
 #include <stdint.h>
 #include <string.h>
 
-static const uint32_t SX126X_FREQ_XTAL_HZ = 32000000; // 32 MHz
-
-// Opcodes for the SX126x-class chip.
-typedef enum
-{
-  SX126X_OP_SET_DIO_IRQ_PARAMS = 0x08,
-  SX126X_OP_READ_REGISTER = 0x1D,
-  SX126X_OP_SET_STANDBY = 0x80,
-  SX126X_OP_SET_RF_FREQUENCY = 0x86,
-  SX126X_OP_SET_PACKET_TYPE = 0x8A,
-  SX126X_OP_SET_MODULATION_PARAMS = 0x8B,
-  SX126X_OP_SET_TX_PARAMS = 0x8E,
-  SX126X_OP_SET_PA_CONFIG = 0x95,
-} sx126x_opcode_t;
-
-// Standby modes for the SX126x-class chip.
-typedef enum
-{
-  SX126X_STBY_RC = 0x00,
-  SX126X_STBY_XOSC = 0x01,
-} sx126x_standby_mode_t;
-
-// Packet types for the SX126x-class chip.
-typedef enum
-{
-  SX126X_PACKET_TYPE_GFSK = 0x00,
-  SX126X_PACKET_TYPE_LORA = 0x01,
-  SX126X_PACKET_TYPE_LR_FHSS = 0x03,
-} sx126x_packet_type_t;
-
-// IRQs
-typedef enum
-{
-  SX126X_IRQ_TX_DONE = (1 << 0),
-  SX126X_IRQ_RX_DONE = (1 << 1),
-  SX126X_IRQ_PREAMBLE_DETECTED = (1 << 2),
-  SX126X_IRQ_SYNC_WORD_VALID = (1 << 3),
-  SX126X_IRQ_HEADER_VALID = (1 << 4),
-  SX126X_IRQ_HEADER_ERR = (1 << 5),
-  SX126X_IRQ_CRC_ERR = (1 << 6),
-  SX126X_IRQ_CAD_DONE = (1 << 7),
-  SX126X_IRQ_CAD_DETECTED = (1 << 8),
-  SX126X_IRQ_TIMEOUT = (1 << 9),
-  SX126X_IRQ_LR_FHSS_HOP = (1 << 14),
-
-  SX126X_IRQ_NONE = 0x0000,
-  SX126X_IRQ_ALL = 0xFFFF,
-} sx126x_irq_t;
+// Longest command frame built by the core (WriteRegister with a full GFSK sync word).
+#define SX126X_CMD_MAX_LEN (3 + SX126X_GFSK_SYNC_WORD_MAX_LEN)
+
+// Largest number of commands in the init sequence.
+#define SX126X_INIT_CMD_MAX 11
+
+// Frame clocked only to pull NSS low, which is what wakes the chip; it is not executed. One byte
+// long so that no status is read back from a chip that is still asleep.
+#define SX126X_WAKE_FRAME_LEN 1
+
+// SetTx/SetRx timeouts are in units of 15.625us, i.e. 64 ticks per millisecond.
+#define SX126X_TIMEOUT_TICKS_PER_MS 64
+#define SX126X_TIMEOUT_MAX_TICKS 0xFFFFFE
+
+// Initial speculative payload read of the chained RX completion, until a packet has been seen.
+#define SX126X_RX_PREFETCH_INITIAL 32
+
+// Margin on top of the time on air for the SetTx timeout of a blocking transmit, covering the PA
+// ramp-up and the switch into TX.
+#define SX126X_TRANSMIT_MARGIN_MS 10
+
+// Interval between IRQ status polls of a blocking transmit, on buses with a delay hook.
+#define SX126X_TRANSMIT_POLL_US 1000
+
+// Least time one IRQ status poll takes on the bus: GetIrqStatus clocks 32 bits, 2 us at the chip's
+// 16 MHz SPI limit. Bounds a blocking transmit on buses with neither a clock nor a delay hook.
+#define SX126X_TRANSMIT_POLL_MIN_US 2
+
+// Largest number of frames handed to bus->transfer_batch in one call.
+#define SX126X_BATCH_MAX_FRAMES 16
+
+// MISO bytes captured from a write-only command: the opcode slot and the status byte.
+#define SX126X_STATUS_RX_LEN 2
+
+// Command header plus payload of a buffer access, staged for HALs without transfer_batch.
+#define SX126X_STAGE_MAX_LEN (3 + SX126X_MAX_PAYLOAD_LEN)
+
+// A single encoded command frame.
+typedef struct
+{
+  uint8_t buf[SX126X_CMD_MAX_LEN];
+  size_t len;
+} sx126x_cmd_t;
 
 // Configuratin values for PA.
 typedef struct
@@ -68,24 +66,181 @@ typedef struct
 } sx126x_pa_config_t;
 
 static sx126x_status_t sx126x_set_standby(sx126x_t *dev, sx126x_standby_mode_t mode);
-static sx126x_status_t sx126x_set_packet_type(sx126x_t *dev, sx126x_modem_t modem);
-static sx126x_status_t sx126x_set_frequency(sx126x_t *dev, uint32_t hz);
-static sx126x_status_t sx126x_set_pa_profile(sx126x_t *dev, sx126x_pa_profile_t profile);
 static sx126x_status_t
-sx126x_set_tx_params(sx126x_t *dev, int pwr, sx126x_power_ramp_time_t ramp_time);
-static sx126x_status_t sx126x_set_lora_modulation_params(sx126x_t *dev,
-                                                         sx126x_lora_spreading_factor_t sf,
-                                                         sx126x_lora_bandwidth_t bw,
-                                                         sx126x_lora_coding_rate_t cr,
-                                                         bool ldro);
-static sx126x_status_t sx126x_set_dio_irq_params(
-    sx126x_t *dev, uint16_t irq_mask, uint16_t dio1_mask, uint16_t dio2_mask, uint16_t dio3_mask);
+sx126x_get_pa_configuration(sx126x_t *dev, sx126x_pa_profile_t profile, sx126x_pa_config_t *cfg);
 
+static void sx126x_encode_standby(sx126x_cmd_t *cmd, sx126x_standby_mode_t mode);
+static void sx126x_encode_fallback_mode(sx126x_cmd_t *cmd, sx126x_fallback_mode_t mode);
+static void sx126x_encode_sleep(sx126x_cmd_t *cmd, bool warm);
+static void sx126x_encode_wake(sx126x_cmd_t *cmd);
+static void sx126x_encode_packet_type(sx126x_cmd_t *cmd, sx126x_modem_t modem);
+static void sx126x_encode_frequency(sx126x_cmd_t *cmd, uint32_t hz);
 static sx126x_status_t
-sx126x_get_pa_configuration(sx126x_t *dev, sx126x_pa_profile_t profile, sx126x_pa_config_t *cfg);
+sx126x_encode_pa_profile(sx126x_t *dev, sx126x_cmd_t *cmd, sx126x_pa_profile_t profile);
+static void sx126x_encode_tx_params(sx126x_cmd_t *cmd, int pwr, sx126x_power_ramp_time_t ramp_time);
+static void sx126x_encode_lora_modulation_params(sx126x_cmd_t *cmd,
+                                                 sx126x_lora_spreading_factor_t sf,
+                                                 sx126x_lora_bandwidth_t bw,
+                                                 sx126x_lora_coding_rate_t cr,
+                                                 bool ldro);
+static void sx126x_encode_gfsk_modulation_params(sx126x_cmd_t *cmd, const sx126x_config_t *cfg);
+static void sx126x_encode_modulation_params(sx126x_cmd_t *cmd, const sx126x_config_t *cfg);
+static void sx126x_encode_dio_irq_params(sx126x_cmd_t *cmd,
+                                         uint16_t irq_mask,
+                                         uint16_t dio1_mask,
+                                         uint16_t dio2_mask,
+                                         uint16_t dio3_mask);
+
+static void sx126x_encode_buffer_base_address(sx126x_cmd_t *cmd, uint8_t tx_base, uint8_t rx_base);
+static void sx126x_encode_lora_packet_params(sx126x_cmd_t *cmd, const sx126x_t *dev, uint8_t len);
+static void sx126x_encode_gfsk_packet_params(sx126x_cmd_t *cmd, const sx126x_t *dev, uint8_t len);
+static void sx126x_encode_packet_params(sx126x_cmd_t *cmd, const sx126x_t *dev, uint8_t len);
+static uint8_t sx126x_rx_payload_len(const sx126x_t *dev);
+static void sx126x_encode_lora_sync_word(sx126x_cmd_t *cmd, uint8_t sync_word);
+static void sx126x_encode_iq_polarity(sx126x_cmd_t *cmd, bool inverted);
+static void sx126x_encode_gfsk_sync_word(sx126x_cmd_t *cmd, const uint8_t *sync_word, uint8_t len);
+static bool sx126x_gfsk_sync_word_changed(const sx126x_config_t *a, const sx126x_config_t *b);
+static sx126x_status_t sx126x_check_config(const sx126x_config_t *cfg);
+static void sx126x_encode_tx(sx126x_cmd_t *cmd, uint32_t timeout_ticks);
+static void sx126x_encode_clear_irq_status(sx126x_cmd_t *cmd, uint16_t irq);
+static void sx126x_encode_rx(sx126x_cmd_t *cmd, uint32_t timeout_ticks);
+static void sx126x_encode_lora_symb_num_timeout(sx126x_cmd_t *cmd, uint8_t symbols);
+static void sx126x_encode_cad_params(sx126x_cmd_t *cmd,
+                                     const sx126x_t *dev,
+                                     sx126x_cad_exit_t exit_mode,
+                                     uint32_t timeout_ticks);
+static void sx126x_encode_cad(sx126x_cmd_t *cmd);
+
+static void sx126x_apply_frame_format(sx126x_t *dev, const sx126x_config_t *cfg);
+static sx126x_status_t sx126x_finish_init(sx126x_t *dev, const sx126x_config_t *cfg);
+static size_t sx126x_build_retention_cmds(const sx126x_t *dev, sx126x_cmd_t *cmds);
+static sx126x_status_t sx126x_build_config_cmds(sx126x_t *dev,
+                                                const sx126x_config_t *cfg,
+                                                sx126x_cmd_t *cmds,
+                                                size_t *count);
+
+static sx126x_status_t sx126x_get_irq_status(sx126x_t *dev, uint16_t *irq);
+static void sx126x_complete_tx(sx126x_t *dev, sx126x_status_t result);
+static sx126x_status_t sx126x_sync_modem(sx126x_t *dev);
+static void sx126x_complete_lr_fhss(sx126x_t *dev, sx126x_status_t result);
+static sx126x_status_t sx126x_lr_fhss_irq(sx126x_t *dev);
+static sx126x_status_t sx126x_rx_after_tx_irq(sx126x_t *dev);
+static void sx126x_tx_queue_kick(sx126x_t *dev);
+static sx126x_status_t sx126x_start_tx(sx126x_t *dev,
+                                       bool lbt,
+                                       uint8_t base,
+                                       const uint8_t *payload,
+                                       uint8_t len,
+                                       uint32_t timeout_ticks,
+                                       sx126x_tx_done_cb_t cb,
+                                       void *arg);
+static uint32_t sx126x_timeout_ticks(uint32_t timeout_ms);
+static uint32_t sx126x_rx_timeout_ticks(uint32_t timeout_us);
+static void sx126x_complete_rx(sx126x_t *dev, sx126x_status_t result);
+static void sx126x_complete_cad(sx126x_t *dev, sx126x_status_t result);
+static sx126x_status_t sx126x_cad_done(sx126x_t *dev, uint16_t irq);
+static sx126x_status_t sx126x_rx_read(sx126x_t *dev, sx126x_rx_packet_t *pkt, bool payload);
+static sx126x_status_t sx126x_drain_rx(sx126x_t *dev);
+static void sx126x_decode_packet_status(const sx126x_t *dev,
+                                        const uint8_t *status,
+                                        sx126x_rx_packet_t *pkt);
+static void sx126x_dio1_handler(void *arg);
+
+static sx126x_status_t sx126x_init_locked(sx126x_t *dev, sx126x_bus_t *bus, sx126x_config_t *cfg);
+static sx126x_status_t sx126x_deinit_locked(sx126x_t *dev);
+static sx126x_status_t sx126x_init_from_image_locked(sx126x_t *dev,
+                                                     sx126x_bus_t *bus,
+                                                     const sx126x_init_image_t *image);
+static sx126x_status_t sx126x_reconfigure_locked(sx126x_t *dev, const sx126x_config_t *cfg);
+static sx126x_status_t sx126x_sleep_locked(sx126x_t *dev, bool warm);
+static sx126x_status_t sx126x_wake_locked(sx126x_t *dev);
+static sx126x_status_t sx126x_set_channel_locked(sx126x_t *dev, uint16_t index);
+static sx126x_status_t sx126x_transmit_async_locked(sx126x_t *dev,
+                                                    const uint8_t *tx_buffer,
+                                                    size_t tx_len,
+                                                    uint32_t timeout_ms,
+                                                    sx126x_tx_done_cb_t cb,
+                                                    void *arg);
+static sx126x_status_t sx126x_tx_queue_push_locked(sx126x_t *dev,
+                                                   const uint8_t *tx_buffer,
+                                                   size_t tx_len,
+                                                   uint32_t timeout_ms,
+                                                   sx126x_tx_done_cb_t cb,
+                                                   void *arg);
+static sx126x_status_t sx126x_transmit_lbt_locked(sx126x_t *dev,
+                                                  const uint8_t *tx_buffer,
+                                                  size_t tx_len,
+                                                  uint32_t timeout_ms,
+                                                  sx126x_tx_done_cb_t cb,
+                                                  void *arg);
+static sx126x_status_t sx126x_transmit_lr_fhss_locked(sx126x_t *dev,
+                                                      const sx126x_lr_fhss_table_t *table,
+                                                      const uint8_t *payload,
+                                                      size_t len,
+                                                      uint32_t timeout_ms,
+                                                      sx126x_tx_done_cb_t cb,
+                                                      void *arg);
+static sx126x_status_t sx126x_transmit_receive_locked(sx126x_t *dev,
+                                                      const uint8_t *tx_buffer,
+                                                      size_t tx_len,
+                                                      uint32_t tx_timeout_ms,
+                                                      sx126x_rx_ring_t *ring,
+                                                      uint32_t timeout_us,
+                                                      uint8_t symbols,
+                                                      sx126x_rx_done_cb_t cb,
+                                                      void *arg);
+static sx126x_status_t sx126x_receive_continuous_locked(sx126x_t *dev, sx126x_rx_ring_t *ring);
+static sx126x_status_t sx126x_receive_single_locked(sx126x_t *dev,
+                                                    sx126x_rx_ring_t *ring,
+                                                    uint32_t timeout_us,
+                                                    uint8_t symbols,
+                                                    sx126x_rx_done_cb_t cb,
+                                                    void *arg);
+static sx126x_status_t sx126x_cad_locked(sx126x_t *dev, sx126x_cad_done_cb_t cb, void *arg);
+static sx126x_status_t sx126x_set_cad_params_locked(sx126x_t *dev,
+                                                    const sx126x_cad_params_t *params);
+static sx126x_status_t sx126x_cad_receive_locked(sx126x_t *dev,
+                                                 sx126x_rx_ring_t *ring,
+                                                 uint32_t timeout_us,
+                                                 sx126x_rx_done_cb_t cb,
+                                                 void *arg);
+static sx126x_status_t sx126x_receive_stop_locked(sx126x_t *dev);
+static sx126x_status_t sx126x_rx_complete_locked(sx126x_t *dev, sx126x_rx_packet_t *pkt);
+static sx126x_status_t sx126x_handle_irq_locked(sx126x_t *dev);
+
+static sx126x_status_t sx126x_bus_lock(sx126x_bus_t *bus);
+static void sx126x_bus_unlock(sx126x_bus_t *bus);
+static sx126x_status_t
+sx126x_bus_xfer(sx126x_t *dev, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len);
+static sx126x_status_t sx126x_bus_xfer_staged(sx126x_t *dev, const sx126x_bus_frame_t *frame);
+static sx126x_status_t
+sx126x_submit_frames(sx126x_t *dev, const sx126x_bus_frame_t *frames, size_t count);
+static sx126x_status_t
+sx126x_check_status(sx126x_t *dev, uint8_t opcode, size_t tx_len, const uint8_t *rx, size_t rx_len);
+#if SX126X_ENABLE_STATS
+static uint32_t sx126x_now_us(sx126x_t *dev);
+#endif
+static sx126x_status_t sx126x_write_cmd(sx126x_t *dev, const sx126x_cmd_t *cmd);
+static sx126x_status_t sx126x_bus_wake(sx126x_t *dev);
+static sx126x_status_t
+sx126x_submit_cmds(sx126x_t *dev, const sx126x_cmd_t *cmds, size_t count);
 
 // Initialize the given radio instance
 sx126x_status_t sx126x_init(sx126x_t *dev, sx126x_bus_t *bus, sx126x_config_t *cfg)
+{
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_init_locked(dev, bus, cfg);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_init_locked(sx126x_t *dev, sx126x_bus_t *bus, sx126x_config_t *cfg)
 {
   SX126X_LOG_INFO(bus, "Initializing SX126x driver...");
 
@@ -109,86 +264,66 @@ sx126x_status_t sx126x_init(sx126x_t *dev, sx126x_bus_t *bus, sx126x_config_t *c
   dev->chip = cfg->chip;
   dev->state = SX126X_STATE_INIT;
 
-  sx126x_status_t st;
-
-  SX126X_LOG_INFO(bus, "Setting RC standby mode...");
-  st = sx126x_set_standby(dev, SX126X_STBY_RC);
-  if (st != SX126X_OK)
+  if (sx126x_check_config(cfg) != SX126X_OK)
   {
-    SX126X_LOG_ERROR(bus, "Failed to set RC standby mode.");
-    return st;
+    SX126X_LOG_ERROR(bus, "Invalid modem configuration.");
+    return SX126X_ERR_INVALID_ARG;
   }
-  SX126X_LOG_INFO(bus, "RC standby mode has been set.");
 
-  SX126X_LOG_INFO(bus, "Setting packet type...");
-  st = sx126x_set_packet_type(dev, cfg->modem);
-  if (st != SX126X_OK)
-  {
-    SX126X_LOG_ERROR(bus, "Failed to set packet type.");
-    return st;
-  }
-  SX126X_LOG_INFO(bus, "Packet type has been set using modem %d.", cfg->modem);
+  sx126x_apply_frame_format(dev, cfg);
+
+  // Encode the whole sequence up front so that it can be handed to the bus in one submission.
+  sx126x_cmd_t cmds[SX126X_INIT_CMD_MAX];
+  size_t n = 0;
+  sx126x_status_t st;
 
-  SX126X_LOG_INFO(bus, "Setting RF frequency...");
-  st = sx126x_set_frequency(dev, cfg->frequency_hz);
+  st = sx126x_build_config_cmds(dev, cfg, cmds, &n);
   if (st != SX126X_OK)
   {
-    SX126X_LOG_ERROR(bus, "Failed to set RF frequency.");
+    SX126X_LOG_ERROR(bus, "Failed to build init sequence.");
     return st;
   }
-  SX126X_LOG_INFO(bus, "RF frequency set to %dhz.", cfg->frequency_hz);
 
-  SX126X_LOG_INFO(bus, "Setting PA profile...");
-  st = sx126x_set_pa_profile(dev, cfg->pa_profile);
+  SX126X_LOG_INFO(bus, "Submitting init sequence (%u commands)...", (unsigned)n);
+  st = sx126x_submit_cmds(dev, cmds, n);
   if (st != SX126X_OK)
   {
-    SX126X_LOG_ERROR(bus, "Failed to set PA profile.");
+    SX126X_LOG_ERROR(bus, "Failed to submit init sequence.");
     return st;
   }
-  SX126X_LOG_INFO(bus, "PA profile %d has been set.", cfg->pa_profile);
 
-  SX126X_LOG_INFO(bus, "Setting TX params...");
-  st = sx126x_set_tx_params(dev, cfg->power_dbm, cfg->power_ramp_time);
+  st = sx126x_finish_init(dev, cfg);
   if (st != SX126X_OK)
   {
-    SX126X_LOG_ERROR(bus, "Failed to set TX params.");
     return st;
   }
-  SX126X_LOG_INFO(bus, "TX params set.");
 
-  if (cfg->modem == SX126X_MODEM_LORA)
-  {
-    SX126X_LOG_INFO(bus, "Setting LoRa modulation params...");
-    st = sx126x_set_lora_modulation_params(
-        dev, cfg->lora_sf, cfg->lora_bw, cfg->lora_cr, cfg->lora_ldro);
-    if (st != SX126X_OK)
-    {
-      SX126X_LOG_ERROR(bus, "Failed to set LoRa modulation params.");
-      return st;
-    }
-    SX126X_LOG_INFO(bus, "LoRa modulation params set.");
-  }
+  if (cfg->modem == SX126X_MODEM_FSK)
+    SX126X_LOG_INFO(bus,
+               "SX126x init complete: chip=%d, freq=%lu Hz, PA=%d, pwr=%ddBm, pwr_ramp_time=%d, "
+               "GFSK br=%lu bps, fdev=%lu Hz, shaping=%d, bw=%d.",
+               dev->chip,
+               cfg->frequency_hz,
+               cfg->pa_profile,
+               cfg->power_dbm,
+               cfg->power_ramp_time,
+               cfg->gfsk_bitrate_bps,
+               cfg->gfsk_fdev_hz,
+               cfg->gfsk_shaping,
+               cfg->gfsk_bw);
   else
-  {
-    // !NOTE: Only the LoRa modem is supported at this time.
-    SX126X_LOG_ERROR(bus, "Only the LoRa modem is supported at this time.");
-    return SX126X_ERR_INVALID_ARG;
-  }
-
-  dev->is_initialized = true;
-
-  SX126X_LOG_INFO(bus,
-             "SX126x init complete: chip=%d, freq=%lu Hz, PA=%d, pwr=%ddBm, pwr_ramp_time=%d, "
-             "sf=%d, bw=%d, cr=%d, ldro=%d.",
-             dev->chip,
-             cfg->frequency_hz,
-             cfg->pa_profile,
-             cfg->power_dbm,
-             cfg->power_ramp_time,
-             cfg->lora_sf,
-             cfg->lora_bw,
-             cfg->lora_cr,
-             cfg->lora_ldro);
+    SX126X_LOG_INFO(bus,
+               "SX126x init complete: chip=%d, freq=%lu Hz, PA=%d, pwr=%ddBm, pwr_ramp_time=%d, "
+               "sf=%d, bw=%d, cr=%d, ldro=%d.",
+               dev->chip,
+               cfg->frequency_hz,
+               cfg->pa_profile,
+               cfg->power_dbm,
+               cfg->power_ramp_time,
+               cfg->lora_sf,
+               cfg->lora_bw,
+               cfg->lora_cr,
+               sx126x_lora_ldro_enabled(cfg));
 
   dev->state = SX126X_STATE_STANDBY;
 
@@ -197,6 +332,22 @@ sx126x_status_t sx126x_init(sx126x_t *dev, sx126x_bus_t *bus, sx126x_config_t *c
 
 // Deinitialize the given radio instance
 sx126x_status_t sx126x_deinit(sx126x_t *dev)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_deinit_locked(dev);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_deinit_locked(sx126x_t *dev)
 {
   if (!dev)
   {
@@ -210,6 +361,9 @@ sx126x_status_t sx126x_deinit(sx126x_t *dev)
     // Attempt to put the chip in RC standby (lowest power safe state)
     if (dev->bus)
     {
+      if (dev->bus->attach_dio1)
+        dev->bus->attach_dio1(dev->bus, NULL, NULL);
+
       sx126x_status_t st = sx126x_set_standby(dev, SX126X_STBY_RC);
       if (st != SX126X_OK)
       {
@@ -225,245 +379,3005 @@ sx126x_status_t sx126x_deinit(sx126x_t *dev)
   return SX126X_OK;
 }
 
-// Transmit a message using the configured sx126x_t
-sx126x_status_t sx126x_transmit(sx126x_t *dev, const uint8_t *tx_buffer, size_t tx_len)
+// Initialize the given radio instance from a pre-encoded init image
+sx126x_status_t
+sx126x_init_from_image(sx126x_t *dev, sx126x_bus_t *bus, const sx126x_init_image_t *image)
 {
-  if (!dev)
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_init_from_image_locked(dev, bus, image);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_init_from_image_locked(sx126x_t *dev,
+                                                     sx126x_bus_t *bus,
+                                                     const sx126x_init_image_t *image)
+{
+  if (!dev || !bus || !image || !image->data)
   {
     return SX126X_ERR_INVALID_ARG;
   }
 
-  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  if (dev->is_initialized || !bus->transfer)
   {
-    return SX126X_ERR_NOT_INIT;
+    return SX126X_ERR_INVALID_ARG;
   }
 
+  memset(dev, 0, sizeof(*dev));
+  dev->bus = bus;
+  dev->chip = image->config.chip;
+  dev->state = SX126X_STATE_INIT;
+
+  sx126x_apply_frame_format(dev, &image->config);
+
+  // Point the bus frames straight into the image; nothing is copied.
+  sx126x_bus_frame_t frames[SX126X_BATCH_MAX_FRAMES];
+  size_t n = 0;
+  size_t off = 0;
   sx126x_status_t st;
 
-  SX126X_LOG_INFO(dev->bus, "Starting transmit sequence...");
+  while (off < image->len)
+  {
+    size_t len = image->data[off++];
+    if (len == 0 || len > image->len - off)
+    {
+      SX126X_LOG_ERROR(bus, "Malformed init image at offset %u.", (unsigned)(off - 1));
+      return SX126X_ERR_INVALID_ARG;
+    }
+
+    frames[n++] = (sx126x_bus_frame_t){.tx = &image->data[off], .tx_len = len};
+    off += len;
 
-  st = sx126x_set_standby(dev, SX126X_STBY_RC);
+    if (n == SX126X_BATCH_MAX_FRAMES || off == image->len)
+    {
+      st = sx126x_submit_frames(dev, frames, n);
+      if (st != SX126X_OK)
+      {
+        SX126X_LOG_ERROR(bus, "Failed to submit init image.");
+        return st;
+      }
+      n = 0;
+    }
+  }
+
+  st = sx126x_finish_init(dev, &image->config);
   if (st != SX126X_OK)
   {
-    SX126X_LOG_ERROR(dev->bus, "Failed to set STDBY_RC mode.");
-    return SX126X_ERR_UNKNOWN;
+    return st;
   }
 
-  // TODO
+  SX126X_LOG_INFO(bus, "SX126x init from image complete (%u bytes).", (unsigned)image->len);
 
-  // 1. [ ] Switch to STDBY_RC mode
-  // 2. [ ] Define where the payload is stored with `SetBufferBaseAddress()`
-  // 3. [ ] Send the payload to the data buffer with `WriteBuffer()`
-  // 4. [ ] Define the frame format to be used with `SetPacketParams()`
-  // 5. [ ] Configure DIO and IRQ with `SetDioIrqParams()`, select TxDone map IRQ to a DIO
-  // 6. [ ] Define sync word value with `WriteReg()`
-  // 7. [ ] Set the device to transmitter mode to start the transmission with `SetTx()`; use the
-  // parameter to enable Timeout
-  // 8. [ ] Wait for TxDone or Timeout; once the packet has been sent the chip automatically goes to
-  // STDBY_RC mode
-  // 9. [ ] Clear the IRQ TxDone/Timeout flag
-
-  SX126X_LOG_INFO(dev->bus, "Transmit sequence complete.");
+  dev->state = SX126X_STATE_STANDBY;
 
   return SX126X_OK;
 }
 
-static sx126x_status_t sx126x_set_standby(sx126x_t *dev, sx126x_standby_mode_t mode)
+// Apply a new configuration, sending only the commands whose parameters changed
+sx126x_status_t sx126x_reconfigure(sx126x_t *dev, const sx126x_config_t *cfg)
 {
-  if (!dev || !dev->bus || !dev->bus->transfer)
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
   {
-    return SX126X_ERR_INVALID_ARG;
+    return st;
   }
 
-  uint8_t tx[] = {SX126X_OP_SET_STANDBY, mode};
-  return dev->bus->transfer(dev->bus, tx, sizeof(tx), NULL, 0);
+  st = sx126x_reconfigure_locked(dev, cfg);
+  sx126x_bus_unlock(bus);
+
+  return st;
 }
 
-static sx126x_status_t sx126x_set_packet_type(sx126x_t *dev, sx126x_modem_t modem)
+static sx126x_status_t sx126x_reconfigure_locked(sx126x_t *dev, const sx126x_config_t *cfg)
 {
-  if (!dev || !dev->bus || !dev->bus->transfer)
+  if (!dev || !cfg)
   {
     return SX126X_ERR_INVALID_ARG;
   }
 
-  sx126x_packet_type_t pkt_type;
-  if (modem == SX126X_MODEM_LORA)
-    pkt_type = SX126X_PACKET_TYPE_LORA;
-  else
-    pkt_type = SX126X_PACKET_TYPE_GFSK;
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
 
-  uint8_t tx[] = {SX126X_OP_SET_PACKET_TYPE, pkt_type};
-  return dev->bus->transfer(dev->bus, tx, sizeof(tx), NULL, 0);
-}
+  if (dev->state != SX126X_STATE_STANDBY)
+  {
+    return SX126X_ERR_BUSY;
+  }
 
-static sx126x_status_t sx126x_set_frequency(sx126x_t *dev, uint32_t hz)
-{
-  if (!dev || !dev->bus || !dev->bus->transfer)
+  if (sx126x_check_config(cfg) != SX126X_OK)
   {
+    SX126X_LOG_ERROR(dev->bus, "Invalid modem configuration.");
     return SX126X_ERR_INVALID_ARG;
   }
 
-  uint32_t frequency = (uint32_t)(((uint64_t)hz << 25) / SX126X_FREQ_XTAL_HZ);
-  uint8_t tx[] = {
-      SX126X_OP_SET_RF_FREQUENCY,
-      (frequency >> 24) & 0xFF,
-      (frequency >> 16) & 0xFF,
-      (frequency >> 8) & 0xFF,
-      frequency & 0xFF,
-  };
-  return dev->bus->transfer(dev->bus, tx, sizeof(tx), NULL, 0);
+  sx126x_cmd_t cmds[SX126X_INIT_CMD_MAX];
+  size_t full = 0;
+  size_t n = 0;
+  sx126x_status_t st;
+
+  sx126x_chip_variant_t prev_chip = dev->chip;
+  dev->chip = cfg->chip;
+
+  // What a full resync would cost; this is the baseline for the skipped count.
+  st = sx126x_build_config_cmds(dev, cfg, cmds, &full);
+  if (st != SX126X_OK)
+  {
+    dev->chip = prev_chip;
+    return st;
+  }
+
+  const sx126x_config_t *old = &dev->shadow;
+  bool resync = !dev->shadow_valid || dev->modem_stale || old->modem != cfg->modem;
+
+  if (resync)
+  {
+    // Unknown chip state, a packet type change (which resets the modem parameters), or the packet
+    // type of an LR-FHSS transmission left behind.
+    n = full;
+    dev->reconfig_stats.resyncs++;
+  }
+  else
+  {
+    bool pa_changed = old->chip != cfg->chip || old->pa_profile != cfg->pa_profile;
+
+    if (old->frequency_hz != cfg->frequency_hz)
+      sx126x_encode_frequency(&cmds[n++], cfg->frequency_hz);
+
+    if (old->fallback_mode != cfg->fallback_mode)
+      sx126x_encode_fallback_mode(&cmds[n++], cfg->fallback_mode);
+
+    if (pa_changed)
+    {
+      st = sx126x_encode_pa_profile(dev, &cmds[n++], cfg->pa_profile);
+      if (st != SX126X_OK)
+      {
+        dev->chip = prev_chip;
+        return st;
+      }
+    }
+
+    // SetTxParams must follow SetPaConfig, so it is resent whenever the PA changes.
+    if (pa_changed || old->power_dbm != cfg->power_dbm ||
+        old->power_ramp_time != cfg->power_ramp_time)
+      sx126x_encode_tx_params(&cmds[n++], cfg->power_dbm, cfg->power_ramp_time);
+
+    if (cfg->modem == SX126X_MODEM_FSK)
+    {
+      if (old->gfsk_bitrate_bps != cfg->gfsk_bitrate_bps ||
+          old->gfsk_fdev_hz != cfg->gfsk_fdev_hz || old->gfsk_shaping != cfg->gfsk_shaping ||
+          old->gfsk_bw != cfg->gfsk_bw)
+        sx126x_encode_gfsk_modulation_params(&cmds[n++], cfg);
+
+      // A zero length disables sync word matching through the packet params alone.
+      if (cfg->gfsk_sync_word_len && sx126x_gfsk_sync_word_changed(old, cfg))
+        sx126x_encode_gfsk_sync_word(&cmds[n++], cfg->gfsk_sync_word, cfg->gfsk_sync_word_len);
+    }
+    else
+    {
+      bool ldro = sx126x_lora_ldro_enabled(cfg);
+      if (old->lora_sf != cfg->lora_sf || old->lora_bw != cfg->lora_bw ||
+          old->lora_cr != cfg->lora_cr || sx126x_lora_ldro_enabled(old) != ldro)
+        sx126x_encode_lora_modulation_params(
+            &cmds[n++], cfg->lora_sf, cfg->lora_bw, cfg->lora_cr, ldro);
+
+      if (old->lora_sync_word != cfg->lora_sync_word)
+        sx126x_encode_lora_sync_word(
+            &cmds[n++],
+            cfg->lora_sync_word ? cfg->lora_sync_word : SX126X_LORA_SYNC_WORD_DEFAULT);
+
+      if (old->lora_invert_iq != cfg->lora_invert_iq)
+        sx126x_encode_iq_polarity(&cmds[n++], cfg->lora_invert_iq);
+    }
+  }
+
+  if (n > 0)
+  {
+    st = sx126x_submit_cmds(dev, cmds, n);
+    if (st != SX126X_OK)
+    {
+      // The chip is now in an unknown mix of old and new settings.
+      SX126X_LOG_ERROR(dev->bus, "Failed to apply new configuration, forcing resync.");
+      dev->chip = prev_chip;
+      dev->shadow_valid = false;
+      return st;
+    }
+  }
+
+  // A full resync puts both buffer bases back to 0 and the configured packet type in place.
+  if (resync)
+  {
+    dev->tx_base = 0x00;
+    dev->modem_stale = false;
+  }
+
+  // Apart from the IQ polarity register, frame format is applied per TX/RX, so it only needs
+  // updating on the host side.
+  sx126x_apply_frame_format(dev, cfg);
+  dev->pa_profile = cfg->pa_profile;
+  dev->shadow = *cfg;
+  dev->shadow_valid = true;
+
+  dev->reconfig_stats.sent += n;
+  dev->reconfig_stats.skipped += full - n;
+
+  SX126X_LOG_DEBUG(dev->bus, "Reconfigured with %u of %u commands.", (unsigned)n, (unsigned)full);
+
+  return SX126X_OK;
 }
 
-static sx126x_status_t sx126x_set_pa_profile(sx126x_t *dev, sx126x_pa_profile_t profile)
+// Decode the cached status byte
+sx126x_status_t sx126x_get_cached_status(const sx126x_t *dev,
+                                         sx126x_chip_mode_t *mode,
+                                         sx126x_cmd_status_t *cmd_status)
 {
-  if (!dev || !dev->bus || !dev->bus->transfer)
+  if (!dev)
   {
     return SX126X_ERR_INVALID_ARG;
   }
 
-  sx126x_pa_config_t cfg;
-  sx126x_status_t st;
+  if (!dev->is_initialized)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (mode)
+    *mode = SX126X_STATUS_CHIP_MODE(dev->status);
+  if (cmd_status)
+    *cmd_status = SX126X_STATUS_CMD_STATUS(dev->status);
+
+  return SX126X_OK;
+}
+
+// Put the chip to sleep, warm or cold
+sx126x_status_t sx126x_sleep(sx126x_t *dev, bool warm)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
 
-  st = sx126x_get_pa_configuration(dev, profile, &cfg);
+  sx126x_status_t st = sx126x_bus_lock(bus);
   if (st != SX126X_OK)
   {
     return st;
   }
 
-  uint8_t tx[] = {
-      SX126X_OP_SET_PA_CONFIG,
-      cfg.pa_duty_cycle,
-      cfg.hp_max,
-      cfg.chip,
-      cfg.pa_lut,
-  };
-
-  st = dev->bus->transfer(dev->bus, tx, sizeof(tx), NULL, 0);
-  if (st == SX126X_OK)
-    dev->pa_profile = profile;
+  st = sx126x_sleep_locked(dev, warm);
+  sx126x_bus_unlock(bus);
 
   return st;
 }
 
-static sx126x_status_t
-sx126x_get_pa_configuration(sx126x_t *dev, sx126x_pa_profile_t profile, sx126x_pa_config_t *cfg)
+static sx126x_status_t sx126x_sleep_locked(sx126x_t *dev, bool warm)
 {
   if (!dev)
+  {
     return SX126X_ERR_INVALID_ARG;
+  }
 
-  switch (dev->chip)
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
   {
-  case SX126X_CHIP_SX1261:
-    // SX1261 supports only low power (14 dBm)
-    cfg->pa_duty_cycle = 0x04;
-    cfg->hp_max = 0x00;
-    cfg->chip = 0x01;
-    cfg->pa_lut = 0x01;
+    return SX126X_ERR_NOT_INIT;
+  }
 
-    // Force low power regardless of user selection
-    if (profile != SX126X_PA_LOW_POWER && dev->bus && dev->bus->log)
-      dev->bus->log("Warning: SX1261 only supports LOW_POWER. Overriding user profile.");
-    break;
+  if (dev->state != SX126X_STATE_STANDBY)
+  {
+    return SX126X_ERR_BUSY;
+  }
 
-  case SX126X_CHIP_SX1262:
-    switch (profile)
-    {
-    case SX126X_PA_LOW_POWER:
-      // ~14 dBm configuration
-      cfg->pa_duty_cycle = 0x04;
-      cfg->hp_max = 0x00;
-      cfg->chip = 0x00;
-      cfg->pa_lut = 0x01;
-      break;
-
-    case SX126X_PA_MEDIUM_POWER:
-      // ~17 dBm configuration
-      cfg->pa_duty_cycle = 0x06;
-      cfg->hp_max = 0x03;
-      cfg->chip = 0x00;
-      cfg->pa_lut = 0x01;
-      break;
-
-    case SX126X_PA_HIGH_POWER:
-      // +20 dBm configuration (safe max for SX1262)
-      cfg->pa_duty_cycle = 0x07;
-      cfg->hp_max = 0x05;
-      cfg->chip = 0x00;
-      cfg->pa_lut = 0x01;
-      break;
-    }
-    break;
+  sx126x_cmd_t cmd;
+  sx126x_encode_sleep(&cmd, warm);
 
-  default:
-    // Unknown chip: safest possible configuration
-    cfg->pa_duty_cycle = 0x04;
-    cfg->hp_max = 0x00;
-    cfg->chip = 0x00;
-    cfg->pa_lut = 0x01;
-    if (dev->bus && dev->bus->log)
-      dev->bus->log("Unknown SX126x chip — using default low power PA config.");
-    break;
+  // SX126X_ERR_CMD reports the command before SetSleep, which has still gone out.
+  sx126x_status_t st = sx126x_write_cmd(dev, &cmd);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    return st;
   }
 
+  dev->is_warm_sleep = warm;
+  __atomic_store_n(&dev->state, SX126X_STATE_SLEEP, __ATOMIC_SEQ_CST);
+
+  SX126X_LOG_DEBUG(dev->bus, "Entered %s sleep.", warm ? "warm" : "cold");
+
   return SX126X_OK;
 }
 
-static sx126x_status_t
-sx126x_set_tx_params(sx126x_t *dev, int pwr, sx126x_power_ramp_time_t ramp_time)
+// Wake the chip and restore its configuration
+sx126x_status_t sx126x_wake(sx126x_t *dev)
 {
-  if (!dev || !dev->bus || !dev->bus->transfer)
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
   {
-    return SX126X_ERR_INVALID_ARG;
+    return st;
   }
 
-  uint8_t tx[] = {
-      SX126X_OP_SET_TX_PARAMS,
-      pwr,
-      ramp_time,
-  };
+  st = sx126x_wake_locked(dev);
+  sx126x_bus_unlock(bus);
 
-  return dev->bus->transfer(dev->bus, tx, sizeof(tx), NULL, 0);
+  return st;
 }
 
-static sx126x_status_t sx126x_set_lora_modulation_params(sx126x_t *dev,
-                                                         sx126x_lora_spreading_factor_t sf,
-                                                         sx126x_lora_bandwidth_t bw,
-                                                         sx126x_lora_coding_rate_t cr,
-                                                         bool ldro)
+static sx126x_status_t sx126x_wake_locked(sx126x_t *dev)
 {
-  if (!dev || !dev->bus || !dev->bus->transfer)
+  if (!dev)
   {
     return SX126X_ERR_INVALID_ARG;
   }
 
-  uint8_t tx[] = {SX126X_OP_SET_MODULATION_PARAMS, sf, bw, cr, (uint8_t)(ldro ? 0x01 : 0x00)};
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
 
-  return dev->bus->transfer(dev->bus, tx, sizeof(tx), NULL, 0);
-}
+  if (dev->state != SX126X_STATE_SLEEP)
+  {
+    return SX126X_OK;
+  }
 
-static sx126x_status_t sx126x_set_dio_irq_params(
-    sx126x_t *dev, uint16_t irq_mask, uint16_t dio1_mask, uint16_t dio2_mask, uint16_t dio3_mask)
-{
-  if (!dev || !dev->bus || !dev->bus->transfer)
+  sx126x_cmd_t cmds[SX126X_INIT_CMD_MAX];
+  size_t n = 0;
+
+  // The wake frame goes out on its own: the commands after it must wait until the chip has come
+  // up, which the HAL does before their first frame.
+  sx126x_status_t st = sx126x_bus_wake(dev);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
   {
-    return SX126X_ERR_INVALID_ARG;
+    SX126X_LOG_ERROR(dev->bus, "Failed to wake the chip.");
+    return st;
+  }
+
+  // The chip comes back in RC standby either way. After a warm sleep only the registers it does
+  // not retain are rewritten, unless the shadow is not trusted; a cold sleep lost everything.
+  bool warm = dev->is_warm_sleep && dev->shadow_valid;
+  if (warm)
+  {
+    n += sx126x_build_retention_cmds(dev, &cmds[n]);
+  }
+  else
+  {
+    size_t count = 0;
+    st = sx126x_build_config_cmds(dev, &dev->shadow, &cmds[n], &count);
+    if (st != SX126X_OK)
+    {
+      return st;
+    }
+    n += count;
+  }
+
+  st = sx126x_submit_cmds(dev, cmds, n);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    // Whether the chip is configured is unknown; stay asleep so the wake can be retried.
+    SX126X_LOG_ERROR(dev->bus, "Failed to restore the configuration after waking.");
+    return st;
   }
 
-  uint8_t tx[] = {
-      SX126X_OP_SET_DIO_IRQ_PARAMS,
+  if (!warm)
+  {
+    dev->tx_base = 0x00;
+    dev->lora_symb_timeout = 0;
+    dev->modem_stale = false;
+  }
+  dev->is_warm_sleep = false;
+  __atomic_store_n(&dev->state, SX126X_STATE_STANDBY, __ATOMIC_SEQ_CST);
 
-      (irq_mask >> 8) & 0xFF,
-      irq_mask & 0xFF,
+  // The chip is back at the shadow. After a command error it stays untrusted, so the next
+  // reconfigure resends everything.
+  if (st == SX126X_OK)
+    dev->shadow_valid = true;
 
-      (dio1_mask >> 8) & 0xFF,
-      dio1_mask & 0xFF,
+  SX126X_LOG_DEBUG(dev->bus,
+                   "Woke from %s sleep with %u commands.",
+                   warm ? "warm" : "cold",
+                   (unsigned)n);
 
-      (dio2_mask >> 8) & 0xFF,
-      dio2_mask & 0xFF,
+  return st;
+}
 
-      (dio3_mask >> 8) & 0xFF,
-      dio3_mask & 0xFF,
-  };
+#if SX126X_ENABLE_STATS
+// Copy out the bus statistics
+sx126x_status_t sx126x_get_stats(const sx126x_t *dev, sx126x_stats_t *out)
+{
+  if (!dev || !out)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  *out = dev->stats;
+
+  return SX126X_OK;
+}
 
-  return dev->bus->transfer(dev->bus, tx, sizeof(tx), NULL, 0);
-}
\ No newline at end of file
+// Clear the bus statistics
+sx126x_status_t sx126x_reset_stats(sx126x_t *dev)
+{
+  if (!dev)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  memset(&dev->stats, 0, sizeof(dev->stats));
+
+  return SX126X_OK;
+}
+#endif
+
+// Select the channel plan used by sx126x_set_channel
+sx126x_status_t sx126x_set_channel_plan(sx126x_t *dev, const sx126x_channel_plan_t *plan)
+{
+  if (!dev)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (plan && (!plan->channels || plan->count == 0))
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  dev->channel_plan = plan;
+
+  return SX126X_OK;
+}
+
+// Tune to a channel of the current plan without converting its frequency
+sx126x_status_t sx126x_set_channel(sx126x_t *dev, uint16_t index)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_set_channel_locked(dev, index);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_set_channel_locked(sx126x_t *dev, uint16_t index)
+{
+  if (!dev)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (!dev->channel_plan || index >= dev->channel_plan->count)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (dev->state != SX126X_STATE_STANDBY)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  const sx126x_channel_t *ch = &dev->channel_plan->channels[index];
+
+  sx126x_status_t st = sx126x_bus_xfer(dev, ch->frame, sizeof(ch->frame), NULL, 0);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  // Keep the shadow in step so a later sx126x_reconfigure does not resend the frequency.
+  dev->shadow.frequency_hz = ch->hz;
+
+  return SX126X_OK;
+}
+
+// Start an interrupt-driven transmission on the configured sx126x_t
+sx126x_status_t sx126x_transmit_async(sx126x_t *dev,
+                                      const uint8_t *tx_buffer,
+                                      size_t tx_len,
+                                      uint32_t timeout_ms,
+                                      sx126x_tx_done_cb_t cb,
+                                      void *arg)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_transmit_async_locked(dev, tx_buffer, tx_len, timeout_ms, cb, arg);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_transmit_async_locked(sx126x_t *dev,
+                                                    const uint8_t *tx_buffer,
+                                                    size_t tx_len,
+                                                    uint32_t timeout_ms,
+                                                    sx126x_tx_done_cb_t cb,
+                                                    void *arg)
+{
+  if (!dev || !tx_buffer || tx_len == 0 || tx_len > SX126X_MAX_PAYLOAD_LEN)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (dev->state != SX126X_STATE_STANDBY)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  uint32_t timeout_ticks = sx126x_timeout_ticks(timeout_ms);
+
+  // A full-size packet needs the whole buffer, so the TX base goes back to 0 if the TX queue
+  // moved it.
+  dev->tx_queued = false;
+  sx126x_status_t st =
+      sx126x_start_tx(dev, false, 0x00, tx_buffer, (uint8_t)tx_len, timeout_ticks, cb, arg);
+  if (st != SX126X_OK)
+  {
+    SX126X_LOG_ERROR(dev->bus, "Failed to start transmission.");
+    return st;
+  }
+
+  return SX126X_OK;
+}
+
+// Queue a packet for a back-to-back burst, uploading it while the previous one is on air
+sx126x_status_t sx126x_tx_queue_push(sx126x_t *dev,
+                                     const uint8_t *tx_buffer,
+                                     size_t tx_len,
+                                     uint32_t timeout_ms,
+                                     sx126x_tx_done_cb_t cb,
+                                     void *arg)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_tx_queue_push_locked(dev, tx_buffer, tx_len, timeout_ms, cb, arg);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_tx_queue_push_locked(sx126x_t *dev,
+                                                   const uint8_t *tx_buffer,
+                                                   size_t tx_len,
+                                                   uint32_t timeout_ms,
+                                                   sx126x_tx_done_cb_t cb,
+                                                   void *arg)
+{
+  if (!dev || !tx_buffer || tx_len == 0 || tx_len > SX126X_TX_QUEUE_MAX_LEN)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  uint32_t timeout_ticks = sx126x_timeout_ticks(timeout_ms);
+  sx126x_status_t st;
+
+  if (__atomic_load_n(&dev->state, __ATOMIC_SEQ_CST) == SX126X_STATE_STANDBY)
+  {
+    // Nothing on air: start straight away from the half currently programmed.
+    dev->tx_queued = true;
+    return sx126x_start_tx(
+        dev, false, dev->tx_base, tx_buffer, (uint8_t)tx_len, timeout_ticks, cb, arg);
+  }
+
+  // Only a packet started by this queue is known to leave the other half free.
+  if (dev->state != SX126X_STATE_TX || !dev->tx_queued || dev->tx_next_staged)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  uint8_t base = dev->tx_base ^ SX126X_TX_QUEUE_MAX_LEN;
+  uint8_t write_cmd[] = {SX126X_OP_WRITE_BUFFER, base};
+  sx126x_bus_frame_t frame = {
+      .tx = write_cmd, .tx_len = sizeof(write_cmd), .data_tx = tx_buffer, .data_len = tx_len};
+
+  st = sx126x_submit_frames(dev, &frame, 1);
+  if (st == SX126X_ERR_CMD && dev->error_opcode == SX126X_OP_SET_TX)
+  {
+    // The packet on air never started; end it so the caller can restart the burst.
+    sx126x_complete_tx(dev, st);
+    return st;
+  }
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    return st;
+  }
+
+  dev->tx_next_base = base;
+  dev->tx_next_len = (uint8_t)tx_len;
+  dev->tx_next_ticks = timeout_ticks;
+  dev->tx_next_cb = cb;
+  dev->tx_next_arg = arg;
+  __atomic_store_n(&dev->tx_next_staged, true, __ATOMIC_SEQ_CST);
+
+  // If TxDone was handled while the payload was uploading, nobody else will start it.
+  if (__atomic_load_n(&dev->state, __ATOMIC_SEQ_CST) != SX126X_STATE_TX)
+    sx126x_tx_queue_kick(dev);
+
+  return SX126X_OK;
+}
+
+// Transmit only if a CAD finds the channel clear, chained on the chip
+sx126x_status_t sx126x_transmit_lbt(sx126x_t *dev,
+                                    const uint8_t *tx_buffer,
+                                    size_t tx_len,
+                                    uint32_t timeout_ms,
+                                    sx126x_tx_done_cb_t cb,
+                                    void *arg)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_transmit_lbt_locked(dev, tx_buffer, tx_len, timeout_ms, cb, arg);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_transmit_lbt_locked(sx126x_t *dev,
+                                                  const uint8_t *tx_buffer,
+                                                  size_t tx_len,
+                                                  uint32_t timeout_ms,
+                                                  sx126x_tx_done_cb_t cb,
+                                                  void *arg)
+{
+  if (!dev || !tx_buffer || tx_len == 0 || tx_len > SX126X_MAX_PAYLOAD_LEN)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (dev->modem != SX126X_MODEM_LORA)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (dev->state != SX126X_STATE_STANDBY)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  dev->tx_queued = false;
+  sx126x_status_t st = sx126x_start_tx(
+      dev, true, 0x00, tx_buffer, (uint8_t)tx_len, sx126x_timeout_ticks(timeout_ms), cb, arg);
+  if (st != SX126X_OK)
+  {
+    SX126X_LOG_ERROR(dev->bus, "Failed to start listen-before-talk transmission.");
+    return st;
+  }
+
+  return SX126X_OK;
+}
+
+// Packet type and modulation of an LR-FHSS transmission, sent ahead of it.
+static const uint8_t sx126x_lr_fhss_type_cmd[] = {SX126X_OP_SET_PACKET_TYPE,
+                                                  SX126X_PACKET_TYPE_LR_FHSS};
+static const uint8_t sx126x_lr_fhss_mod_cmd[] = {SX126X_OP_SET_MODULATION_PARAMS,
+                                                 (SX126X_LR_FHSS_BITRATE >> 24) & 0xFF,
+                                                 (SX126X_LR_FHSS_BITRATE >> 16) & 0xFF,
+                                                 (SX126X_LR_FHSS_BITRATE >> 8) & 0xFF,
+                                                 SX126X_LR_FHSS_BITRATE & 0xFF,
+                                                 SX126X_LR_FHSS_SHAPING};
+
+// Transmit an LR-FHSS packet from a pre-encoded hop table
+sx126x_status_t sx126x_transmit_lr_fhss(sx126x_t *dev,
+                                        const sx126x_lr_fhss_table_t *table,
+                                        const uint8_t *payload,
+                                        size_t len,
+                                        uint32_t timeout_ms,
+                                        sx126x_tx_done_cb_t cb,
+                                        void *arg)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_transmit_lr_fhss_locked(dev, table, payload, len, timeout_ms, cb, arg);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_transmit_lr_fhss_locked(sx126x_t *dev,
+                                                      const sx126x_lr_fhss_table_t *table,
+                                                      const uint8_t *payload,
+                                                      size_t len,
+                                                      uint32_t timeout_ms,
+                                                      sx126x_tx_done_cb_t cb,
+                                                      void *arg)
+{
+  if (!dev || !table || !table->hops || table->count == 0 ||
+      table->count > SX126X_LR_FHSS_MAX_HOPS || !payload || len == 0 ||
+      len > SX126X_MAX_PAYLOAD_LEN)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (dev->state != SX126X_STATE_STANDBY)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  uint16_t preload =
+      table->count < SX126X_LR_FHSS_HOP_SLOTS ? table->count : SX126X_LR_FHSS_HOP_SLOTS;
+  sx126x_bus_frame_t frames[5 + SX126X_LR_FHSS_HOP_SLOTS + 1];
+  size_t n = 0;
+
+  sx126x_cmd_t base_cmd;
+  sx126x_cmd_t tx_cmd;
+  uint8_t write_cmd[] = {SX126X_OP_WRITE_BUFFER, 0x00};
+  uint8_t ctrl_cmd[] = {SX126X_OP_WRITE_REGISTER,
+                        (SX126X_REG_LR_FHSS_CTRL >> 8) & 0xFF,
+                        SX126X_REG_LR_FHSS_CTRL & 0xFF,
+                        SX126X_LR_FHSS_CTRL_HOPPING,
+                        (uint8_t)len,
+                        (uint8_t)table->count};
+
+  frames[n++] = (sx126x_bus_frame_t){
+      .tx = sx126x_lr_fhss_type_cmd, .tx_len = sizeof(sx126x_lr_fhss_type_cmd)};
+  frames[n++] = (sx126x_bus_frame_t){
+      .tx = sx126x_lr_fhss_mod_cmd, .tx_len = sizeof(sx126x_lr_fhss_mod_cmd)};
+  if (dev->tx_base != 0x00)
+  {
+    sx126x_encode_buffer_base_address(&base_cmd, 0x00, 0x00);
+    frames[n++] = (sx126x_bus_frame_t){.tx = base_cmd.buf, .tx_len = base_cmd.len};
+  }
+  frames[n++] = (sx126x_bus_frame_t){
+      .tx = write_cmd, .tx_len = sizeof(write_cmd), .data_tx = payload, .data_len = len};
+  frames[n++] = (sx126x_bus_frame_t){.tx = ctrl_cmd, .tx_len = sizeof(ctrl_cmd)};
+  for (uint16_t i = 0; i < preload; i++)
+  {
+    frames[n++] = (sx126x_bus_frame_t){.tx = table->hops[i].frame,
+                                       .tx_len = SX126X_LR_FHSS_HOP_FRAME_LEN};
+  }
+  sx126x_encode_tx(&tx_cmd, sx126x_timeout_ticks(timeout_ms));
+  frames[n++] = (sx126x_bus_frame_t){.tx = tx_cmd.buf, .tx_len = tx_cmd.len};
+
+  // Arm the hop path before SetTx goes out; the first hop IRQ may follow it closely.
+  dev->tx_queued = false;
+  dev->lr_fhss_next = &table->hops[preload];
+  dev->lr_fhss_end = &table->hops[table->count];
+  dev->tx_cb = cb;
+  dev->tx_cb_arg = arg;
+  dev->modem_stale = true;
+  __atomic_store_n(&dev->state, SX126X_STATE_TX, __ATOMIC_SEQ_CST);
+
+  // A full hop table does not fit in one batch; the rest, ending with SetTx, follows in a second.
+  // Command errors are handled as in sx126x_start_tx.
+  for (size_t i = 0; i < n; i += SX126X_BATCH_MAX_FRAMES)
+  {
+    size_t count = n - i < SX126X_BATCH_MAX_FRAMES ? n - i : SX126X_BATCH_MAX_FRAMES;
+    sx126x_status_t st = sx126x_submit_frames(dev, &frames[i], count);
+    if (st != SX126X_OK && st != SX126X_ERR_CMD)
+    {
+      SX126X_LOG_ERROR(dev->bus, "Failed to start LR-FHSS transmission.");
+      dev->tx_cb = NULL;
+      dev->tx_cb_arg = NULL;
+      dev->lr_fhss_next = NULL;
+      dev->lr_fhss_end = NULL;
+      __atomic_store_n(&dev->state, SX126X_STATE_STANDBY, __ATOMIC_SEQ_CST);
+
+      // The packet type may already be LR-FHSS. If it cannot be put back now, the next
+      // operation does it first.
+      if (sx126x_sync_modem(dev) != SX126X_OK)
+        SX126X_LOG_WARN(dev->bus, "Failed to restore the modem after LR-FHSS.");
+      return st;
+    }
+  }
+
+  dev->tx_base = 0x00;
+
+  return SX126X_OK;
+}
+
+// Completion of a blocking transmit. The outcome is kept in dev, so a TX that ends after
+// sx126x_transmit has given up on it writes nothing the caller has released.
+static void sx126x_transmit_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  (void)arg;
+  dev->transmit_result = result;
+  __atomic_store_n(&dev->transmit_done, true, __ATOMIC_SEQ_CST);
+}
+
+// Give up on a blocking transmit that has not ended, completing it with result. If the bus lock
+// cannot be had, the TX is left to end by itself.
+static void sx126x_transmit_abort(sx126x_t *dev, sx126x_status_t result)
+{
+  if (sx126x_bus_lock(dev->bus) != SX126X_OK)
+    return;
+
+  if (dev->state == SX126X_STATE_TX && !dev->transmit_done)
+  {
+    sx126x_set_standby(dev, SX126X_STBY_RC);
+    sx126x_complete_tx(dev, result);
+  }
+  sx126x_bus_unlock(dev->bus);
+}
+
+// Transmit a message using the configured sx126x_t and wait for it to finish
+sx126x_status_t sx126x_transmit(sx126x_t *dev, const uint8_t *tx_buffer, size_t tx_len)
+{
+  if (!dev || tx_len > SX126X_MAX_PAYLOAD_LEN)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  // The chip ends the TX with a Timeout IRQ if TxDone does not come within the time on air.
+  uint32_t timeout_ms =
+      sx126x_time_on_air_us(&dev->shadow, (uint8_t)tx_len) / 1000 + SX126X_TRANSMIT_MARGIN_MS;
+
+  dev->transmit_done = false;
+  sx126x_status_t st =
+      sx126x_transmit_async(dev, tx_buffer, tx_len, timeout_ms, sx126x_transmit_done, NULL);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  // Should the chip's timeout go missing too, stop at twice its length, measured on the bus's
+  // clock, by the polls' delays or, failing both, by the least time a poll takes.
+  sx126x_bus_t *bus = dev->bus;
+  uint32_t limit_us = 2 * timeout_ms * 1000;
+  uint32_t start_us = bus->now_us ? bus->now_us(bus) : 0;
+  uint32_t waited_us = 0;
+
+  // Command errors are logged and counted; one that ends the TX arrives through the callback.
+  while (!__atomic_load_n(&dev->transmit_done, __ATOMIC_SEQ_CST))
+  {
+    st = sx126x_handle_irq(dev);
+    if (st != SX126X_OK && st != SX126X_ERR_CMD)
+    {
+      sx126x_transmit_abort(dev, st);
+      return st;
+    }
+
+    if (bus->delay_us)
+    {
+      bus->delay_us(bus, SX126X_TRANSMIT_POLL_US);
+      waited_us += SX126X_TRANSMIT_POLL_US;
+    }
+    else
+    {
+      waited_us += SX126X_TRANSMIT_POLL_MIN_US;
+    }
+
+    if (bus->now_us)
+      waited_us = bus->now_us(bus) - start_us;
+    if (waited_us > limit_us)
+    {
+      SX126X_LOG_ERROR(bus, "TX did not end within its timeout.");
+      sx126x_transmit_abort(dev, SX126X_ERR_TIMEOUT);
+      return SX126X_ERR_TIMEOUT;
+    }
+  }
+
+  return dev->transmit_result;
+}
+
+// Start continuous reception on the given radio instance
+sx126x_status_t sx126x_receive_continuous(sx126x_t *dev, sx126x_rx_ring_t *ring)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_receive_continuous_locked(dev, ring);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_receive_continuous_locked(sx126x_t *dev, sx126x_rx_ring_t *ring)
+{
+  if (!dev || !ring || !ring->slots)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (dev->state != SX126X_STATE_STANDBY)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  sx126x_status_t st = sx126x_sync_modem(dev);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  // In explicit header mode the payload length acts as the maximum accepted length. A symbol
+  // timeout left over from a single window would end continuous RX too.
+  sx126x_cmd_t cmds[3];
+  size_t n = 0;
+  if (dev->modem == SX126X_MODEM_LORA && dev->lora_symb_timeout)
+    sx126x_encode_lora_symb_num_timeout(&cmds[n++], 0);
+  sx126x_encode_packet_params(&cmds[n++], dev, sx126x_rx_payload_len(dev));
+  sx126x_encode_rx(&cmds[n++], SX126X_RX_TIMEOUT_CONTINUOUS);
+
+  dev->rx_ring = ring;
+  dev->rx_single = false;
+  dev->state = SX126X_STATE_RX;
+
+  // As for TX, a command error leaves the receiver running until a rejected SetRx is seen.
+  st = sx126x_submit_cmds(dev, cmds, n);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    SX126X_LOG_ERROR(dev->bus, "Failed to start continuous RX.");
+    dev->rx_ring = NULL;
+    dev->state = SX126X_STATE_STANDBY;
+    return st;
+  }
+
+  dev->lora_symb_timeout = 0;
+
+  return SX126X_OK;
+}
+
+// Open a single receive window on the given radio instance
+sx126x_status_t sx126x_receive_single(sx126x_t *dev,
+                                      sx126x_rx_ring_t *ring,
+                                      uint32_t timeout_us,
+                                      uint8_t symbols,
+                                      sx126x_rx_done_cb_t cb,
+                                      void *arg)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_receive_single_locked(dev, ring, timeout_us, symbols, cb, arg);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_receive_single_locked(sx126x_t *dev,
+                                                    sx126x_rx_ring_t *ring,
+                                                    uint32_t timeout_us,
+                                                    uint8_t symbols,
+                                                    sx126x_rx_done_cb_t cb,
+                                                    void *arg)
+{
+  if (!dev || !ring || !ring->slots)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (dev->state != SX126X_STATE_STANDBY)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  sx126x_status_t st = sx126x_sync_modem(dev);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  // A window with neither timer nor symbol timeout stays open until a packet arrives.
+  uint32_t ticks = sx126x_rx_timeout_ticks(timeout_us);
+  bool is_lora = dev->modem == SX126X_MODEM_LORA;
+
+  sx126x_cmd_t cmds[3];
+  size_t n = 0;
+  if (is_lora && symbols != dev->lora_symb_timeout)
+    sx126x_encode_lora_symb_num_timeout(&cmds[n++], symbols);
+  sx126x_encode_packet_params(&cmds[n++], dev, sx126x_rx_payload_len(dev));
+  sx126x_encode_rx(&cmds[n++], ticks);
+
+  dev->rx_ring = ring;
+  dev->rx_single = true;
+  dev->rx_cb = cb;
+  dev->rx_cb_arg = arg;
+  dev->state = SX126X_STATE_RX;
+
+  st = sx126x_submit_cmds(dev, cmds, n);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    SX126X_LOG_ERROR(dev->bus, "Failed to open RX window.");
+    dev->rx_ring = NULL;
+    dev->rx_single = false;
+    dev->rx_cb = NULL;
+    dev->rx_cb_arg = NULL;
+    dev->state = SX126X_STATE_STANDBY;
+    return st;
+  }
+
+  if (is_lora)
+    dev->lora_symb_timeout = symbols;
+
+  return SX126X_OK;
+}
+
+// Open the shortest RX window for a packet expected within uncertainty_us
+sx126x_status_t sx126x_receive_window(sx126x_t *dev,
+                                      sx126x_rx_ring_t *ring,
+                                      uint32_t uncertainty_us,
+                                      sx126x_rx_done_cb_t cb,
+                                      void *arg)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  if (!dev)
+  {
+    st = SX126X_ERR_INVALID_ARG;
+  }
+  else
+  {
+    uint32_t timeout_us = sx126x_rx_timeout_us(&dev->shadow, uncertainty_us);
+    uint8_t symbols = sx126x_lora_rx_symbols(&dev->shadow, uncertainty_us);
+
+    if (timeout_us == 0)
+      st = SX126X_ERR_INVALID_ARG;
+    else
+      st = sx126x_receive_single_locked(dev, ring, timeout_us, symbols, cb, arg);
+  }
+
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+// Send a packet and open a receive window from its TxDone
+sx126x_status_t sx126x_transmit_receive(sx126x_t *dev,
+                                        const uint8_t *tx_buffer,
+                                        size_t tx_len,
+                                        uint32_t tx_timeout_ms,
+                                        sx126x_rx_ring_t *ring,
+                                        uint32_t timeout_us,
+                                        uint8_t symbols,
+                                        sx126x_rx_done_cb_t cb,
+                                        void *arg)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_transmit_receive_locked(
+      dev, tx_buffer, tx_len, tx_timeout_ms, ring, timeout_us, symbols, cb, arg);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_transmit_receive_locked(sx126x_t *dev,
+                                                      const uint8_t *tx_buffer,
+                                                      size_t tx_len,
+                                                      uint32_t tx_timeout_ms,
+                                                      sx126x_rx_ring_t *ring,
+                                                      uint32_t timeout_us,
+                                                      uint8_t symbols,
+                                                      sx126x_rx_done_cb_t cb,
+                                                      void *arg)
+{
+  if (!dev || !tx_buffer || tx_len == 0 || tx_len > SX126X_MAX_PAYLOAD_LEN || !ring ||
+      !ring->slots)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (dev->state != SX126X_STATE_STANDBY)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  sx126x_status_t st = sx126x_sync_modem(dev);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  sx126x_cmd_t cmd;
+  bool is_lora = dev->modem == SX126X_MODEM_LORA;
+
+  // The symbol timeout is a setting rather than part of the window, so it goes out now.
+  if (is_lora && symbols != dev->lora_symb_timeout)
+  {
+    sx126x_encode_lora_symb_num_timeout(&cmd, symbols);
+    st = sx126x_write_cmd(dev, &cmd);
+    if (st != SX126X_OK && st != SX126X_ERR_CMD)
+    {
+      return st;
+    }
+    dev->lora_symb_timeout = symbols;
+  }
+
+  // An explicit LoRa header carries the length, so the receiver only needs SetRx. Otherwise the
+  // length in the packet parameters bounds what it accepts.
+  dev->rx_after_tx_params_len = 0;
+  if (!is_lora || dev->lora_implicit_header)
+  {
+    sx126x_encode_packet_params(&cmd, dev, sx126x_rx_payload_len(dev));
+    memcpy(dev->rx_after_tx_params, cmd.buf, cmd.len);
+    dev->rx_after_tx_params_len = (uint8_t)cmd.len;
+  }
+  sx126x_encode_rx(&cmd, sx126x_rx_timeout_ticks(timeout_us));
+  memcpy(dev->rx_after_tx_set_rx, cmd.buf, cmd.len);
+
+  dev->rx_ring = ring;
+  dev->rx_single = true;
+  dev->rx_cb = cb;
+  dev->rx_cb_arg = arg;
+  dev->rx_after_tx = true;
+
+  dev->tx_queued = false;
+  st = sx126x_start_tx(dev,
+                       false,
+                       0x00,
+                       tx_buffer,
+                       (uint8_t)tx_len,
+                       sx126x_timeout_ticks(tx_timeout_ms),
+                       NULL,
+                       NULL);
+  if (st != SX126X_OK)
+  {
+    SX126X_LOG_ERROR(dev->bus, "Failed to start transmission.");
+    dev->rx_after_tx = false;
+    dev->rx_ring = NULL;
+    dev->rx_single = false;
+    dev->rx_cb = NULL;
+    dev->rx_cb_arg = NULL;
+    return st;
+  }
+
+  return SX126X_OK;
+}
+
+// Recommended CAD settings per spreading factor, SF5 to SF12
+void sx126x_cad_default_params(sx126x_lora_spreading_factor_t sf, sx126x_cad_params_t *out)
+{
+  static const sx126x_cad_params_t table[] = {
+      {SX126X_CAD_ON_2_SYMB, 18, 10}, // SF5
+      {SX126X_CAD_ON_2_SYMB, 19, 10}, // SF6
+      {SX126X_CAD_ON_2_SYMB, 22, 10}, // SF7
+      {SX126X_CAD_ON_2_SYMB, 22, 10}, // SF8
+      {SX126X_CAD_ON_4_SYMB, 23, 10}, // SF9
+      {SX126X_CAD_ON_4_SYMB, 24, 10}, // SF10
+      {SX126X_CAD_ON_4_SYMB, 25, 10}, // SF11
+      {SX126X_CAD_ON_4_SYMB, 28, 10}, // SF12
+  };
+
+  if (!out)
+  {
+    return;
+  }
+
+  if (sf < SX126X_LORA_SF_5)
+    sf = SX126X_LORA_SF_5;
+  if (sf > SX126X_LORA_SF_12)
+    sf = SX126X_LORA_SF_12;
+
+  *out = table[sf - SX126X_LORA_SF_5];
+}
+
+// Select the CAD settings for the given radio instance
+sx126x_status_t sx126x_set_cad_params(sx126x_t *dev, const sx126x_cad_params_t *params)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_set_cad_params_locked(dev, params);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_set_cad_params_locked(sx126x_t *dev,
+                                                    const sx126x_cad_params_t *params)
+{
+  if (!dev || (params && (params->symbols > SX126X_CAD_ON_16_SYMB || params->det_peak == 0)))
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  // They are sent with every CAD, so nothing goes to the chip here.
+  if (params)
+    dev->cad_params = *params;
+  else
+    dev->cad_params = (sx126x_cad_params_t){0};
+
+  return SX126X_OK;
+}
+
+// Run a single CAD on the given radio instance
+sx126x_status_t sx126x_cad(sx126x_t *dev, sx126x_cad_done_cb_t cb, void *arg)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_cad_locked(dev, cb, arg);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_cad_locked(sx126x_t *dev, sx126x_cad_done_cb_t cb, void *arg)
+{
+  if (!dev)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (dev->modem != SX126X_MODEM_LORA)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (dev->state != SX126X_STATE_STANDBY)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  sx126x_status_t st = sx126x_sync_modem(dev);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  sx126x_cmd_t cmds[2];
+  sx126x_encode_cad_params(&cmds[0], dev, SX126X_CAD_EXIT_ONLY, 0);
+  sx126x_encode_cad(&cmds[1]);
+
+  dev->cad_exit = SX126X_CAD_EXIT_ONLY;
+  dev->cad_cb = cb;
+  dev->cad_cb_arg = arg;
+  __atomic_store_n(&dev->state, SX126X_STATE_CAD, __ATOMIC_SEQ_CST);
+
+  // As for TX, a command error leaves the CAD to end through the IRQ path.
+  st = sx126x_submit_cmds(dev, cmds, 2);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    SX126X_LOG_ERROR(dev->bus, "Failed to start CAD.");
+    dev->cad_cb = NULL;
+    dev->cad_cb_arg = NULL;
+    __atomic_store_n(&dev->state, SX126X_STATE_STANDBY, __ATOMIC_SEQ_CST);
+    return st;
+  }
+
+  return SX126X_OK;
+}
+
+// Open an RX window on the given radio instance only if a CAD hears activity
+sx126x_status_t sx126x_cad_receive(sx126x_t *dev,
+                                   sx126x_rx_ring_t *ring,
+                                   uint32_t timeout_us,
+                                   sx126x_rx_done_cb_t cb,
+                                   void *arg)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_cad_receive_locked(dev, ring, timeout_us, cb, arg);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_cad_receive_locked(sx126x_t *dev,
+                                                 sx126x_rx_ring_t *ring,
+                                                 uint32_t timeout_us,
+                                                 sx126x_rx_done_cb_t cb,
+                                                 void *arg)
+{
+  if (!dev || !ring || !ring->slots)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (dev->modem != SX126X_MODEM_LORA)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (dev->state != SX126X_STATE_STANDBY)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  sx126x_status_t st = sx126x_sync_modem(dev);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  // The window that follows the CAD runs on its RX timer alone.
+  sx126x_cmd_t cmds[4];
+  size_t n = 0;
+  if (dev->lora_symb_timeout)
+    sx126x_encode_lora_symb_num_timeout(&cmds[n++], 0);
+  sx126x_encode_packet_params(&cmds[n++], dev, sx126x_rx_payload_len(dev));
+  sx126x_encode_cad_params(
+      &cmds[n++], dev, SX126X_CAD_EXIT_RX, sx126x_rx_timeout_ticks(timeout_us));
+  sx126x_encode_cad(&cmds[n++]);
+
+  dev->rx_ring = ring;
+  dev->rx_single = true;
+  dev->rx_cb = cb;
+  dev->rx_cb_arg = arg;
+  dev->cad_exit = SX126X_CAD_EXIT_RX;
+  __atomic_store_n(&dev->state, SX126X_STATE_CAD, __ATOMIC_SEQ_CST);
+
+  st = sx126x_submit_cmds(dev, cmds, n);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    SX126X_LOG_ERROR(dev->bus, "Failed to start CAD.");
+    dev->rx_ring = NULL;
+    dev->rx_single = false;
+    dev->rx_cb = NULL;
+    dev->rx_cb_arg = NULL;
+    __atomic_store_n(&dev->state, SX126X_STATE_STANDBY, __ATOMIC_SEQ_CST);
+    return st;
+  }
+
+  dev->lora_symb_timeout = 0;
+
+  return SX126X_OK;
+}
+
+// Stop continuous reception on the given radio instance
+sx126x_status_t sx126x_receive_stop(sx126x_t *dev)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_receive_stop_locked(dev);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_receive_stop_locked(sx126x_t *dev)
+{
+  if (!dev)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (dev->state != SX126X_STATE_RX &&
+      !(dev->state == SX126X_STATE_CAD && dev->cad_exit == SX126X_CAD_EXIT_RX))
+  {
+    return SX126X_OK;
+  }
+
+  sx126x_status_t st = sx126x_set_standby(dev, SX126X_STBY_RC);
+  if (st != SX126X_OK)
+  {
+    SX126X_LOG_ERROR(dev->bus, "Failed to leave RX.");
+    return st;
+  }
+
+  dev->state = SX126X_STATE_STANDBY;
+  dev->rx_ring = NULL;
+  dev->rx_single = false;
+  dev->rx_cb = NULL;
+  dev->rx_cb_arg = NULL;
+
+  return SX126X_OK;
+}
+
+// Read one RX completion in a single submission
+sx126x_status_t sx126x_rx_complete(sx126x_t *dev, sx126x_rx_packet_t *pkt)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_rx_complete_locked(dev, pkt);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+static sx126x_status_t sx126x_rx_complete_locked(sx126x_t *dev, sx126x_rx_packet_t *pkt)
+{
+  if (!dev || !pkt)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  return sx126x_rx_read(dev, pkt, true);
+}
+
+// Service DIO1 for the given radio instance
+sx126x_status_t sx126x_handle_irq(sx126x_t *dev)
+{
+  sx126x_bus_t *bus = dev ? dev->bus : NULL;
+
+  sx126x_status_t st = sx126x_bus_lock(bus);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  st = sx126x_handle_irq_locked(dev);
+  sx126x_bus_unlock(bus);
+
+  return st;
+}
+
+bool sx126x_is_idle(const sx126x_t *dev)
+{
+  return dev && __atomic_load_n(&dev->state, __ATOMIC_SEQ_CST) == SX126X_STATE_STANDBY;
+}
+
+sx126x_status_t sx126x_attach_irq(sx126x_t *dev)
+{
+  if (!dev || !dev->bus)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->bus->attach_dio1)
+  {
+    return SX126X_OK;
+  }
+
+  return dev->bus->attach_dio1(dev->bus, sx126x_dio1_handler, dev);
+}
+
+static sx126x_status_t sx126x_handle_irq_locked(sx126x_t *dev)
+{
+  if (!dev)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!dev->is_initialized || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  // In RX the IRQ status is read as part of the chained completion read.
+  if (dev->state == SX126X_STATE_RX && dev->rx_ring)
+  {
+    return sx126x_drain_rx(dev);
+  }
+
+  // An LR-FHSS transmission has its own path, built around the hop IRQ.
+  if (dev->state == SX126X_STATE_TX && dev->lr_fhss_end)
+  {
+    return sx126x_lr_fhss_irq(dev);
+  }
+
+  // So does a transmission that goes on to receive.
+  if (dev->state == SX126X_STATE_TX && dev->rx_after_tx)
+  {
+    return sx126x_rx_after_tx_irq(dev);
+  }
+
+  // A command error still delivers valid IRQ flags; it is reported once they are handled.
+  uint16_t irq;
+  sx126x_status_t st = sx126x_get_irq_status(dev, &irq);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    if (dev->state == SX126X_STATE_TX)
+      sx126x_complete_tx(dev, st);
+    else if (dev->state == SX126X_STATE_CAD)
+      sx126x_complete_cad(dev, st);
+    return st;
+  }
+
+  // A rejected SetTx never raises an IRQ, so the transmission ends here.
+  if (st == SX126X_ERR_CMD && dev->state == SX126X_STATE_TX &&
+      dev->error_opcode == SX126X_OP_SET_TX && !(irq & (SX126X_IRQ_TX_DONE | SX126X_IRQ_TIMEOUT)))
+  {
+    sx126x_complete_tx(dev, st);
+  }
+
+  // Likewise for a rejected SetCad.
+  if (st == SX126X_ERR_CMD && dev->state == SX126X_STATE_CAD &&
+      dev->error_opcode == SX126X_OP_SET_CAD && !(irq & SX126X_IRQ_CAD_DONE))
+  {
+    sx126x_complete_cad(dev, st);
+  }
+
+  if (irq == SX126X_IRQ_NONE)
+  {
+    return st;
+  }
+
+  // Clear exactly what was read so that an IRQ raised in between is not lost. After a CAD that
+  // chains into RX, anything but the CAD flags is left for the RX completion read.
+  uint16_t clear_irq = irq;
+  if (dev->state == SX126X_STATE_CAD && dev->cad_exit == SX126X_CAD_EXIT_RX)
+    clear_irq &= SX126X_IRQ_CAD_DONE | SX126X_IRQ_CAD_DETECTED;
+
+  sx126x_cmd_t clear;
+  sx126x_encode_clear_irq_status(&clear, clear_irq);
+  sx126x_status_t clear_st = sx126x_write_cmd(dev, &clear);
+  if (clear_st != SX126X_OK)
+  {
+    SX126X_LOG_WARN(dev->bus, "Failed to clear IRQ status 0x%04x.", clear_irq);
+    if (st == SX126X_OK)
+      st = clear_st;
+  }
+
+  switch (dev->state)
+  {
+  case SX126X_STATE_TX:
+    if (irq & SX126X_IRQ_TX_DONE)
+      sx126x_complete_tx(dev, SX126X_OK);
+    else if (irq & SX126X_IRQ_TIMEOUT)
+      sx126x_complete_tx(dev, SX126X_ERR_TIMEOUT);
+    break;
+
+  case SX126X_STATE_CAD:
+    if (irq & SX126X_IRQ_CAD_DONE)
+    {
+      sx126x_status_t cad_st = sx126x_cad_done(dev, irq);
+      if (st == SX126X_OK)
+        st = cad_st;
+    }
+    break;
+
+  default:
+    SX126X_LOG_DEBUG(dev->bus, "Ignoring IRQ 0x%04x in state %d.", irq, dev->state);
+    break;
+  }
+
+  return st;
+}
+
+static sx126x_status_t sx126x_set_standby(sx126x_t *dev, sx126x_standby_mode_t mode)
+{
+  if (!dev || !dev->bus || !dev->bus->transfer)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  sx126x_cmd_t cmd;
+  sx126x_encode_standby(&cmd, mode);
+  return sx126x_write_cmd(dev, &cmd);
+}
+
+static sx126x_status_t
+sx126x_get_pa_configuration(sx126x_t *dev, sx126x_pa_profile_t profile, sx126x_pa_config_t *cfg)
+{
+  if (!dev)
+    return SX126X_ERR_INVALID_ARG;
+
+  if (dev->chip == SX126X_CHIP_SX1261)
+  {
+    // SX1261 supports only low power (14 dBm)
+    if (profile != SX126X_PA_LOW_POWER && dev->bus && dev->bus->log)
+      dev->bus->log("Warning: SX1261 only supports LOW_POWER. Overriding user profile.");
+  }
+  else if (dev->chip != SX126X_CHIP_SX1262)
+  {
+    // Unknown chip: safest possible configuration
+    if (dev->bus && dev->bus->log)
+      dev->bus->log("Unknown SX126x chip — using default low power PA config.");
+  }
+
+  cfg->pa_duty_cycle = SX126X_PA_DUTY_CYCLE(dev->chip, profile);
+  cfg->hp_max = SX126X_PA_HP_MAX(dev->chip, profile);
+  cfg->chip = SX126X_PA_DEVICE_SEL(dev->chip);
+  cfg->pa_lut = SX126X_PA_LUT;
+
+  return SX126X_OK;
+}
+
+// Copy the host-side frame format settings out of a configuration.
+static void sx126x_apply_frame_format(sx126x_t *dev, const sx126x_config_t *cfg)
+{
+  dev->modem = cfg->modem;
+  dev->lora_preamble_len =
+      cfg->lora_preamble_len ? cfg->lora_preamble_len : SX126X_LORA_PREAMBLE_DEFAULT;
+  dev->lora_implicit_header = cfg->lora_implicit_header;
+  dev->lora_crc_on = cfg->lora_crc_on;
+  dev->lora_invert_iq = cfg->lora_invert_iq;
+  dev->rx_payload_len = cfg->rx_payload_len;
+  dev->gfsk_preamble_bits =
+      cfg->gfsk_preamble_bits ? cfg->gfsk_preamble_bits : SX126X_GFSK_PREAMBLE_DEFAULT;
+  dev->gfsk_preamble_detect = cfg->gfsk_preamble_detect;
+  dev->gfsk_sync_word_len = cfg->gfsk_sync_word_len;
+  dev->gfsk_fixed_length = cfg->gfsk_fixed_length;
+  dev->gfsk_crc = cfg->gfsk_crc;
+  dev->gfsk_whitening = cfg->gfsk_whitening;
+}
+
+// Reject modem settings the chip cannot represent.
+static sx126x_status_t sx126x_check_config(const sx126x_config_t *cfg)
+{
+  if (cfg->fallback_mode != 0 && cfg->fallback_mode != SX126X_FALLBACK_STDBY_RC &&
+      cfg->fallback_mode != SX126X_FALLBACK_STDBY_XOSC && cfg->fallback_mode != SX126X_FALLBACK_FS)
+    return SX126X_ERR_INVALID_ARG;
+
+  switch (cfg->modem)
+  {
+  case SX126X_MODEM_LORA:
+    return SX126X_OK;
+
+  case SX126X_MODEM_FSK:
+    if (cfg->gfsk_bitrate_bps < 600 || cfg->gfsk_bitrate_bps > 300000 ||
+        cfg->gfsk_sync_word_len > SX126X_GFSK_SYNC_WORD_MAX_LEN ||
+        cfg->gfsk_crc > SX126X_GFSK_CRC_2_BYTE_INV)
+      return SX126X_ERR_INVALID_ARG;
+    return SX126X_OK;
+
+  default:
+    return SX126X_ERR_INVALID_ARG;
+  }
+}
+
+// Common tail of sx126x_init and sx126x_init_from_image, once cfg has been applied to the chip.
+static sx126x_status_t sx126x_finish_init(sx126x_t *dev, const sx126x_config_t *cfg)
+{
+  sx126x_bus_t *bus = dev->bus;
+
+  dev->pa_profile = cfg->pa_profile;
+  dev->shadow = *cfg;
+  dev->shadow_valid = true;
+  dev->rx_prefetch_len = SX126X_RX_PREFETCH_INITIAL;
+
+  sx126x_status_t st = sx126x_attach_irq(dev);
+  if (st != SX126X_OK)
+  {
+    SX126X_LOG_ERROR(bus, "Failed to attach DIO1 handler.");
+    return st;
+  }
+
+  dev->is_initialized = true;
+
+  return SX126X_OK;
+}
+
+// Encode what a warm sleep discards from the configuration in the shadow. Settings made by
+// commands are retained; registers written directly are treated as lost and rewritten, which is
+// only needed where they differ from their reset value. Returns the number of commands.
+static size_t sx126x_build_retention_cmds(const sx126x_t *dev, sx126x_cmd_t *cmds)
+{
+  const sx126x_config_t *cfg = &dev->shadow;
+  size_t n = 0;
+
+  if (cfg->modem == SX126X_MODEM_FSK)
+  {
+    if (cfg->gfsk_sync_word_len)
+      sx126x_encode_gfsk_sync_word(&cmds[n++], cfg->gfsk_sync_word, cfg->gfsk_sync_word_len);
+  }
+  else
+  {
+    if (cfg->lora_sync_word)
+      sx126x_encode_lora_sync_word(&cmds[n++], cfg->lora_sync_word);
+    if (cfg->lora_invert_iq)
+      sx126x_encode_iq_polarity(&cmds[n++], true);
+  }
+
+  return n;
+}
+
+// Encode the full command sequence that brings the chip to cfg from any standby state.
+static sx126x_status_t sx126x_build_config_cmds(sx126x_t *dev,
+                                                const sx126x_config_t *cfg,
+                                                sx126x_cmd_t *cmds,
+                                                size_t *count)
+{
+  size_t n = 0;
+  sx126x_status_t st;
+
+  sx126x_encode_standby(&cmds[n++], SX126X_STBY_RC);
+  sx126x_encode_packet_type(&cmds[n++], cfg->modem);
+  sx126x_encode_frequency(&cmds[n++], cfg->frequency_hz);
+  st = sx126x_encode_pa_profile(dev, &cmds[n++], cfg->pa_profile);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+  sx126x_encode_tx_params(&cmds[n++], cfg->power_dbm, cfg->power_ramp_time);
+  sx126x_encode_modulation_params(&cmds[n++], cfg);
+  sx126x_encode_buffer_base_address(&cmds[n++], 0x00, 0x00);
+  sx126x_encode_dio_irq_params(
+      &cmds[n++], SX126X_DIO1_IRQ_MASK, SX126X_DIO1_IRQ_MASK, SX126X_IRQ_NONE, SX126X_IRQ_NONE);
+  // The chip only resets its fallback mode on a reset, so a resync also sends the default back.
+  if (cfg->fallback_mode || dev->shadow.fallback_mode)
+    sx126x_encode_fallback_mode(&cmds[n++], cfg->fallback_mode);
+  if (cfg->modem == SX126X_MODEM_FSK)
+  {
+    if (cfg->gfsk_sync_word_len)
+      sx126x_encode_gfsk_sync_word(&cmds[n++], cfg->gfsk_sync_word, cfg->gfsk_sync_word_len);
+  }
+  else
+  {
+    if (cfg->lora_sync_word)
+      sx126x_encode_lora_sync_word(&cmds[n++], cfg->lora_sync_word);
+    // Like the fallback mode, the register survives anything short of a reset.
+    if (cfg->lora_invert_iq || dev->shadow.lora_invert_iq)
+      sx126x_encode_iq_polarity(&cmds[n++], cfg->lora_invert_iq);
+  }
+
+  *count = n;
+  return SX126X_OK;
+}
+
+static void sx126x_encode_standby(sx126x_cmd_t *cmd, sx126x_standby_mode_t mode)
+{
+  cmd->buf[0] = SX126X_OP_SET_STANDBY;
+  cmd->buf[1] = mode;
+  cmd->len = 2;
+}
+
+static void sx126x_encode_fallback_mode(sx126x_cmd_t *cmd, sx126x_fallback_mode_t mode)
+{
+  cmd->buf[0] = SX126X_OP_SET_RX_TX_FALLBACK_MODE;
+  cmd->buf[1] = mode ? mode : SX126X_FALLBACK_STDBY_RC;
+  cmd->len = 2;
+}
+
+static void sx126x_encode_sleep(sx126x_cmd_t *cmd, bool warm)
+{
+  cmd->buf[0] = SX126X_OP_SET_SLEEP;
+  cmd->buf[1] = warm ? SX126X_SLEEP_WARM_START : 0x00;
+  cmd->len = 2;
+}
+
+static void sx126x_encode_wake(sx126x_cmd_t *cmd)
+{
+  cmd->buf[0] = SX126X_OP_GET_STATUS;
+  cmd->len = SX126X_WAKE_FRAME_LEN;
+}
+
+static void sx126x_encode_packet_type(sx126x_cmd_t *cmd, sx126x_modem_t modem)
+{
+  sx126x_packet_type_t pkt_type;
+  if (modem == SX126X_MODEM_LORA)
+    pkt_type = SX126X_PACKET_TYPE_LORA;
+  else
+    pkt_type = SX126X_PACKET_TYPE_GFSK;
+
+  cmd->buf[0] = SX126X_OP_SET_PACKET_TYPE;
+  cmd->buf[1] = pkt_type;
+  cmd->len = 2;
+}
+
+// Same frame as a channel plan entry, from the same encoder.
+static void sx126x_encode_frequency(sx126x_cmd_t *cmd, uint32_t hz)
+{
+  sx126x_channel_t ch;
+  sx126x_channel_encode(&ch, hz);
+
+  memcpy(cmd->buf, ch.frame, SX126X_CHANNEL_FRAME_LEN);
+  cmd->len = SX126X_CHANNEL_FRAME_LEN;
+}
+
+static sx126x_status_t
+sx126x_encode_pa_profile(sx126x_t *dev, sx126x_cmd_t *cmd, sx126x_pa_profile_t profile)
+{
+  sx126x_pa_config_t cfg;
+  sx126x_status_t st = sx126x_get_pa_configuration(dev, profile, &cfg);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  cmd->buf[0] = SX126X_OP_SET_PA_CONFIG;
+  cmd->buf[1] = cfg.pa_duty_cycle;
+  cmd->buf[2] = cfg.hp_max;
+  cmd->buf[3] = cfg.chip;
+  cmd->buf[4] = cfg.pa_lut;
+  cmd->len = 5;
+
+  return SX126X_OK;
+}
+
+static void sx126x_encode_tx_params(sx126x_cmd_t *cmd, int pwr, sx126x_power_ramp_time_t ramp_time)
+{
+  cmd->buf[0] = SX126X_OP_SET_TX_PARAMS;
+  cmd->buf[1] = (uint8_t)pwr;
+  cmd->buf[2] = ramp_time;
+  cmd->len = 3;
+}
+
+static void sx126x_encode_lora_modulation_params(sx126x_cmd_t *cmd,
+                                                 sx126x_lora_spreading_factor_t sf,
+                                                 sx126x_lora_bandwidth_t bw,
+                                                 sx126x_lora_coding_rate_t cr,
+                                                 bool ldro)
+{
+  cmd->buf[0] = SX126X_OP_SET_MODULATION_PARAMS;
+  cmd->buf[1] = sf;
+  cmd->buf[2] = bw;
+  cmd->buf[3] = cr;
+  cmd->buf[4] = (uint8_t)(ldro ? 0x01 : 0x00);
+  cmd->len = 5;
+}
+
+static void sx126x_encode_gfsk_modulation_params(sx126x_cmd_t *cmd, const sx126x_config_t *cfg)
+{
+  // BR = 32 * Fxtal / bitrate; Fdev in PLL steps of Fxtal / 2^25.
+  uint32_t br = (uint32_t)((32ull * SX126X_XTAL_HZ) / cfg->gfsk_bitrate_bps);
+  uint32_t fdev = (uint32_t)(((uint64_t)cfg->gfsk_fdev_hz << 25) / SX126X_XTAL_HZ);
+
+  cmd->buf[0] = SX126X_OP_SET_MODULATION_PARAMS;
+  cmd->buf[1] = (br >> 16) & 0xFF;
+  cmd->buf[2] = (br >> 8) & 0xFF;
+  cmd->buf[3] = br & 0xFF;
+  cmd->buf[4] = cfg->gfsk_shaping;
+  cmd->buf[5] = cfg->gfsk_bw;
+  cmd->buf[6] = (fdev >> 16) & 0xFF;
+  cmd->buf[7] = (fdev >> 8) & 0xFF;
+  cmd->buf[8] = fdev & 0xFF;
+  cmd->len = 9;
+}
+
+static void sx126x_encode_modulation_params(sx126x_cmd_t *cmd, const sx126x_config_t *cfg)
+{
+  if (cfg->modem == SX126X_MODEM_FSK)
+    sx126x_encode_gfsk_modulation_params(cmd, cfg);
+  else
+    sx126x_encode_lora_modulation_params(
+        cmd, cfg->lora_sf, cfg->lora_bw, cfg->lora_cr, sx126x_lora_ldro_enabled(cfg));
+}
+
+static void sx126x_encode_dio_irq_params(sx126x_cmd_t *cmd,
+                                         uint16_t irq_mask,
+                                         uint16_t dio1_mask,
+                                         uint16_t dio2_mask,
+                                         uint16_t dio3_mask)
+{
+  cmd->buf[0] = SX126X_OP_SET_DIO_IRQ_PARAMS;
+
+  cmd->buf[1] = (irq_mask >> 8) & 0xFF;
+  cmd->buf[2] = irq_mask & 0xFF;
+
+  cmd->buf[3] = (dio1_mask >> 8) & 0xFF;
+  cmd->buf[4] = dio1_mask & 0xFF;
+
+  cmd->buf[5] = (dio2_mask >> 8) & 0xFF;
+  cmd->buf[6] = dio2_mask & 0xFF;
+
+  cmd->buf[7] = (dio3_mask >> 8) & 0xFF;
+  cmd->buf[8] = dio3_mask & 0xFF;
+  cmd->len = 9;
+}
+
+static void sx126x_encode_buffer_base_address(sx126x_cmd_t *cmd, uint8_t tx_base, uint8_t rx_base)
+{
+  cmd->buf[0] = SX126X_OP_SET_BUFFER_BASE_ADDRESS;
+  cmd->buf[1] = tx_base;
+  cmd->buf[2] = rx_base;
+  cmd->len = 3;
+}
+
+static void sx126x_encode_lora_packet_params(sx126x_cmd_t *cmd, const sx126x_t *dev, uint8_t len)
+{
+  cmd->buf[0] = SX126X_OP_SET_PACKET_PARAMS;
+  cmd->buf[1] = (dev->lora_preamble_len >> 8) & 0xFF;
+  cmd->buf[2] = dev->lora_preamble_len & 0xFF;
+  cmd->buf[3] = dev->lora_implicit_header ? 0x01 : 0x00;
+  cmd->buf[4] = len;
+  cmd->buf[5] = dev->lora_crc_on ? 0x01 : 0x00;
+  cmd->buf[6] = dev->lora_invert_iq ? 0x01 : 0x00;
+  cmd->len = 7;
+}
+
+static void sx126x_encode_gfsk_packet_params(sx126x_cmd_t *cmd, const sx126x_t *dev, uint8_t len)
+{
+  // Chip CRC codes, indexed by sx126x_gfsk_crc_t.
+  static const uint8_t crc_type[] = {0x01, 0x00, 0x02, 0x04, 0x06};
+
+  cmd->buf[0] = SX126X_OP_SET_PACKET_PARAMS;
+  cmd->buf[1] = (dev->gfsk_preamble_bits >> 8) & 0xFF;
+  cmd->buf[2] = dev->gfsk_preamble_bits & 0xFF;
+  cmd->buf[3] = dev->gfsk_preamble_detect;
+  cmd->buf[4] = (uint8_t)(dev->gfsk_sync_word_len * 8);
+  cmd->buf[5] = 0x00; // no address filtering
+  cmd->buf[6] = dev->gfsk_fixed_length ? 0x00 : 0x01;
+  cmd->buf[7] = len;
+  cmd->buf[8] = crc_type[dev->gfsk_crc];
+  cmd->buf[9] = dev->gfsk_whitening ? 0x01 : 0x00;
+  cmd->len = 10;
+}
+
+// Payload length for the receiver's packet parameters. With an implicit LoRa header or fixed-length
+// GFSK packets the packet does not carry it, so it is the configured one; otherwise it only bounds
+// what is accepted.
+static uint8_t sx126x_rx_payload_len(const sx126x_t *dev)
+{
+  bool is_fixed = dev->modem == SX126X_MODEM_FSK ? dev->gfsk_fixed_length
+                                                  : dev->lora_implicit_header;
+  if (is_fixed && dev->rx_payload_len)
+    return dev->rx_payload_len;
+  return SX126X_MAX_PAYLOAD_LEN;
+}
+
+// Packet parameters for the modem the radio is configured for.
+static void sx126x_encode_packet_params(sx126x_cmd_t *cmd, const sx126x_t *dev, uint8_t len)
+{
+  if (dev->modem == SX126X_MODEM_FSK)
+    sx126x_encode_gfsk_packet_params(cmd, dev, len);
+  else
+    sx126x_encode_lora_packet_params(cmd, dev, len);
+}
+
+static void sx126x_encode_lora_sync_word(sx126x_cmd_t *cmd, uint8_t sync_word)
+{
+  // Each nibble of the sync word goes in the high nibble of one register byte.
+  cmd->buf[0] = SX126X_OP_WRITE_REGISTER;
+  cmd->buf[1] = (SX126X_REG_LORA_SYNC_WORD >> 8) & 0xFF;
+  cmd->buf[2] = SX126X_REG_LORA_SYNC_WORD & 0xFF;
+  cmd->buf[3] = (sync_word & 0xF0) | 0x04;
+  cmd->buf[4] = ((sync_word & 0x0F) << 4) | 0x04;
+  cmd->len = 5;
+}
+
+static void sx126x_encode_iq_polarity(sx126x_cmd_t *cmd, bool inverted)
+{
+  cmd->buf[0] = SX126X_OP_WRITE_REGISTER;
+  cmd->buf[1] = (SX126X_REG_IQ_POLARITY >> 8) & 0xFF;
+  cmd->buf[2] = SX126X_REG_IQ_POLARITY & 0xFF;
+  cmd->buf[3] = inverted ? SX126X_IQ_POLARITY_DEFAULT & ~SX126X_IQ_POLARITY_STANDARD_BIT
+                         : SX126X_IQ_POLARITY_DEFAULT;
+  cmd->len = 4;
+}
+
+static void sx126x_encode_gfsk_sync_word(sx126x_cmd_t *cmd, const uint8_t *sync_word, uint8_t len)
+{
+  cmd->buf[0] = SX126X_OP_WRITE_REGISTER;
+  cmd->buf[1] = (SX126X_REG_GFSK_SYNC_WORD >> 8) & 0xFF;
+  cmd->buf[2] = SX126X_REG_GFSK_SYNC_WORD & 0xFF;
+  memcpy(&cmd->buf[3], sync_word, len);
+  cmd->len = 3 + (size_t)len;
+}
+
+static bool sx126x_gfsk_sync_word_changed(const sx126x_config_t *a, const sx126x_config_t *b)
+{
+  // Only the length is part of the packet params; the register holds the bytes.
+  return a->gfsk_sync_word_len != b->gfsk_sync_word_len ||
+         memcmp(a->gfsk_sync_word, b->gfsk_sync_word, b->gfsk_sync_word_len) != 0;
+}
+
+static void sx126x_encode_tx(sx126x_cmd_t *cmd, uint32_t timeout_ticks)
+{
+  cmd->buf[0] = SX126X_OP_SET_TX;
+  cmd->buf[1] = (timeout_ticks >> 16) & 0xFF;
+  cmd->buf[2] = (timeout_ticks >> 8) & 0xFF;
+  cmd->buf[3] = timeout_ticks & 0xFF;
+  cmd->len = 4;
+}
+
+static void sx126x_encode_rx(sx126x_cmd_t *cmd, uint32_t timeout_ticks)
+{
+  cmd->buf[0] = SX126X_OP_SET_RX;
+  cmd->buf[1] = (timeout_ticks >> 16) & 0xFF;
+  cmd->buf[2] = (timeout_ticks >> 8) & 0xFF;
+  cmd->buf[3] = timeout_ticks & 0xFF;
+  cmd->len = 4;
+}
+
+static void sx126x_encode_lora_symb_num_timeout(sx126x_cmd_t *cmd, uint8_t symbols)
+{
+  cmd->buf[0] = SX126X_OP_SET_LORA_SYMB_NUM_TIMEOUT;
+  cmd->buf[1] = symbols;
+  cmd->len = 2;
+}
+
+// SetCadParams with the radio's CAD settings, or the defaults for its spreading factor. The
+// timeout is the RX or TX timeout of the mode the CAD chains into.
+static void sx126x_encode_cad_params(sx126x_cmd_t *cmd,
+                                     const sx126x_t *dev,
+                                     sx126x_cad_exit_t exit_mode,
+                                     uint32_t timeout_ticks)
+{
+  sx126x_cad_params_t params = dev->cad_params;
+  if (params.det_peak == 0)
+    sx126x_cad_default_params(dev->shadow.lora_sf, &params);
+
+  cmd->buf[0] = SX126X_OP_SET_CAD_PARAMS;
+  cmd->buf[1] = params.symbols;
+  cmd->buf[2] = params.det_peak;
+  cmd->buf[3] = params.det_min;
+  cmd->buf[4] = exit_mode;
+  cmd->buf[5] = (timeout_ticks >> 16) & 0xFF;
+  cmd->buf[6] = (timeout_ticks >> 8) & 0xFF;
+  cmd->buf[7] = timeout_ticks & 0xFF;
+  cmd->len = 8;
+}
+
+static void sx126x_encode_cad(sx126x_cmd_t *cmd)
+{
+  cmd->buf[0] = SX126X_OP_SET_CAD;
+  cmd->len = 1;
+}
+
+static void sx126x_encode_clear_irq_status(sx126x_cmd_t *cmd, uint16_t irq)
+{
+  cmd->buf[0] = SX126X_OP_CLEAR_IRQ_STATUS;
+  cmd->buf[1] = (irq >> 8) & 0xFF;
+  cmd->buf[2] = irq & 0xFF;
+  cmd->len = 3;
+}
+
+static sx126x_status_t sx126x_get_irq_status(sx126x_t *dev, uint16_t *irq)
+{
+  // Full duplex in place: the reply overwrites the command.
+  uint8_t buf[] = {SX126X_OP_GET_IRQ_STATUS, 0x00, 0x00, 0x00};
+
+  // A command error reported here belongs to an earlier command; the IRQ status itself is valid.
+  sx126x_status_t st = sx126x_bus_xfer(dev, buf, sizeof(buf), buf, sizeof(buf));
+  if (st == SX126X_OK || st == SX126X_ERR_CMD)
+    *irq = ((uint16_t)buf[2] << 8) | buf[3];
+
+  return st;
+}
+
+// Leave TX and report the outcome. The callback is cleared first so it may start the next TX.
+static void sx126x_complete_tx(sx126x_t *dev, sx126x_status_t result)
+{
+  sx126x_tx_done_cb_t cb = dev->tx_cb;
+  void *arg = dev->tx_cb_arg;
+
+  dev->tx_cb = NULL;
+  dev->tx_cb_arg = NULL;
+  __atomic_store_n(&dev->state, SX126X_STATE_STANDBY, __ATOMIC_SEQ_CST);
+
+  // Put the staged packet on air before running the callback, which may queue the one after.
+  sx126x_tx_queue_kick(dev);
+
+  if (cb)
+    cb(dev, result, arg);
+}
+
+// Put the configured packet type and modulation back if LR-FHSS left the chip without them.
+// Every operation calls this before starting, so a restore that failed is retried there.
+static sx126x_status_t sx126x_sync_modem(sx126x_t *dev)
+{
+  sx126x_cmd_t cmds[2];
+
+  if (!dev->modem_stale)
+    return SX126X_OK;
+
+  sx126x_encode_packet_type(&cmds[0], dev->modem);
+  sx126x_encode_modulation_params(&cmds[1], &dev->shadow);
+  sx126x_status_t st = sx126x_submit_cmds(dev, cmds, 2);
+  if (st == SX126X_ERR_CMD)
+    st = SX126X_OK;
+  dev->modem_stale = st != SX126X_OK;
+
+  return st;
+}
+
+// End an LR-FHSS transmission: put the configured packet type and modulation back, then report.
+static void sx126x_complete_lr_fhss(sx126x_t *dev, sx126x_status_t result)
+{
+  dev->lr_fhss_next = NULL;
+  dev->lr_fhss_end = NULL;
+
+  sx126x_status_t st = sx126x_sync_modem(dev);
+  if (st != SX126X_OK)
+  {
+    SX126X_LOG_WARN(dev->bus, "Failed to restore the modem after LR-FHSS.");
+    if (result == SX126X_OK)
+      result = st;
+  }
+
+  sx126x_complete_tx(dev, result);
+}
+
+// Clears the hop IRQ alone, ahead of each hop refill.
+static const uint8_t sx126x_lr_fhss_clear_cmd[] = {SX126X_OP_CLEAR_IRQ_STATUS,
+                                                   (SX126X_IRQ_LR_FHSS_HOP >> 8) & 0xFF,
+                                                   SX126X_IRQ_LR_FHSS_HOP & 0xFF};
+
+// DIO1 during an LR-FHSS transmission. A lone hop IRQ is the hot path: its clear and the next
+// pre-encoded hop frame go out in one submission, with nothing computed or logged in between. The
+// frame targets the slot the chip has just left.
+static sx126x_status_t sx126x_lr_fhss_irq(sx126x_t *dev)
+{
+  sx126x_bus_frame_t frames[2] = {
+      {.tx = sx126x_lr_fhss_clear_cmd, .tx_len = sizeof(sx126x_lr_fhss_clear_cmd)},
+  };
+  size_t n = 1;
+  uint16_t irq;
+
+  sx126x_status_t st = sx126x_get_irq_status(dev, &irq);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    sx126x_complete_lr_fhss(dev, st);
+    return st;
+  }
+
+  if ((irq & SX126X_IRQ_LR_FHSS_HOP) && dev->lr_fhss_next != dev->lr_fhss_end)
+  {
+    frames[n++] = (sx126x_bus_frame_t){.tx = dev->lr_fhss_next->frame,
+                                       .tx_len = SX126X_LR_FHSS_HOP_FRAME_LEN};
+    dev->lr_fhss_next++;
+  }
+
+  if (irq == SX126X_IRQ_LR_FHSS_HOP)
+  {
+    sx126x_status_t hop_st = sx126x_submit_frames(dev, frames, n);
+    return st == SX126X_OK ? hop_st : st;
+  }
+
+  // Anything else: clear exactly what was read, refilling the hop table as well if due.
+  sx126x_cmd_t clear;
+  if (irq != SX126X_IRQ_NONE)
+  {
+    sx126x_encode_clear_irq_status(&clear, irq);
+    frames[0] = (sx126x_bus_frame_t){.tx = clear.buf, .tx_len = clear.len};
+    sx126x_status_t clear_st = sx126x_submit_frames(dev, frames, n);
+    if (clear_st != SX126X_OK)
+    {
+      SX126X_LOG_WARN(dev->bus, "Failed to clear IRQ status 0x%04x.", irq);
+      if (st == SX126X_OK)
+        st = clear_st;
+    }
+  }
+
+  // A rejected SetTx never raises an IRQ, so the transmission ends here.
+  if (irq & SX126X_IRQ_TX_DONE)
+    sx126x_complete_lr_fhss(dev, SX126X_OK);
+  else if (irq & SX126X_IRQ_TIMEOUT)
+    sx126x_complete_lr_fhss(dev, SX126X_ERR_TIMEOUT);
+  else if (st == SX126X_ERR_CMD && dev->error_opcode == SX126X_OP_SET_TX)
+    sx126x_complete_lr_fhss(dev, st);
+
+  return st;
+}
+
+// Clears TxDone alone, ahead of the receive window that follows it.
+static const uint8_t sx126x_tx_done_clear_cmd[] = {
+    SX126X_OP_CLEAR_IRQ_STATUS, (SX126X_IRQ_TX_DONE >> 8) & 0xFF, SX126X_IRQ_TX_DONE & 0xFF};
+
+// End a transmit-receive exchange before its receive window opened.
+static void sx126x_rx_after_tx_abort(sx126x_t *dev, sx126x_status_t result)
+{
+  dev->rx_after_tx = false;
+  sx126x_complete_rx(dev, result);
+}
+
+// DIO1 while sx126x_transmit_receive is transmitting. On TxDone the chip has fallen back to its
+// fallback mode, and the IRQ clear and the pre-encoded window frames go out in one submission,
+// with nothing computed or logged in between. From then on the window is handled like any other.
+static sx126x_status_t sx126x_rx_after_tx_irq(sx126x_t *dev)
+{
+  sx126x_bus_frame_t frames[3] = {
+      {.tx = sx126x_tx_done_clear_cmd, .tx_len = sizeof(sx126x_tx_done_clear_cmd)},
+  };
+  size_t n = 1;
+  uint16_t irq;
+  sx126x_cmd_t clear;
+
+  sx126x_status_t st = sx126x_get_irq_status(dev, &irq);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    sx126x_rx_after_tx_abort(dev, st);
+    return st;
+  }
+
+  // Clear exactly what was read, so the window does not start with a stale flag.
+  if (irq != SX126X_IRQ_TX_DONE && irq != SX126X_IRQ_NONE)
+  {
+    sx126x_encode_clear_irq_status(&clear, irq);
+    frames[0] = (sx126x_bus_frame_t){.tx = clear.buf, .tx_len = clear.len};
+  }
+
+  if (!(irq & SX126X_IRQ_TX_DONE))
+  {
+    if (irq != SX126X_IRQ_NONE)
+    {
+      sx126x_status_t clear_st = sx126x_submit_frames(dev, frames, n);
+      if (clear_st != SX126X_OK)
+      {
+        SX126X_LOG_WARN(dev->bus, "Failed to clear IRQ status 0x%04x.", irq);
+        if (st == SX126X_OK)
+          st = clear_st;
+      }
+    }
+
+    // A rejected SetTx never raises an IRQ, so the exchange ends here.
+    if (irq & SX126X_IRQ_TIMEOUT)
+      sx126x_rx_after_tx_abort(dev, SX126X_ERR_TIMEOUT);
+    else if (st == SX126X_ERR_CMD && dev->error_opcode == SX126X_OP_SET_TX)
+      sx126x_rx_after_tx_abort(dev, st);
+    return st;
+  }
+
+  if (dev->rx_after_tx_params_len)
+  {
+    frames[n++] = (sx126x_bus_frame_t){.tx = dev->rx_after_tx_params,
+                                       .tx_len = dev->rx_after_tx_params_len};
+  }
+  frames[n++] = (sx126x_bus_frame_t){.tx = dev->rx_after_tx_set_rx,
+                                     .tx_len = sizeof(dev->rx_after_tx_set_rx)};
+
+  // Switch to RX first so that a fast RxDone cannot race the state change.
+  dev->rx_after_tx = false;
+  __atomic_store_n(&dev->state, SX126X_STATE_RX, __ATOMIC_SEQ_CST);
+
+  sx126x_status_t rx_st = sx126x_submit_frames(dev, frames, n);
+  if (rx_st != SX126X_OK && rx_st != SX126X_ERR_CMD)
+  {
+    SX126X_LOG_ERROR(dev->bus, "Failed to open RX window after TX.");
+    sx126x_complete_rx(dev, rx_st);
+  }
+
+  return st == SX126X_OK ? rx_st : st;
+}
+
+// Start the packet staged by sx126x_tx_queue_push, if any. Its payload is already in the buffer.
+static void sx126x_tx_queue_kick(sx126x_t *dev)
+{
+  if (!__atomic_exchange_n(&dev->tx_next_staged, false, __ATOMIC_SEQ_CST))
+  {
+    return;
+  }
+
+  sx126x_status_t st = sx126x_start_tx(
+      dev, false, dev->tx_next_base, NULL, dev->tx_next_len, dev->tx_next_ticks, dev->tx_next_cb,
+      dev->tx_next_arg);
+  if (st != SX126X_OK)
+  {
+    SX126X_LOG_ERROR(dev->bus, "Failed to start queued transmission.");
+    if (dev->tx_next_cb)
+      dev->tx_next_cb(dev, st, dev->tx_next_arg);
+  }
+}
+
+// Put a packet on air from the given half of the data buffer, uploading the payload first unless
+// it is already there (payload NULL). Everything goes out as one submission. With lbt, a CAD in
+// listen-before-talk mode takes the place of SetTx and the chip only transmits if it is clear.
+static sx126x_status_t sx126x_start_tx(sx126x_t *dev,
+                                       bool lbt,
+                                       uint8_t base,
+                                       const uint8_t *payload,
+                                       uint8_t len,
+                                       uint32_t timeout_ticks,
+                                       sx126x_tx_done_cb_t cb,
+                                       void *arg)
+{
+  sx126x_status_t st = sx126x_sync_modem(dev);
+  if (st != SX126X_OK)
+  {
+    return st;
+  }
+
+  sx126x_bus_frame_t frames[5];
+  size_t n = 0;
+
+  sx126x_cmd_t base_cmd;
+  sx126x_cmd_t pkt_cmd;
+  sx126x_cmd_t cad_cmd;
+  sx126x_cmd_t tx_cmd;
+  uint8_t write_cmd[] = {SX126X_OP_WRITE_BUFFER, base};
+
+  if (base != dev->tx_base)
+  {
+    sx126x_encode_buffer_base_address(&base_cmd, base, 0x00);
+    frames[n++] = (sx126x_bus_frame_t){.tx = base_cmd.buf, .tx_len = base_cmd.len};
+  }
+
+  // The payload is clocked out straight from the caller's buffer behind the WriteBuffer header.
+  if (payload)
+  {
+    frames[n++] = (sx126x_bus_frame_t){
+        .tx = write_cmd, .tx_len = sizeof(write_cmd), .data_tx = payload, .data_len = len};
+  }
+
+  sx126x_encode_packet_params(&pkt_cmd, dev, len);
+  frames[n++] = (sx126x_bus_frame_t){.tx = pkt_cmd.buf, .tx_len = pkt_cmd.len};
+  if (lbt)
+  {
+    sx126x_encode_cad_params(&cad_cmd, dev, SX126X_CAD_EXIT_LBT, timeout_ticks);
+    sx126x_encode_cad(&tx_cmd);
+    frames[n++] = (sx126x_bus_frame_t){.tx = cad_cmd.buf, .tx_len = cad_cmd.len};
+    dev->cad_exit = SX126X_CAD_EXIT_LBT;
+  }
+  else
+  {
+    sx126x_encode_tx(&tx_cmd, timeout_ticks);
+  }
+  frames[n++] = (sx126x_bus_frame_t){.tx = tx_cmd.buf, .tx_len = tx_cmd.len};
+
+  // Arm completion before SetTx goes out so that a fast DIO1 cannot race the state change.
+  dev->tx_cb = cb;
+  dev->tx_cb_arg = arg;
+  __atomic_store_n(&dev->state, lbt ? SX126X_STATE_CAD : SX126X_STATE_TX, __ATOMIC_SEQ_CST);
+
+  // A command error means every frame still went out and SetTx may have been accepted. The TX
+  // then ends through the IRQ path: TxDone, or an abort once a rejected SetTx is seen.
+  st = sx126x_submit_frames(dev, frames, n);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    dev->tx_cb = NULL;
+    dev->tx_cb_arg = NULL;
+    __atomic_store_n(&dev->state, SX126X_STATE_STANDBY, __ATOMIC_SEQ_CST);
+    return st;
+  }
+
+  dev->tx_base = base;
+
+  return SX126X_OK;
+}
+
+// Convert a TX timeout in milliseconds to SetTx ticks, 0 meaning no timeout.
+static uint32_t sx126x_timeout_ticks(uint32_t timeout_ms)
+{
+  if (!timeout_ms)
+  {
+    return 0;
+  }
+
+  uint64_t ticks = (uint64_t)timeout_ms * SX126X_TIMEOUT_TICKS_PER_MS;
+  return ticks > SX126X_TIMEOUT_MAX_TICKS ? SX126X_TIMEOUT_MAX_TICKS : (uint32_t)ticks;
+}
+
+// Convert an RX timeout in microseconds to SetRx ticks, rounding up so that a non-zero timeout
+// never becomes 0 (no timeout).
+static uint32_t sx126x_rx_timeout_ticks(uint32_t timeout_us)
+{
+  uint64_t ticks = ((uint64_t)timeout_us * SX126X_TIMEOUT_TICKS_PER_MS + 999) / 1000;
+  return ticks > SX126X_TIMEOUT_MAX_TICKS ? SX126X_TIMEOUT_MAX_TICKS : (uint32_t)ticks;
+}
+
+// IRQs that end a reception, the only ones the RX completion read acknowledges.
+#define SX126X_RX_IRQ_MASK                                                                         \
+  (SX126X_IRQ_RX_DONE | SX126X_IRQ_CRC_ERR | SX126X_IRQ_HEADER_ERR | SX126X_IRQ_TIMEOUT)
+
+// Command bytes of the chained RX completion read. The packet always starts at RX base 0.
+static const uint8_t sx126x_rx_irq_cmd[] = {SX126X_OP_GET_IRQ_STATUS, 0x00, 0x00, 0x00};
+static const uint8_t sx126x_rx_clear_cmd[] = {
+    SX126X_OP_CLEAR_IRQ_STATUS, (SX126X_RX_IRQ_MASK >> 8) & 0xFF, SX126X_RX_IRQ_MASK & 0xFF};
+static const uint8_t sx126x_rx_buffer_cmd[] = {SX126X_OP_GET_RX_BUFFER_STATUS, 0x00, 0x00, 0x00};
+static const uint8_t sx126x_rx_status_cmd[] = {SX126X_OP_GET_PACKET_STATUS, 0x00, 0x00, 0x00, 0x00};
+static const uint8_t sx126x_rx_read_cmd[] = {SX126X_OP_READ_BUFFER, 0x00, 0x00};
+
+// Read and clear the IRQ status, the packet's location and status, and (when payload is set) the
+// first rx_prefetch_len bytes of it, all in one submission. Payload bytes land directly in pkt.
+// Without payload the packet is only acknowledged and none of it is read.
+static sx126x_status_t sx126x_rx_read(sx126x_t *dev, sx126x_rx_packet_t *pkt, bool payload)
+{
+  uint8_t irq_rx[sizeof(sx126x_rx_irq_cmd)];
+  uint8_t buf_rx[sizeof(sx126x_rx_buffer_cmd)];
+  uint8_t pkt_rx[sizeof(sx126x_rx_status_cmd)];
+  uint8_t read_rx[sizeof(sx126x_rx_read_cmd)];
+  uint8_t prefetch = payload ? dev->rx_prefetch_len : 0;
+
+  sx126x_bus_frame_t frames[] = {
+      {.tx = sx126x_rx_irq_cmd, .tx_len = sizeof(sx126x_rx_irq_cmd), .rx = irq_rx,
+       .rx_len = sizeof(irq_rx)},
+      {.tx = sx126x_rx_clear_cmd, .tx_len = sizeof(sx126x_rx_clear_cmd)},
+      {.tx = sx126x_rx_buffer_cmd, .tx_len = sizeof(sx126x_rx_buffer_cmd), .rx = buf_rx,
+       .rx_len = sizeof(buf_rx)},
+      {.tx = sx126x_rx_status_cmd, .tx_len = sizeof(sx126x_rx_status_cmd), .rx = pkt_rx,
+       .rx_len = sizeof(pkt_rx)},
+      {.tx = sx126x_rx_read_cmd, .tx_len = sizeof(sx126x_rx_read_cmd), .rx = read_rx,
+       .rx_len = sizeof(read_rx), .data_rx = pkt->payload, .data_len = prefetch},
+  };
+
+  // SX126X_ERR_CMD reports an earlier command; the data read back is still good.
+  sx126x_status_t st = sx126x_submit_frames(dev, frames, prefetch ? 5 : 4);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    return st;
+  }
+
+  pkt->irq = ((uint16_t)irq_rx[2] << 8) | irq_rx[3];
+  pkt->len = 0;
+
+  if (!(pkt->irq & SX126X_IRQ_RX_DONE) ||
+      (pkt->irq & (SX126X_IRQ_CRC_ERR | SX126X_IRQ_HEADER_ERR)))
+  {
+    return st;
+  }
+
+  uint8_t len = buf_rx[2];
+  uint8_t start = buf_rx[3];
+  uint8_t have = 0;
+
+  sx126x_decode_packet_status(dev, pkt_rx, pkt);
+
+  // The prefetched bytes are only the packet's if it starts where the speculative read did.
+  if (start == sx126x_rx_read_cmd[1])
+    have = len < prefetch ? len : prefetch;
+
+  if (payload && have < len)
+  {
+    // Longer than the previous packet: fetch the tail.
+    uint8_t tail_tx[] = {SX126X_OP_READ_BUFFER, (uint8_t)(start + have), 0x00};
+    sx126x_bus_frame_t tail = {.tx = tail_tx,
+                               .tx_len = sizeof(tail_tx),
+                               .rx = read_rx,
+                               .rx_len = sizeof(read_rx),
+                               .data_rx = &pkt->payload[have],
+                               .data_len = (size_t)(len - have)};
+    sx126x_status_t tail_st = sx126x_submit_frames(dev, &tail, 1);
+    if (tail_st != SX126X_OK && tail_st != SX126X_ERR_CMD)
+    {
+      return tail_st;
+    }
+  }
+
+  pkt->len = len;
+
+  // Senders tend to repeat frame sizes, so the next read is sized after this one.
+  if (payload)
+    dev->rx_prefetch_len = len;
+
+  return st;
+}
+
+// Move one received packet from the chip into the RX ring. Never blocks on the consumer.
+static sx126x_status_t sx126x_drain_rx(sx126x_t *dev)
+{
+  sx126x_rx_packet_t *slot = sx126x_rx_ring_acquire(dev->rx_ring);
+  sx126x_rx_packet_t discard;
+
+  // With the ring full the IRQ must still be read and cleared, but the payload is not needed.
+  sx126x_status_t st = sx126x_rx_read(dev, slot ? slot : &discard, slot != NULL);
+  if (st != SX126X_OK && st != SX126X_ERR_CMD)
+  {
+    dev->rx_stats.bus_errors++;
+    return st;
+  }
+
+  if (st == SX126X_ERR_CMD && dev->error_opcode == SX126X_OP_SET_RX)
+  {
+    // A rejected SetRx never raises an IRQ, so reception ends here.
+    SX126X_LOG_ERROR(dev->bus, "RX was rejected by the chip.");
+    if (dev->rx_single)
+    {
+      sx126x_complete_rx(dev, st);
+    }
+    else
+    {
+      dev->rx_ring = NULL;
+      dev->state = SX126X_STATE_STANDBY;
+    }
+    return st;
+  }
+
+  uint16_t irq = slot ? slot->irq : discard.irq;
+  sx126x_status_t result = SX126X_ERR_TIMEOUT;
+
+  if (irq & SX126X_IRQ_RX_DONE)
+  {
+    if (irq & (SX126X_IRQ_CRC_ERR | SX126X_IRQ_HEADER_ERR))
+    {
+      dev->rx_stats.crc_errors++;
+    }
+    else if (!slot)
+    {
+      dev->rx_stats.overruns++;
+      result = SX126X_ERR_NO_MEM;
+    }
+    else
+    {
+      sx126x_rx_ring_commit(dev->rx_ring);
+      dev->rx_stats.received++;
+      result = SX126X_OK;
+    }
+  }
+
+  // A single window closes with its first packet, its timeout or a header error. The chip falls
+  // back to standby by itself except after a header error.
+  if (dev->rx_single &&
+      (irq & (SX126X_IRQ_RX_DONE | SX126X_IRQ_TIMEOUT | SX126X_IRQ_HEADER_ERR)))
+  {
+    if (!(irq & (SX126X_IRQ_RX_DONE | SX126X_IRQ_TIMEOUT)))
+    {
+      sx126x_status_t stby_st = sx126x_set_standby(dev, SX126X_STBY_RC);
+      if (stby_st != SX126X_OK && st == SX126X_OK)
+        st = stby_st;
+    }
+    sx126x_complete_rx(dev, result);
+  }
+
+  return st;
+}
+
+// Close a single receive window and report how it ended.
+static void sx126x_complete_rx(sx126x_t *dev, sx126x_status_t result)
+{
+  sx126x_rx_done_cb_t cb = dev->rx_cb;
+  void *arg = dev->rx_cb_arg;
+
+  dev->rx_cb = NULL;
+  dev->rx_cb_arg = NULL;
+  dev->rx_ring = NULL;
+  dev->rx_single = false;
+  __atomic_store_n(&dev->state, SX126X_STATE_STANDBY, __ATOMIC_SEQ_CST);
+
+  if (cb)
+    cb(dev, result, arg);
+}
+
+// End a CAD that did not go on to TX or RX, reporting through the callback of the operation that
+// started it.
+static void sx126x_complete_cad(sx126x_t *dev, sx126x_status_t result)
+{
+  if (dev->cad_exit == SX126X_CAD_EXIT_LBT)
+  {
+    sx126x_complete_tx(dev, result);
+    return;
+  }
+
+  if (dev->cad_exit == SX126X_CAD_EXIT_RX)
+  {
+    sx126x_complete_rx(dev, result);
+    return;
+  }
+
+  sx126x_cad_done_cb_t cb = dev->cad_cb;
+  void *arg = dev->cad_cb_arg;
+
+  dev->cad_cb = NULL;
+  dev->cad_cb_arg = NULL;
+  __atomic_store_n(&dev->state, SX126X_STATE_STANDBY, __ATOMIC_SEQ_CST);
+
+  if (cb)
+    cb(dev, result, arg);
+}
+
+// Follow the chip out of a finished CAD. A chained TX or RX has already started by itself when
+// the CAD found what it was waiting for.
+static sx126x_status_t sx126x_cad_done(sx126x_t *dev, uint16_t irq)
+{
+  bool is_busy = (irq & SX126X_IRQ_CAD_DETECTED) != 0;
+
+  if (dev->cad_exit == SX126X_CAD_EXIT_LBT && !is_busy)
+  {
+    if (irq & SX126X_IRQ_TX_DONE)
+      sx126x_complete_tx(dev, SX126X_OK);
+    else if (irq & SX126X_IRQ_TIMEOUT)
+      sx126x_complete_tx(dev, SX126X_ERR_TIMEOUT);
+    else
+      __atomic_store_n(&dev->state, SX126X_STATE_TX, __ATOMIC_SEQ_CST);
+    return SX126X_OK;
+  }
+
+  if (dev->cad_exit == SX126X_CAD_EXIT_RX && is_busy)
+  {
+    __atomic_store_n(&dev->state, SX126X_STATE_RX, __ATOMIC_SEQ_CST);
+    if (irq & ~(SX126X_IRQ_CAD_DONE | SX126X_IRQ_CAD_DETECTED))
+      return sx126x_drain_rx(dev);
+    return SX126X_OK;
+  }
+
+  if (dev->cad_exit == SX126X_CAD_EXIT_RX)
+    sx126x_complete_cad(dev, SX126X_ERR_TIMEOUT);
+  else
+    sx126x_complete_cad(dev, is_busy ? SX126X_ERR_CHANNEL_BUSY : SX126X_OK);
+
+  return SX126X_OK;
+}
+
+// Fill in RSSI and SNR from the GetPacketStatus response.
+static void sx126x_decode_packet_status(const sx126x_t *dev,
+                                        const uint8_t *status,
+                                        sx126x_rx_packet_t *pkt)
+{
+  if (dev->modem == SX126X_MODEM_FSK)
+  {
+    // GFSK reports RxStatus, RssiSync and RssiAvg; there is no SNR estimate.
+    pkt->rssi_dbm = -(int16_t)status[4] / 2;
+    pkt->snr_db = 0;
+    pkt->signal_rssi_dbm = -(int16_t)status[3] / 2;
+  }
+  else
+  {
+    pkt->rssi_dbm = -(int16_t)status[2] / 2;
+    pkt->snr_db = (int8_t)((int8_t)status[3] / 4);
+    pkt->signal_rssi_dbm = -(int16_t)status[4] / 2;
+  }
+}
+
+// Trampoline registered with bus->attach_dio1.
+static void sx126x_dio1_handler(void *arg)
+{
+  sx126x_handle_irq((sx126x_t *)arg);
+}
+
+// Enter the bus critical section around one logical operation. Buses without hooks rely on the
+// HAL's per-transfer locking.
+static sx126x_status_t sx126x_bus_lock(sx126x_bus_t *bus)
+{
+  if (!bus || !bus->lock || !bus->unlock)
+  {
+    return SX126X_OK;
+  }
+
+  return bus->lock(bus);
+}
+
+static void sx126x_bus_unlock(sx126x_bus_t *bus)
+{
+  if (bus && bus->lock && bus->unlock)
+    bus->unlock(bus);
+}
+
+// Single point through which every command reaches the bus.
+static sx126x_status_t
+sx126x_bus_xfer(sx126x_t *dev, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len)
+{
+  // Write-only commands still clock the status byte back; keep it instead of dropping MISO.
+  uint8_t status_rx[SX126X_STATUS_RX_LEN];
+  if (!rx)
+  {
+    rx = status_rx;
+    rx_len = tx_len < sizeof(status_rx) ? tx_len : sizeof(status_rx);
+  }
+
+  // Taken before the transfer, which may overwrite tx when it is also the rx buffer.
+  uint8_t opcode = tx_len ? tx[0] : SX126X_STATS_OPCODE_OTHER;
+
+#if SX126X_ENABLE_STATS
+  uint32_t start = sx126x_now_us(dev);
+#endif
+
+  sx126x_status_t xfer_st = dev->bus->transfer(dev->bus, tx, tx_len, rx, rx_len);
+  sx126x_status_t st = xfer_st;
+  if (st == SX126X_OK)
+    st = sx126x_check_status(dev, opcode, tx_len, rx, rx_len);
+
+#if SX126X_ENABLE_STATS
+  // A command error in the status byte belongs to the previous command, already counted in
+  // cmd_errors against error_opcode; only the transfer itself is charged to this opcode.
+  uint32_t elapsed = sx126x_now_us(dev) - start;
+  sx126x_stats_record_call(&dev->stats, false, elapsed, xfer_st == SX126X_OK);
+  sx126x_stats_record_frame(
+      &dev->stats, opcode, tx_len > rx_len ? tx_len : rx_len, elapsed, xfer_st == SX126X_OK);
+#endif
+
+  // After a failed command the chip's settings can no longer be trusted to match the shadow.
+  if (st != SX126X_OK)
+    dev->shadow_valid = false;
+
+  return st;
+}
+
+// Clock a frame with a payload phase through plain transfer calls, which cannot gather: the
+// command and payload are staged in one buffer. Only for HALs without transfer_batch.
+static sx126x_status_t sx126x_bus_xfer_staged(sx126x_t *dev, const sx126x_bus_frame_t *frame)
+{
+  size_t cmd_len = frame->tx_len > frame->rx_len ? frame->tx_len : frame->rx_len;
+  size_t len = cmd_len + frame->data_len;
+  uint8_t stage[SX126X_STAGE_MAX_LEN];
+
+  // The core never moves payload in both directions at once.
+  if (len > sizeof(stage) || (frame->data_tx && frame->data_rx) || !frame->tx_len)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (frame->data_tx)
+  {
+    memset(stage, 0x00, cmd_len);
+    memcpy(stage, frame->tx, frame->tx_len);
+    memcpy(&stage[cmd_len], frame->data_tx, frame->data_len);
+    return sx126x_bus_xfer(dev, stage, len, frame->rx, frame->rx_len);
+  }
+
+  sx126x_status_t st = sx126x_bus_xfer(dev, frame->tx, frame->tx_len, stage, len);
+  if (st == SX126X_OK || st == SX126X_ERR_CMD)
+  {
+    if (frame->rx)
+      memcpy(frame->rx, stage, frame->rx_len);
+    if (frame->data_rx)
+      memcpy(frame->data_rx, &stage[cmd_len], frame->data_len);
+  }
+
+  return st;
+}
+
+// Cache the status byte of a completed frame and report a failure of the command before it.
+static sx126x_status_t
+sx126x_check_status(sx126x_t *dev, uint8_t opcode, size_t tx_len, const uint8_t *rx, size_t rx_len)
+{
+  // The status byte is the second one on MISO; the first is clocked during the opcode.
+  if (tx_len < SX126X_STATUS_RX_LEN || rx_len < SX126X_STATUS_RX_LEN)
+  {
+    return SX126X_OK;
+  }
+
+  uint8_t prev_opcode = dev->status_opcode;
+  dev->status = rx[1];
+  dev->status_opcode = opcode;
+
+  switch (SX126X_STATUS_CMD_STATUS(rx[1]))
+  {
+  case SX126X_CMD_STATUS_TIMEOUT:
+  case SX126X_CMD_STATUS_PROCESSING_ERROR:
+  case SX126X_CMD_STATUS_EXEC_FAILURE:
+    dev->cmd_errors++;
+    dev->error_opcode = prev_opcode;
+    SX126X_LOG_WARN(dev->bus,
+                    "Command 0x%02x failed (status 0x%02x).",
+                    (unsigned)prev_opcode,
+                    (unsigned)rx[1]);
+    return SX126X_ERR_CMD;
+
+  default:
+    return SX126X_OK;
+  }
+}
+
+#if SX126X_ENABLE_STATS
+// Monotonic timestamp for latency accounting, 0 on buses without a clock.
+static uint32_t sx126x_now_us(sx126x_t *dev)
+{
+  return dev->bus->now_us ? dev->bus->now_us(dev->bus) : 0;
+}
+#endif
+
+// Send a sequence of frames, as a single batch when the bus supports it. At most
+// SX126X_BATCH_MAX_FRAMES frames per call.
+static sx126x_status_t
+sx126x_submit_frames(sx126x_t *dev, const sx126x_bus_frame_t *frames, size_t count)
+{
+  sx126x_bus_t *bus = dev->bus;
+
+  if (bus->transfer_batch)
+  {
+    // Give write-only frames somewhere to put their status byte, and note every opcode before
+    // in-place frames overwrite it.
+    sx126x_bus_frame_t framed[SX126X_BATCH_MAX_FRAMES];
+    uint8_t status_rx[SX126X_BATCH_MAX_FRAMES][SX126X_STATUS_RX_LEN];
+    uint8_t opcodes[SX126X_BATCH_MAX_FRAMES];
+    for (size_t i = 0; i < count; i++)
+    {
+      framed[i] = frames[i];
+      opcodes[i] = framed[i].tx_len ? framed[i].tx[0] : SX126X_STATS_OPCODE_OTHER;
+      if (!framed[i].rx)
+      {
+        framed[i].rx = status_rx[i];
+        framed[i].rx_len = framed[i].tx_len < SX126X_STATUS_RX_LEN ? framed[i].tx_len
+                                                                   : SX126X_STATUS_RX_LEN;
+      }
+    }
+    frames = framed;
+
+#if SX126X_ENABLE_STATS
+    uint32_t start = sx126x_now_us(dev);
+#endif
+
+    sx126x_status_t xfer_st = bus->transfer_batch(bus, frames, count);
+    sx126x_status_t st = xfer_st;
+
+    // Walk every status byte in order; the first failure reported is the one returned.
+    for (size_t i = 0; st == SX126X_OK && i < count; i++)
+    {
+      sx126x_status_t cmd_st =
+          sx126x_check_status(dev, opcodes[i], frames[i].tx_len, frames[i].rx, frames[i].rx_len);
+      if (cmd_st != SX126X_OK)
+      {
+        for (i++; i < count; i++)
+          sx126x_check_status(dev, opcodes[i], frames[i].tx_len, frames[i].rx, frames[i].rx_len);
+        st = cmd_st;
+      }
+    }
+
+#if SX126X_ENABLE_STATS
+    uint32_t elapsed = sx126x_now_us(dev) - start;
+    sx126x_stats_record_call(&dev->stats, true, elapsed, xfer_st == SX126X_OK);
+    for (size_t i = 0; i < count; i++)
+    {
+      const sx126x_bus_frame_t *f = &frames[i];
+      sx126x_stats_record_frame(&dev->stats,
+                                opcodes[i],
+                                (f->tx_len > f->rx_len ? f->tx_len : f->rx_len) + f->data_len,
+                                elapsed / (uint32_t)count,
+                                xfer_st == SX126X_OK);
+    }
+#endif
+
+    if (st != SX126X_OK)
+      dev->shadow_valid = false;
+    return st;
+  }
+
+  // Fallback for HALs without a batch entry point: one transfer per frame. A failed command does
+  // not stop the sequence, matching what a batch does on the wire.
+  sx126x_status_t result = SX126X_OK;
+  for (size_t i = 0; i < count; i++)
+  {
+    const sx126x_bus_frame_t *f = &frames[i];
+    sx126x_status_t st = f->data_len ? sx126x_bus_xfer_staged(dev, f)
+                                     : sx126x_bus_xfer(dev, f->tx, f->tx_len, f->rx, f->rx_len);
+    if (st == SX126X_ERR_CMD)
+    {
+      if (result == SX126X_OK)
+        result = st;
+    }
+    else if (st != SX126X_OK)
+    {
+      return st;
+    }
+  }
+
+  return result;
+}
+
+// Send a single command frame to the chip.
+static sx126x_status_t sx126x_write_cmd(sx126x_t *dev, const sx126x_cmd_t *cmd)
+{
+  return sx126x_bus_xfer(dev, cmd->buf, cmd->len, NULL, 0);
+}
+
+// Wake the chip through the HAL's wake hook, or with a bare wake frame on buses without one.
+static sx126x_status_t sx126x_bus_wake(sx126x_t *dev)
+{
+  if (dev->bus->wake)
+  {
+    return dev->bus->wake(dev->bus);
+  }
+
+  sx126x_cmd_t cmd;
+  sx126x_encode_wake(&cmd);
+  return sx126x_write_cmd(dev, &cmd);
+}
+
+// Send a sequence of command frames, as a single batch when the bus supports it.
+static sx126x_status_t
+sx126x_submit_cmds(sx126x_t *dev, const sx126x_cmd_t *cmds, size_t count)
+{
+  sx126x_bus_frame_t frames[SX126X_BATCH_MAX_FRAMES];
+  sx126x_status_t result = SX126X_OK;
+
+  while (count > 0)
+  {
+    size_t n = count < SX126X_BATCH_MAX_FRAMES ? count : SX126X_BATCH_MAX_FRAMES;
+    for (size_t i = 0; i < n; i++)
+    {
+      frames[i] = (sx126x_bus_frame_t){.tx = cmds[i].buf, .tx_len = cmds[i].len};
+    }
+
+    sx126x_status_t st = sx126x_submit_frames(dev, frames, n);
+    if (st == SX126X_ERR_CMD)
+    {
+      if (result == SX126X_OK)
+        result = st;
+    }
+    else if (st != SX126X_OK)
+    {
+      return st;
+    }
+
+    cmds += n;
+    count -= n;
+  }
+
+  return result;
+}
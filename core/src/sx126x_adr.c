@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/adr.h"
+#include "sx126x/airtime.h"
+#include "sx126x/rx_ring.h"
+#include "sx126x/sx126x.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bandwidth codes that name a LoRa bandwidth.
+#define SX126X_ADR_BW_VALID 0x077Fu
+
+// Thermal noise over 125 kHz, -174 dBm/Hz + 51 dB, in 0.1 dB.
+#define SX126X_ADR_NOISE_125K_DB10 (-1230)
+
+// Each bandwidth relative to 125 kHz, in 0.1 dB, indexed by bandwidth code.
+static const int16_t sx126x_adr_bw_db10[] = {
+    [SX126X_LORA_BW_7] = -120,
+    [SX126X_LORA_BW_15] = -90,
+    [SX126X_LORA_BW_32] = -60,
+    [SX126X_LORA_BW_62] = -30,
+    [SX126X_LORA_BW_125] = 0,
+    [SX126X_LORA_BW_250] = 30,
+    [SX126X_LORA_BW_500] = 60,
+    [SX126X_LORA_BW_10] = -108,
+    [SX126X_LORA_BW_20] = -78,
+    [SX126X_LORA_BW_41] = -48,
+};
+
+// Demodulator SNR floor in 0.1 dB: -7.5 dB at SF7, 2.5 dB lower per step.
+static int16_t sx126x_adr_floor_db10(sx126x_lora_spreading_factor_t sf)
+{
+  return (int16_t)(-25 * ((int)sf - 4));
+}
+
+// Smallest integer at or above num / 10.
+static int sx126x_adr_ceil_div10(int num)
+{
+  return num >= 0 ? (num + 9) / 10 : -(-num / 10);
+}
+
+// An allowed bandwidth narrower than bw, the next one down, or with any set the narrowest of all.
+// A larger divider is a narrower bandwidth.
+static bool sx126x_adr_narrower(const sx126x_adr_t *adr,
+                                sx126x_lora_bandwidth_t bw,
+                                bool any,
+                                sx126x_lora_bandwidth_t *out)
+{
+  uint32_t best_div = 0;
+
+  for (uint32_t code = 0; code < 16; code++)
+  {
+    uint32_t div = SX126X_LORA_BW_DIV(code);
+    if (!(adr->cfg.bw_mask & SX126X_ADR_BW(code)) || (!any && div <= SX126X_LORA_BW_DIV(bw)))
+      continue;
+
+    if (best_div == 0 || (any ? div > best_div : div < best_div))
+    {
+      best_div = div;
+      *out = (sx126x_lora_bandwidth_t)code;
+    }
+  }
+
+  return best_div != 0;
+}
+
+static bool sx126x_adr_set(sx126x_adr_t *adr,
+                           sx126x_adr_peer_t *peer,
+                           const sx126x_adr_setting_t *setting)
+{
+  if (peer->setting.sf == setting->sf && peer->setting.bw == setting->bw &&
+      peer->setting.power_dbm == setting->power_dbm)
+    return false;
+
+  peer->setting = *setting;
+  adr->stats.changes++;
+  return true;
+}
+
+static void sx126x_adr_robust(const sx126x_adr_t *adr, sx126x_adr_setting_t *setting)
+{
+  setting->sf = adr->cfg.sf_max;
+  setting->power_dbm = adr->cfg.power_max_dbm;
+  sx126x_adr_narrower(adr, SX126X_LORA_BW_125, true, &setting->bw);
+}
+
+sx126x_status_t sx126x_adr_init(sx126x_adr_t *adr, sx126x_t *radio, const sx126x_adr_cfg_t *cfg)
+{
+  if (!adr || !radio || !cfg)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!radio->is_initialized || radio->shadow.modem != SX126X_MODEM_LORA)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  if (cfg->sf_min < SX126X_LORA_SF_5 || cfg->sf_max > SX126X_LORA_SF_12 ||
+      cfg->sf_min > cfg->sf_max || (cfg->bw_mask & ~SX126X_ADR_BW_VALID) ||
+      cfg->power_min_dbm > cfg->power_max_dbm || cfg->payload_len == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  adr->radio = radio;
+  adr->cfg = *cfg;
+  if (adr->cfg.bw_mask == 0)
+    adr->cfg.bw_mask = (uint16_t)SX126X_ADR_BW(radio->shadow.lora_bw);
+  if (adr->cfg.power_step_db == 0)
+    adr->cfg.power_step_db = 1;
+  adr->stats = (sx126x_adr_stats_t){0};
+
+  return SX126X_OK;
+}
+
+void sx126x_adr_peer_init(const sx126x_adr_t *adr, sx126x_adr_peer_t *peer)
+{
+  if (!adr || !peer)
+    return;
+
+  *peer = (sx126x_adr_peer_t){0};
+  sx126x_adr_robust(adr, &peer->setting);
+}
+
+void sx126x_adr_record(sx126x_adr_t *adr, sx126x_adr_peer_t *peer, const sx126x_rx_packet_t *pkt)
+{
+  if (!adr || !peer || !pkt)
+    return;
+
+  // Undo the bandwidth and power the packet was sent with.
+  int power_db10 = peer->setting.power_dbm * 10;
+  int link = pkt->snr_db * 10 + sx126x_adr_bw_db10[peer->setting.bw] - power_db10;
+
+  // At high SNR the estimate saturates, but the RSSI over the noise floor keeps rising with the
+  // signal. The bandwidth drops out, as it widens the noise floor and the SNR alike.
+  if (pkt->snr_db >= SX126X_ADR_SNR_SATURATION_DB)
+  {
+    int floor = SX126X_ADR_NOISE_125K_DB10 + SX126X_ADR_NOISE_FIGURE_DB * 10;
+    int from_rssi = pkt->signal_rssi_dbm * 10 - floor - power_db10;
+    if (from_rssi > link)
+      link = from_rssi;
+  }
+
+  peer->link_db10[peer->next] = (int16_t)link;
+  peer->rssi_dbm[peer->next] = pkt->rssi_dbm;
+  peer->next = (uint8_t)((peer->next + 1) % SX126X_ADR_HISTORY);
+  if (peer->count < SX126X_ADR_HISTORY)
+    peer->count++;
+  peer->losses = 0;
+  adr->stats.samples++;
+}
+
+bool sx126x_adr_lost(sx126x_adr_t *adr, sx126x_adr_peer_t *peer)
+{
+  if (!adr || !peer || adr->cfg.loss_limit == 0)
+    return false;
+
+  if (++peer->losses < adr->cfg.loss_limit)
+    return false;
+
+  // The history no longer describes the link.
+  peer->losses = 0;
+  peer->count = 0;
+  peer->next = 0;
+
+  sx126x_adr_setting_t next = peer->setting;
+  if (next.power_dbm < adr->cfg.power_max_dbm)
+    next.power_dbm = adr->cfg.power_max_dbm;
+  else if (next.sf < adr->cfg.sf_max)
+    next.sf = (sx126x_lora_spreading_factor_t)(next.sf + 1);
+  else
+    sx126x_adr_narrower(adr, next.bw, false, &next.bw);
+
+  if (!sx126x_adr_set(adr, peer, &next))
+    return false;
+
+  adr->stats.step_backs++;
+  return true;
+}
+
+bool sx126x_adr_update(sx126x_adr_t *adr, sx126x_adr_peer_t *peer)
+{
+  if (!adr || !peer || peer->count == 0 || peer->count < adr->cfg.min_samples)
+    return false;
+
+  int32_t sum = 0;
+  for (uint8_t i = 0; i < peer->count; i++)
+    sum += peer->link_db10[i];
+  int link = (int)(sum / peer->count);
+
+  const sx126x_adr_cfg_t *cfg = &adr->cfg;
+  sx126x_config_t trial = adr->radio->shadow;
+  sx126x_adr_setting_t best;
+  uint32_t best_us = UINT32_MAX;
+
+  sx126x_adr_robust(adr, &best);
+
+  for (int sf = cfg->sf_min; sf <= (int)cfg->sf_max; sf++)
+  {
+    for (uint32_t bw = 0; bw < 16; bw++)
+    {
+      if (!(cfg->bw_mask & SX126X_ADR_BW(bw)))
+        continue;
+
+      // Lowest power, on the power_step_db grid, at which the predicted SNR keeps the margin.
+      int need_db10 = sx126x_adr_floor_db10((sx126x_lora_spreading_factor_t)sf) +
+                      cfg->margin_db * 10 + sx126x_adr_bw_db10[bw] - link;
+      int power = sx126x_adr_ceil_div10(need_db10);
+      if (power < cfg->power_min_dbm)
+        power = cfg->power_min_dbm;
+      int steps = (power - cfg->power_min_dbm + cfg->power_step_db - 1) / cfg->power_step_db;
+      power = cfg->power_min_dbm + steps * cfg->power_step_db;
+      if (power > cfg->power_max_dbm)
+        continue;
+
+      trial.lora_sf = (sx126x_lora_spreading_factor_t)sf;
+      trial.lora_bw = (sx126x_lora_bandwidth_t)bw;
+      uint32_t us = sx126x_time_on_air_us(&trial, cfg->payload_len);
+
+      if (us < best_us || (us == best_us && power < best.power_dbm))
+      {
+        best_us = us;
+        best.sf = trial.lora_sf;
+        best.bw = trial.lora_bw;
+        best.power_dbm = (int8_t)power;
+      }
+    }
+  }
+
+  return sx126x_adr_set(adr, peer, &best);
+}
+
+sx126x_status_t sx126x_adr_apply(sx126x_adr_t *adr, const sx126x_adr_peer_t *peer)
+{
+  if (!adr || !adr->radio || !peer)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  const sx126x_config_t *now = &adr->radio->shadow;
+  if (now->lora_sf == peer->setting.sf && now->lora_bw == peer->setting.bw &&
+      now->power_dbm == peer->setting.power_dbm)
+  {
+    return SX126X_OK;
+  }
+
+  sx126x_config_t cfg = *now;
+  cfg.lora_sf = peer->setting.sf;
+  cfg.lora_bw = peer->setting.bw;
+  cfg.power_dbm = peer->setting.power_dbm;
+
+  adr->stats.applied++;
+  return sx126x_reconfigure(adr->radio, &cfg);
+}
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/aggregate.h"
+#include "sx126x/airtime.h"
+#include "sx126x/commands.h"
+#include "sx126x/sx126x.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static void sx126x_agg_clear(sx126x_agg_t *agg)
+{
+  agg->len = 0;
+  agg->count = 0;
+  agg->single_us = 0;
+  agg->ready = false;
+}
+
+// Mark the frame as due, counting the first reason it became so.
+static void sx126x_agg_due(sx126x_agg_t *agg, uint32_t *reason)
+{
+  if (agg->ready || agg->count == 0)
+    return;
+
+  agg->ready = true;
+  (*reason)++;
+}
+
+// Start the frame if it is due and the radio is free.
+static bool sx126x_agg_send(sx126x_agg_t *agg)
+{
+  if (!agg->ready || !sx126x_is_idle(agg->radio))
+    return false;
+
+  uint32_t airtime_us = sx126x_time_on_air_us(&agg->radio->shadow, agg->len);
+  sx126x_status_t st =
+      sx126x_transmit_async(agg->radio, agg->frame, agg->len, 0, agg->cfg.done, agg->cfg.arg);
+
+  if (st == SX126X_ERR_BUSY)
+    return false;
+
+  if (st != SX126X_OK)
+  {
+    agg->stats.failed++;
+    sx126x_agg_clear(agg);
+    if (agg->cfg.done)
+      agg->cfg.done(agg->radio, st, agg->cfg.arg);
+    return false;
+  }
+
+  // The frame is in the chip's buffer, so the next one may be filled right away.
+  agg->stats.frames++;
+  agg->stats.airtime_us += airtime_us;
+  agg->stats.single_us += agg->single_us;
+  sx126x_agg_clear(agg);
+
+  return true;
+}
+
+sx126x_status_t sx126x_agg_init(sx126x_agg_t *agg, sx126x_t *radio, const sx126x_agg_cfg_t *cfg)
+{
+  if (!agg || !radio || !cfg || cfg->max_len == 1 || cfg->overhead_pct > 100)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!radio->is_initialized)
+  {
+    return SX126X_ERR_NOT_INIT;
+  }
+
+  agg->radio = radio;
+  agg->cfg = *cfg;
+  if (agg->cfg.max_len == 0)
+    agg->cfg.max_len = SX126X_MAX_PAYLOAD_LEN;
+  agg->stats = (sx126x_agg_stats_t){0};
+  sx126x_agg_clear(agg);
+
+  return SX126X_OK;
+}
+
+sx126x_status_t sx126x_agg_add(sx126x_agg_t *agg, const uint8_t *msg, uint8_t len, uint32_t now_us)
+{
+  if (!agg || !agg->radio || !msg || len == 0 || len > agg->cfg.max_len - SX126X_AGG_PREFIX_LEN)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (agg->len + SX126X_AGG_PREFIX_LEN + len > agg->cfg.max_len)
+  {
+    sx126x_agg_due(agg, &agg->stats.flush_size);
+    sx126x_agg_send(agg);
+
+    // Still full: the radio has yet to finish the previous frame.
+    if (agg->count)
+    {
+      return SX126X_ERR_BUSY;
+    }
+  }
+
+  if (agg->count == 0)
+    agg->first_us = now_us;
+
+  const sx126x_config_t *cfg = &agg->radio->shadow;
+  agg->frame[agg->len] = len;
+  memcpy(&agg->frame[agg->len + SX126X_AGG_PREFIX_LEN], msg, len);
+  agg->len = (uint8_t)(agg->len + SX126X_AGG_PREFIX_LEN + len);
+  agg->count++;
+  agg->single_us += sx126x_time_on_air_us(cfg, len);
+  agg->stats.messages++;
+
+  // Once the fixed cost is a small enough share, waiting for more messages gains little.
+  if (agg->cfg.overhead_pct)
+  {
+    uint64_t fixed_us = sx126x_time_on_air_us(cfg, 0);
+    uint64_t total_us = sx126x_time_on_air_us(cfg, agg->len);
+    if (fixed_us * 100 <= total_us * agg->cfg.overhead_pct)
+      sx126x_agg_due(agg, &agg->stats.flush_overhead);
+  }
+
+  if (agg->cfg.max_delay_us == 0)
+    sx126x_agg_due(agg, &agg->stats.flush_deadline);
+
+  sx126x_agg_send(agg);
+
+  return SX126X_OK;
+}
+
+bool sx126x_agg_flush(sx126x_agg_t *agg)
+{
+  if (!agg || !agg->radio)
+    return false;
+
+  sx126x_agg_due(agg, &agg->stats.flush_explicit);
+  return sx126x_agg_send(agg);
+}
+
+bool sx126x_agg_poll(sx126x_agg_t *agg, uint32_t now_us, uint32_t *wait_us)
+{
+  uint32_t wait = UINT32_MAX;
+  bool is_started = false;
+
+  if (agg && agg->radio && agg->count)
+  {
+    uint32_t waited = now_us - agg->first_us;
+    if (waited >= agg->cfg.max_delay_us)
+      sx126x_agg_due(agg, &agg->stats.flush_deadline);
+
+    is_started = sx126x_agg_send(agg);
+    if (agg->count)
+      wait = agg->ready ? 0 : agg->cfg.max_delay_us - waited;
+  }
+
+  if (wait_us)
+    *wait_us = wait;
+
+  return is_started;
+}
+
+void sx126x_agg_iter_init(sx126x_agg_iter_t *it, const uint8_t *frame, uint8_t len)
+{
+  if (!it)
+    return;
+
+  it->frame = frame;
+  it->len = frame ? len : 0;
+  it->pos = 0;
+}
+
+bool sx126x_agg_next(sx126x_agg_iter_t *it, const uint8_t **msg, uint8_t *len)
+{
+  if (!it || !msg || !len || it->pos >= it->len)
+    return false;
+
+  uint8_t n = it->frame[it->pos];
+  uint32_t end = (uint32_t)it->pos + SX126X_AGG_PREFIX_LEN + n;
+  if (n == 0 || end > it->len)
+    return false;
+
+  *msg = &it->frame[it->pos + SX126X_AGG_PREFIX_LEN];
+  *len = n;
+  it->pos = (uint8_t)end;
+
+  return true;
+}
@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/airtime.h"
+#include "sx126x/commands.h"
+#include "sx126x/sx126x.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// One symbol lasts 2^SF * div / 32 MHz, i.e. (2^SF * div * 125) / 4 ns, with div from
+// SX126X_LORA_BW_DIV.
+static uint32_t sx126x_lora_div(sx126x_lora_bandwidth_t bw)
+{
+  return SX126X_LORA_BW_DIV(bw);
+}
+
+uint32_t sx126x_lora_symbol_ns(sx126x_lora_spreading_factor_t sf, sx126x_lora_bandwidth_t bw)
+{
+  uint32_t div = sx126x_lora_div(bw);
+  if (sf < SX126X_LORA_SF_5 || sf > SX126X_LORA_SF_12 || div == 0)
+  {
+    return 0;
+  }
+
+  return ((uint32_t)div << sf) / 4 * 125;
+}
+
+bool sx126x_lora_ldro_enabled(const sx126x_config_t *cfg)
+{
+  if (cfg->lora_ldro)
+  {
+    return true;
+  }
+
+  return sx126x_lora_symbol_ns(cfg->lora_sf, cfg->lora_bw) > SX126X_LORA_LDRO_SYMBOL_NS;
+}
+
+static uint32_t sx126x_lora_time_on_air_us(const sx126x_config_t *cfg, uint8_t payload_len)
+{
+  int sf = cfg->lora_sf;
+  uint32_t div = sx126x_lora_div(cfg->lora_bw);
+  if (sf < SX126X_LORA_SF_5 || sf > SX126X_LORA_SF_12 || div == 0)
+  {
+    return 0;
+  }
+
+  // Long-interleaved coding rates carry the same redundancy as their plain counterparts.
+  int cr;
+  switch (cfg->lora_cr)
+  {
+  case SX126X_LORA_CR_4_5:
+  case SX126X_LORA_CR_4_5_LI:
+    cr = 1;
+    break;
+  case SX126X_LORA_CR_4_6:
+  case SX126X_LORA_CR_4_6_LI:
+    cr = 2;
+    break;
+  case SX126X_LORA_CR_4_7:
+    cr = 3;
+    break;
+  case SX126X_LORA_CR_4_8:
+  case SX126X_LORA_CR_4_8_LI:
+    cr = 4;
+    break;
+  default:
+    return 0;
+  }
+
+  bool is_long_sf = sf >= SX126X_LORA_SF_7;
+  uint32_t preamble =
+      cfg->lora_preamble_len ? cfg->lora_preamble_len : SX126X_LORA_PREAMBLE_DEFAULT;
+
+  // Payload bits left over after the 8 symbols sent at the header's coding rate. SF5/6 carry two
+  // fewer symbols of header overhead; an explicit header adds 20 bits.
+  int32_t bits = 8 * (int32_t)payload_len - 4 * sf + (cfg->lora_crc_on ? 16 : 0) +
+                 (is_long_sf ? 8 : 0) + (cfg->lora_implicit_header ? 0 : 20);
+  int32_t bits_per_block = 4 * (is_long_sf && sx126x_lora_ldro_enabled(cfg) ? sf - 2 : sf);
+  uint32_t payload_syms = 8;
+  if (bits > 0)
+    payload_syms += (uint32_t)((bits + bits_per_block - 1) / bits_per_block) * (uint32_t)(cr + 4);
+
+  // Symbols in quarters: the preamble is followed by 4.25 sync symbols, 6.25 at SF5/6.
+  uint64_t syms_x4 = 4 * ((uint64_t)preamble + payload_syms) + (is_long_sf ? 17 : 25);
+
+  // syms_x4 / 4 * 2^SF * div * 125 / 4 ns, rounded up to whole microseconds.
+  uint64_t ns_x16 = (syms_x4 << sf) * div * 125;
+  uint64_t us = (ns_x16 + 15999) / 16000;
+
+  return us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
+
+static uint32_t sx126x_gfsk_time_on_air_us(const sx126x_config_t *cfg, uint8_t payload_len)
+{
+  if (cfg->gfsk_bitrate_bps == 0 || cfg->gfsk_sync_word_len > SX126X_GFSK_SYNC_WORD_MAX_LEN)
+  {
+    return 0;
+  }
+
+  uint32_t crc_bits;
+  switch (cfg->gfsk_crc)
+  {
+  case SX126X_GFSK_CRC_OFF:
+    crc_bits = 0;
+    break;
+  case SX126X_GFSK_CRC_1_BYTE:
+  case SX126X_GFSK_CRC_1_BYTE_INV:
+    crc_bits = 8;
+    break;
+  case SX126X_GFSK_CRC_2_BYTE:
+  case SX126X_GFSK_CRC_2_BYTE_INV:
+    crc_bits = 16;
+    break;
+  default:
+    return 0;
+  }
+
+  uint64_t bits = cfg->gfsk_preamble_bits ? cfg->gfsk_preamble_bits : SX126X_GFSK_PREAMBLE_DEFAULT;
+  bits += 8u * cfg->gfsk_sync_word_len + (cfg->gfsk_fixed_length ? 0 : 8) + 8u * payload_len +
+          crc_bits;
+
+  return (uint32_t)((bits * 1000000 + cfg->gfsk_bitrate_bps - 1) / cfg->gfsk_bitrate_bps);
+}
+
+uint32_t sx126x_time_on_air_us(const sx126x_config_t *cfg, uint8_t payload_len)
+{
+  if (!cfg)
+  {
+    return 0;
+  }
+
+  switch (cfg->modem)
+  {
+  case SX126X_MODEM_LORA:
+    return sx126x_lora_time_on_air_us(cfg, payload_len);
+  case SX126X_MODEM_FSK:
+    return sx126x_gfsk_time_on_air_us(cfg, payload_len);
+  default:
+    return 0;
+  }
+}
+
+uint8_t sx126x_lora_rx_symbols(const sx126x_config_t *cfg, uint32_t uncertainty_us)
+{
+  if (!cfg || cfg->modem != SX126X_MODEM_LORA)
+  {
+    return 0;
+  }
+
+  uint32_t symbol_ns = sx126x_lora_symbol_ns(cfg->lora_sf, cfg->lora_bw);
+  if (symbol_ns == 0)
+  {
+    return 0;
+  }
+
+  // The receiver cannot see more of the preamble than was sent.
+  uint32_t preamble =
+      cfg->lora_preamble_len ? cfg->lora_preamble_len : SX126X_LORA_PREAMBLE_DEFAULT;
+  uint32_t detect =
+      preamble < SX126X_LORA_RX_DETECT_SYMBOLS ? preamble : SX126X_LORA_RX_DETECT_SYMBOLS;
+  uint64_t spread = ((uint64_t)uncertainty_us * 2000 + symbol_ns - 1) / symbol_ns;
+  uint64_t symbols = spread + detect;
+
+  // The chip stores the timeout as mantissa * 2^(2 * exponent + 1) with a 5-bit mantissa; other
+  // values get rounded on the chip. Round up here instead: even counts to 62, then multiples of 8.
+  if (symbols > SX126X_LORA_RX_SYMBOLS_MAX)
+    return SX126X_LORA_RX_SYMBOLS_MAX;
+  if (symbols > 62)
+    return (uint8_t)((symbols + 7) & ~7u);
+  return (uint8_t)((symbols + 1) & ~1u);
+}
+
+uint32_t sx126x_rx_timeout_us(const sx126x_config_t *cfg, uint32_t uncertainty_us)
+{
+  if (!cfg)
+  {
+    return 0;
+  }
+
+  uint64_t us;
+
+  if (cfg->modem == SX126X_MODEM_LORA)
+  {
+    uint32_t symbol_ns = sx126x_lora_symbol_ns(cfg->lora_sf, cfg->lora_bw);
+    if (symbol_ns == 0)
+    {
+      return 0;
+    }
+
+    // Preamble, 4.25 sync symbols (6.25 at SF5/6) and the 8 header symbols, in quarters.
+    uint32_t preamble =
+        cfg->lora_preamble_len ? cfg->lora_preamble_len : SX126X_LORA_PREAMBLE_DEFAULT;
+    uint64_t syms_x4 = 4 * ((uint64_t)preamble + 8) + (cfg->lora_sf >= SX126X_LORA_SF_7 ? 17 : 25);
+    us = (syms_x4 * symbol_ns + 3999) / 4000;
+  }
+  else if (cfg->modem == SX126X_MODEM_FSK)
+  {
+    if (cfg->gfsk_bitrate_bps == 0)
+    {
+      return 0;
+    }
+
+    uint64_t bits =
+        cfg->gfsk_preamble_bits ? cfg->gfsk_preamble_bits : SX126X_GFSK_PREAMBLE_DEFAULT;
+    bits += 8u * cfg->gfsk_sync_word_len;
+    us = (bits * 1000000 + cfg->gfsk_bitrate_bps - 1) / cfg->gfsk_bitrate_bps;
+  }
+  else
+  {
+    return 0;
+  }
+
+  us += 2 * (uint64_t)uncertainty_us;
+
+  return us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/channel_plan.h"
+#include "sx126x/commands.h"
+#include "sx126x/types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+void sx126x_channel_encode(sx126x_channel_t *ch, uint32_t hz)
+{
+  uint32_t word = SX126X_RF_FREQ_WORD(hz);
+
+  ch->hz = hz;
+  ch->frame[0] = SX126X_OP_SET_RF_FREQUENCY;
+  ch->frame[1] = (word >> 24) & 0xFF;
+  ch->frame[2] = (word >> 16) & 0xFF;
+  ch->frame[3] = (word >> 8) & 0xFF;
+  ch->frame[4] = word & 0xFF;
+}
+
+sx126x_status_t sx126x_channel_plan_init(sx126x_channel_plan_t *plan,
+                                         const sx126x_channel_t *channels,
+                                         uint16_t count)
+{
+  if (!plan || !channels || count == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  plan->channels = channels;
+  plan->count = count;
+
+  return SX126X_OK;
+}
+
+sx126x_status_t sx126x_channel_plan_build(sx126x_channel_plan_t *plan,
+                                          sx126x_channel_t *storage,
+                                          const uint32_t *hz,
+                                          uint16_t count)
+{
+  if (!plan || !storage || !hz || count == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  for (uint16_t i = 0; i < count; i++)
+  {
+    sx126x_channel_encode(&storage[i], hz[i]);
+  }
+
+  return sx126x_channel_plan_init(plan, storage, count);
+}
+
+sx126x_status_t sx126x_channel_plan_build_linear(sx126x_channel_plan_t *plan,
+                                                 sx126x_channel_t *storage,
+                                                 uint32_t first_hz,
+                                                 uint32_t spacing_hz,
+                                                 uint16_t count)
+{
+  if (!plan || !storage || count == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  // The last channel must not wrap past 2^32 Hz.
+  if ((uint64_t)first_hz + (uint64_t)spacing_hz * (count - 1) > UINT32_MAX)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  for (uint16_t i = 0; i < count; i++)
+  {
+    sx126x_channel_encode(&storage[i], first_hz + spacing_hz * i);
+  }
+
+  return sx126x_channel_plan_init(plan, storage, count);
+}
@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/duty_cycle.h"
+#include "sx126x/airtime.h"
+#include "sx126x/sx126x.h"
+#include "sx126x/tx_request.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Credit is kept in microseconds of airtime times 10^6, so that one microsecond of elapsed time
+// adds exactly duty_ppm units and no division is needed to refill a bucket.
+#define SX126X_DUTY_CREDIT_PER_US 1000000u
+
+static uint64_t sx126x_duty_capacity(const sx126x_duty_band_t *band)
+{
+  return (uint64_t)band->burst_us * SX126X_DUTY_CREDIT_PER_US;
+}
+
+static void sx126x_duty_refill(sx126x_duty_band_t *band, uint32_t now_us)
+{
+  uint32_t elapsed = now_us - band->last_us;
+  uint64_t capacity = sx126x_duty_capacity(band);
+
+  band->last_us = now_us;
+  band->credit += (uint64_t)elapsed * band->duty_ppm;
+  if (band->credit > capacity)
+    band->credit = capacity;
+}
+
+// Microseconds until band has the credit for airtime_us, 0 if it already has.
+static uint32_t sx126x_duty_wait(const sx126x_duty_band_t *band, uint32_t airtime_us)
+{
+  uint64_t need = (uint64_t)airtime_us * SX126X_DUTY_CREDIT_PER_US;
+  if (band->credit >= need)
+    return 0;
+
+  uint64_t wait = (need - band->credit + band->duty_ppm - 1) / band->duty_ppm;
+  return wait > UINT32_MAX - 1 ? UINT32_MAX - 1 : (uint32_t)wait;
+}
+
+sx126x_status_t sx126x_duty_init(sx126x_duty_t *sched,
+                                 sx126x_t *radio,
+                                 sx126x_duty_band_t *bands,
+                                 uint8_t band_count,
+                                 const uint8_t *channel_band,
+                                 uint16_t channel_count,
+                                 uint32_t now_us)
+{
+  if (!sched || !radio || !bands || band_count == 0 || band_count > SX126X_DUTY_MAX_BANDS ||
+      !channel_band || channel_count == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  for (uint8_t i = 0; i < band_count; i++)
+  {
+    if (bands[i].duty_ppm == 0 || bands[i].duty_ppm > SX126X_DUTY_CREDIT_PER_US)
+    {
+      return SX126X_ERR_INVALID_ARG;
+    }
+  }
+
+  for (uint16_t i = 0; i < channel_count; i++)
+  {
+    if (channel_band[i] >= band_count)
+    {
+      return SX126X_ERR_INVALID_ARG;
+    }
+  }
+
+  for (uint8_t i = 0; i < band_count; i++)
+  {
+    bands[i].credit = sx126x_duty_capacity(&bands[i]);
+    bands[i].last_us = now_us;
+    bands[i].airtime_us = 0;
+  }
+
+  sched->radio = radio;
+  sched->bands = bands;
+  sched->band_count = band_count;
+  sched->channel_band = channel_band;
+  sched->channel_count = channel_count;
+  sx126x_tx_fifo_init(&sched->queue);
+  sched->stats = (sx126x_duty_stats_t){0};
+
+  return SX126X_OK;
+}
+
+sx126x_status_t sx126x_duty_submit(sx126x_duty_t *sched,
+                                   sx126x_duty_tx_t *tx,
+                                   uint16_t channel,
+                                   const uint8_t *payload,
+                                   uint8_t len,
+                                   sx126x_tx_done_cb_t done,
+                                   void *arg)
+{
+  if (!sched || !sched->radio || !tx || !payload || len == 0 || channel >= sched->channel_count)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (tx->req.queued)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  uint32_t airtime_us = sx126x_time_on_air_us(&sched->radio->shadow, len);
+  const sx126x_duty_band_t *band = &sched->bands[sched->channel_band[channel]];
+
+  // A packet longer than the bucket would never get the credit it needs.
+  if (airtime_us == 0 || airtime_us > band->burst_us)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  tx->channel = channel;
+  tx->airtime_us = airtime_us;
+
+  return sx126x_tx_fifo_push(&sched->queue, &tx->req, payload, len, done, arg);
+}
+
+bool sx126x_duty_poll(sx126x_duty_t *sched, uint32_t now_us, uint32_t *wait_us)
+{
+  uint32_t wait = UINT32_MAX;
+  bool is_started = false;
+
+  if (!sched || !sched->radio)
+  {
+    if (wait_us)
+      *wait_us = wait;
+    return false;
+  }
+
+  for (uint8_t i = 0; i < sched->band_count; i++)
+    sx126x_duty_refill(&sched->bands[i], now_us);
+
+  // Bands whose oldest request has already been looked at, which keeps requests in order per band.
+  uint32_t seen = 0;
+  sx126x_tx_req_t *prev = NULL;
+  sx126x_tx_req_t *req = sched->queue.head;
+
+  while (req)
+  {
+    sx126x_tx_req_t *next = req->next;
+    sx126x_duty_tx_t *tx = (sx126x_duty_tx_t *)req;
+    uint8_t b = sched->channel_band[tx->channel];
+    uint32_t mask = 1u << b;
+
+    if (seen & mask)
+    {
+      prev = req;
+      req = next;
+      continue;
+    }
+    seen |= mask;
+
+    sx126x_duty_band_t *band = &sched->bands[b];
+    uint32_t band_wait = sx126x_duty_wait(band, tx->airtime_us);
+
+    if (band_wait == 0 && !is_started && sx126x_is_idle(sched->radio))
+    {
+      sx126x_status_t st = sx126x_set_channel(sched->radio, tx->channel);
+      if (st == SX126X_OK)
+        st = sx126x_transmit_async(sched->radio, req->payload, req->len, 0, req->done, req->arg);
+
+      if (st == SX126X_OK)
+      {
+        band->credit -= (uint64_t)tx->airtime_us * SX126X_DUTY_CREDIT_PER_US;
+        band->airtime_us += tx->airtime_us;
+        sched->stats.released++;
+        sx126x_tx_fifo_remove(&sched->queue, prev, req);
+        is_started = true;
+
+        // The band's next request, if any, now waits for the credit just spent.
+        seen &= ~mask;
+        req = next;
+        continue;
+      }
+
+      if (st != SX126X_ERR_BUSY)
+      {
+        sched->stats.failed++;
+        sx126x_tx_fifo_finish(&sched->queue, prev, req, sched->radio, st);
+        seen &= ~mask;
+        req = next;
+        continue;
+      }
+    }
+    else if (band_wait > 0)
+    {
+      sched->stats.deferred++;
+    }
+
+    if (band_wait < wait)
+      wait = band_wait;
+    prev = req;
+    req = next;
+  }
+
+  if (wait_us)
+    *wait_us = wait;
+
+  return is_started;
+}
@@ -0,0 +1,454 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/frag.h"
+#include "sx126x/commands.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static bool sx126x_frag_bit(const uint8_t *bitmap, uint16_t index)
+{
+  return (bitmap[index / 8] >> (index % 8)) & 1;
+}
+
+static void sx126x_frag_set_bit(uint8_t *bitmap, uint16_t index)
+{
+  bitmap[index / 8] |= (uint8_t)(1u << (index % 8));
+}
+
+// Next fragment after index, wrapping around, that has not been acknowledged; index itself if it is
+// the only one left, count if there is none.
+static uint16_t sx126x_frag_next_unacked(const sx126x_frag_tx_t *tx, uint16_t index)
+{
+  for (uint16_t i = 1; i <= tx->count; i++)
+  {
+    uint16_t n = (uint16_t)((index + i) % tx->count);
+    if (!sx126x_frag_bit(tx->acked, n))
+      return n;
+  }
+
+  return tx->count;
+}
+
+// Copy len bytes of the message from offset out of its pieces.
+static void sx126x_frag_gather(const sx126x_frag_tx_t *tx, size_t offset, uint8_t *out, size_t len)
+{
+  for (size_t s = 0; s < tx->seg_count && len > 0; s++)
+  {
+    const sx126x_frag_seg_t *seg = &tx->segs[s];
+    if (offset >= seg->len)
+    {
+      offset -= seg->len;
+      continue;
+    }
+
+    size_t n = seg->len - offset;
+    if (n > len)
+      n = len;
+    memcpy(out, seg->data + offset, n);
+    out += n;
+    len -= n;
+    offset = 0;
+  }
+}
+
+sx126x_status_t sx126x_frag_tx_init(sx126x_frag_tx_t *tx, const sx126x_frag_tx_cfg_t *cfg)
+{
+  if (!tx || !cfg || cfg->frag_len > SX126X_FRAG_MAX_LEN ||
+      cfg->window > SX126X_FRAG_MAX_FRAGMENTS)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  memset(tx, 0, sizeof(*tx));
+  tx->cfg = *cfg;
+  if (tx->cfg.frag_len == 0)
+    tx->cfg.frag_len = SX126X_FRAG_MAX_LEN;
+
+  return SX126X_OK;
+}
+
+sx126x_status_t sx126x_frag_tx_start(sx126x_frag_tx_t *tx,
+                                     uint8_t msg_id,
+                                     const sx126x_frag_seg_t *segs,
+                                     size_t seg_count)
+{
+  if (!tx || tx->cfg.frag_len == 0 || (!segs && seg_count))
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  size_t total = 0;
+  for (size_t s = 0; s < seg_count; s++)
+  {
+    if (!segs[s].data && segs[s].len)
+    {
+      return SX126X_ERR_INVALID_ARG;
+    }
+    total += segs[s].len;
+  }
+
+  if (total == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  size_t count = (total + tx->cfg.frag_len - 1) / tx->cfg.frag_len;
+  if (total > UINT16_MAX || count > SX126X_FRAG_MAX_FRAGMENTS)
+  {
+    return SX126X_ERR_NO_MEM;
+  }
+
+  tx->segs = segs;
+  tx->seg_count = seg_count;
+  tx->total = (uint16_t)total;
+  tx->count = (uint16_t)count;
+  tx->msg_id = msg_id;
+  memset(tx->acked, 0, sizeof(tx->acked));
+  memset(tx->sent_map, 0, sizeof(tx->sent_map));
+  tx->acked_count = 0;
+  tx->next = 0;
+  tx->burst = 0;
+  tx->burst_last = 0;
+  tx->retries = 0;
+  tx->is_waiting = false;
+  tx->is_active = true;
+
+  return SX126X_OK;
+}
+
+bool sx126x_frag_tx_next(sx126x_frag_tx_t *tx, uint8_t *frame, uint8_t *len)
+{
+  if (!tx || !frame || !len || !tx->is_active || tx->is_waiting)
+    return false;
+
+  uint16_t index = tx->next;
+  uint8_t flags = SX126X_FRAG_TYPE_DATA;
+
+  if (tx->cfg.window == 0)
+  {
+    if (index >= tx->count)
+      return false;
+    tx->next++;
+  }
+  else
+  {
+    if (tx->acked_count == tx->count)
+      return false;
+    if (sx126x_frag_bit(tx->acked, index))
+      index = sx126x_frag_next_unacked(tx, index);
+
+    // A burst ends after window fragments, or where the next one to send wraps back to the start.
+    uint16_t following = sx126x_frag_next_unacked(tx, index);
+    tx->next = following < tx->count ? following : index;
+    if (++tx->burst >= tx->cfg.window || following <= index)
+    {
+      flags |= SX126X_FRAG_FLAG_ACK_REQ;
+      tx->burst = 0;
+      tx->burst_last = index;
+      tx->is_waiting = true;
+    }
+  }
+
+  if (index == tx->count - 1)
+    flags |= SX126X_FRAG_FLAG_LAST;
+
+  size_t offset = (size_t)index * tx->cfg.frag_len;
+  size_t n = tx->total - offset;
+  if (n > tx->cfg.frag_len)
+    n = tx->cfg.frag_len;
+
+  frame[0] = flags;
+  frame[1] = tx->msg_id;
+  frame[2] = (uint8_t)index;
+  frame[3] = (uint8_t)(tx->total >> 8);
+  frame[4] = (uint8_t)tx->total;
+  sx126x_frag_gather(tx, offset, &frame[SX126X_FRAG_HEADER_LEN], n);
+  *len = (uint8_t)(SX126X_FRAG_HEADER_LEN + n);
+
+  tx->stats.sent++;
+  if (sx126x_frag_bit(tx->sent_map, index))
+    tx->stats.resent++;
+  sx126x_frag_set_bit(tx->sent_map, index);
+
+  return true;
+}
+
+sx126x_status_t sx126x_frag_tx_ack(sx126x_frag_tx_t *tx, const uint8_t *frame, uint8_t len)
+{
+  if (!tx || !frame || !tx->is_active || len < SX126X_FRAG_ACK_HEADER_LEN ||
+      (frame[0] & SX126X_FRAG_TYPE_MASK) != SX126X_FRAG_TYPE_ACK || frame[1] != tx->msg_id)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  uint16_t span = (uint16_t)(frame[2] + 1);
+  if (span > tx->count || len < SX126X_FRAG_ACK_HEADER_LEN + (span + 7) / 8)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  const uint8_t *bitmap = &frame[SX126X_FRAG_ACK_HEADER_LEN];
+  for (uint16_t i = 0; i < span; i++)
+  {
+    if (sx126x_frag_bit(bitmap, i) && !sx126x_frag_bit(tx->acked, i))
+    {
+      sx126x_frag_set_bit(tx->acked, i);
+      tx->acked_count++;
+    }
+  }
+
+  tx->stats.acks++;
+  tx->retries = 0;
+  tx->burst = 0;
+  tx->is_waiting = false;
+
+  return SX126X_OK;
+}
+
+sx126x_status_t sx126x_frag_tx_timeout(sx126x_frag_tx_t *tx)
+{
+  if (!tx || !tx->is_active || !tx->is_waiting)
+  {
+    return SX126X_OK;
+  }
+
+  tx->stats.timeouts++;
+  if (tx->cfg.max_retries && ++tx->retries >= tx->cfg.max_retries)
+  {
+    tx->is_active = false;
+    tx->is_waiting = false;
+    return SX126X_ERR_TIMEOUT;
+  }
+
+  // Send the last fragment of the burst again, alone, to ask once more.
+  tx->next = tx->burst_last;
+  tx->burst = (uint16_t)(tx->cfg.window - 1);
+  tx->is_waiting = false;
+
+  return SX126X_OK;
+}
+
+bool sx126x_frag_tx_done(const sx126x_frag_tx_t *tx)
+{
+  if (!tx || !tx->is_active)
+    return false;
+
+  return tx->cfg.window ? tx->acked_count == tx->count : tx->next >= tx->count;
+}
+
+sx126x_status_t sx126x_frag_pool_init(sx126x_frag_pool_t *pool,
+                                      sx126x_frag_slot_t *slots,
+                                      uint8_t slot_count,
+                                      uint8_t *storage,
+                                      uint16_t slot_size)
+{
+  if (!pool || !slots || slot_count == 0 || !storage || slot_size == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  for (uint8_t i = 0; i < slot_count; i++)
+  {
+    memset(&slots[i], 0, sizeof(slots[i]));
+    slots[i].buf = storage + (size_t)i * slot_size;
+    slots[i].cap = slot_size;
+  }
+
+  pool->slots = slots;
+  pool->slot_count = slot_count;
+  pool->stats = (sx126x_frag_pool_stats_t){0};
+
+  return SX126X_OK;
+}
+
+static void sx126x_frag_slot_start(sx126x_frag_slot_t *slot,
+                                   uint32_t src,
+                                   uint8_t msg_id,
+                                   uint16_t total)
+{
+  slot->is_used = true;
+  slot->ack_requested = false;
+  slot->src = src;
+  slot->msg_id = msg_id;
+  slot->total = total;
+  slot->frag_len = 0;
+  slot->count = 0;
+  slot->span = 0;
+  slot->received = 0;
+  memset(slot->bitmap, 0, sizeof(slot->bitmap));
+}
+
+// Slot of the message a fragment belongs to, or a new one for it; NULL if none can be had.
+static sx126x_frag_slot_t *sx126x_frag_find(sx126x_frag_pool_t *pool,
+                                            uint32_t src,
+                                            uint8_t msg_id,
+                                            uint32_t now_us)
+{
+  sx126x_frag_slot_t *free_slot = NULL;
+  sx126x_frag_slot_t *oldest = NULL;
+
+  for (uint8_t i = 0; i < pool->slot_count; i++)
+  {
+    sx126x_frag_slot_t *slot = &pool->slots[i];
+    if (!slot->is_used)
+    {
+      if (!free_slot)
+        free_slot = slot;
+      continue;
+    }
+
+    if (slot->src == src && slot->msg_id == msg_id)
+      return slot;
+
+    if (!sx126x_frag_complete(slot) &&
+        (!oldest || now_us - slot->last_us > now_us - oldest->last_us))
+      oldest = slot;
+  }
+
+  if (free_slot)
+    return free_slot;
+
+  if (oldest)
+  {
+    pool->stats.evicted++;
+    oldest->is_used = false;
+  }
+
+  return oldest;
+}
+
+sx126x_status_t sx126x_frag_rx(sx126x_frag_pool_t *pool,
+                               uint32_t src,
+                               const uint8_t *frame,
+                               uint8_t len,
+                               uint32_t now_us,
+                               sx126x_frag_slot_t **slot)
+{
+  if (!pool || !pool->slots || !frame || !slot)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  *slot = NULL;
+
+  if (len <= SX126X_FRAG_HEADER_LEN || (frame[0] & SX126X_FRAG_TYPE_MASK) != SX126X_FRAG_TYPE_DATA)
+  {
+    pool->stats.rejected++;
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  uint8_t msg_id = frame[1];
+  uint16_t index = frame[2];
+  uint16_t total = (uint16_t)(frame[3] << 8 | frame[4]);
+  uint8_t n = (uint8_t)(len - SX126X_FRAG_HEADER_LEN);
+  bool is_last = frame[0] & SX126X_FRAG_FLAG_LAST;
+
+  // Every fragment but the last has the same length, and the last one ends the message.
+  uint32_t offset = is_last ? (uint32_t)total - n : (uint32_t)index * n;
+  bool is_bad = n > total;
+  if (is_last)
+    is_bad = is_bad || (uint32_t)index * n > offset || (index == 0) != (offset == 0);
+  else
+    is_bad = is_bad || offset + n >= total;
+  if (is_bad)
+  {
+    pool->stats.rejected++;
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (total > pool->slots[0].cap)
+  {
+    pool->stats.rejected++;
+    return SX126X_ERR_NO_MEM;
+  }
+
+  sx126x_frag_slot_t *s = sx126x_frag_find(pool, src, msg_id, now_us);
+  if (!s)
+  {
+    pool->stats.rejected++;
+    return SX126X_ERR_NO_MEM;
+  }
+
+  // A new message, or one that reuses the id of an earlier one.
+  if (!s->is_used || s->total != total)
+    sx126x_frag_slot_start(s, src, msg_id, total);
+
+  // The fragment must agree with what the slot has learnt from the others.
+  if (is_last)
+  {
+    is_bad = index + 1 < s->span || (s->count && index + 1 != s->count) ||
+             (s->frag_len && (n > s->frag_len || offset != (uint32_t)index * s->frag_len));
+  }
+  else
+  {
+    uint32_t last_offset = s->count ? (uint32_t)(s->count - 1) * n : 0;
+    is_bad = (s->frag_len && n != s->frag_len) ||
+             (s->count &&
+              (index + 1 >= s->count || last_offset >= total || total - last_offset > n));
+  }
+
+  if (is_bad)
+  {
+    pool->stats.rejected++;
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (!is_last)
+    s->frag_len = n;
+  else
+    s->count = (uint16_t)(index + 1);
+  if (index + 1 > s->span)
+    s->span = (uint16_t)(index + 1);
+
+  s->last_us = now_us;
+  s->ack_requested = frame[0] & SX126X_FRAG_FLAG_ACK_REQ;
+  *slot = s;
+  pool->stats.fragments++;
+
+  if (sx126x_frag_bit(s->bitmap, index))
+  {
+    pool->stats.duplicates++;
+    return SX126X_OK;
+  }
+
+  memcpy(&s->buf[offset], &frame[SX126X_FRAG_HEADER_LEN], n);
+  sx126x_frag_set_bit(s->bitmap, index);
+  s->received++;
+  if (sx126x_frag_complete(s))
+    pool->stats.completed++;
+
+  return SX126X_OK;
+}
+
+bool sx126x_frag_complete(const sx126x_frag_slot_t *slot)
+{
+  return slot && slot->is_used && slot->count && slot->received == slot->count;
+}
+
+sx126x_status_t sx126x_frag_ack(const sx126x_frag_slot_t *slot, uint8_t *frame, uint8_t *len)
+{
+  if (!slot || !slot->is_used || slot->span == 0 || !frame || !len)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  uint8_t bytes = (uint8_t)((slot->span + 7) / 8);
+  frame[0] = SX126X_FRAG_TYPE_ACK;
+  frame[1] = slot->msg_id;
+  frame[2] = (uint8_t)(slot->span - 1);
+  memcpy(&frame[SX126X_FRAG_ACK_HEADER_LEN], slot->bitmap, bytes);
+  *len = (uint8_t)(SX126X_FRAG_ACK_HEADER_LEN + bytes);
+
+  return SX126X_OK;
+}
+
+void sx126x_frag_release(sx126x_frag_pool_t *pool, sx126x_frag_slot_t *slot)
+{
+  (void)pool;
+
+  if (slot)
+    slot->is_used = false;
+}
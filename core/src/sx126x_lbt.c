@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/lbt.h"
+#include "sx126x/sx126x.h"
+#include "sx126x/tx_request.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Seed used when the configuration leaves it at 0; xorshift never leaves a zero state.
+#define SX126X_LBT_DEFAULT_SEED 0x2545F491u
+
+static uint32_t sx126x_lbt_random(sx126x_lbt_t *lbt)
+{
+  uint32_t x = lbt->rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  lbt->rng = x;
+  return x;
+}
+
+// Runs from the DIO1 handler: only record the outcome for the next poll.
+static void sx126x_lbt_radio_done(sx126x_t *radio, sx126x_status_t result, void *arg)
+{
+  sx126x_lbt_t *lbt = (sx126x_lbt_t *)arg;
+  (void)radio;
+
+  lbt->result = result;
+  __atomic_store_n(&lbt->is_done, true, __ATOMIC_SEQ_CST);
+}
+
+// Take the head off the queue and report how it ended.
+static void sx126x_lbt_finish(sx126x_lbt_t *lbt, sx126x_status_t result)
+{
+  lbt->is_backing_off = false;
+  sx126x_tx_fifo_finish(&lbt->queue, NULL, lbt->queue.head, lbt->radio, result);
+}
+
+// Wait a random time within a window that doubles with every busy CAD.
+static void sx126x_lbt_back_off(sx126x_lbt_t *lbt, sx126x_lbt_tx_t *tx, uint32_t now_us)
+{
+  uint32_t window = lbt->cfg.backoff_min_us;
+  for (uint8_t i = 1; i < tx->attempts && window < lbt->cfg.backoff_max_us; i++)
+    window = window > UINT32_MAX / 2 ? UINT32_MAX : window * 2;
+  if (window > lbt->cfg.backoff_max_us)
+    window = lbt->cfg.backoff_max_us;
+
+  lbt->is_backing_off = true;
+  lbt->ready_us = now_us + sx126x_lbt_random(lbt) % window;
+}
+
+// Start the head's CAD, or its TX after a clear CAD when they are not chained.
+static sx126x_status_t sx126x_lbt_start(sx126x_lbt_t *lbt, bool is_cad)
+{
+  const sx126x_tx_req_t *req = lbt->queue.head;
+  sx126x_status_t st;
+
+  if (!is_cad)
+    st = sx126x_transmit_async(lbt->radio, req->payload, req->len, 0, sx126x_lbt_radio_done, lbt);
+  else if (lbt->cfg.chain)
+    st = sx126x_transmit_lbt(lbt->radio, req->payload, req->len, 0, sx126x_lbt_radio_done, lbt);
+  else
+    st = sx126x_cad(lbt->radio, sx126x_lbt_radio_done, lbt);
+
+  if (st == SX126X_OK)
+  {
+    lbt->is_running = true;
+    lbt->is_transmitting = !is_cad;
+    if (is_cad)
+      lbt->stats.cads++;
+  }
+
+  return st;
+}
+
+// Act on the outcome of the head's CAD or TX.
+static bool sx126x_lbt_complete(sx126x_lbt_t *lbt, uint32_t now_us)
+{
+  sx126x_lbt_tx_t *tx = (sx126x_lbt_tx_t *)lbt->queue.head;
+  sx126x_status_t result = lbt->result;
+  bool was_transmitting = lbt->is_transmitting;
+
+  lbt->is_running = false;
+  lbt->is_transmitting = false;
+
+  if (result == SX126X_ERR_CHANNEL_BUSY)
+  {
+    lbt->stats.deferrals++;
+    if (tx->attempts < UINT8_MAX)
+      tx->attempts++;
+    if (lbt->cfg.max_attempts && tx->attempts >= lbt->cfg.max_attempts)
+    {
+      lbt->stats.dropped++;
+      sx126x_lbt_finish(lbt, result);
+    }
+    else
+    {
+      sx126x_lbt_back_off(lbt, tx, now_us);
+    }
+    return false;
+  }
+
+  // A clear CAD that did not chain into TX: transmit straight away.
+  if (result == SX126X_OK && !lbt->cfg.chain && !was_transmitting)
+  {
+    result = sx126x_lbt_start(lbt, false);
+    if (result == SX126X_OK)
+      return true;
+  }
+
+  if (result == SX126X_OK)
+    lbt->stats.sent++;
+  else
+    lbt->stats.failed++;
+  sx126x_lbt_finish(lbt, result);
+
+  return false;
+}
+
+sx126x_status_t sx126x_lbt_init(sx126x_lbt_t *lbt, sx126x_t *radio, const sx126x_lbt_cfg_t *cfg)
+{
+  if (!lbt || !radio || !cfg || cfg->backoff_min_us == 0 ||
+      cfg->backoff_max_us < cfg->backoff_min_us)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  lbt->radio = radio;
+  lbt->cfg = *cfg;
+  lbt->rng = cfg->seed ? cfg->seed : SX126X_LBT_DEFAULT_SEED;
+  sx126x_tx_fifo_init(&lbt->queue);
+  lbt->is_running = false;
+  lbt->is_transmitting = false;
+  lbt->is_done = false;
+  lbt->result = SX126X_OK;
+  lbt->is_backing_off = false;
+  lbt->ready_us = 0;
+  lbt->stats = (sx126x_lbt_stats_t){0};
+
+  return SX126X_OK;
+}
+
+sx126x_status_t sx126x_lbt_submit(sx126x_lbt_t *lbt,
+                                  sx126x_lbt_tx_t *tx,
+                                  const uint8_t *payload,
+                                  uint8_t len,
+                                  sx126x_tx_done_cb_t done,
+                                  void *arg)
+{
+  if (!lbt || !lbt->radio || !tx)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  sx126x_status_t st = sx126x_tx_fifo_push(&lbt->queue, &tx->req, payload, len, done, arg);
+  if (st == SX126X_OK)
+    tx->attempts = 0;
+
+  return st;
+}
+
+bool sx126x_lbt_poll(sx126x_lbt_t *lbt, uint32_t now_us, uint32_t *wait_us)
+{
+  uint32_t wait = UINT32_MAX;
+  bool is_started = false;
+
+  if (!lbt || !lbt->radio)
+  {
+    if (wait_us)
+      *wait_us = wait;
+    return false;
+  }
+
+  if (lbt->is_running && __atomic_exchange_n(&lbt->is_done, false, __ATOMIC_SEQ_CST))
+    is_started = sx126x_lbt_complete(lbt, now_us);
+
+  if (lbt->queue.head && !lbt->is_running)
+  {
+    int32_t remaining = (int32_t)(lbt->ready_us - now_us);
+
+    if (lbt->is_backing_off && remaining > 0)
+    {
+      wait = (uint32_t)remaining;
+    }
+    else if (!sx126x_is_idle(lbt->radio))
+    {
+      // Busy with something else; try again on the next poll.
+      wait = 0;
+    }
+    else
+    {
+      lbt->is_backing_off = false;
+      sx126x_status_t st = sx126x_lbt_start(lbt, true);
+      if (st == SX126X_OK)
+      {
+        is_started = true;
+      }
+      else if (st != SX126X_ERR_BUSY)
+      {
+        lbt->stats.failed++;
+        sx126x_lbt_finish(lbt, st);
+      }
+      else
+      {
+        wait = 0;
+      }
+    }
+  }
+
+  if (wait_us)
+    *wait_us = wait;
+
+  return is_started;
+}
@@ -0,0 +1,225 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/log_ring.h"
+#include "sx126x/log.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Bounded MPMC queue in the style of Vyukov, used here with a single consumer. A slot whose seq
+// equals the claiming index is free; seq == index + 1 means the record is published; the consumer
+// hands it back with seq = index + capacity.
+#define RING_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+sx126x_status_t
+sx126x_log_ring_init(sx126x_log_ring_t *ring, sx126x_log_slot_t *slots, uint32_t capacity)
+{
+  if (!ring || !slots || capacity == 0 || (capacity & (capacity - 1)) != 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  for (uint32_t i = 0; i < capacity; i++)
+  {
+    slots[i].seq = i;
+  }
+
+  ring->slots = slots;
+  ring->capacity = capacity;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->dropped = 0;
+
+  return SX126X_OK;
+}
+
+void sx126x_log_ring_record(sx126x_log_ring_t *ring,
+                            uint8_t level,
+                            uint32_t timestamp_us,
+                            const char *fmt,
+                            const uint64_t *args,
+                            size_t nargs)
+{
+  uint32_t pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+  sx126x_log_slot_t *slot;
+
+  for (;;)
+  {
+    slot = &ring->slots[pos & (ring->capacity - 1)];
+    int32_t diff = (int32_t)(RING_LOAD(&slot->seq) - pos);
+
+    if (diff == 0)
+    {
+      if (__atomic_compare_exchange_n(
+              &ring->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    }
+    else if (diff < 0)
+    {
+      __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+      return;
+    }
+    else
+    {
+      pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    }
+  }
+
+  if (nargs > SX126X_LOG_MAX_ARGS)
+    nargs = SX126X_LOG_MAX_ARGS;
+
+  slot->rec.fmt = fmt;
+  slot->rec.timestamp_us = timestamp_us;
+  slot->rec.level = level;
+  slot->rec.nargs = (uint8_t)nargs;
+  memcpy(slot->rec.args, args, nargs * sizeof(args[0]));
+
+  RING_STORE(&slot->seq, pos + 1);
+}
+
+bool sx126x_log_ring_pop(sx126x_log_ring_t *ring, sx126x_log_record_t *out)
+{
+  uint32_t pos = ring->tail;
+  sx126x_log_slot_t *slot = &ring->slots[pos & (ring->capacity - 1)];
+
+  if (RING_LOAD(&slot->seq) != pos + 1)
+  {
+    return false;
+  }
+
+  *out = slot->rec;
+  RING_STORE(&slot->seq, pos + ring->capacity);
+  ring->tail = pos + 1;
+
+  return true;
+}
+
+// Append an snprintf result to buf at the running total, which keeps counting once buf is full.
+#define LOG_APPEND(buf, size, total, ...)                                                          \
+  do                                                                                               \
+  {                                                                                                \
+    size_t off_ = (size_t)(total) < (size) ? (size_t)(total) : (size);                             \
+    int n_ = snprintf((buf) + off_, (size) - off_, __VA_ARGS__);                                   \
+    if (n_ < 0)                                                                                    \
+      return n_;                                                                                   \
+    (total) += n_;                                                                                 \
+  } while (0)
+
+// Longest conversion specification handed to snprintf, e.g. "%-08.4llx".
+#define LOG_SPEC_MAX 16
+
+// Format one conversion specification, handing v over as the type the conversion expects. Returns
+// the snprintf result, or -1 for conversions a ring record cannot carry.
+static int log_format_arg(
+    char *buf, size_t size, const char *spec, const char *mod, char conv, uint64_t v)
+{
+  bool is_long = mod[0] == 'l' && mod[1] != 'l';
+  bool is_long_long = mod[0] == 'l' && mod[1] == 'l';
+
+  switch (conv)
+  {
+  case 'd':
+  case 'i':
+    if (is_long_long || mod[0] == 'j')
+      return snprintf(buf, size, spec, (long long)v);
+    if (is_long)
+      return snprintf(buf, size, spec, (long)v);
+    if (mod[0] == 'z' || mod[0] == 't')
+      return snprintf(buf, size, spec, (ptrdiff_t)v);
+    return snprintf(buf, size, spec, (int)v);
+
+  case 'u':
+  case 'o':
+  case 'x':
+  case 'X':
+    if (is_long_long || mod[0] == 'j')
+      return snprintf(buf, size, spec, (unsigned long long)v);
+    if (is_long)
+      return snprintf(buf, size, spec, (unsigned long)v);
+    if (mod[0] == 'z' || mod[0] == 't')
+      return snprintf(buf, size, spec, (size_t)v);
+    return snprintf(buf, size, spec, (unsigned int)v);
+
+  case 'c':
+    return snprintf(buf, size, spec, (int)v);
+
+  case 's':
+    return snprintf(buf, size, spec, (const char *)(uintptr_t)v);
+
+  case 'p':
+    return snprintf(buf, size, spec, (void *)(uintptr_t)v);
+
+  default:
+    return -1;
+  }
+}
+
+int sx126x_log_format(const sx126x_log_record_t *rec, char *buf, size_t size)
+{
+  static const char *const tags[] = {"ERROR", "WARN", "INFO", "DEBUG"};
+  const char *tag = rec->level < sizeof(tags) / sizeof(tags[0]) ? tags[rec->level] : "?";
+
+  int prefix = snprintf(buf, size, "[%s] ", tag);
+  if (prefix < 0 || (size_t)prefix >= size)
+  {
+    return prefix;
+  }
+
+  // Walk the format one conversion at a time. Flags, width and precision are passed through;
+  // a '*' width, a missing argument or an unsupported conversion is printed as written.
+  int total = prefix;
+  uint8_t next = 0;
+  const char *p = rec->fmt;
+
+  while (*p)
+  {
+    const char *pct = strchr(p, '%');
+    if (!pct)
+    {
+      LOG_APPEND(buf, size, total, "%s", p);
+      break;
+    }
+
+    LOG_APPEND(buf, size, total, "%.*s", (int)(pct - p), p);
+    if (pct[1] == '%')
+    {
+      LOG_APPEND(buf, size, total, "%%");
+      p = pct + 2;
+      continue;
+    }
+
+    const char *q = pct + 1 + strspn(pct + 1, "-+ #0");
+    q += strspn(q, "0123456789");
+    if (*q == '.')
+      q += 1 + strspn(q + 1, "0123456789");
+    const char *mod = q;
+    q += strspn(q, "hljzt");
+    char conv = *q;
+
+    size_t spec_len = (size_t)(q - pct) + (conv ? 1 : 0);
+    char spec[LOG_SPEC_MAX];
+    int n = -1;
+    if (conv && spec_len < sizeof(spec) && next < rec->nargs)
+    {
+      memcpy(spec, pct, spec_len);
+      spec[spec_len] = '\0';
+
+      size_t off = (size_t)total < size ? (size_t)total : size;
+      n = log_format_arg(buf + off, size - off, spec, mod, conv, rec->args[next]);
+      if (n >= 0)
+        next++;
+    }
+
+    if (n >= 0)
+      total += n;
+    else
+      LOG_APPEND(buf, size, total, "%.*s", (int)spec_len, pct);
+    p = pct + spec_len;
+  }
+
+  return total - prefix;
+}
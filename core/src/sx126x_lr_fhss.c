@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/lr_fhss.h"
+#include "sx126x/channel_plan.h"
+#include "sx126x/commands.h"
+#include "sx126x/types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+void sx126x_lr_fhss_hop_encode(sx126x_lr_fhss_hop_t *hop,
+                               uint16_t index,
+                               uint32_t hz,
+                               uint16_t symbols)
+{
+  // Hop i goes into slot i % SX126X_LR_FHSS_HOP_SLOTS, freed once the chip has sent hop i - 16.
+  uint16_t slot = index % SX126X_LR_FHSS_HOP_SLOTS;
+  uint16_t addr = SX126X_REG_LR_FHSS_HOP_TABLE + slot * SX126X_LR_FHSS_HOP_ENTRY_LEN;
+  uint32_t word = SX126X_RF_FREQ_WORD(hz);
+
+  hop->frame[0] = SX126X_OP_WRITE_REGISTER;
+  hop->frame[1] = (addr >> 8) & 0xFF;
+  hop->frame[2] = addr & 0xFF;
+  hop->frame[3] = (symbols >> 8) & 0xFF;
+  hop->frame[4] = symbols & 0xFF;
+  hop->frame[5] = (word >> 24) & 0xFF;
+  hop->frame[6] = (word >> 16) & 0xFF;
+  hop->frame[7] = (word >> 8) & 0xFF;
+  hop->frame[8] = word & 0xFF;
+}
+
+sx126x_status_t sx126x_lr_fhss_build(sx126x_lr_fhss_table_t *table,
+                                     sx126x_lr_fhss_hop_t *storage,
+                                     const uint32_t *hz,
+                                     const uint16_t *symbols,
+                                     uint16_t count)
+{
+  if (!table || !storage || !hz || !symbols || count == 0 || count > SX126X_LR_FHSS_MAX_HOPS)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  for (uint16_t i = 0; i < count; i++)
+  {
+    if (symbols[i] == 0)
+    {
+      return SX126X_ERR_INVALID_ARG;
+    }
+
+    sx126x_lr_fhss_hop_encode(&storage[i], i, hz[i], symbols[i]);
+  }
+
+  table->hops = storage;
+  table->count = count;
+
+  return SX126X_OK;
+}
@@ -0,0 +1,233 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/multi.h"
+#include "sx126x/bus.h"
+#include "sx126x/sx126x.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// DIO1 handler installed by the manager: only flag the radio, the service runs as a job.
+static void sx126x_multi_dio1(void *arg)
+{
+  sx126x_multi_slot_t *slot = (sx126x_multi_slot_t *)arg;
+  __atomic_store_n(&slot->irq_pending, 1, __ATOMIC_RELEASE);
+}
+
+static sx126x_status_t sx126x_multi_irq_fn(sx126x_t *radio, void *arg)
+{
+  (void)arg;
+  return sx126x_handle_irq(radio);
+}
+
+static void sx126x_multi_enqueue(sx126x_multi_slot_t *slot,
+                                 sx126x_multi_job_t *job,
+                                 sx126x_multi_prio_t prio)
+{
+  job->next = NULL;
+  job->queued = true;
+
+  if (slot->tail[prio])
+    slot->tail[prio]->next = job;
+  else
+    slot->head[prio] = job;
+  slot->tail[prio] = job;
+}
+
+static sx126x_multi_job_t *sx126x_multi_dequeue(sx126x_multi_slot_t *slot, sx126x_multi_prio_t prio)
+{
+  sx126x_multi_job_t *job = slot->head[prio];
+
+  slot->head[prio] = job->next;
+  if (!slot->head[prio])
+    slot->tail[prio] = NULL;
+
+  job->next = NULL;
+  job->queued = false;
+
+  return job;
+}
+
+// Turn DIO1 flags into IRQ service jobs. An already queued service job covers new IRQs too, since
+// sx126x_handle_irq reads every pending flag.
+static void sx126x_multi_collect_irqs(sx126x_multi_t *mgr)
+{
+  for (uint8_t i = 0; i < mgr->count; i++)
+  {
+    sx126x_multi_slot_t *slot = &mgr->slots[i];
+
+    if (__atomic_exchange_n(&slot->irq_pending, 0, __ATOMIC_ACQ_REL) && !slot->irq_job.queued)
+      sx126x_multi_enqueue(slot, &slot->irq_job, mgr->irq_prio);
+  }
+}
+
+// Next radio with work in a class, round-robin from where the class last left off.
+static sx126x_multi_slot_t *sx126x_multi_pick(sx126x_multi_t *mgr, sx126x_multi_prio_t prio)
+{
+  for (uint8_t k = 0; k < mgr->count; k++)
+  {
+    uint8_t i = (uint8_t)((mgr->cursor[prio] + k) % mgr->count);
+
+    if (mgr->slots[i].head[prio])
+    {
+      mgr->cursor[prio] = (uint8_t)((i + 1) % mgr->count);
+      return &mgr->slots[i];
+    }
+  }
+
+  return NULL;
+}
+
+sx126x_status_t sx126x_multi_init(sx126x_multi_t *mgr,
+                                  sx126x_multi_slot_t *slots,
+                                  sx126x_t *const *radios,
+                                  uint8_t count)
+{
+  if (!mgr || !slots || !radios || count == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (!radios[i] || !radios[i]->is_initialized)
+      return SX126X_ERR_NOT_INIT;
+  }
+
+  memset(mgr, 0, sizeof(*mgr));
+  memset(slots, 0, count * sizeof(slots[0]));
+
+  mgr->slots = slots;
+  mgr->count = count;
+  mgr->weight[SX126X_MULTI_PRIO_HIGH] = SX126X_MULTI_WEIGHT_HIGH;
+  mgr->weight[SX126X_MULTI_PRIO_NORMAL] = SX126X_MULTI_WEIGHT_NORMAL;
+  mgr->weight[SX126X_MULTI_PRIO_LOW] = SX126X_MULTI_WEIGHT_LOW;
+  memcpy(mgr->credit, mgr->weight, sizeof(mgr->credit));
+  mgr->irq_prio = SX126X_MULTI_PRIO_HIGH;
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    sx126x_multi_slot_t *slot = &slots[i];
+    sx126x_bus_t *bus = radios[i]->bus;
+
+    slot->radio = radios[i];
+    slot->mgr = mgr;
+    slot->irq_job.fn = sx126x_multi_irq_fn;
+
+    if (bus->attach_dio1)
+    {
+      sx126x_status_t st = bus->attach_dio1(bus, sx126x_multi_dio1, slot);
+      if (st != SX126X_OK)
+      {
+        // Hand the radios taken so far back to the driver's own handler.
+        for (uint8_t j = 0; j < i; j++)
+          sx126x_attach_irq(radios[j]);
+        memset(mgr, 0, sizeof(*mgr));
+        return st;
+      }
+    }
+  }
+
+  return SX126X_OK;
+}
+
+sx126x_status_t sx126x_multi_deinit(sx126x_multi_t *mgr)
+{
+  if (!mgr || !mgr->slots)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  for (uint8_t i = 0; i < mgr->count; i++)
+    sx126x_attach_irq(mgr->slots[i].radio);
+
+  memset(mgr, 0, sizeof(*mgr));
+
+  return SX126X_OK;
+}
+
+sx126x_status_t sx126x_multi_submit(sx126x_multi_t *mgr,
+                                    uint8_t index,
+                                    sx126x_multi_job_t *job,
+                                    sx126x_multi_prio_t prio,
+                                    sx126x_multi_job_fn_t fn,
+                                    sx126x_multi_done_cb_t done,
+                                    void *arg)
+{
+  if (!mgr || !job || !fn || index >= mgr->count || prio >= SX126X_MULTI_PRIO_COUNT)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (job->queued)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  job->fn = fn;
+  job->done = done;
+  job->arg = arg;
+  sx126x_multi_enqueue(&mgr->slots[index], job, prio);
+
+  return SX126X_OK;
+}
+
+void sx126x_multi_notify_irq(sx126x_multi_t *mgr, uint8_t index)
+{
+  if (mgr && index < mgr->count)
+    sx126x_multi_dio1(&mgr->slots[index]);
+}
+
+bool sx126x_multi_run_one(sx126x_multi_t *mgr)
+{
+  if (!mgr || !mgr->slots)
+  {
+    return false;
+  }
+
+  sx126x_multi_collect_irqs(mgr);
+
+  // Highest class with work and credit left goes first. Once every class with work has used up
+  // its credit, a new round starts.
+  for (int round = 0; round < 2; round++)
+  {
+    for (int p = 0; p < SX126X_MULTI_PRIO_COUNT; p++)
+    {
+      if (mgr->credit[p] == 0)
+        continue;
+
+      sx126x_multi_slot_t *slot = sx126x_multi_pick(mgr, (sx126x_multi_prio_t)p);
+      if (!slot)
+        continue;
+
+      mgr->credit[p]--;
+      slot->served[p]++;
+
+      sx126x_multi_job_t *job = sx126x_multi_dequeue(slot, (sx126x_multi_prio_t)p);
+      sx126x_multi_done_cb_t done = job->done;
+      void *arg = job->arg;
+
+      sx126x_status_t st = job->fn(slot->radio, arg);
+      if (done)
+        done(slot->radio, st, arg);
+
+      return true;
+    }
+
+    memcpy(mgr->credit, mgr->weight, sizeof(mgr->credit));
+  }
+
+  return false;
+}
+
+size_t sx126x_multi_run(sx126x_multi_t *mgr, size_t max)
+{
+  size_t n = 0;
+
+  while (n < max && sx126x_multi_run_one(mgr))
+    n++;
+
+  return n;
+}
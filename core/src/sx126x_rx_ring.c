@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/rx_ring.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Indices run freely and wrap at 2^32; slot = index & (capacity - 1). Each side publishes its own
+// index with release semantics and reads the other side's with acquire semantics.
+#define RING_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+sx126x_status_t
+sx126x_rx_ring_init(sx126x_rx_ring_t *ring, sx126x_rx_packet_t *slots, uint32_t capacity)
+{
+  if (!ring || !slots || capacity == 0 || (capacity & (capacity - 1)) != 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  ring->slots = slots;
+  ring->capacity = capacity;
+  ring->head = 0;
+  ring->tail = 0;
+
+  return SX126X_OK;
+}
+
+sx126x_rx_packet_t *sx126x_rx_ring_acquire(sx126x_rx_ring_t *ring)
+{
+  uint32_t head = ring->head;
+  uint32_t tail = RING_LOAD(&ring->tail);
+
+  if (head - tail >= ring->capacity)
+  {
+    return NULL;
+  }
+
+  return &ring->slots[head & (ring->capacity - 1)];
+}
+
+void sx126x_rx_ring_commit(sx126x_rx_ring_t *ring)
+{
+  RING_STORE(&ring->head, ring->head + 1);
+}
+
+const sx126x_rx_packet_t *sx126x_rx_ring_peek(sx126x_rx_ring_t *ring)
+{
+  uint32_t tail = ring->tail;
+  uint32_t head = RING_LOAD(&ring->head);
+
+  if (head == tail)
+  {
+    return NULL;
+  }
+
+  return &ring->slots[tail & (ring->capacity - 1)];
+}
+
+void sx126x_rx_ring_release(sx126x_rx_ring_t *ring)
+{
+  RING_STORE(&ring->tail, ring->tail + 1);
+}
+
+bool sx126x_rx_ring_pop(sx126x_rx_ring_t *ring, sx126x_rx_packet_t *out)
+{
+  const sx126x_rx_packet_t *pkt = sx126x_rx_ring_peek(ring);
+  if (!pkt)
+  {
+    return false;
+  }
+
+  out->len = pkt->len;
+  out->rssi_dbm = pkt->rssi_dbm;
+  out->signal_rssi_dbm = pkt->signal_rssi_dbm;
+  out->snr_db = pkt->snr_db;
+  out->irq = pkt->irq;
+  memcpy(out->payload, pkt->payload, pkt->len);
+
+  sx126x_rx_ring_release(ring);
+  return true;
+}
+
+uint32_t sx126x_rx_ring_count(const sx126x_rx_ring_t *ring)
+{
+  return RING_LOAD(&ring->head) - RING_LOAD(&ring->tail);
+}
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/stats.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if SX126X_ENABLE_STATS
+
+static unsigned sx126x_stats_bucket(uint32_t us)
+{
+  unsigned bucket = 0;
+
+  while (us && bucket < SX126X_STATS_HIST_BUCKETS - 1)
+  {
+    us >>= 1;
+    bucket++;
+  }
+
+  return bucket;
+}
+
+static sx126x_op_stats_t *sx126x_stats_slot(sx126x_stats_t *stats, uint8_t opcode)
+{
+  for (uint8_t i = 0; i < stats->op_count; i++)
+  {
+    if (stats->ops[i].opcode == opcode)
+      return &stats->ops[i];
+  }
+
+  // The last slot is reserved for opcodes that did not get one of their own.
+  if (stats->op_count < SX126X_STATS_MAX_OPCODES - 1)
+  {
+    sx126x_op_stats_t *op = &stats->ops[stats->op_count++];
+    op->opcode = opcode;
+    return op;
+  }
+
+  sx126x_op_stats_t *other = &stats->ops[SX126X_STATS_MAX_OPCODES - 1];
+  if (stats->op_count < SX126X_STATS_MAX_OPCODES)
+  {
+    other->opcode = SX126X_STATS_OPCODE_OTHER;
+    stats->op_count = SX126X_STATS_MAX_OPCODES;
+  }
+  return other;
+}
+
+void sx126x_stats_record_call(sx126x_stats_t *stats, bool batch, uint32_t elapsed_us, bool ok)
+{
+  if (batch)
+    stats->batches++;
+  else
+    stats->transfers++;
+
+  if (!ok)
+    stats->failures++;
+
+  stats->hist[sx126x_stats_bucket(elapsed_us)]++;
+}
+
+void sx126x_stats_record_frame(
+    sx126x_stats_t *stats, uint8_t opcode, size_t bytes, uint32_t elapsed_us, bool ok)
+{
+  sx126x_op_stats_t *op = sx126x_stats_slot(stats, opcode);
+
+  op->calls++;
+  if (!ok)
+    op->failures++;
+  op->bytes += (uint32_t)bytes;
+  op->total_us += elapsed_us;
+  if (elapsed_us > op->max_us)
+    op->max_us = elapsed_us;
+}
+
+#endif // SX126X_ENABLE_STATS
+
+void sx126x_stats_dump(const sx126x_stats_t *stats, void (*print)(const char *fmt, ...))
+{
+  if (!stats || !print)
+  {
+    return;
+  }
+
+  print("bus: transfers=%lu batches=%lu failures=%lu",
+        (unsigned long)stats->transfers,
+        (unsigned long)stats->batches,
+        (unsigned long)stats->failures);
+
+  for (uint8_t i = 0; i < stats->op_count && i < SX126X_STATS_MAX_OPCODES; i++)
+  {
+    const sx126x_op_stats_t *op = &stats->ops[i];
+    print("op 0x%02X: calls=%lu failures=%lu bytes=%lu total=%luus avg=%luus max=%luus",
+          op->opcode,
+          (unsigned long)op->calls,
+          (unsigned long)op->failures,
+          (unsigned long)op->bytes,
+          (unsigned long)op->total_us,
+          (unsigned long)(op->calls ? op->total_us / op->calls : 0),
+          (unsigned long)op->max_us);
+  }
+
+  for (unsigned i = 0; i < SX126X_STATS_HIST_BUCKETS; i++)
+  {
+    if (stats->hist[i] == 0)
+      continue;
+
+    if (i == 0)
+      print("hist 0us: %lu", (unsigned long)stats->hist[i]);
+    else if (i == SX126X_STATS_HIST_BUCKETS - 1)
+      print("hist >=%luus: %lu", 1ul << (i - 1), (unsigned long)stats->hist[i]);
+    else
+      print("hist %lu-%luus: %lu", 1ul << (i - 1), (1ul << i) - 1, (unsigned long)stats->hist[i]);
+  }
+}
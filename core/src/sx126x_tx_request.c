@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/tx_request.h"
+#include "sx126x/sx126x.h"
+#include "sx126x/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+void sx126x_tx_fifo_init(sx126x_tx_fifo_t *fifo)
+{
+  fifo->head = NULL;
+  fifo->tail = NULL;
+}
+
+sx126x_status_t sx126x_tx_fifo_push(sx126x_tx_fifo_t *fifo,
+                                    sx126x_tx_req_t *req,
+                                    const uint8_t *payload,
+                                    uint8_t len,
+                                    sx126x_tx_done_cb_t done,
+                                    void *arg)
+{
+  if (!fifo || !req || !payload || len == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (req->queued)
+  {
+    return SX126X_ERR_BUSY;
+  }
+
+  req->payload = payload;
+  req->len = len;
+  req->done = done;
+  req->arg = arg;
+  req->next = NULL;
+  req->queued = true;
+
+  if (fifo->tail)
+    fifo->tail->next = req;
+  else
+    fifo->head = req;
+  fifo->tail = req;
+
+  return SX126X_OK;
+}
+
+void sx126x_tx_fifo_remove(sx126x_tx_fifo_t *fifo, sx126x_tx_req_t *prev, sx126x_tx_req_t *req)
+{
+  if (prev)
+    prev->next = req->next;
+  else
+    fifo->head = req->next;
+  if (fifo->tail == req)
+    fifo->tail = prev;
+
+  req->next = NULL;
+  req->queued = false;
+}
+
+void sx126x_tx_fifo_finish(sx126x_tx_fifo_t *fifo,
+                           sx126x_tx_req_t *prev,
+                           sx126x_tx_req_t *req,
+                           sx126x_t *radio,
+                           sx126x_status_t result)
+{
+  sx126x_tx_fifo_remove(fifo, prev, req);
+  if (req->done)
+    req->done(radio, result, req->arg);
+}
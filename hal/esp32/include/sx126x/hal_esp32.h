@@ -27,6 +27,9 @@ typedef struct
   int spi_cs_pin;            /**< GPIO pin number for SPI chip select */
   int spi_clock_speed_hz;    /**< SPI clock speed in Hz */
   int spi_queue_size;        /**< SPI queue size */
+  bool use_dio1;             /**< DIO1 is connected, to dio1_pin; polled operation otherwise */
+  int dio1_pin;              /**< GPIO pin number for DIO1, if use_dio1 is set */
+  int busy_pin;              /**< GPIO pin number for BUSY */
 } sx126x_hal_esp32_cfg_t;
 
 /**
@@ -40,8 +43,14 @@ typedef struct sx126x_hal_s
   volatile bool is_running;
   volatile bool is_shutdown_requested;
   SemaphoreHandle_t spi_mutex;
+  bool is_bus_initialized;
   spi_device_handle_t lora_handle;
   TaskHandle_t spi_task_handle;
+  int dio1_pin;
+  int busy_pin;
+  volatile bool is_irq_task_running;
+  sx126x_bus_irq_handler_t dio1_handler;
+  void *dio1_arg;
 } sx126x_hal_esp32_t;
 
 #ifdef __cplusplus
@@ -51,6 +60,9 @@ extern "C"
 
 /**
  * @brief Convenience factory that fills *out with an sx126x_hal_t instance of the ESP32 HAL.
+ *
+ * Transfers of more than 4 bytes go through DMA; buffers outside DMA-capable memory, or not word
+ * aligned, are copied through a heap bounce buffer on each transfer.
  */
 sx126x_status_t sx126x_hal_esp32_init(sx126x_hal_t *out, const sx126x_hal_esp32_cfg_t *cfg);
 
@@ -4,14 +4,134 @@
 #include "sx126x/bus.h"
 #include "sx126x/hal_esp32.h"
 #include "sx126x/sx126x.h"
+#include <driver/gpio.h>
 #include <driver/spi_master.h>
+#include <esp_attr.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <stdbool.h>
 #include <string.h>
 
-static sx126x_status_t esp32_spi_transfer(sx126x_bus_t *bus, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len)
+#define ESP32_IRQ_TASK_STACK_SIZE 4096
+#define ESP32_IRQ_TASK_PRIORITY (configMAX_PRIORITIES - 2)
+#define ESP32_IRQ_TASK_POLL_MS 100
+// Ticks before the IRQ task looks again at a DIO1 line still high after its handler ran.
+#define ESP32_IRQ_TASK_RECHECK_TICKS 1
+
+// Longest BUSY wait before a frame: calibrating all blocks takes about 3.5 ms.
+#define ESP32_BUSY_TIMEOUT_US 10000
+
+// Command phase split at the ends of tx and rx, plus the payload phase.
+#define ESP32_SPI_MAX_SEGMENTS 4
+
+// Longest segment carried in the transaction itself rather than through DMA.
+#define ESP32_SPI_INLINE_LEN 4
+
+// A run of bytes within one frame with the same buffers behind it.
+typedef struct
+{
+  const uint8_t *tx;
+  uint8_t *rx;
+  size_t len;
+} esp32_spi_segment_t;
+
+// Clocked out for segments without tx, so MOSI carries NOPs while the chip answers. In DMA-capable
+// memory, since these segments are mostly reads long enough to go through DMA.
+DMA_ATTR static uint8_t esp32_spi_zeros[SX126X_BUFFER_SIZE];
+
+// Wait for the chip to be ready for the next frame. BUSY is low again within microseconds after
+// most commands, so it is polled without yielding.
+static esp_err_t esp32_wait_busy(const sx126x_hal_esp32_t *hal)
+{
+  int64_t start = esp_timer_get_time();
+
+  while (gpio_get_level(hal->busy_pin))
+  {
+    if (esp_timer_get_time() - start > ESP32_BUSY_TIMEOUT_US)
+      return ESP_ERR_TIMEOUT;
+  }
+
+  return ESP_OK;
+}
+
+static sx126x_status_t esp32_status(esp_err_t ret)
+{
+  if (ret == ESP_OK)
+    return SX126X_OK;
+  return ret == ESP_ERR_TIMEOUT ? SX126X_ERR_TIMEOUT : SX126X_ERR_IO;
+}
+
+// Clock one frame out on the SPI device. The frame is cut into segments wherever tx or rx ends, so
+// neither is read or written past its length, and the segments go out back to back under one CS
+// assertion. A segment without tx clocks out zeros. Segments of up to ESP32_SPI_INLINE_LEN bytes,
+// i.e. most commands, are copied into the transaction; longer ones are moved by DMA straight from
+// and into the caller's buffers, which the SPI driver bounces through the heap unless they are
+// DMA-capable and word aligned. The frame starts once BUSY is low. The caller must hold spi_mutex
+// and the bus.
+static esp_err_t esp32_spi_transmit_locked(sx126x_hal_esp32_t *hal, const sx126x_bus_frame_t *f)
 {
-  if (!bus || !(tx && !rx) || (tx_len == 0 && rx_len == 0))
+  size_t tx_n = f->tx ? f->tx_len : 0;
+  size_t rx_n = f->rx ? f->rx_len : 0;
+  size_t cmd_len = f->tx_len > f->rx_len ? f->tx_len : f->rx_len;
+  esp32_spi_segment_t seg[ESP32_SPI_MAX_SEGMENTS];
+  size_t n = 0;
+
+  for (size_t pos = 0; pos < cmd_len;)
+  {
+    size_t end = cmd_len;
+    if (pos < tx_n && tx_n < end)
+      end = tx_n;
+    if (pos < rx_n && rx_n < end)
+      end = rx_n;
+
+    seg[n++] = (esp32_spi_segment_t){
+      .tx = pos < tx_n ? f->tx + pos : NULL,
+      .rx = pos < rx_n ? f->rx + pos : NULL,
+      .len = end - pos,
+    };
+    pos = end;
+  }
+
+  if (f->data_len)
+  {
+    seg[n++] = (esp32_spi_segment_t){.tx = f->data_tx, .rx = f->data_rx, .len = f->data_len};
+  }
+
+  esp_err_t ret = esp32_wait_busy(hal);
+  for (size_t i = 0; ret == ESP_OK && i < n; i++)
+  {
+    const uint8_t *tx = seg[i].tx ? seg[i].tx : esp32_spi_zeros;
+    spi_transaction_t t = {
+      .flags = i + 1 < n ? SPI_TRANS_CS_KEEP_ACTIVE : 0,
+      .length = seg[i].len * 8,
+      .rxlength = seg[i].rx ? seg[i].len * 8 : 0,
+      .tx_buffer = tx,
+      .rx_buffer = seg[i].rx,
+    };
+
+    if (seg[i].len <= ESP32_SPI_INLINE_LEN)
+    {
+      t.flags |= SPI_TRANS_USE_TXDATA | (seg[i].rx ? SPI_TRANS_USE_RXDATA : 0);
+      memcpy(t.tx_data, tx, seg[i].len);
+    }
+    else if (!seg[i].tx && seg[i].len > sizeof(esp32_spi_zeros))
+    {
+      ret = ESP_ERR_INVALID_SIZE;
+      break;
+    }
+
+    ret = spi_device_polling_transmit(hal->lora_handle, &t);
+    if (ret == ESP_OK && (t.flags & SPI_TRANS_USE_RXDATA))
+      memcpy(seg[i].rx, t.rx_data, seg[i].len);
+  }
+
+  return ret;
+}
+
+static sx126x_status_t
+esp32_spi_transfer(sx126x_bus_t *bus, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len)
+{
+  if (!bus || (!tx && !rx) || (tx_len == 0 && rx_len == 0))
   {
     return SX126X_ERR_INVALID_ARG;
   }
@@ -22,29 +142,171 @@ static sx126x_status_t esp32_spi_transfer(sx126x_bus_t *bus, const uint8_t *tx,
     return SX126X_ERR_INVALID_ARG;
   }
 
-  size_t len = tx_len > rx_len ? tx_len : rx_len;
+  sx126x_bus_frame_t frame = {.tx = tx, .tx_len = tx_len, .rx = rx, .rx_len = rx_len};
 
-  uint8_t dummy_tx[len];
-  const uint8_t *tx_buf = tx ? tx : dummy_tx;
-  if (!tx)
+  // Keeping CS asserted across segments requires the bus to be acquired.
+  xSemaphoreTakeRecursive(hal->spi_mutex, portMAX_DELAY);
+  esp_err_t ret = spi_device_acquire_bus(hal->lora_handle, portMAX_DELAY);
+  if (ret == ESP_OK)
   {
-    memset(dummy_tx, 0x00, len);
+    ret = esp32_spi_transmit_locked(hal, &frame);
+    spi_device_release_bus(hal->lora_handle);
   }
+  xSemaphoreGiveRecursive(hal->spi_mutex);
 
-  uint8_t dummy_rx[len];
-  uint8_t *rx_buf = rx ? rx : dummy_rx;
+  return esp32_status(ret);
+}
+
+static sx126x_status_t
+esp32_spi_transfer_batch(sx126x_bus_t *bus, const sx126x_bus_frame_t *frames, size_t count)
+{
+  if (!bus || !frames || count == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  sx126x_hal_esp32_t *hal = (sx126x_hal_esp32_t *)bus->ctx;
+  if (!hal || !hal->lora_handle)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  // Take the mutex and the SPI bus once for the whole sequence; each frame still gets its own CS
+  // assertion, which is what the SX126x uses to delimit commands.
+  xSemaphoreTakeRecursive(hal->spi_mutex, portMAX_DELAY);
+
+  esp_err_t ret = spi_device_acquire_bus(hal->lora_handle, portMAX_DELAY);
+  if (ret == ESP_OK)
+  {
+    for (size_t i = 0; ret == ESP_OK && i < count; i++)
+    {
+      ret = esp32_spi_transmit_locked(hal, &frames[i]);
+    }
+
+    spi_device_release_bus(hal->lora_handle);
+  }
+
+  xSemaphoreGiveRecursive(hal->spi_mutex);
+
+  return esp32_status(ret);
+}
+
+// Wake the chip with a lone GetStatus byte, clocked without the BUSY wait since BUSY is high while
+// the chip sleeps, then wait for it to come up.
+static sx126x_status_t esp32_wake(sx126x_bus_t *bus)
+{
+  sx126x_hal_esp32_t *hal = bus ? (sx126x_hal_esp32_t *)bus->ctx : NULL;
+  if (!hal || !hal->lora_handle)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
 
   spi_transaction_t t = {
-    .length = len * 8,
-    .tx_buffer = tx_buf,
-    .rx_buffer = rx_buf,
+      .flags = SPI_TRANS_USE_TXDATA,
+      .length = 8,
+      .tx_data = {SX126X_OP_GET_STATUS},
   };
 
-  xSemaphoreTake(hal->spi_mutex, portMAX_DELAY);
-  esp_err_t ret = spi_device_transmit(hal->lora_handle, &t);
-  xSemaphoreGive(hal->spi_mutex);
+  xSemaphoreTakeRecursive(hal->spi_mutex, portMAX_DELAY);
+  esp_err_t ret = spi_device_polling_transmit(hal->lora_handle, &t);
+  if (ret == ESP_OK)
+    ret = esp32_wait_busy(hal);
+  xSemaphoreGiveRecursive(hal->spi_mutex);
 
-  return (ret == ESP_OK) ? SX126X_OK : SX126X_ERR_IO;
+  return esp32_status(ret);
+}
+
+// Hold spi_mutex across a whole driver operation. The transfers inside it re-take it recursively,
+// which does not block.
+static sx126x_status_t esp32_bus_lock(sx126x_bus_t *bus)
+{
+  sx126x_hal_esp32_t *hal = bus ? (sx126x_hal_esp32_t *)bus->ctx : NULL;
+  if (!hal || !hal->spi_mutex)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  xSemaphoreTakeRecursive(hal->spi_mutex, portMAX_DELAY);
+
+  return SX126X_OK;
+}
+
+static void esp32_bus_unlock(sx126x_bus_t *bus)
+{
+  sx126x_hal_esp32_t *hal = (sx126x_hal_esp32_t *)bus->ctx;
+  xSemaphoreGiveRecursive(hal->spi_mutex);
+}
+
+// DIO1 rising edge: defer to the IRQ task, which is allowed to talk SPI.
+static void IRAM_ATTR esp32_dio1_isr(void *arg)
+{
+  sx126x_hal_esp32_t *hal = (sx126x_hal_esp32_t *)arg;
+  BaseType_t woken = pdFALSE;
+
+  vTaskNotifyGiveFromISR(hal->spi_task_handle, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+static void esp32_irq_task(void *arg)
+{
+  sx126x_hal_esp32_t *hal = (sx126x_hal_esp32_t *)arg;
+  TickType_t wait = pdMS_TO_TICKS(ESP32_IRQ_TASK_POLL_MS);
+
+  while (!hal->is_shutdown_requested)
+  {
+    ulTaskNotifyTake(pdTRUE, wait);
+
+    // One handler run per edge. The line can stay high after it: an edge was missed during
+    // handling, or the handler only deferred the work, as the multi-radio manager's does. Look
+    // again a tick later rather than calling the handler in a loop.
+    if (!hal->is_shutdown_requested && hal->dio1_handler && gpio_get_level(hal->dio1_pin))
+      hal->dio1_handler(hal->dio1_arg);
+
+    wait = gpio_get_level(hal->dio1_pin) ? ESP32_IRQ_TASK_RECHECK_TICKS
+                                         : pdMS_TO_TICKS(ESP32_IRQ_TASK_POLL_MS);
+  }
+
+  hal->is_irq_task_running = false;
+  vTaskDelete(NULL);
+}
+
+static sx126x_status_t
+esp32_attach_dio1(sx126x_bus_t *bus, sx126x_bus_irq_handler_t handler, void *arg)
+{
+  if (!bus)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  sx126x_hal_esp32_t *hal = (sx126x_hal_esp32_t *)bus->ctx;
+  if (!hal || hal->dio1_pin < 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  gpio_intr_disable(hal->dio1_pin);
+  hal->dio1_handler = handler;
+  hal->dio1_arg = handler ? arg : NULL;
+  if (handler)
+    gpio_intr_enable(hal->dio1_pin);
+
+  return SX126X_OK;
+}
+
+static uint32_t esp32_now_us(sx126x_bus_t *bus)
+{
+  (void)bus;
+  return (uint32_t)esp_timer_get_time();
+}
+
+// Sleep, rounding up to at least one tick: the driver only waits here between polls of the chip,
+// and spinning through them would hold the CPU for the whole packet.
+static void esp32_delay_us(sx126x_bus_t *bus, uint32_t us)
+{
+  (void)bus;
+
+  TickType_t ticks = pdMS_TO_TICKS((us + 999) / 1000);
+  vTaskDelay(ticks > 0 ? ticks : 1);
 }
 
 static void esp32_log(const char *fmt, ...)
@@ -60,14 +322,21 @@ static void esp32_log(const char *fmt, ...)
 sx126x_status_t sx126x_hal_esp32_init(sx126x_hal_t *hal, const sx126x_hal_esp32_cfg_t *cfg)
 {
   memset(hal, 0, sizeof(*hal));
+  hal->dio1_pin = -1;
 
   hal->bus.transfer = esp32_spi_transfer;
+  hal->bus.transfer_batch = esp32_spi_transfer_batch;
+  hal->bus.wake = esp32_wake;
+  hal->bus.lock = esp32_bus_lock;
+  hal->bus.unlock = esp32_bus_unlock;
+  hal->bus.now_us = esp32_now_us;
+  hal->bus.delay_us = esp32_delay_us;
   hal->bus.log = esp32_log;
   hal->bus.ctx = hal;
 
   hal->bus.log("Initializing SPI...");
 
-  hal->spi_mutex = xSemaphoreCreateMutex();
+  hal->spi_mutex = xSemaphoreCreateRecursiveMutex();
   if (!hal->spi_mutex)
   {
     hal->bus.log("Failed to create SPI mutex.");
@@ -85,8 +354,11 @@ sx126x_status_t sx126x_hal_esp32_init(sx126x_hal_t *hal, const sx126x_hal_esp32_
   if (ret != ESP_OK)
   {
     hal->bus.log("Failed to init SPI bus with status: %d.", ret);
+    sx126x_hal_esp32_deinit(hal);
     return SX126X_ERR_UNKNOWN;
   }
+  hal->spi_host = cfg->spi_host;
+  hal->is_bus_initialized = true;
 
   spi_device_interface_config_t devcfg = {
       .clock_speed_hz = cfg->spi_clock_speed_hz,
@@ -99,17 +371,91 @@ sx126x_status_t sx126x_hal_esp32_init(sx126x_hal_t *hal, const sx126x_hal_esp32_
   if (ret != ESP_OK)
   {
     hal->bus.log("Failed to add SPI device with status: %d.", ret);
+    sx126x_hal_esp32_deinit(hal);
     return SX126X_ERR_UNKNOWN;
   }
 
-  hal->spi_host = cfg->spi_host;
   hal->is_shutdown_requested = false;
+  hal->busy_pin = cfg->busy_pin;
+
+  gpio_config_t busy_io = {
+      .pin_bit_mask = 1ULL << hal->busy_pin,
+      .mode = GPIO_MODE_INPUT,
+      .pull_up_en = GPIO_PULLUP_DISABLE,
+      .pull_down_en = GPIO_PULLDOWN_DISABLE,
+      .intr_type = GPIO_INTR_DISABLE,
+  };
+
+  ret = gpio_config(&busy_io);
+  if (ret != ESP_OK)
+  {
+    hal->bus.log("Failed to configure BUSY with status: %d.", ret);
+    sx126x_hal_esp32_deinit(hal);
+    return SX126X_ERR_UNKNOWN;
+  }
+
+  if (cfg->use_dio1)
+  {
+    hal->dio1_pin = cfg->dio1_pin;
+
+    gpio_config_t io = {
+        .pin_bit_mask = 1ULL << hal->dio1_pin,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_POSEDGE,
+    };
+
+    ret = gpio_config(&io);
+    if (ret != ESP_OK)
+    {
+      hal->bus.log("Failed to configure DIO1 with status: %d.", ret);
+      sx126x_hal_esp32_deinit(hal);
+      return SX126X_ERR_UNKNOWN;
+    }
+
+    hal->is_irq_task_running = true;
+    if (xTaskCreate(esp32_irq_task,
+                    "sx126x_irq",
+                    ESP32_IRQ_TASK_STACK_SIZE,
+                    hal,
+                    ESP32_IRQ_TASK_PRIORITY,
+                    &hal->spi_task_handle) != pdPASS)
+    {
+      hal->is_irq_task_running = false;
+      hal->bus.log("Failed to create DIO1 task.");
+      sx126x_hal_esp32_deinit(hal);
+      return SX126X_ERR_NO_MEM;
+    }
+
+    // The ISR service may already have been installed by the application.
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE)
+    {
+      hal->bus.log("Failed to install GPIO ISR service with status: %d.", ret);
+      sx126x_hal_esp32_deinit(hal);
+      return SX126X_ERR_UNKNOWN;
+    }
+
+    gpio_intr_disable(hal->dio1_pin);
+    ret = gpio_isr_handler_add(hal->dio1_pin, esp32_dio1_isr, hal);
+    if (ret != ESP_OK)
+    {
+      hal->bus.log("Failed to add DIO1 ISR with status: %d.", ret);
+      sx126x_hal_esp32_deinit(hal);
+      return SX126X_ERR_UNKNOWN;
+    }
+
+    hal->bus.attach_dio1 = esp32_attach_dio1;
+  }
+
   hal->is_running = true;
   hal->bus.log("SPI initialized successfully.");
 
   return SX126X_OK;
 }
 
+// Also unwinds a partly done sx126x_hal_esp32_init, releasing only what it got to set up.
 sx126x_status_t sx126x_hal_esp32_deinit(sx126x_hal_t *hal)
 {
   if (!hal)
@@ -119,13 +465,30 @@ sx126x_status_t sx126x_hal_esp32_deinit(sx126x_hal_t *hal)
 
   hal->is_shutdown_requested = true;
 
+  if (hal->dio1_pin >= 0)
+  {
+    gpio_isr_handler_remove(hal->dio1_pin);
+  }
+
+  if (hal->is_irq_task_running)
+  {
+    xTaskNotifyGive(hal->spi_task_handle);
+    while (hal->is_irq_task_running)
+    {
+      vTaskDelay(1);
+    }
+  }
+
   if (hal->lora_handle)
   {
     spi_bus_remove_device(hal->lora_handle);
     hal->lora_handle = NULL;
   }
 
-  spi_bus_free(hal->spi_host);
+  if (hal->is_bus_initialized)
+  {
+    spi_bus_free(hal->spi_host);
+  }
 
   if (hal->spi_mutex)
   {
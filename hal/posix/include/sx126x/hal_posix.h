@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file hal_posix.h
+ * @brief pthread-based reference HAL for host builds.
+ * @version 0.1
+ * @date 2025
+ *
+ * Shows how a HAL on a threaded OS serializes access to a shared SPI bus. Several radios can sit
+ * on one sx126x_hal_posix_bus_t, whose recursive mutex backs the bus lock/unlock hooks, so every
+ * driver operation reaches the wire as one uninterrupted sequence. DIO1 is serviced by a
+ * dedicated thread.
+ *
+ * The HAL does not clock bytes itself: it forwards every frame to a backend sx126x_bus_t, such as
+ * a Linux spidev binding or the simulated chip from hal_sim.h. Because of that it has its own
+ * instance type and is linked alongside another HAL rather than instead of one.
+ */
+
+#ifndef SX126X_HAL_POSIX_H
+#define SX126X_HAL_POSIX_H
+
+#include "sx126x/bus.h"
+#include "sx126x/sx126x.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Contention counters of a shared bus. Only read them while no radio is active.
+ */
+typedef struct
+{
+  uint64_t acquisitions; /**< Outermost acquisitions of the bus mutex */
+  uint64_t contended;    /**< Acquisitions that found the mutex held by another thread */
+  uint64_t transfers;    /**< transfer/transfer_batch calls forwarded to a backend */
+  uint64_t frames;       /**< Frames forwarded to a backend */
+  uint64_t switches;     /**< Frames issued by a different radio than the frame before */
+} sx126x_hal_posix_bus_stats_t;
+
+/**
+ * @brief One physical SPI bus, shared by every radio wired to it.
+ */
+typedef struct
+{
+  pthread_mutex_t mutex; // recursive
+  unsigned depth;
+  const void *last_radio;
+  sx126x_hal_posix_bus_stats_t stats;
+} sx126x_hal_posix_bus_t;
+
+/**
+ * @brief Configuration options for one radio on the POSIX HAL.
+ */
+typedef struct
+{
+  sx126x_hal_posix_bus_t *shared; /**< Bus the radio is wired to */
+  sx126x_bus_t *backend;          /**< Moves the bytes; only its transfer is required */
+  bool disable_lock_hooks;        /**< Leave bus.lock/unlock NULL: lock per transfer only */
+} sx126x_hal_posix_cfg_t;
+
+/**
+ * @brief Represents one radio on the POSIX HAL.
+ */
+typedef struct
+{
+  sx126x_bus_t bus;
+  sx126x_t dev;
+  sx126x_hal_posix_cfg_t cfg;
+
+  pthread_t irq_thread;
+  pthread_mutex_t irq_mutex;
+  pthread_cond_t irq_cond;
+  bool irq_pending;
+  bool is_irq_thread_running;
+  bool is_shutdown_requested;
+  sx126x_bus_irq_handler_t dio1_handler;
+  void *dio1_arg;
+} sx126x_hal_posix_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Initialize a shared bus.
+ */
+sx126x_status_t sx126x_hal_posix_bus_init(sx126x_hal_posix_bus_t *bus);
+
+/**
+ * @brief Destroy a shared bus once every radio on it has been deinitialized.
+ */
+void sx126x_hal_posix_bus_deinit(sx126x_hal_posix_bus_t *bus);
+
+/**
+ * @brief Set up one radio on a shared bus and start its DIO1 thread.
+ */
+sx126x_status_t sx126x_hal_posix_init(sx126x_hal_posix_t *hal, const sx126x_hal_posix_cfg_t *cfg);
+
+/**
+ * @brief Stop the DIO1 thread. Deinitialize the radio's sx126x_t first.
+ */
+sx126x_status_t sx126x_hal_posix_deinit(sx126x_hal_posix_t *hal);
+
+/**
+ * @brief Report a DIO1 rising edge, e.g. from a GPIO event loop. Safe to call from any thread;
+ * the attached handler runs on the radio's DIO1 thread.
+ */
+void sx126x_hal_posix_notify_dio1(sx126x_hal_posix_t *hal);
+
+sx126x_bus_t *sx126x_hal_posix_get_bus(sx126x_hal_posix_t *hal);
+sx126x_t *sx126x_hal_posix_get_device(sx126x_hal_posix_t *hal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_HAL_POSIX_H
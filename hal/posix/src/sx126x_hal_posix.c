@@ -0,0 +1,328 @@
+// SPDX-License-Identifier: MIT
+
+// Recursive mutexes and clock_gettime() under strict ISO C builds.
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "sx126x/hal_posix.h"
+#include "sx126x/bus.h"
+#include "sx126x/sx126x.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+// Take the shared bus mutex, counting outermost and contended acquisitions.
+static void posix_bus_acquire(sx126x_hal_posix_bus_t *bus)
+{
+  // trylock succeeds for the owning thread since the mutex is recursive, so only waits on
+  // another thread count as contention.
+  if (pthread_mutex_trylock(&bus->mutex) != 0)
+  {
+    pthread_mutex_lock(&bus->mutex);
+    bus->stats.contended++;
+  }
+
+  if (bus->depth++ == 0)
+    bus->stats.acquisitions++;
+}
+
+static void posix_bus_release(sx126x_hal_posix_bus_t *bus)
+{
+  bus->depth--;
+  pthread_mutex_unlock(&bus->mutex);
+}
+
+// Account for frames about to go out on behalf of hal. The caller holds the bus mutex.
+static void
+posix_bus_account(sx126x_hal_posix_bus_t *bus, const sx126x_hal_posix_t *hal, size_t frames)
+{
+  if (bus->last_radio != hal)
+  {
+    bus->stats.switches++;
+    bus->last_radio = hal;
+  }
+
+  bus->stats.transfers++;
+  bus->stats.frames += frames;
+}
+
+static sx126x_status_t
+posix_transfer(sx126x_bus_t *bus, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len)
+{
+  sx126x_hal_posix_t *hal = bus ? (sx126x_hal_posix_t *)bus->ctx : NULL;
+  if (!hal || (tx_len == 0 && rx_len == 0))
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  sx126x_hal_posix_bus_t *shared = hal->cfg.shared;
+  sx126x_bus_t *backend = hal->cfg.backend;
+
+  posix_bus_acquire(shared);
+  posix_bus_account(shared, hal, 1);
+  sx126x_status_t st = backend->transfer(backend, tx, tx_len, rx, rx_len);
+  posix_bus_release(shared);
+
+  return st;
+}
+
+static sx126x_status_t
+posix_transfer_batch(sx126x_bus_t *bus, const sx126x_bus_frame_t *frames, size_t count)
+{
+  sx126x_hal_posix_t *hal = bus ? (sx126x_hal_posix_t *)bus->ctx : NULL;
+  if (!hal || !frames || count == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  sx126x_hal_posix_bus_t *shared = hal->cfg.shared;
+  sx126x_bus_t *backend = hal->cfg.backend;
+
+  posix_bus_acquire(shared);
+  posix_bus_account(shared, hal, count);
+  sx126x_status_t st = backend->transfer_batch(backend, frames, count);
+  posix_bus_release(shared);
+
+  return st;
+}
+
+static sx126x_status_t posix_wake(sx126x_bus_t *bus)
+{
+  sx126x_hal_posix_t *hal = bus ? (sx126x_hal_posix_t *)bus->ctx : NULL;
+  if (!hal)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  sx126x_hal_posix_bus_t *shared = hal->cfg.shared;
+  sx126x_bus_t *backend = hal->cfg.backend;
+
+  posix_bus_acquire(shared);
+  posix_bus_account(shared, hal, 1);
+  sx126x_status_t st = backend->wake(backend);
+  posix_bus_release(shared);
+
+  return st;
+}
+
+static sx126x_status_t posix_bus_lock(sx126x_bus_t *bus)
+{
+  sx126x_hal_posix_t *hal = bus ? (sx126x_hal_posix_t *)bus->ctx : NULL;
+  if (!hal)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  posix_bus_acquire(hal->cfg.shared);
+
+  return SX126X_OK;
+}
+
+static void posix_bus_unlock(sx126x_bus_t *bus)
+{
+  sx126x_hal_posix_t *hal = (sx126x_hal_posix_t *)bus->ctx;
+  posix_bus_release(hal->cfg.shared);
+}
+
+static sx126x_status_t
+posix_attach_dio1(sx126x_bus_t *bus, sx126x_bus_irq_handler_t handler, void *arg)
+{
+  sx126x_hal_posix_t *hal = bus ? (sx126x_hal_posix_t *)bus->ctx : NULL;
+  if (!hal)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  pthread_mutex_lock(&hal->irq_mutex);
+  hal->dio1_handler = handler;
+  hal->dio1_arg = handler ? arg : NULL;
+  pthread_mutex_unlock(&hal->irq_mutex);
+
+  return SX126X_OK;
+}
+
+// Prefer the backend's clock, which is the modelled one when the backend is the simulator.
+static uint32_t posix_now_us(sx126x_bus_t *bus)
+{
+  sx126x_hal_posix_t *hal = (sx126x_hal_posix_t *)bus->ctx;
+  sx126x_bus_t *backend = hal->cfg.backend;
+
+  if (backend->now_us)
+  {
+    return backend->now_us(backend);
+  }
+
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+// Wait on the backend's clock when it has its own, e.g. the simulator's modelled one.
+static void posix_delay_us(sx126x_bus_t *bus, uint32_t us)
+{
+  sx126x_hal_posix_t *hal = (sx126x_hal_posix_t *)bus->ctx;
+  sx126x_bus_t *backend = hal->cfg.backend;
+
+  if (backend->delay_us)
+  {
+    backend->delay_us(backend, us);
+    return;
+  }
+
+  struct timespec ts = {.tv_sec = us / 1000000u, .tv_nsec = (long)(us % 1000000u) * 1000};
+  nanosleep(&ts, NULL);
+}
+
+// DIO1 thread: runs the attached handler once per reported edge, outside of irq_mutex.
+static void *posix_irq_thread(void *arg)
+{
+  sx126x_hal_posix_t *hal = (sx126x_hal_posix_t *)arg;
+
+  pthread_mutex_lock(&hal->irq_mutex);
+  while (!hal->is_shutdown_requested)
+  {
+    if (!hal->irq_pending)
+    {
+      pthread_cond_wait(&hal->irq_cond, &hal->irq_mutex);
+      continue;
+    }
+
+    hal->irq_pending = false;
+    sx126x_bus_irq_handler_t handler = hal->dio1_handler;
+    void *handler_arg = hal->dio1_arg;
+
+    pthread_mutex_unlock(&hal->irq_mutex);
+    if (handler)
+      handler(handler_arg);
+    pthread_mutex_lock(&hal->irq_mutex);
+  }
+  pthread_mutex_unlock(&hal->irq_mutex);
+
+  return NULL;
+}
+
+sx126x_status_t sx126x_hal_posix_bus_init(sx126x_hal_posix_bus_t *bus)
+{
+  if (!bus)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  memset(bus, 0, sizeof(*bus));
+
+  pthread_mutexattr_t attr;
+  if (pthread_mutexattr_init(&attr) != 0)
+  {
+    return SX126X_ERR_NO_MEM;
+  }
+
+  int ret = pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  if (ret == 0)
+    ret = pthread_mutex_init(&bus->mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+
+  return ret == 0 ? SX126X_OK : SX126X_ERR_NO_MEM;
+}
+
+void sx126x_hal_posix_bus_deinit(sx126x_hal_posix_bus_t *bus)
+{
+  if (!bus)
+    return;
+
+  pthread_mutex_destroy(&bus->mutex);
+  memset(bus, 0, sizeof(*bus));
+}
+
+sx126x_status_t sx126x_hal_posix_init(sx126x_hal_posix_t *hal, const sx126x_hal_posix_cfg_t *cfg)
+{
+  if (!hal || !cfg || !cfg->shared || !cfg->backend || !cfg->backend->transfer)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  memset(hal, 0, sizeof(*hal));
+  hal->cfg = *cfg;
+
+  hal->bus.transfer = posix_transfer;
+  // Without a batching backend the core falls back to one transfer per frame.
+  hal->bus.transfer_batch = cfg->backend->transfer_batch ? posix_transfer_batch : NULL;
+  hal->bus.wake = cfg->backend->wake ? posix_wake : NULL;
+  hal->bus.attach_dio1 = posix_attach_dio1;
+  hal->bus.now_us = posix_now_us;
+  hal->bus.delay_us = posix_delay_us;
+  hal->bus.log = cfg->backend->log;
+  hal->bus.log_ring = cfg->backend->log_ring;
+  hal->bus.ctx = hal;
+
+  if (!cfg->disable_lock_hooks)
+  {
+    hal->bus.lock = posix_bus_lock;
+    hal->bus.unlock = posix_bus_unlock;
+  }
+
+  if (pthread_mutex_init(&hal->irq_mutex, NULL) != 0)
+  {
+    return SX126X_ERR_NO_MEM;
+  }
+
+  if (pthread_cond_init(&hal->irq_cond, NULL) != 0)
+  {
+    pthread_mutex_destroy(&hal->irq_mutex);
+    return SX126X_ERR_NO_MEM;
+  }
+
+  if (pthread_create(&hal->irq_thread, NULL, posix_irq_thread, hal) != 0)
+  {
+    pthread_cond_destroy(&hal->irq_cond);
+    pthread_mutex_destroy(&hal->irq_mutex);
+    return SX126X_ERR_NO_MEM;
+  }
+
+  hal->is_irq_thread_running = true;
+
+  return SX126X_OK;
+}
+
+sx126x_status_t sx126x_hal_posix_deinit(sx126x_hal_posix_t *hal)
+{
+  if (!hal)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  if (hal->is_irq_thread_running)
+  {
+    pthread_mutex_lock(&hal->irq_mutex);
+    hal->is_shutdown_requested = true;
+    pthread_cond_signal(&hal->irq_cond);
+    pthread_mutex_unlock(&hal->irq_mutex);
+
+    pthread_join(hal->irq_thread, NULL);
+    pthread_cond_destroy(&hal->irq_cond);
+    pthread_mutex_destroy(&hal->irq_mutex);
+  }
+
+  memset(hal, 0, sizeof(*hal));
+
+  return SX126X_OK;
+}
+
+void sx126x_hal_posix_notify_dio1(sx126x_hal_posix_t *hal)
+{
+  pthread_mutex_lock(&hal->irq_mutex);
+  hal->irq_pending = true;
+  pthread_cond_signal(&hal->irq_cond);
+  pthread_mutex_unlock(&hal->irq_mutex);
+}
+
+sx126x_bus_t *sx126x_hal_posix_get_bus(sx126x_hal_posix_t *hal)
+{
+  return &hal->bus;
+}
+
+sx126x_t *sx126x_hal_posix_get_device(sx126x_hal_posix_t *hal)
+{
+  return &hal->dev;
+}
@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file hal_sim.h
+ * @brief Simulated SX126x chip HAL for host-side testing and benchmarking.
+ * @version 0.1
+ * @date 2025
+ *
+ * The simulator implements sx126x_bus_t on top of a software model of the chip. It decodes the
+ * command set, keeps register, buffer and IRQ state, and charges every bus access against a
+ * modelled clock (HAL overhead, BUSY wait and SPI clocking), so driver operations can be measured
+ * in transactions, bytes on the bus and latency without hardware.
+ */
+
+#ifndef SX126X_HAL_SIM_H
+#define SX126X_HAL_SIM_H
+
+#include "sx126x/commands.h"
+#include "sx126x/hal.h"
+#include "sx126x/sx126x.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// Size of the modelled register space (0x0000 - 0x0FFF).
+#define SX126X_HAL_SIM_REG_SPACE 0x1000
+
+// Number of over-the-air packets that can be scheduled ahead of time.
+#define SX126X_HAL_SIM_RX_QUEUE 32
+
+/**
+ * @brief Configuration options for the simulated HAL.
+ *
+ * Zero-valued timing fields are replaced with the defaults noted below.
+ */
+typedef struct
+{
+  uint32_t spi_clock_hz;    /**< Modelled SPI clock, default 8 MHz */
+  uint32_t txn_overhead_ns; /**< HAL cost per bus call (lock + SPI setup), default 20us */
+  uint32_t cs_overhead_ns;  /**< NSS setup/hold per frame, default 1us */
+  uint32_t busy_timeout_ns; /**< How long the HAL waits on a stuck BUSY line, default 10ms */
+  bool disable_batch;       /**< Leave bus.transfer_batch NULL to exercise the core fallback */
+  bool enable_log;          /**< Print driver log lines to stderr */
+} sx126x_hal_sim_cfg_t;
+
+/**
+ * @brief Kinds of fault the simulator can inject.
+ */
+typedef enum
+{
+  SX126X_HAL_SIM_FAULT_NONE = 0,
+  SX126X_HAL_SIM_FAULT_IO,         /**< transfer fails with SX126X_ERR_IO, command is dropped */
+  SX126X_HAL_SIM_FAULT_BUSY_STUCK, /**< BUSY never drops, transfer fails with SX126X_ERR_TIMEOUT */
+  SX126X_HAL_SIM_FAULT_CMD_ERROR,  /**< chip rejects the command in its status byte */
+} sx126x_hal_sim_fault_kind_t;
+
+/**
+ * @brief A fault injection rule.
+ */
+typedef struct
+{
+  sx126x_hal_sim_fault_kind_t kind;
+  bool any_opcode; /**< Match every opcode instead of only `opcode` */
+  uint8_t opcode;  /**< Opcode to match */
+  uint32_t skip;   /**< Matching frames to let through before faulting */
+  uint32_t count;  /**< Matching frames to fault, 0 disables the rule */
+} sx126x_hal_sim_fault_t;
+
+/**
+ * @brief Bus and timing counters accumulated by the simulator.
+ */
+typedef struct
+{
+  uint64_t transactions;          /**< Calls into transfer/transfer_batch */
+  uint64_t frames;                /**< Commands clocked (one per NSS assertion) */
+  uint64_t bytes;                 /**< Bytes clocked on the bus */
+  uint64_t bus_ns;                /**< Modelled time spent inside bus calls */
+  uint64_t busy_wait_ns;          /**< Portion of bus_ns spent waiting on BUSY */
+  uint64_t faults;                /**< Injected faults that fired */
+  uint64_t cmd_errors;            /**< Commands rejected with an error status */
+  uint64_t rx_dropped;            /**< Injected packets that found the receiver off */
+  uint64_t rx_overwritten;        /**< Packets that landed on a buffer the host had not read yet */
+  uint64_t cads;                  /**< Channel activity detections run */
+  uint64_t cad_detected;          /**< CADs that detected activity */
+  uint64_t lr_fhss_hops;          /**< LR-FHSS hop IRQs raised */
+  uint64_t lr_fhss_refills;       /**< Hop table entries rewritten in answer to a hop IRQ */
+  uint64_t lr_fhss_stale_hops;    /**< LR-FHSS hops sent from an entry that was not refilled */
+  uint64_t lr_fhss_refill_max_ns; /**< Worst time from a hop IRQ to its hop table refill */
+  uint64_t lr_fhss_hop_min_ns;    /**< Shortest hop, which bounds the hop IRQ's answer */
+  uint64_t turnarounds;           /**< Receiver starts that followed a TxDone */
+  uint64_t turnaround_total_ns;   /**< Sum of the times from TxDone to the receiver listening */
+  uint64_t turnaround_max_ns;     /**< Longest time from TxDone to the receiver listening */
+  uint64_t op_count[256];         /**< Frames per opcode */
+} sx126x_hal_sim_stats_t;
+
+/**
+ * @brief A packet scheduled to finish arriving over the air.
+ */
+typedef struct
+{
+  uint64_t at_ns;
+  uint8_t len;
+  int8_t rssi_dbm;
+  int8_t snr_db;
+  bool crc_ok;
+  uint8_t payload[SX126X_MAX_PAYLOAD_LEN];
+} sx126x_hal_sim_rx_t;
+
+/**
+ * @brief Shared-medium hooks, for simulating several nodes on one channel.
+ *
+ * tx is told about every LoRa or GFSK transmission the chip starts. cad decides whether a CAD
+ * listening over [start_ns, end_ns] detects anything; without it, a CAD detects the packets
+ * scheduled with sx126x_hal_sim_schedule_rx that are on air at the time.
+ */
+typedef struct
+{
+  void (*tx)(void *arg, const sx126x_hal_t *hal, uint64_t start_ns, uint64_t end_ns);
+  bool (*cad)(void *arg, const sx126x_hal_t *hal, uint64_t start_ns, uint64_t end_ns);
+  void *arg;
+} sx126x_hal_sim_medium_t;
+
+/**
+ * @brief Modelled chip state.
+ */
+typedef struct
+{
+  bool sleeping;
+  bool warm_sleep;
+  sx126x_chip_mode_t mode;
+  uint8_t cmd_status;
+  uint8_t fallback_mode;
+
+  uint8_t packet_type;
+  uint32_t rf_freq;
+  uint8_t mod_params[8];
+  uint8_t pkt_params[9];
+  uint8_t tx_params[2];
+  uint8_t pa_config[4];
+
+  uint8_t tx_base;
+  uint8_t rx_base;
+  uint8_t rx_payload_len;
+  uint8_t rx_start;
+  uint8_t pkt_status[3];
+  bool rx_unread;
+
+  uint16_t irq_status;
+  uint16_t irq_mask;
+  uint16_t dio_mask[3];
+  uint16_t device_errors;
+
+  bool tx_pending;
+  uint64_t tx_done_at_ns;
+  bool turnaround_pending; // TxDone raised at tx_done_at_ns, and no SetRx, SetTx or SetCad since
+  bool rx_continuous;
+  bool rx_timeout_pending;
+  uint64_t rx_timeout_at_ns;
+  uint8_t lora_symb_timeout;
+  uint8_t cad_params[7];
+  bool cad_pending;
+  uint64_t cad_start_ns;
+  uint64_t cad_done_at_ns;
+  bool lr_fhss_pending;        // LR-FHSS transmission on air
+  uint8_t lr_fhss_hop;         // hop being sent
+  uint64_t lr_fhss_hop_end_ns; // end of that hop
+  uint16_t lr_fhss_stale;      // hop table slots sent from and not rewritten since
+  bool lr_fhss_refill_pending; // a hop IRQ has not been answered with a refill yet
+  uint64_t lr_fhss_irq_ns;     // when that hop IRQ was raised
+
+  uint8_t buffer[SX126X_BUFFER_SIZE];
+  uint8_t regs[SX126X_HAL_SIM_REG_SPACE];
+} sx126x_hal_sim_chip_t;
+
+/**
+ * @brief Represents a simulated HAL instance.
+ */
+typedef struct sx126x_hal_s
+{
+  sx126x_bus_t bus;
+  sx126x_t dev;
+  sx126x_hal_sim_cfg_t cfg;
+  sx126x_hal_sim_stats_t stats;
+  sx126x_hal_sim_fault_t fault;
+  sx126x_hal_sim_chip_t chip;
+  sx126x_hal_sim_medium_t medium;
+  uint64_t now_ns;
+  uint64_t busy_until_ns;
+  sx126x_bus_irq_handler_t dio1_handler;
+  void *dio1_arg;
+  sx126x_hal_sim_rx_t rx_queue[SX126X_HAL_SIM_RX_QUEUE];
+  uint32_t rx_queue_len;
+} sx126x_hal_sim_t;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Convenience factory that fills *out with an sx126x_hal_t instance of the simulated HAL.
+ *
+ * @param cfg Simulator options, or NULL for defaults.
+ */
+sx126x_status_t sx126x_hal_sim_init(sx126x_hal_t *out, const sx126x_hal_sim_cfg_t *cfg);
+
+/**
+ * @brief Convenience destroy wrapper for the simulated HAL.
+ */
+sx126x_status_t sx126x_hal_sim_deinit(sx126x_hal_t *hal);
+
+/**
+ * @brief Advance the modelled clock, firing any TX/RX events that fall due.
+ *
+ * Events fire at their scheduled time. Whenever DIO1 is high afterwards, the attached handler is
+ * run (standing in for the HAL's interrupt task); bus traffic it generates advances the clock too.
+ */
+void sx126x_hal_sim_advance(sx126x_hal_t *hal, uint64_t ns);
+
+/**
+ * @brief Current modelled time in nanoseconds.
+ */
+uint64_t sx126x_hal_sim_now_ns(const sx126x_hal_t *hal);
+
+/**
+ * @brief Run the attached DIO1 handler while the line is high, as the HAL's interrupt task would.
+ *
+ * Call after sx126x_hal_sim_inject_rx or anything else that raises an IRQ outside of advance.
+ */
+void sx126x_hal_sim_service_dio1(sx126x_hal_t *hal);
+
+/**
+ * @brief Deliver a packet to the receiver as if it had just finished arriving over the air.
+ *
+ * @param crc_ok false to flag the packet with a CRC error.
+ * @return true if the receiver was on and the packet was written to the buffer.
+ */
+bool sx126x_hal_sim_inject_rx(sx126x_hal_t *hal,
+                              const uint8_t *payload,
+                              uint8_t len,
+                              int rssi_dbm,
+                              int snr_db,
+                              bool crc_ok);
+
+/**
+ * @brief Schedule a packet to finish arriving at an absolute modelled time.
+ *
+ * Arrivals are processed in time order as the clock moves, including in the middle of the
+ * driver's own bus traffic, so a packet can land while the previous one is still being drained.
+ *
+ * @return false if the schedule queue is full.
+ */
+bool sx126x_hal_sim_schedule_rx(sx126x_hal_t *hal,
+                                uint64_t at_ns,
+                                const uint8_t *payload,
+                                uint8_t len,
+                                int rssi_dbm,
+                                int snr_db,
+                                bool crc_ok);
+
+/**
+ * @brief Attach shared-medium hooks, replacing any previous ones; NULL detaches them.
+ */
+void sx126x_hal_sim_set_medium(sx126x_hal_t *hal, const sx126x_hal_sim_medium_t *medium);
+
+/**
+ * @brief Arm a fault injection rule, replacing any previous rule.
+ */
+void sx126x_hal_sim_set_fault(sx126x_hal_t *hal, const sx126x_hal_sim_fault_t *fault);
+
+/**
+ * @brief Zero the bus and timing counters.
+ */
+void sx126x_hal_sim_reset_stats(sx126x_hal_t *hal);
+
+/**
+ * @brief Level of the DIO1 line (any pending IRQ routed to DIO1).
+ */
+bool sx126x_hal_sim_dio1(const sx126x_hal_t *hal);
+
+/**
+ * @brief Modelled time on air for the currently configured packet type, modulation and packet
+ *        params.
+ */
+uint64_t sx126x_hal_sim_airtime_ns(const sx126x_hal_t *hal, uint8_t payload_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SX126X_HAL_SIM_H
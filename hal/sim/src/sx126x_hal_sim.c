@@ -0,0 +1,1204 @@
+// SPDX-License-Identifier: MIT
+
+#include "sx126x/hal_sim.h"
+#include "sx126x/bus.h"
+#include "sx126x/commands.h"
+#include "sx126x/sx126x.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// Defaults for zero-valued timing fields in sx126x_hal_sim_cfg_t.
+#define SIM_DEFAULT_SPI_CLOCK_HZ 8000000u
+#define SIM_DEFAULT_TXN_OVERHEAD_NS 20000u
+#define SIM_DEFAULT_CS_OVERHEAD_NS 1000u
+#define SIM_DEFAULT_BUSY_TIMEOUT_NS 10000000u
+
+// BUSY times, roughly following the datasheet switching-time tables.
+#define SIM_BUSY_DEFAULT_NS 2000u
+#define SIM_BUSY_STBY_XOSC_NS 31000u
+#define SIM_BUSY_FS_NS 50000u
+#define SIM_BUSY_TX_FROM_STBY_NS 126000u
+#define SIM_BUSY_TX_FROM_XOSC_NS 95000u
+#define SIM_BUSY_TX_FROM_FS_NS 62000u
+#define SIM_BUSY_RX_FROM_STBY_NS 83000u
+#define SIM_BUSY_RX_FROM_XOSC_NS 52000u
+#define SIM_BUSY_RX_FROM_FS_NS 41000u
+#define SIM_BUSY_SLEEP_NS 500000u
+#define SIM_BUSY_CALIBRATE_NS 3500000u
+#define SIM_BUSY_CALIBRATE_IMAGE_NS 4000000u
+#define SIM_WAKE_COLD_NS 3500000u
+#define SIM_WAKE_WARM_NS 340000u
+
+// One tick of the SetTx/SetRx timeout argument (15.625us).
+#define SIM_TIMEOUT_TICK_NS 15625u
+
+// SetCadParams exit modes.
+#define SIM_CAD_EXIT_RX 0x01
+#define SIM_CAD_EXIT_LBT 0x10
+
+// Fallback mode argument values for SetRxTxFallbackMode.
+#define SIM_FALLBACK_FS 0x40
+#define SIM_FALLBACK_STBY_XOSC 0x30
+#define SIM_FALLBACK_STBY_RC 0x20
+
+// LoRa sync word register and its reset value (private network).
+#define SIM_REG_LORA_SYNC_WORD 0x0740
+
+// IQ polarity register and its reset value.
+#define SIM_REG_IQ_POLARITY 0x0736
+#define SIM_IQ_POLARITY_RESET 0x0D
+
+// LR-FHSS symbol time at 488.28125 bit/s, and the hopping registers: control, packet length and
+// hop count, then the hop table of 16 entries of a 2-byte symbol count and a frequency word.
+#define SIM_LR_FHSS_SYMBOL_NS 2048000u
+#define SIM_REG_LR_FHSS_CTRL 0x0385
+#define SIM_REG_LR_FHSS_NUM_HOPS 0x0387
+#define SIM_REG_LR_FHSS_HOP_TABLE 0x0388
+#define SIM_LR_FHSS_HOP_SLOTS 16
+#define SIM_LR_FHSS_HOP_ENTRY_LEN 6
+
+// Bound on back-to-back DIO1 handler runs, in case a handler never clears the line.
+#define SIM_DIO1_MAX_RUNS 16
+
+static void sim_log(const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+// Put the modelled chip into its power-on state.
+// Registers outside the retention memory, which a warm start does not preserve either.
+static void sim_regs_reset(sx126x_hal_sim_chip_t *chip)
+{
+  memset(chip->regs, 0, sizeof(chip->regs));
+  chip->regs[SIM_REG_LORA_SYNC_WORD] = 0x14;
+  chip->regs[SIM_REG_LORA_SYNC_WORD + 1] = 0x24;
+  chip->regs[SIM_REG_IQ_POLARITY] = SIM_IQ_POLARITY_RESET;
+}
+
+static void sim_chip_reset(sx126x_hal_sim_chip_t *chip)
+{
+  memset(chip, 0, sizeof(*chip));
+  chip->mode = SX126X_CHIP_MODE_STBY_RC;
+  chip->fallback_mode = SIM_FALLBACK_STBY_RC;
+  chip->packet_type = SX126X_PACKET_TYPE_GFSK;
+  sim_regs_reset(chip);
+}
+
+static uint64_t sim_clock_ns(const sx126x_hal_sim_t *hal, size_t bytes)
+{
+  return ((uint64_t)bytes * 8u * 1000000000ull) / hal->cfg.spi_clock_hz;
+}
+
+static uint32_t sim_u24(const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+static void sim_raise_irq(sx126x_hal_sim_chip_t *chip, uint16_t irq)
+{
+  chip->irq_status |= irq & chip->irq_mask;
+}
+
+static sx126x_chip_mode_t sim_fallback_mode(const sx126x_hal_sim_chip_t *chip)
+{
+  switch (chip->fallback_mode)
+  {
+  case SIM_FALLBACK_FS:
+    return SX126X_CHIP_MODE_FS;
+  case SIM_FALLBACK_STBY_XOSC:
+    return SX126X_CHIP_MODE_STBY_XOSC;
+  default:
+    return SX126X_CHIP_MODE_STBY_RC;
+  }
+}
+
+// Time to get on air or start listening: the crystal and then the synthesizer have to start
+// unless the chip is already past them.
+static uint32_t sim_busy_tx_ns(const sx126x_hal_sim_chip_t *chip)
+{
+  if (chip->mode == SX126X_CHIP_MODE_FS)
+    return SIM_BUSY_TX_FROM_FS_NS;
+  return chip->mode == SX126X_CHIP_MODE_STBY_XOSC ? SIM_BUSY_TX_FROM_XOSC_NS
+                                                  : SIM_BUSY_TX_FROM_STBY_NS;
+}
+
+static uint32_t sim_busy_rx_ns(const sx126x_hal_sim_chip_t *chip)
+{
+  if (chip->mode == SX126X_CHIP_MODE_FS)
+    return SIM_BUSY_RX_FROM_FS_NS;
+  return chip->mode == SX126X_CHIP_MODE_STBY_XOSC ? SIM_BUSY_RX_FROM_XOSC_NS
+                                                  : SIM_BUSY_RX_FROM_STBY_NS;
+}
+
+// Real bandwidth in Hz for a LoRa bandwidth code.
+static double sim_lora_bw_hz(uint8_t bw)
+{
+  switch (bw)
+  {
+  case 0x00:
+    return 7810.0;
+  case 0x08:
+    return 10420.0;
+  case 0x01:
+    return 15630.0;
+  case 0x09:
+    return 20830.0;
+  case 0x02:
+    return 31250.0;
+  case 0x0A:
+    return 41670.0;
+  case 0x03:
+    return 62500.0;
+  case 0x04:
+    return 125000.0;
+  case 0x05:
+    return 250000.0;
+  case 0x06:
+    return 500000.0;
+  default:
+    return 125000.0;
+  }
+}
+
+static uint64_t sim_lora_airtime_ns(const sx126x_hal_sim_chip_t *chip, uint8_t payload_len)
+{
+  int sf = chip->mod_params[0];
+  double bw = sim_lora_bw_hz(chip->mod_params[1]);
+  int cr = chip->mod_params[2];
+  int de = chip->mod_params[3] ? 1 : 0;
+
+  // Long-interleaved coding rates map onto the same redundancy as their plain counterparts.
+  if (cr == 0x05)
+    cr = 1;
+  else if (cr == 0x06)
+    cr = 2;
+  else if (cr == 0x07)
+    cr = 4;
+  if (cr < 1 || cr > 4)
+    cr = 1;
+  if (sf < 5 || sf > 12)
+    sf = 7;
+
+  int preamble = ((int)chip->pkt_params[0] << 8) | chip->pkt_params[1];
+  int ih = chip->pkt_params[2] ? 1 : 0;
+  int crc = chip->pkt_params[4] ? 1 : 0;
+  int pl = payload_len;
+
+  double tsym = (double)(1u << sf) / bw;
+  double n_payload;
+  double t_preamble;
+
+  if (sf >= 7)
+  {
+    double num = 8.0 * pl - 4.0 * sf + 28.0 + 16.0 * crc - 20.0 * ih;
+    double den = 4.0 * (sf - 2 * de);
+    n_payload = 8.0 + fmax(ceil(num / den) * (cr + 4), 0.0);
+    t_preamble = (preamble + 4.25) * tsym;
+  }
+  else
+  {
+    double num = 8.0 * pl - 4.0 * sf + 16.0 * crc + 20.0 * (1 - ih);
+    double den = 4.0 * sf;
+    n_payload = 8.0 + fmax(ceil(num / den) * (cr + 4), 0.0);
+    t_preamble = (preamble + 6.25) * tsym;
+  }
+
+  return (uint64_t)((t_preamble + n_payload * tsym) * 1e9);
+}
+
+// Duration of one LoRa symbol with the current modulation params.
+static uint64_t sim_lora_symbol_ns(const sx126x_hal_sim_chip_t *chip)
+{
+  int sf = chip->mod_params[0];
+  if (sf < 5 || sf > 12)
+    sf = 7;
+  return (uint64_t)((double)(1u << sf) / sim_lora_bw_hz(chip->mod_params[1]) * 1e9);
+}
+
+static uint64_t sim_gfsk_airtime_ns(const sx126x_hal_sim_chip_t *chip, uint8_t payload_len)
+{
+  uint32_t br = sim_u24(&chip->mod_params[0]);
+  if (br == 0)
+    return 0;
+
+  // Bit rate is 32 * Fxtal / BR.
+  double bitrate = 32.0 * 32e6 / br;
+
+  int preamble = ((int)chip->pkt_params[0] << 8) | chip->pkt_params[1];
+  int sync_bits = chip->pkt_params[3];
+  int length_byte = chip->pkt_params[5] ? 8 : 0;
+  int crc_bits;
+  switch (chip->pkt_params[7])
+  {
+  case 0x00:
+  case 0x04:
+    crc_bits = 8;
+    break;
+  case 0x02:
+  case 0x06:
+    crc_bits = 16;
+    break;
+  default:
+    crc_bits = 0;
+    break;
+  }
+
+  int bits = preamble + sync_bits + length_byte + 8 * payload_len + crc_bits;
+  return (uint64_t)(bits / bitrate * 1e9);
+}
+
+static uint64_t sim_airtime_ns(const sx126x_hal_sim_chip_t *chip, uint8_t payload_len)
+{
+  if (chip->packet_type == SX126X_PACKET_TYPE_GFSK)
+    return sim_gfsk_airtime_ns(chip, payload_len);
+  return sim_lora_airtime_ns(chip, payload_len);
+}
+
+// Payload length programmed by the last SetPacketParams.
+static uint8_t sim_payload_len(const sx126x_hal_sim_chip_t *chip)
+{
+  return chip->packet_type == SX126X_PACKET_TYPE_GFSK ? chip->pkt_params[6] : chip->pkt_params[3];
+}
+
+// A packet finishes arriving over the air.
+static bool sim_rx_arrive(sx126x_hal_sim_t *hal,
+                          const uint8_t *payload,
+                          uint8_t len,
+                          int rssi_dbm,
+                          int snr_db,
+                          bool crc_ok)
+{
+  sx126x_hal_sim_chip_t *chip = &hal->chip;
+
+  if (chip->sleeping || chip->mode != SX126X_CHIP_MODE_RX)
+  {
+    hal->stats.rx_dropped++;
+    return false;
+  }
+
+  if (chip->rx_unread)
+    hal->stats.rx_overwritten++;
+
+  chip->rx_start = chip->rx_base;
+  chip->rx_payload_len = len;
+  chip->rx_unread = true;
+  for (uint8_t i = 0; i < len; i++)
+    chip->buffer[(uint8_t)(chip->rx_base + i)] = payload[i];
+
+  if (chip->packet_type == SX126X_PACKET_TYPE_GFSK)
+  {
+    // RxStatus, RssiSync, RssiAvg
+    chip->pkt_status[0] = 0x00;
+    chip->pkt_status[1] = (uint8_t)(-rssi_dbm * 2);
+    chip->pkt_status[2] = (uint8_t)(-rssi_dbm * 2);
+  }
+  else
+  {
+    chip->pkt_status[0] = (uint8_t)(-rssi_dbm * 2);
+    chip->pkt_status[1] = (uint8_t)(int8_t)(snr_db * 4);
+    chip->pkt_status[2] = (uint8_t)(-rssi_dbm * 2);
+  }
+
+  sim_raise_irq(chip, SX126X_IRQ_RX_DONE | (crc_ok ? 0 : SX126X_IRQ_CRC_ERR));
+  chip->cmd_status = SX126X_CMD_STATUS_DATA_AVAILABLE;
+
+  // Single-shot RX returns to the fallback mode; continuous RX keeps listening.
+  if (!chip->rx_continuous)
+  {
+    chip->rx_timeout_pending = false;
+    chip->mode = sim_fallback_mode(chip);
+  }
+
+  return true;
+}
+
+// Has the next scheduled packet started arriving? The model treats any packet on air as detected.
+static bool sim_rx_in_flight(const sx126x_hal_sim_t *hal)
+{
+  if (hal->rx_queue_len == 0)
+    return false;
+
+  const sx126x_hal_sim_rx_t *rx = &hal->rx_queue[0];
+  return rx->at_ns <= hal->now_ns + sim_airtime_ns(&hal->chip, rx->len);
+}
+
+// Does a CAD over [start_ns, end_ns] hear anything? Without a medium, the scheduled packets are
+// the only other transmitters.
+static bool sim_cad_detect(const sx126x_hal_sim_t *hal, uint64_t start_ns, uint64_t end_ns)
+{
+  if (hal->medium.cad)
+    return hal->medium.cad(hal->medium.arg, hal, start_ns, end_ns);
+
+  for (uint32_t i = 0; i < hal->rx_queue_len; i++)
+  {
+    const sx126x_hal_sim_rx_t *rx = &hal->rx_queue[i];
+    uint64_t airtime = sim_airtime_ns(&hal->chip, rx->len);
+    if (rx->at_ns > start_ns && rx->at_ns - airtime < end_ns)
+      return true;
+  }
+
+  return false;
+}
+
+// Put the packet in the buffer on air from start_ns, or until the timeout cuts it short.
+static void sim_start_tx(sx126x_hal_sim_t *hal, uint64_t start_ns, uint32_t timeout)
+{
+  sx126x_hal_sim_chip_t *chip = &hal->chip;
+  uint64_t airtime = sim_airtime_ns(chip, sim_payload_len(chip));
+  uint64_t end_ns;
+
+  chip->mode = SX126X_CHIP_MODE_TX;
+  chip->rx_timeout_pending = false;
+  chip->cad_pending = false;
+  chip->lr_fhss_pending = false;
+  if (timeout != 0 && (uint64_t)timeout * SIM_TIMEOUT_TICK_NS < airtime)
+  {
+    chip->tx_pending = false;
+    chip->rx_timeout_pending = true;
+    chip->rx_timeout_at_ns = start_ns + (uint64_t)timeout * SIM_TIMEOUT_TICK_NS;
+    end_ns = chip->rx_timeout_at_ns;
+  }
+  else
+  {
+    chip->tx_pending = true;
+    chip->tx_done_at_ns = start_ns + airtime;
+    end_ns = chip->tx_done_at_ns;
+  }
+
+  if (hal->medium.tx)
+    hal->medium.tx(hal->medium.arg, hal, start_ns, end_ns);
+}
+
+// Length of the hop described by a hop table entry.
+static uint64_t sim_lr_fhss_hop_ns(sx126x_hal_sim_t *hal, unsigned slot)
+{
+  const uint8_t *entry =
+      &hal->chip.regs[SIM_REG_LR_FHSS_HOP_TABLE + slot * SIM_LR_FHSS_HOP_ENTRY_LEN];
+  uint64_t ns = (((uint64_t)entry[0] << 8) | entry[1]) * SIM_LR_FHSS_SYMBOL_NS;
+
+  if (!hal->stats.lr_fhss_hop_min_ns || ns < hal->stats.lr_fhss_hop_min_ns)
+    hal->stats.lr_fhss_hop_min_ns = ns;
+  return ns;
+}
+
+// Start an LR-FHSS transmission at the first entry of the hop table.
+static void sim_start_lr_fhss(sx126x_hal_sim_t *hal, uint64_t start_ns, uint32_t timeout)
+{
+  sx126x_hal_sim_chip_t *chip = &hal->chip;
+
+  chip->mode = SX126X_CHIP_MODE_TX;
+  chip->tx_pending = false;
+  chip->cad_pending = false;
+  chip->rx_timeout_pending = timeout != 0;
+  chip->rx_timeout_at_ns = start_ns + (uint64_t)timeout * SIM_TIMEOUT_TICK_NS;
+  chip->lr_fhss_pending = true;
+  chip->lr_fhss_hop = 0;
+  chip->lr_fhss_stale = 0;
+  chip->lr_fhss_refill_pending = false;
+  chip->lr_fhss_hop_end_ns = start_ns + sim_lr_fhss_hop_ns(hal, 0);
+}
+
+// The current hop ends: move on to the next table entry and raise the hop IRQ, or finish the
+// packet after its last hop. An entry sent from must be rewritten before the chip wraps back to it.
+static void sim_lr_fhss_next_hop(sx126x_hal_sim_t *hal)
+{
+  sx126x_hal_sim_chip_t *chip = &hal->chip;
+  unsigned slot = chip->lr_fhss_hop % SIM_LR_FHSS_HOP_SLOTS;
+
+  if (++chip->lr_fhss_hop >= chip->regs[SIM_REG_LR_FHSS_NUM_HOPS])
+  {
+    chip->lr_fhss_pending = false;
+    chip->rx_timeout_pending = false;
+    sim_raise_irq(chip, SX126X_IRQ_TX_DONE);
+    chip->cmd_status = SX126X_CMD_STATUS_TX_DONE;
+    chip->mode = sim_fallback_mode(chip);
+    return;
+  }
+
+  chip->lr_fhss_stale |= (uint16_t)(1u << slot);
+  hal->stats.lr_fhss_hops++;
+  sim_raise_irq(chip, SX126X_IRQ_LR_FHSS_HOP);
+  chip->lr_fhss_refill_pending = true;
+  chip->lr_fhss_irq_ns = chip->lr_fhss_hop_end_ns;
+
+  slot = chip->lr_fhss_hop % SIM_LR_FHSS_HOP_SLOTS;
+  if (chip->lr_fhss_stale & (1u << slot))
+    hal->stats.lr_fhss_stale_hops++;
+  chip->lr_fhss_hop_end_ns += sim_lr_fhss_hop_ns(hal, slot);
+}
+
+// A CAD has finished listening: report it and move on as its exit mode says.
+static void sim_cad_finish(sx126x_hal_sim_t *hal)
+{
+  sx126x_hal_sim_chip_t *chip = &hal->chip;
+  bool detected = sim_cad_detect(hal, chip->cad_start_ns, chip->cad_done_at_ns);
+  uint8_t exit_mode = chip->cad_params[3];
+  uint32_t timeout = sim_u24(&chip->cad_params[4]);
+
+  chip->cad_pending = false;
+  hal->stats.cads++;
+  if (detected)
+    hal->stats.cad_detected++;
+  sim_raise_irq(chip, SX126X_IRQ_CAD_DONE | (detected ? SX126X_IRQ_CAD_DETECTED : 0));
+
+  if (exit_mode == SIM_CAD_EXIT_LBT && !detected)
+  {
+    sim_start_tx(hal, chip->cad_done_at_ns + SIM_BUSY_TX_FROM_FS_NS, timeout);
+  }
+  else if (exit_mode == SIM_CAD_EXIT_RX && detected)
+  {
+    chip->rx_continuous = false;
+    chip->rx_timeout_pending = timeout != 0;
+    chip->rx_timeout_at_ns = chip->cad_done_at_ns + (uint64_t)timeout * SIM_TIMEOUT_TICK_NS;
+  }
+  else
+  {
+    chip->mode = SX126X_CHIP_MODE_STBY_RC;
+  }
+}
+
+// Fire any scheduled chip events that are due at the current modelled time.
+static void sim_process_events(sx126x_hal_sim_t *hal)
+{
+  sx126x_hal_sim_chip_t *chip = &hal->chip;
+
+  while (hal->rx_queue_len > 0 && hal->now_ns >= hal->rx_queue[0].at_ns)
+  {
+    sx126x_hal_sim_rx_t *rx = &hal->rx_queue[0];
+    sim_rx_arrive(hal, rx->payload, rx->len, rx->rssi_dbm, rx->snr_db, rx->crc_ok);
+    hal->rx_queue_len--;
+    memmove(&hal->rx_queue[0], &hal->rx_queue[1], hal->rx_queue_len * sizeof(hal->rx_queue[0]));
+  }
+
+  if (chip->tx_pending && hal->now_ns >= chip->tx_done_at_ns)
+  {
+    chip->tx_pending = false;
+    chip->turnaround_pending = true;
+    sim_raise_irq(chip, SX126X_IRQ_TX_DONE);
+    chip->cmd_status = SX126X_CMD_STATUS_TX_DONE;
+    chip->mode = sim_fallback_mode(chip);
+  }
+
+  if (chip->cad_pending && hal->now_ns >= chip->cad_done_at_ns)
+    sim_cad_finish(hal);
+
+  while (chip->lr_fhss_pending && hal->now_ns >= chip->lr_fhss_hop_end_ns)
+    sim_lr_fhss_next_hop(hal);
+
+  if (chip->rx_timeout_pending && hal->now_ns >= chip->rx_timeout_at_ns)
+  {
+    chip->rx_timeout_pending = false;
+
+    // A receiver that has locked onto a packet stops its timers and waits for the packet to end.
+    if (chip->mode != SX126X_CHIP_MODE_RX || !sim_rx_in_flight(hal))
+    {
+      chip->lr_fhss_pending = false;
+      sim_raise_irq(chip, SX126X_IRQ_TIMEOUT);
+      chip->mode = sim_fallback_mode(chip);
+    }
+  }
+}
+
+// Does the armed fault rule fire for this opcode?
+static sx126x_hal_sim_fault_kind_t sim_take_fault(sx126x_hal_sim_t *hal, uint8_t opcode)
+{
+  sx126x_hal_sim_fault_t *f = &hal->fault;
+
+  if (f->kind == SX126X_HAL_SIM_FAULT_NONE || f->count == 0)
+    return SX126X_HAL_SIM_FAULT_NONE;
+
+  if (!f->any_opcode && f->opcode != opcode)
+    return SX126X_HAL_SIM_FAULT_NONE;
+
+  if (f->skip > 0)
+  {
+    f->skip--;
+    return SX126X_HAL_SIM_FAULT_NONE;
+  }
+
+  f->count--;
+  hal->stats.faults++;
+  return f->kind;
+}
+
+// Execute one decoded command. Returns the command status to report on the next frame.
+static uint8_t sim_execute(sx126x_hal_sim_t *hal, const uint8_t *tx, size_t len, uint8_t *miso)
+{
+  sx126x_hal_sim_chip_t *chip = &hal->chip;
+  uint8_t op = tx[0];
+  uint64_t busy_ns = SIM_BUSY_DEFAULT_NS;
+
+// Reject frames that are too short to carry the command's parameters.
+#define SIM_NEED(n)                                                                                \
+  do                                                                                               \
+  {                                                                                                \
+    if (len < (n))                                                                                 \
+      return SX126X_CMD_STATUS_PROCESSING_ERROR;                                                   \
+  } while (0)
+
+  switch (op)
+  {
+  case SX126X_OP_SET_STANDBY:
+    SIM_NEED(2);
+    chip->tx_pending = false;
+    chip->rx_timeout_pending = false;
+    chip->cad_pending = false;
+    chip->lr_fhss_pending = false;
+    if (tx[1] == 0x01)
+    {
+      if (chip->mode == SX126X_CHIP_MODE_STBY_RC)
+        busy_ns = SIM_BUSY_STBY_XOSC_NS;
+      chip->mode = SX126X_CHIP_MODE_STBY_XOSC;
+    }
+    else
+    {
+      chip->mode = SX126X_CHIP_MODE_STBY_RC;
+    }
+    break;
+
+  case SX126X_OP_SET_FS:
+    chip->mode = SX126X_CHIP_MODE_FS;
+    busy_ns = SIM_BUSY_FS_NS;
+    break;
+
+  case SX126X_OP_SET_SLEEP:
+    SIM_NEED(2);
+    chip->tx_pending = false;
+    chip->turnaround_pending = false;
+    chip->rx_timeout_pending = false;
+    chip->cad_pending = false;
+    chip->lr_fhss_pending = false;
+    chip->sleeping = true;
+    chip->warm_sleep = (tx[1] & SX126X_SLEEP_WARM_START) != 0;
+    busy_ns = SIM_BUSY_SLEEP_NS;
+    break;
+
+  case SX126X_OP_SET_TX:
+  {
+    SIM_NEED(4);
+    busy_ns = sim_busy_tx_ns(chip);
+    chip->turnaround_pending = false;
+    if (chip->packet_type != SX126X_PACKET_TYPE_LR_FHSS)
+    {
+      sim_start_tx(hal, hal->now_ns + busy_ns, sim_u24(&tx[1]));
+      break;
+    }
+
+    // LR-FHSS needs hopping enabled and at least one hop.
+    if (!(chip->regs[SIM_REG_LR_FHSS_CTRL] & 0x01) || chip->regs[SIM_REG_LR_FHSS_NUM_HOPS] == 0)
+      return SX126X_CMD_STATUS_PROCESSING_ERROR;
+    sim_start_lr_fhss(hal, hal->now_ns + busy_ns, sim_u24(&tx[1]));
+    break;
+  }
+
+  case SX126X_OP_SET_RX:
+  {
+    SIM_NEED(4);
+    busy_ns = sim_busy_rx_ns(chip);
+    uint32_t timeout = sim_u24(&tx[1]);
+
+    // The first receiver start after a TxDone completes a turnaround.
+    if (chip->turnaround_pending)
+    {
+      uint64_t ns = hal->now_ns + busy_ns - chip->tx_done_at_ns;
+      chip->turnaround_pending = false;
+      hal->stats.turnarounds++;
+      hal->stats.turnaround_total_ns += ns;
+      if (ns > hal->stats.turnaround_max_ns)
+        hal->stats.turnaround_max_ns = ns;
+    }
+
+    chip->mode = SX126X_CHIP_MODE_RX;
+    chip->tx_pending = false;
+    chip->cad_pending = false;
+    chip->lr_fhss_pending = false;
+    chip->rx_continuous = timeout == SX126X_RX_TIMEOUT_CONTINUOUS;
+    chip->rx_timeout_pending = timeout != 0 && !chip->rx_continuous;
+    chip->rx_timeout_at_ns = hal->now_ns + busy_ns + (uint64_t)timeout * SIM_TIMEOUT_TICK_NS;
+
+    // The LoRa symbol timeout ends a single window early when no preamble shows up.
+    if (chip->packet_type == SX126X_PACKET_TYPE_LORA && !chip->rx_continuous &&
+        chip->lora_symb_timeout)
+    {
+      uint64_t at = hal->now_ns + busy_ns + chip->lora_symb_timeout * sim_lora_symbol_ns(chip);
+      if (!chip->rx_timeout_pending || at < chip->rx_timeout_at_ns)
+        chip->rx_timeout_at_ns = at;
+      chip->rx_timeout_pending = true;
+    }
+    break;
+  }
+
+  case SX126X_OP_SET_RX_TX_FALLBACK_MODE:
+    SIM_NEED(2);
+    chip->fallback_mode = tx[1];
+    break;
+
+  case SX126X_OP_CALIBRATE:
+    busy_ns = SIM_BUSY_CALIBRATE_NS;
+    break;
+
+  case SX126X_OP_CALIBRATE_IMAGE:
+    busy_ns = SIM_BUSY_CALIBRATE_IMAGE_NS;
+    break;
+
+  case SX126X_OP_SET_PACKET_TYPE:
+    SIM_NEED(2);
+    chip->packet_type = tx[1];
+    break;
+
+  case SX126X_OP_GET_PACKET_TYPE:
+    if (miso && len > 2)
+      miso[2] = chip->packet_type;
+    break;
+
+  case SX126X_OP_SET_RF_FREQUENCY:
+    SIM_NEED(5);
+    chip->rf_freq = ((uint32_t)tx[1] << 24) | sim_u24(&tx[2]);
+    break;
+
+  case SX126X_OP_SET_PA_CONFIG:
+    SIM_NEED(5);
+    memcpy(chip->pa_config, &tx[1], sizeof(chip->pa_config));
+    break;
+
+  case SX126X_OP_SET_TX_PARAMS:
+    SIM_NEED(3);
+    memcpy(chip->tx_params, &tx[1], sizeof(chip->tx_params));
+    break;
+
+  case SX126X_OP_SET_MODULATION_PARAMS:
+  {
+    size_t n = len - 1 < sizeof(chip->mod_params) ? len - 1 : sizeof(chip->mod_params);
+    SIM_NEED(2);
+    memcpy(chip->mod_params, &tx[1], n);
+    break;
+  }
+
+  case SX126X_OP_SET_PACKET_PARAMS:
+  {
+    size_t n = len - 1 < sizeof(chip->pkt_params) ? len - 1 : sizeof(chip->pkt_params);
+    SIM_NEED(2);
+    memcpy(chip->pkt_params, &tx[1], n);
+    break;
+  }
+
+  case SX126X_OP_SET_BUFFER_BASE_ADDRESS:
+    SIM_NEED(3);
+    chip->tx_base = tx[1];
+    chip->rx_base = tx[2];
+    break;
+
+  case SX126X_OP_WRITE_BUFFER:
+    SIM_NEED(2);
+    for (size_t i = 2; i < len; i++)
+      chip->buffer[(uint8_t)(tx[1] + (i - 2))] = tx[i];
+    break;
+
+  case SX126X_OP_READ_BUFFER:
+    SIM_NEED(2);
+    chip->rx_unread = false;
+    for (size_t i = 3; miso && i < len; i++)
+      miso[i] = chip->buffer[(uint8_t)(tx[1] + (i - 3))];
+    break;
+
+  case SX126X_OP_WRITE_REGISTER:
+  {
+    SIM_NEED(3);
+    uint32_t addr = ((uint32_t)tx[1] << 8) | tx[2];
+    if (addr + (len - 3) > SX126X_HAL_SIM_REG_SPACE)
+      return SX126X_CMD_STATUS_PROCESSING_ERROR;
+    memcpy(&chip->regs[addr], &tx[3], len - 3);
+
+    // A write into the hop table refills an entry, normally in answer to the latest hop IRQ.
+    if (addr >= SIM_REG_LR_FHSS_HOP_TABLE &&
+        addr < SIM_REG_LR_FHSS_HOP_TABLE + SIM_LR_FHSS_HOP_SLOTS * SIM_LR_FHSS_HOP_ENTRY_LEN)
+    {
+      unsigned slot = (addr - SIM_REG_LR_FHSS_HOP_TABLE) / SIM_LR_FHSS_HOP_ENTRY_LEN;
+      chip->lr_fhss_stale &= (uint16_t)~(1u << slot);
+      if (chip->lr_fhss_pending && chip->lr_fhss_refill_pending)
+      {
+        uint64_t latency = hal->now_ns - chip->lr_fhss_irq_ns;
+        chip->lr_fhss_refill_pending = false;
+        hal->stats.lr_fhss_refills++;
+        if (latency > hal->stats.lr_fhss_refill_max_ns)
+          hal->stats.lr_fhss_refill_max_ns = latency;
+      }
+    }
+    break;
+  }
+
+  case SX126X_OP_READ_REGISTER:
+  {
+    SIM_NEED(3);
+    uint32_t addr = ((uint32_t)tx[1] << 8) | tx[2];
+    size_t n = len > 4 ? len - 4 : 0;
+    if (addr + n > SX126X_HAL_SIM_REG_SPACE)
+      return SX126X_CMD_STATUS_PROCESSING_ERROR;
+    if (miso && n > 0)
+      memcpy(&miso[4], &chip->regs[addr], n);
+    break;
+  }
+
+  case SX126X_OP_SET_DIO_IRQ_PARAMS:
+    SIM_NEED(9);
+    chip->irq_mask = ((uint16_t)tx[1] << 8) | tx[2];
+    chip->dio_mask[0] = ((uint16_t)tx[3] << 8) | tx[4];
+    chip->dio_mask[1] = ((uint16_t)tx[5] << 8) | tx[6];
+    chip->dio_mask[2] = ((uint16_t)tx[7] << 8) | tx[8];
+    break;
+
+  case SX126X_OP_GET_IRQ_STATUS:
+    if (miso && len > 3)
+    {
+      miso[2] = (chip->irq_status >> 8) & 0xFF;
+      miso[3] = chip->irq_status & 0xFF;
+    }
+    break;
+
+  case SX126X_OP_CLEAR_IRQ_STATUS:
+    SIM_NEED(3);
+    chip->irq_status &= (uint16_t)~(((uint16_t)tx[1] << 8) | tx[2]);
+    break;
+
+  case SX126X_OP_GET_RX_BUFFER_STATUS:
+    if (miso && len > 3)
+    {
+      miso[2] = chip->rx_payload_len;
+      miso[3] = chip->rx_start;
+    }
+    break;
+
+  case SX126X_OP_GET_PACKET_STATUS:
+    for (size_t i = 2; miso && i < len && i < 5; i++)
+      miso[i] = chip->pkt_status[i - 2];
+    break;
+
+  case SX126X_OP_GET_DEVICE_ERRORS:
+    if (miso && len > 3)
+    {
+      miso[2] = (chip->device_errors >> 8) & 0xFF;
+      miso[3] = chip->device_errors & 0xFF;
+    }
+    break;
+
+  case SX126X_OP_CLEAR_DEVICE_ERRORS:
+    chip->device_errors = 0;
+    break;
+
+  case SX126X_OP_SET_CAD_PARAMS:
+    SIM_NEED(8);
+    memcpy(chip->cad_params, &tx[1], sizeof(chip->cad_params));
+    break;
+
+  case SX126X_OP_SET_CAD:
+  {
+    // CAD is a LoRa feature; it listens for 1 to 16 symbols.
+    if (chip->packet_type != SX126X_PACKET_TYPE_LORA || chip->cad_params[0] > 4)
+      return SX126X_CMD_STATUS_PROCESSING_ERROR;
+    busy_ns = sim_busy_rx_ns(chip);
+    chip->mode = SX126X_CHIP_MODE_RX;
+    chip->tx_pending = false;
+    chip->turnaround_pending = false;
+    chip->rx_timeout_pending = false;
+    chip->lr_fhss_pending = false;
+    chip->cad_pending = true;
+    chip->cad_start_ns = hal->now_ns + busy_ns;
+    chip->cad_done_at_ns =
+        chip->cad_start_ns + ((uint64_t)1 << chip->cad_params[0]) * sim_lora_symbol_ns(chip);
+    break;
+  }
+
+  case SX126X_OP_SET_LORA_SYMB_NUM_TIMEOUT:
+    SIM_NEED(2);
+    chip->lora_symb_timeout = tx[1];
+    break;
+
+  case SX126X_OP_GET_STATUS:
+  case SX126X_OP_GET_RSSI_INST:
+  case SX126X_OP_GET_STATS:
+  case SX126X_OP_RESET_STATS:
+  case SX126X_OP_SET_REGULATOR_MODE:
+  case SX126X_OP_SET_DIO2_AS_RF_SWITCH_CTRL:
+  case SX126X_OP_SET_DIO3_AS_TCXO_CTRL:
+  case SX126X_OP_STOP_TIMER_ON_PREAMBLE:
+    break;
+
+  default:
+    return SX126X_CMD_STATUS_PROCESSING_ERROR;
+  }
+
+#undef SIM_NEED
+
+  hal->busy_until_ns = hal->now_ns + busy_ns;
+  return SX126X_CMD_STATUS_RESERVED;
+}
+
+// Clock one frame, command and payload phase, through the modelled chip, including the BUSY wait
+// that precedes it. The local buffers stand for the chip's own shift register.
+static sx126x_status_t sim_frame(sx126x_hal_sim_t *hal, const sx126x_bus_frame_t *f)
+{
+  sx126x_hal_sim_chip_t *chip = &hal->chip;
+  size_t cmd_len = f->tx_len > f->rx_len ? f->tx_len : f->rx_len;
+  size_t len = cmd_len + f->data_len;
+  uint8_t op = f->tx && f->tx_len ? f->tx[0] : 0x00;
+  uint8_t frame[SX126X_BUFFER_SIZE + 8];
+
+  if (len == 0 || len > sizeof(frame))
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  sx126x_hal_sim_fault_kind_t fault = sim_take_fault(hal, op);
+  if (fault == SX126X_HAL_SIM_FAULT_IO)
+  {
+    return SX126X_ERR_IO;
+  }
+  if (fault == SX126X_HAL_SIM_FAULT_BUSY_STUCK)
+  {
+    hal->now_ns += hal->cfg.busy_timeout_ns;
+    hal->stats.busy_wait_ns += hal->cfg.busy_timeout_ns;
+    sim_process_events(hal);
+    return SX126X_ERR_TIMEOUT;
+  }
+
+  // The HAL waits for BUSY to drop before asserting NSS.
+  if (hal->now_ns < hal->busy_until_ns)
+  {
+    hal->stats.busy_wait_ns += hal->busy_until_ns - hal->now_ns;
+    hal->now_ns = hal->busy_until_ns;
+  }
+  sim_process_events(hal);
+
+  hal->now_ns += hal->cfg.cs_overhead_ns + sim_clock_ns(hal, len);
+  hal->stats.frames++;
+  hal->stats.bytes += len;
+  hal->stats.op_count[op]++;
+
+  // Bytes past tx_len, and a payload phase without data_tx, are clocked out as NOP.
+  memset(frame, 0x00, len);
+  if (f->tx)
+    memcpy(frame, f->tx, f->tx_len);
+  if (f->data_tx)
+    memcpy(&frame[cmd_len], f->data_tx, f->data_len);
+
+  uint8_t miso[SX126X_BUFFER_SIZE + 8];
+  uint8_t status = SX126X_STATUS_BYTE(chip->mode, chip->cmd_status);
+  memset(miso, status, len);
+
+  if (chip->sleeping)
+  {
+    // NSS going low wakes the chip; the command itself is not executed.
+    chip->sleeping = false;
+    if (!chip->warm_sleep)
+      sim_chip_reset(chip);
+    else
+      sim_regs_reset(chip);
+    memset(chip->buffer, 0, sizeof(chip->buffer));
+    chip->mode = SX126X_CHIP_MODE_STBY_RC;
+    hal->busy_until_ns = hal->now_ns + (chip->warm_sleep ? SIM_WAKE_WARM_NS : SIM_WAKE_COLD_NS);
+    chip->warm_sleep = false;
+    memset(miso, 0x00, len);
+  }
+  else if (fault == SX126X_HAL_SIM_FAULT_CMD_ERROR)
+  {
+    chip->cmd_status = SX126X_CMD_STATUS_PROCESSING_ERROR;
+    hal->stats.cmd_errors++;
+  }
+  else
+  {
+    chip->cmd_status = sim_execute(hal, frame, len, miso);
+    if (chip->cmd_status == SX126X_CMD_STATUS_PROCESSING_ERROR)
+      hal->stats.cmd_errors++;
+  }
+
+  if (f->rx)
+    memcpy(f->rx, miso, f->rx_len);
+  if (f->data_rx)
+    memcpy(f->data_rx, &miso[cmd_len], f->data_len);
+
+  return SX126X_OK;
+}
+
+static sx126x_status_t
+sim_transfer(sx126x_bus_t *bus, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len)
+{
+  if (!bus || (tx_len == 0 && rx_len == 0))
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  sx126x_hal_sim_t *hal = (sx126x_hal_sim_t *)bus->ctx;
+  if (!hal)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  uint64_t start = hal->now_ns;
+  hal->stats.transactions++;
+  hal->now_ns += hal->cfg.txn_overhead_ns;
+
+  sx126x_bus_frame_t frame = {.tx = tx, .tx_len = tx_len, .rx = rx, .rx_len = rx_len};
+  sx126x_status_t st = sim_frame(hal, &frame);
+
+  hal->stats.bus_ns += hal->now_ns - start;
+  return st;
+}
+
+static sx126x_status_t
+sim_transfer_batch(sx126x_bus_t *bus, const sx126x_bus_frame_t *frames, size_t count)
+{
+  if (!bus || !frames || count == 0)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  sx126x_hal_sim_t *hal = (sx126x_hal_sim_t *)bus->ctx;
+  if (!hal)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  uint64_t start = hal->now_ns;
+  hal->stats.transactions++;
+  hal->now_ns += hal->cfg.txn_overhead_ns;
+
+  sx126x_status_t st = SX126X_OK;
+  for (size_t i = 0; st == SX126X_OK && i < count; i++)
+  {
+    st = sim_frame(hal, &frames[i]);
+  }
+
+  hal->stats.bus_ns += hal->now_ns - start;
+  return st;
+}
+
+static sx126x_status_t
+sim_attach_dio1(sx126x_bus_t *bus, sx126x_bus_irq_handler_t handler, void *arg)
+{
+  if (!bus || !bus->ctx)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  sx126x_hal_sim_t *hal = (sx126x_hal_sim_t *)bus->ctx;
+  hal->dio1_handler = handler;
+  hal->dio1_arg = handler ? arg : NULL;
+
+  return SX126X_OK;
+}
+
+static uint32_t sim_now_us(sx126x_bus_t *bus)
+{
+  const sx126x_hal_sim_t *hal = (const sx126x_hal_sim_t *)bus->ctx;
+  return (uint32_t)(hal->now_ns / 1000);
+}
+
+// Waiting moves the modelled clock, running whatever the chip does meanwhile.
+static void sim_delay_us(sx126x_bus_t *bus, uint32_t us)
+{
+  sx126x_hal_sim_advance((sx126x_hal_t *)bus->ctx, (uint64_t)us * 1000);
+}
+
+// Earliest scheduled chip event, if any.
+static bool sim_next_event(const sx126x_hal_sim_t *hal, uint64_t *at_ns)
+{
+  const sx126x_hal_sim_chip_t *chip = &hal->chip;
+  bool found = false;
+
+  if (chip->tx_pending)
+  {
+    *at_ns = chip->tx_done_at_ns;
+    found = true;
+  }
+  if (chip->rx_timeout_pending && (!found || chip->rx_timeout_at_ns < *at_ns))
+  {
+    *at_ns = chip->rx_timeout_at_ns;
+    found = true;
+  }
+  if (chip->cad_pending && (!found || chip->cad_done_at_ns < *at_ns))
+  {
+    *at_ns = chip->cad_done_at_ns;
+    found = true;
+  }
+  if (chip->lr_fhss_pending && (!found || chip->lr_fhss_hop_end_ns < *at_ns))
+  {
+    *at_ns = chip->lr_fhss_hop_end_ns;
+    found = true;
+  }
+  if (hal->rx_queue_len > 0 && (!found || hal->rx_queue[0].at_ns < *at_ns))
+  {
+    *at_ns = hal->rx_queue[0].at_ns;
+    found = true;
+  }
+
+  return found;
+}
+
+sx126x_status_t sx126x_hal_sim_init(sx126x_hal_t *hal, const sx126x_hal_sim_cfg_t *cfg)
+{
+  if (!hal)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  memset(hal, 0, sizeof(*hal));
+
+  if (cfg)
+    hal->cfg = *cfg;
+  if (!hal->cfg.spi_clock_hz)
+    hal->cfg.spi_clock_hz = SIM_DEFAULT_SPI_CLOCK_HZ;
+  if (!hal->cfg.txn_overhead_ns)
+    hal->cfg.txn_overhead_ns = SIM_DEFAULT_TXN_OVERHEAD_NS;
+  if (!hal->cfg.cs_overhead_ns)
+    hal->cfg.cs_overhead_ns = SIM_DEFAULT_CS_OVERHEAD_NS;
+  if (!hal->cfg.busy_timeout_ns)
+    hal->cfg.busy_timeout_ns = SIM_DEFAULT_BUSY_TIMEOUT_NS;
+
+  hal->bus.transfer = sim_transfer;
+  hal->bus.transfer_batch = hal->cfg.disable_batch ? NULL : sim_transfer_batch;
+  hal->bus.attach_dio1 = sim_attach_dio1;
+  hal->bus.now_us = sim_now_us;
+  hal->bus.delay_us = sim_delay_us;
+  hal->bus.log = hal->cfg.enable_log ? sim_log : NULL;
+  hal->bus.ctx = hal;
+
+  sim_chip_reset(&hal->chip);
+
+  return SX126X_OK;
+}
+
+sx126x_status_t sx126x_hal_sim_deinit(sx126x_hal_t *hal)
+{
+  if (!hal)
+  {
+    return SX126X_ERR_INVALID_ARG;
+  }
+
+  memset(hal, 0, sizeof(*hal));
+
+  return SX126X_OK;
+}
+
+void sx126x_hal_sim_advance(sx126x_hal_t *hal, uint64_t ns)
+{
+  uint64_t target = hal->now_ns + ns;
+  uint64_t at;
+
+  sx126x_hal_sim_service_dio1(hal);
+
+  while (sim_next_event(hal, &at) && at <= target)
+  {
+    if (at > hal->now_ns)
+      hal->now_ns = at;
+    sim_process_events(hal);
+    sx126x_hal_sim_service_dio1(hal);
+  }
+
+  if (hal->now_ns < target)
+    hal->now_ns = target;
+}
+
+void sx126x_hal_sim_service_dio1(sx126x_hal_t *hal)
+{
+  for (int i = 0; i < SIM_DIO1_MAX_RUNS && hal->dio1_handler && sx126x_hal_sim_dio1(hal); i++)
+  {
+    hal->dio1_handler(hal->dio1_arg);
+  }
+}
+
+uint64_t sx126x_hal_sim_now_ns(const sx126x_hal_t *hal)
+{
+  return hal->now_ns;
+}
+
+bool sx126x_hal_sim_inject_rx(sx126x_hal_t *hal,
+                              const uint8_t *payload,
+                              uint8_t len,
+                              int rssi_dbm,
+                              int snr_db,
+                              bool crc_ok)
+{
+  sim_process_events(hal);
+  return sim_rx_arrive(hal, payload, len, rssi_dbm, snr_db, crc_ok);
+}
+
+bool sx126x_hal_sim_schedule_rx(sx126x_hal_t *hal,
+                                uint64_t at_ns,
+                                const uint8_t *payload,
+                                uint8_t len,
+                                int rssi_dbm,
+                                int snr_db,
+                                bool crc_ok)
+{
+  if (hal->rx_queue_len >= SX126X_HAL_SIM_RX_QUEUE)
+  {
+    return false;
+  }
+
+  // Keep the queue sorted by arrival time.
+  uint32_t i = hal->rx_queue_len;
+  while (i > 0 && hal->rx_queue[i - 1].at_ns > at_ns)
+  {
+    hal->rx_queue[i] = hal->rx_queue[i - 1];
+    i--;
+  }
+
+  sx126x_hal_sim_rx_t *rx = &hal->rx_queue[i];
+  rx->at_ns = at_ns;
+  rx->len = len;
+  rx->rssi_dbm = (int8_t)rssi_dbm;
+  rx->snr_db = (int8_t)snr_db;
+  rx->crc_ok = crc_ok;
+  memcpy(rx->payload, payload, len);
+  hal->rx_queue_len++;
+
+  return true;
+}
+
+void sx126x_hal_sim_set_medium(sx126x_hal_t *hal, const sx126x_hal_sim_medium_t *medium)
+{
+  if (medium)
+    hal->medium = *medium;
+  else
+    memset(&hal->medium, 0, sizeof(hal->medium));
+}
+
+void sx126x_hal_sim_set_fault(sx126x_hal_t *hal, const sx126x_hal_sim_fault_t *fault)
+{
+  if (fault)
+    hal->fault = *fault;
+  else
+    memset(&hal->fault, 0, sizeof(hal->fault));
+}
+
+void sx126x_hal_sim_reset_stats(sx126x_hal_t *hal)
+{
+  memset(&hal->stats, 0, sizeof(hal->stats));
+}
+
+bool sx126x_hal_sim_dio1(const sx126x_hal_t *hal)
+{
+  return (hal->chip.irq_status & hal->chip.dio_mask[0]) != 0;
+}
+
+uint64_t sx126x_hal_sim_airtime_ns(const sx126x_hal_t *hal, uint8_t payload_len)
+{
+  return sim_airtime_ns(&hal->chip, payload_len);
+}
+
+sx126x_bus_t *sx126x_hal_get_bus(sx126x_hal_t *hal)
+{
+  return &hal->bus;
+}
+
+sx126x_t *sx126x_hal_get_device(sx126x_hal_t *hal)
+{
+  return &hal->dev;
+}
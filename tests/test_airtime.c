@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Time on air: sx126x_time_on_air_us against the simulator's model of the chip, LDRO selection and
+ * GFSK framing.
+ */
+
+#include "test_util.h"
+#include <sx126x/airtime.h>
+#include <sx126x/commands.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/sx126x.h>
+
+static sx126x_hal_t test_sim;
+static uint8_t test_payload[SX126X_MAX_PAYLOAD_LEN];
+
+// Whether the driver's estimate for a packet of len bytes is within 0.1% of the simulated chip's.
+static bool test_matches_sim(sx126x_t *dev, const sx126x_config_t *cfg, uint8_t len)
+{
+  // Packet parameters reach the chip with the transmission, so send one to compare against.
+  if (sx126x_transmit_async(dev, test_payload, len, 0, NULL, NULL) != SX126X_OK)
+    return false;
+
+  uint64_t airtime_ns = sx126x_hal_sim_airtime_ns(&test_sim, len);
+  double ref = (double)airtime_ns / 1000.0;
+  double got = sx126x_time_on_air_us(cfg, len);
+  sx126x_hal_sim_advance(&test_sim, airtime_ns + 1000000);
+
+  double err = (got - ref) / ref;
+  return err < 0.001 && err > -0.001;
+}
+
+static void test_known_value(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+
+  // SF7/125 kHz, CR 4/5, 8 symbol preamble, explicit header and CRC: 40.25 symbols of 1.024 ms.
+  TEST_CHECK(sx126x_time_on_air_us(&cfg, 12) == 41216);
+  TEST_CHECK(sx126x_lora_symbol_ns(SX126X_LORA_SF_7, SX126X_LORA_BW_125) == 1024000);
+}
+
+static void test_lora_matches_sim(void)
+{
+  static const sx126x_lora_bandwidth_t bws[] = {
+      SX126X_LORA_BW_7,
+      SX126X_LORA_BW_62,
+      SX126X_LORA_BW_125,
+      SX126X_LORA_BW_500,
+  };
+  static const uint8_t lens[] = {1, 51, 255};
+  sx126x_config_t cfg;
+
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  for (int sf = SX126X_LORA_SF_5; sf <= SX126X_LORA_SF_12; sf++)
+  {
+    for (size_t b = 0; b < sizeof(bws) / sizeof(bws[0]); b++)
+    {
+      for (int variant = 0; variant < 4; variant++)
+      {
+        cfg.lora_sf = (sx126x_lora_spreading_factor_t)sf;
+        cfg.lora_bw = bws[b];
+        cfg.lora_implicit_header = variant & 1;
+        cfg.lora_cr = (variant & 2) ? SX126X_LORA_CR_4_8 : SX126X_LORA_CR_4_5;
+        TEST_CHECK(sx126x_reconfigure(dev, &cfg) == SX126X_OK);
+
+        for (size_t l = 0; l < sizeof(lens); l++)
+        {
+          if (!test_matches_sim(dev, &cfg, lens[l]))
+          {
+            fprintf(stderr, "SF%d bw=%d variant=%d len=%u\n", sf, bws[b], variant, lens[l]);
+            test_failures++;
+          }
+        }
+      }
+    }
+  }
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_gfsk(void)
+{
+  sx126x_config_t cfg;
+
+  test_gfsk_config(&cfg);
+
+  // Default preamble, two sync bytes, length byte, payload and two CRC bytes at 20 us a bit.
+  uint32_t bits = SX126X_GFSK_PREAMBLE_DEFAULT + 16 + 8 + 8 * 10 + 16;
+  TEST_CHECK(sx126x_time_on_air_us(&cfg, 10) == bits * 20);
+
+  cfg.gfsk_fixed_length = true;
+  TEST_CHECK(sx126x_time_on_air_us(&cfg, 10) == (bits - 8) * 20);
+
+  cfg.gfsk_fixed_length = false;
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  TEST_CHECK(test_matches_sim(dev, &cfg, 10));
+  TEST_CHECK(test_matches_sim(dev, &cfg, 255));
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_ldro(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+
+  cfg.lora_sf = SX126X_LORA_SF_10;
+  TEST_CHECK(!sx126x_lora_ldro_enabled(&cfg));
+  TEST_CHECK(!SX126X_LORA_LDRO_REQUIRED(SX126X_LORA_SF_10, SX126X_LORA_BW_125));
+
+  cfg.lora_sf = SX126X_LORA_SF_11;
+  TEST_CHECK(sx126x_lora_ldro_enabled(&cfg));
+  TEST_CHECK(SX126X_LORA_LDRO_REQUIRED(SX126X_LORA_SF_11, SX126X_LORA_BW_125));
+
+  cfg.lora_bw = SX126X_LORA_BW_250;
+  TEST_CHECK(!sx126x_lora_ldro_enabled(&cfg));
+
+  cfg.lora_ldro = true;
+  TEST_CHECK(sx126x_lora_ldro_enabled(&cfg));
+}
+
+static void test_invalid(void)
+{
+  sx126x_config_t cfg;
+
+  test_default_config(&cfg);
+  cfg.lora_sf = (sx126x_lora_spreading_factor_t)13;
+  TEST_CHECK(sx126x_time_on_air_us(&cfg, 12) == 0);
+
+  test_gfsk_config(&cfg);
+  cfg.gfsk_bitrate_bps = 0;
+  TEST_CHECK(sx126x_time_on_air_us(&cfg, 12) == 0);
+
+  cfg.modem = (sx126x_modem_t)0x7F;
+  TEST_CHECK(sx126x_time_on_air_us(&cfg, 12) == 0);
+}
+
+int main(void)
+{
+  for (int i = 0; i < SX126X_MAX_PAYLOAD_LEN; i++)
+    test_payload[i] = (uint8_t)i;
+
+  TEST_RUN(test_known_value);
+  TEST_RUN(test_lora_matches_sim);
+  TEST_RUN(test_gfsk);
+  TEST_RUN(test_ldro);
+  TEST_RUN(test_invalid);
+
+  return test_failures ? 1 : 0;
+}
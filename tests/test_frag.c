@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Fragmentation and reassembly: messages go through whole whatever the order fragments arrive in,
+ * selective ACKs have only the missing fragments sent again, and malformed frames are turned away.
+ */
+
+#include "test_util.h"
+#include <sx126x/frag.h>
+
+#define TEST_MSG_LEN 1000
+#define TEST_MAX_FRAMES 16
+
+static sx126x_frag_pool_t test_pool;
+static sx126x_frag_slot_t test_slots[2];
+static uint8_t test_storage[2 * TEST_MSG_LEN];
+static uint8_t test_msg[TEST_MSG_LEN];
+static uint8_t test_frames[TEST_MAX_FRAMES][SX126X_MAX_PAYLOAD_LEN];
+static uint8_t test_lens[TEST_MAX_FRAMES];
+
+// The message in three pieces, as a header, a body and a trailer would be.
+static const sx126x_frag_seg_t test_segs[] = {
+    {test_msg, 32},
+    {test_msg + 32, TEST_MSG_LEN - 36},
+    {test_msg + TEST_MSG_LEN - 4, 4},
+};
+
+static void test_setup(void)
+{
+  for (uint32_t i = 0; i < TEST_MSG_LEN; i++)
+    test_msg[i] = (uint8_t)(i * 7 + (i >> 8));
+  sx126x_frag_pool_init(&test_pool, test_slots, 2, test_storage, TEST_MSG_LEN);
+}
+
+// Build every fragment of a message sent without ACKs; the number built.
+static uint32_t test_build(sx126x_frag_tx_t *tx, uint8_t frag_len)
+{
+  sx126x_frag_tx_cfg_t cfg = {.frag_len = frag_len};
+  uint32_t n = 0;
+
+  TEST_CHECK(sx126x_frag_tx_init(tx, &cfg) == SX126X_OK);
+  TEST_CHECK(sx126x_frag_tx_start(tx, 1, test_segs, 3) == SX126X_OK);
+  while (n < TEST_MAX_FRAMES && sx126x_frag_tx_next(tx, test_frames[n], &test_lens[n]))
+    n++;
+
+  return n;
+}
+
+static bool test_delivered(const sx126x_frag_slot_t *slot)
+{
+  return slot && sx126x_frag_complete(slot) && slot->total == TEST_MSG_LEN &&
+         memcmp(slot->buf, test_msg, TEST_MSG_LEN) == 0;
+}
+
+static void test_in_order(void)
+{
+  sx126x_frag_tx_t tx;
+  sx126x_frag_slot_t *slot = NULL;
+
+  test_setup();
+  uint32_t n = test_build(&tx, 0);
+  TEST_CHECK(n == (TEST_MSG_LEN + SX126X_FRAG_MAX_LEN - 1) / SX126X_FRAG_MAX_LEN);
+  TEST_CHECK(sx126x_frag_tx_done(&tx));
+
+  for (uint32_t i = 0; i < n; i++)
+    TEST_CHECK(sx126x_frag_rx(&test_pool, 0, test_frames[i], test_lens[i], i, &slot) == SX126X_OK);
+  TEST_CHECK(test_delivered(slot));
+  TEST_CHECK(test_pool.stats.completed == 1);
+}
+
+static void test_out_of_order(void)
+{
+  sx126x_frag_tx_t tx;
+  sx126x_frag_slot_t *slot = NULL;
+
+  test_setup();
+  uint32_t n = test_build(&tx, 100);
+  TEST_CHECK(n == TEST_MSG_LEN / 100);
+
+  for (uint32_t i = n; i-- > 0;)
+  {
+    TEST_CHECK(sx126x_frag_rx(&test_pool, 0, test_frames[i], test_lens[i], i, &slot) == SX126X_OK);
+    TEST_CHECK(sx126x_frag_complete(slot) == (i == 0));
+  }
+  TEST_CHECK(test_delivered(slot));
+}
+
+static void test_duplicates(void)
+{
+  sx126x_frag_tx_t tx;
+  sx126x_frag_slot_t *slot = NULL;
+
+  test_setup();
+  uint32_t n = test_build(&tx, 100);
+
+  for (uint32_t i = 0; i < n; i++)
+  {
+    TEST_CHECK(sx126x_frag_rx(&test_pool, 0, test_frames[i], test_lens[i], i, &slot) == SX126X_OK);
+    if (i % 3 == 0)
+      TEST_CHECK(sx126x_frag_rx(&test_pool, 0, test_frames[i], test_lens[i], i, &slot) ==
+                 SX126X_OK);
+  }
+  TEST_CHECK(test_delivered(slot));
+  TEST_CHECK(test_pool.stats.duplicates == (n + 2) / 3);
+  TEST_CHECK(test_pool.stats.completed == 1);
+}
+
+static void test_selective_ack(void)
+{
+  sx126x_frag_tx_t tx;
+  sx126x_frag_slot_t *slot = NULL;
+  sx126x_frag_tx_cfg_t cfg = {.frag_len = 100, .window = 4};
+  uint8_t frame[SX126X_MAX_PAYLOAD_LEN];
+  uint8_t len;
+  bool is_lost = false;
+
+  test_setup();
+  TEST_CHECK(sx126x_frag_tx_init(&tx, &cfg) == SX126X_OK);
+  TEST_CHECK(sx126x_frag_tx_start(&tx, 2, test_segs, 3) == SX126X_OK);
+
+  for (uint32_t bursts = 0; !sx126x_frag_tx_done(&tx) && bursts < TEST_MAX_FRAMES; bursts++)
+  {
+    while (sx126x_frag_tx_next(&tx, frame, &len))
+    {
+      // The first copy of fragment 1 is lost on the way.
+      if (frame[2] == 1 && !is_lost)
+        is_lost = true;
+      else
+        TEST_CHECK(sx126x_frag_rx(&test_pool, 0, frame, len, bursts, &slot) == SX126X_OK);
+
+      if (frame[0] & SX126X_FRAG_FLAG_ACK_REQ)
+        break;
+    }
+
+    TEST_CHECK(slot && slot->ack_requested);
+    if (!slot)
+      return;
+    sx126x_frag_ack(slot, frame, &len);
+    TEST_CHECK(sx126x_frag_tx_ack(&tx, frame, len) == SX126X_OK);
+  }
+
+  TEST_CHECK(sx126x_frag_tx_done(&tx));
+  TEST_CHECK(test_delivered(slot));
+  TEST_CHECK(tx.stats.sent == TEST_MSG_LEN / 100 + 1);
+  TEST_CHECK(tx.stats.resent == 1);
+  TEST_CHECK(test_pool.stats.duplicates == 0);
+}
+
+static void test_lost_ack(void)
+{
+  sx126x_frag_tx_t tx;
+  sx126x_frag_slot_t *slot = NULL;
+  sx126x_frag_tx_cfg_t cfg = {.frag_len = 100, .window = 2, .max_retries = 2};
+  uint8_t frame[SX126X_MAX_PAYLOAD_LEN];
+  uint8_t len;
+
+  test_setup();
+  TEST_CHECK(sx126x_frag_tx_init(&tx, &cfg) == SX126X_OK);
+  TEST_CHECK(sx126x_frag_tx_start(&tx, 3, test_segs, 3) == SX126X_OK);
+
+  TEST_CHECK(sx126x_frag_tx_next(&tx, frame, &len));
+  TEST_CHECK(sx126x_frag_tx_next(&tx, frame, &len));
+  TEST_CHECK(frame[0] & SX126X_FRAG_FLAG_ACK_REQ);
+  TEST_CHECK(!sx126x_frag_tx_next(&tx, frame, &len));
+
+  // With the ACK missing, the end of the burst is sent again to ask once more.
+  TEST_CHECK(sx126x_frag_tx_timeout(&tx) == SX126X_OK);
+  TEST_CHECK(sx126x_frag_tx_next(&tx, frame, &len));
+  TEST_CHECK(frame[2] == 1 && (frame[0] & SX126X_FRAG_FLAG_ACK_REQ));
+  TEST_CHECK(tx.stats.timeouts == 1);
+
+  TEST_CHECK(sx126x_frag_rx(&test_pool, 0, frame, len, 0, &slot) == SX126X_OK);
+  sx126x_frag_ack(slot, frame, &len);
+  TEST_CHECK(sx126x_frag_tx_ack(&tx, frame, len) == SX126X_OK);
+  TEST_CHECK(tx.is_active);
+
+  // Give up after max_retries missing ACKs in a row.
+  while (sx126x_frag_tx_next(&tx, frame, &len))
+    ;
+  sx126x_frag_tx_timeout(&tx);
+  while (sx126x_frag_tx_next(&tx, frame, &len))
+    ;
+  sx126x_frag_tx_timeout(&tx);
+  TEST_CHECK(!tx.is_active);
+}
+
+static void test_rejects_malformed(void)
+{
+  sx126x_frag_tx_t tx;
+  sx126x_frag_slot_t *slot;
+  uint8_t frame[SX126X_MAX_PAYLOAD_LEN];
+
+  test_setup();
+  uint32_t n = test_build(&tx, 100);
+
+  // Too short to carry any data.
+  TEST_CHECK(sx126x_frag_rx(&test_pool, 0, test_frames[0], SX126X_FRAG_HEADER_LEN, 0, &slot) ==
+             SX126X_ERR_INVALID_ARG);
+
+  // Not a data fragment.
+  memcpy(frame, test_frames[0], test_lens[0]);
+  frame[0] = SX126X_FRAG_TYPE_ACK;
+  TEST_CHECK(sx126x_frag_rx(&test_pool, 0, frame, test_lens[0], 0, &slot) ==
+             SX126X_ERR_INVALID_ARG);
+
+  // A fragment that runs past the end of the message.
+  memcpy(frame, test_frames[0], test_lens[0]);
+  frame[2] = (uint8_t)n;
+  TEST_CHECK(sx126x_frag_rx(&test_pool, 0, frame, test_lens[0], 0, &slot) ==
+             SX126X_ERR_INVALID_ARG);
+
+  // A message larger than a slot.
+  memcpy(frame, test_frames[0], test_lens[0]);
+  frame[3] = (uint8_t)((TEST_MSG_LEN + 1) >> 8);
+  frame[4] = (uint8_t)(TEST_MSG_LEN + 1);
+  TEST_CHECK(sx126x_frag_rx(&test_pool, 0, frame, test_lens[0], 0, &slot) == SX126X_ERR_NO_MEM);
+
+  // A fragment whose length disagrees with the others of its message.
+  TEST_CHECK(sx126x_frag_rx(&test_pool, 0, test_frames[0], test_lens[0], 0, &slot) == SX126X_OK);
+  TEST_CHECK(sx126x_frag_rx(&test_pool, 0, test_frames[1], test_lens[1] - 1, 0, &slot) ==
+             SX126X_ERR_INVALID_ARG);
+
+  TEST_CHECK(test_pool.stats.rejected == 5);
+  TEST_CHECK(test_pool.stats.fragments == 1);
+
+  // An ACK for another message.
+  uint8_t ack[SX126X_FRAG_ACK_MAX_LEN];
+  uint8_t len;
+  sx126x_frag_ack(slot, ack, &len);
+  ack[1] ^= 0xFF;
+  TEST_CHECK(sx126x_frag_tx_ack(&tx, ack, len) == SX126X_ERR_INVALID_ARG);
+}
+
+int main(void)
+{
+  TEST_RUN(test_in_order);
+  TEST_RUN(test_out_of_order);
+  TEST_RUN(test_duplicates);
+  TEST_RUN(test_selective_ack);
+  TEST_RUN(test_lost_ack);
+  TEST_RUN(test_rejects_malformed);
+
+  return test_failures ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Deferred logging: messages recorded through the SX126X_LOG_* macros come back out of the ring
+ * formatted as bus->log would have printed them.
+ */
+
+#include "test_util.h"
+#include <stdint.h>
+#include <sx126x/bus.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/log.h>
+#include <sx126x/log_ring.h>
+
+static sx126x_hal_t test_sim;
+static sx126x_log_ring_t test_ring;
+static sx126x_log_slot_t test_slots[4];
+
+// Attach an empty ring to the simulator's bus.
+static sx126x_bus_t *test_bus(void)
+{
+  sx126x_hal_sim_init(&test_sim, NULL);
+  sx126x_bus_t *bus = sx126x_hal_get_bus(&test_sim);
+  TEST_CHECK(sx126x_log_ring_init(&test_ring, test_slots, 4) == SX126X_OK);
+  bus->log_ring = &test_ring;
+
+  return bus;
+}
+
+// Pop the oldest record and check that it formats as expected.
+static void test_expect(const char *expected)
+{
+  sx126x_log_record_t rec;
+  char buf[128];
+
+  TEST_CHECK(sx126x_log_ring_pop(&test_ring, &rec));
+  int n = sx126x_log_format(&rec, buf, sizeof(buf));
+  TEST_CHECK(strcmp(buf, expected) == 0);
+  TEST_CHECK(n == (int)strlen(expected) - (int)(strchr(expected, ']') - expected) - 2);
+  if (strcmp(buf, expected) != 0)
+    fprintf(stderr, "got \"%s\", expected \"%s\"\n", buf, expected);
+}
+
+static void test_conversions(void)
+{
+  sx126x_bus_t *bus = test_bus();
+  static const char name[] = "sx1262";
+  uint64_t big = 0x123456789ull;
+  int16_t rssi = -97;
+
+  SX126X_LOG_ERROR(bus, "no args");
+  SX126X_LOG_WARN(bus, "%s at %lu Hz, %d dBm", name, 868100000ul, rssi);
+  SX126X_LOG_INFO(bus, "%llx %02x %-4u| 100%%", (unsigned long long)big, 0xA, 7u);
+  TEST_CHECK(test_ring.dropped == 0);
+
+  test_expect("[ERROR] no args");
+  test_expect("[WARN] sx1262 at 868100000 Hz, -97 dBm");
+  test_expect("[INFO] 123456789 0a 7   | 100%");
+
+  sx126x_log_record_t rec;
+  TEST_CHECK(!sx126x_log_ring_pop(&test_ring, &rec));
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_unsupported(void)
+{
+  sx126x_bus_t *bus = test_bus();
+
+  // A missing argument or a conversion a record cannot carry is printed as written.
+  SX126X_LOG_ERROR(bus, "%d %d", 1);
+  SX126X_LOG_ERROR(bus, "%f %d", 2, 3);
+  test_expect("[ERROR] 1 %d");
+  test_expect("[ERROR] %f 2");
+
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_full_ring(void)
+{
+  sx126x_bus_t *bus = test_bus();
+
+  for (int i = 0; i < 6; i++)
+    SX126X_LOG_ERROR(bus, "message %d", i);
+  TEST_CHECK(test_ring.dropped == 2);
+
+  test_expect("[ERROR] message 0");
+  test_expect("[ERROR] message 1");
+  test_expect("[ERROR] message 2");
+  test_expect("[ERROR] message 3");
+
+  // Popping frees slots for new records.
+  SX126X_LOG_ERROR(bus, "message %d", 6);
+  test_expect("[ERROR] message 6");
+
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_truncation(void)
+{
+  sx126x_log_record_t rec = {.fmt = "value %u of %u", .level = SX126X_LOG_LEVEL_INFO, .nargs = 2};
+  char buf[12];
+
+  rec.args[0] = 12345;
+  rec.args[1] = 67890;
+
+  // Like snprintf, the result counts the whole message even when it does not fit.
+  TEST_CHECK(sx126x_log_format(&rec, buf, sizeof(buf)) == (int)strlen("value 12345 of 67890"));
+  TEST_CHECK(strcmp(buf, "[INFO] valu") == 0);
+}
+
+int main(void)
+{
+  TEST_RUN(test_conversions);
+  TEST_RUN(test_unsupported);
+  TEST_RUN(test_full_ring);
+  TEST_RUN(test_truncation);
+
+  return test_failures ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Delta reconfiguration: sx126x_reconfigure sends only the commands whose parameters changed.
+ */
+
+#include "test_util.h"
+#include <sx126x/commands.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/sx126x.h>
+
+static sx126x_hal_t test_sim;
+
+// Frames of one opcode sent since the counters were last reset.
+static uint64_t test_frames(uint8_t opcode)
+{
+  return test_sim.stats.op_count[opcode];
+}
+
+static void test_unchanged_sends_nothing(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  sx126x_hal_sim_reset_stats(&test_sim);
+  TEST_CHECK(sx126x_reconfigure(dev, &cfg) == SX126X_OK);
+  TEST_CHECK(test_sim.stats.frames == 0);
+  TEST_CHECK(dev->reconfig_stats.sent == 0);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_frequency_only(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  uint32_t rf_freq = test_sim.chip.rf_freq;
+  sx126x_hal_sim_reset_stats(&test_sim);
+  cfg.frequency_hz = 868300000;
+  TEST_CHECK(sx126x_reconfigure(dev, &cfg) == SX126X_OK);
+  TEST_CHECK(test_frames(SX126X_OP_SET_RF_FREQUENCY) == 1);
+  TEST_CHECK(test_sim.stats.frames == 1);
+  TEST_CHECK(test_sim.chip.rf_freq == SX126X_RF_FREQ_WORD(868300000));
+  TEST_CHECK(test_sim.chip.rf_freq != rf_freq);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_modulation_only(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  sx126x_hal_sim_reset_stats(&test_sim);
+  cfg.lora_sf = SX126X_LORA_SF_9;
+  TEST_CHECK(sx126x_reconfigure(dev, &cfg) == SX126X_OK);
+  TEST_CHECK(test_frames(SX126X_OP_SET_MODULATION_PARAMS) == 1);
+  TEST_CHECK(test_frames(SX126X_OP_SET_RF_FREQUENCY) == 0);
+  TEST_CHECK(test_frames(SX126X_OP_SET_TX_PARAMS) == 0);
+  TEST_CHECK(test_frames(SX126X_OP_SET_PACKET_TYPE) == 0);
+  TEST_CHECK(test_sim.chip.mod_params[0] == SX126X_LORA_SF_9);
+  TEST_CHECK(dev->reconfig_stats.skipped > 0);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_power_only(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  sx126x_hal_sim_reset_stats(&test_sim);
+  cfg.power_dbm = 10;
+  TEST_CHECK(sx126x_reconfigure(dev, &cfg) == SX126X_OK);
+  TEST_CHECK(test_frames(SX126X_OP_SET_TX_PARAMS) == 1);
+  TEST_CHECK(test_frames(SX126X_OP_SET_MODULATION_PARAMS) == 0);
+  TEST_CHECK(test_frames(SX126X_OP_SET_RF_FREQUENCY) == 0);
+  TEST_CHECK(test_sim.chip.tx_params[0] == 10);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_invert_iq(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  TEST_CHECK(test_sim.chip.regs[SX126X_REG_IQ_POLARITY] == SX126X_IQ_POLARITY_DEFAULT);
+
+  sx126x_hal_sim_reset_stats(&test_sim);
+  cfg.lora_invert_iq = true;
+  TEST_CHECK(sx126x_reconfigure(dev, &cfg) == SX126X_OK);
+  // Only the IQ polarity register; packet parameters go out with the next transmission.
+  TEST_CHECK(test_frames(SX126X_OP_WRITE_REGISTER) == 1);
+  TEST_CHECK(test_sim.stats.frames == 1);
+  TEST_CHECK(test_sim.chip.regs[SX126X_REG_IQ_POLARITY] ==
+             (SX126X_IQ_POLARITY_DEFAULT & ~SX126X_IQ_POLARITY_STANDARD_BIT));
+
+  cfg.lora_invert_iq = false;
+  TEST_CHECK(sx126x_reconfigure(dev, &cfg) == SX126X_OK);
+  TEST_CHECK(test_sim.chip.regs[SX126X_REG_IQ_POLARITY] == SX126X_IQ_POLARITY_DEFAULT);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_modem_change_resyncs(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  sx126x_hal_sim_reset_stats(&test_sim);
+  test_gfsk_config(&cfg);
+  TEST_CHECK(sx126x_reconfigure(dev, &cfg) == SX126X_OK);
+  TEST_CHECK(test_frames(SX126X_OP_SET_PACKET_TYPE) == 1);
+  TEST_CHECK(test_sim.chip.packet_type == SX126X_PACKET_TYPE_GFSK);
+  TEST_CHECK(dev->reconfig_stats.resyncs == 1);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_bus_error_resyncs(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  // A failed command leaves the chip's settings unknown, so the next change resends everything.
+  sx126x_hal_sim_fault_t fault = {
+      .kind = SX126X_HAL_SIM_FAULT_IO, .opcode = SX126X_OP_SET_RF_FREQUENCY, .count = 1};
+  sx126x_hal_sim_set_fault(&test_sim, &fault);
+  cfg.frequency_hz = 868500000;
+  TEST_CHECK(sx126x_reconfigure(dev, &cfg) != SX126X_OK);
+
+  sx126x_hal_sim_reset_stats(&test_sim);
+  TEST_CHECK(sx126x_reconfigure(dev, &cfg) == SX126X_OK);
+  TEST_CHECK(dev->reconfig_stats.resyncs == 1);
+  TEST_CHECK(test_frames(SX126X_OP_SET_MODULATION_PARAMS) == 1);
+  TEST_CHECK(test_sim.chip.rf_freq == SX126X_RF_FREQ_WORD(868500000));
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+int main(void)
+{
+  TEST_RUN(test_unchanged_sends_nothing);
+  TEST_RUN(test_frequency_only);
+  TEST_RUN(test_modulation_only);
+  TEST_RUN(test_power_only);
+  TEST_RUN(test_invert_iq);
+  TEST_RUN(test_modem_change_resyncs);
+  TEST_RUN(test_bus_error_resyncs);
+
+  return test_failures ? 1 : 0;
+}
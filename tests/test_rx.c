@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Receive paths: continuous and single RX into the ring, the batched completion read, and the
+ * packet lengths programmed for packets that do not carry one.
+ */
+
+#include "test_util.h"
+#include <sx126x/commands.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/rx_ring.h>
+#include <sx126x/sx126x.h>
+
+static sx126x_hal_t test_sim;
+static sx126x_rx_ring_t test_ring;
+static sx126x_rx_packet_t test_ring_slots[4];
+static uint8_t test_payload[SX126X_MAX_PAYLOAD_LEN];
+static sx126x_status_t test_result;
+static uint32_t test_done;
+
+static void test_rx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  (void)dev;
+  (void)arg;
+
+  test_result = result;
+  test_done++;
+}
+
+// Bring up a radio for receiving with an empty ring.
+static sx126x_t *test_receiver(sx126x_config_t *cfg)
+{
+  for (int i = 0; i < SX126X_MAX_PAYLOAD_LEN; i++)
+    test_payload[i] = (uint8_t)(i * 7 + 1);
+  sx126x_rx_ring_init(&test_ring, test_ring_slots, 4);
+  test_result = SX126X_OK;
+  test_done = 0;
+
+  return test_radio(&test_sim, cfg);
+}
+
+static void test_continuous(void)
+{
+  sx126x_config_t cfg;
+  sx126x_rx_packet_t pkt;
+
+  test_default_config(&cfg);
+  sx126x_t *dev = test_receiver(&cfg);
+  if (!dev)
+    return;
+
+  TEST_CHECK(sx126x_receive_continuous(dev, &test_ring) == SX126X_OK);
+  for (uint8_t n = 1; n <= 3; n++)
+  {
+    uint64_t at_ns = sx126x_hal_sim_now_ns(&test_sim) + 1000000;
+    TEST_CHECK(sx126x_hal_sim_schedule_rx(&test_sim, at_ns, test_payload, n * 20, -80, 8, true));
+    sx126x_hal_sim_advance(&test_sim, 2000000);
+  }
+
+  TEST_CHECK(dev->rx_stats.received == 3);
+  TEST_CHECK(sx126x_rx_ring_count(&test_ring) == 3);
+  for (uint8_t n = 1; n <= 3; n++)
+  {
+    TEST_CHECK(sx126x_rx_ring_pop(&test_ring, &pkt));
+    TEST_CHECK(pkt.len == n * 20);
+    TEST_CHECK(memcmp(pkt.payload, test_payload, pkt.len) == 0);
+    TEST_CHECK(pkt.rssi_dbm == -80);
+    TEST_CHECK(pkt.snr_db == 8);
+  }
+
+  TEST_CHECK(sx126x_receive_stop(dev) == SX126X_OK);
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_crc_error(void)
+{
+  sx126x_config_t cfg;
+
+  test_default_config(&cfg);
+  sx126x_t *dev = test_receiver(&cfg);
+  if (!dev)
+    return;
+
+  TEST_CHECK(sx126x_receive_continuous(dev, &test_ring) == SX126X_OK);
+  TEST_CHECK(sx126x_hal_sim_inject_rx(&test_sim, test_payload, 16, -80, 8, false));
+  sx126x_hal_sim_service_dio1(&test_sim);
+
+  TEST_CHECK(dev->rx_stats.crc_errors == 1);
+  TEST_CHECK(dev->rx_stats.received == 0);
+  TEST_CHECK(sx126x_rx_ring_count(&test_ring) == 0);
+  TEST_CHECK(!sx126x_hal_sim_dio1(&test_sim));
+
+  sx126x_receive_stop(dev);
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_overrun(void)
+{
+  sx126x_config_t cfg;
+
+  test_default_config(&cfg);
+  sx126x_t *dev = test_receiver(&cfg);
+  if (!dev)
+    return;
+
+  TEST_CHECK(sx126x_receive_continuous(dev, &test_ring) == SX126X_OK);
+  for (int i = 0; i < 4; i++)
+  {
+    TEST_CHECK(sx126x_hal_sim_inject_rx(&test_sim, test_payload, 16, -80, 8, true));
+    sx126x_hal_sim_service_dio1(&test_sim);
+  }
+
+  // With the ring full, a dropped packet costs only its four status frames, not its payload.
+  sx126x_hal_sim_reset_stats(&test_sim);
+  for (int i = 0; i < 2; i++)
+  {
+    TEST_CHECK(sx126x_hal_sim_inject_rx(&test_sim, test_payload, 200, -80, 8, true));
+    sx126x_hal_sim_service_dio1(&test_sim);
+  }
+
+  TEST_CHECK(dev->rx_stats.received == 4);
+  TEST_CHECK(dev->rx_stats.overruns == 2);
+  TEST_CHECK(sx126x_rx_ring_count(&test_ring) == 4);
+  TEST_CHECK(test_sim.stats.frames == 2 * 4);
+  TEST_CHECK(test_sim.stats.op_count[SX126X_OP_READ_BUFFER] == 0);
+  TEST_CHECK(test_sim.stats.bytes < 2 * 32);
+
+  sx126x_receive_stop(dev);
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_rx_complete(void)
+{
+  sx126x_config_t cfg;
+  sx126x_rx_packet_t pkt;
+
+  test_default_config(&cfg);
+  sx126x_t *dev = test_receiver(&cfg);
+  if (!dev)
+    return;
+
+  TEST_CHECK(sx126x_receive_continuous(dev, &test_ring) == SX126X_OK);
+
+  // Read completions by hand instead of through the driver's DIO1 handler.
+  sx126x_bus_t *bus = sx126x_hal_get_bus(&test_sim);
+  bus->attach_dio1(bus, NULL, NULL);
+
+  // A short packet, then a longer one than the speculative read covers.
+  static const uint8_t lens[] = {8, 200, 8};
+  for (size_t i = 0; i < sizeof(lens); i++)
+  {
+    TEST_CHECK(sx126x_hal_sim_inject_rx(&test_sim, test_payload, lens[i], -70, 5, true));
+    TEST_CHECK(sx126x_hal_sim_dio1(&test_sim));
+    TEST_CHECK(sx126x_rx_complete(dev, &pkt) == SX126X_OK);
+    TEST_CHECK(pkt.irq & SX126X_IRQ_RX_DONE);
+    TEST_CHECK(pkt.len == lens[i]);
+    TEST_CHECK(memcmp(pkt.payload, test_payload, lens[i]) == 0);
+    TEST_CHECK(!sx126x_hal_sim_dio1(&test_sim));
+  }
+
+  // A packet with a CRC error has no payload.
+  TEST_CHECK(sx126x_hal_sim_inject_rx(&test_sim, test_payload, 16, -70, 5, false));
+  TEST_CHECK(sx126x_rx_complete(dev, &pkt) == SX126X_OK);
+  TEST_CHECK(pkt.irq & SX126X_IRQ_CRC_ERR);
+  TEST_CHECK(pkt.len == 0);
+  TEST_CHECK(!sx126x_hal_sim_dio1(&test_sim));
+
+  sx126x_receive_stop(dev);
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_single_timeout(void)
+{
+  sx126x_config_t cfg;
+
+  test_default_config(&cfg);
+  sx126x_t *dev = test_receiver(&cfg);
+  if (!dev)
+    return;
+
+  TEST_CHECK(sx126x_receive_single(dev, &test_ring, 10000, 0, test_rx_done, NULL) == SX126X_OK);
+  TEST_CHECK(sx126x_receive_single(dev, &test_ring, 10000, 0, test_rx_done, NULL) ==
+             SX126X_ERR_BUSY);
+  sx126x_hal_sim_advance(&test_sim, 20000000);
+
+  TEST_CHECK(test_done == 1);
+  TEST_CHECK(test_result == SX126X_ERR_TIMEOUT);
+  TEST_CHECK(sx126x_rx_ring_count(&test_ring) == 0);
+  TEST_CHECK(sx126x_is_idle(dev));
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_single_packet(void)
+{
+  sx126x_config_t cfg;
+  sx126x_rx_packet_t pkt;
+
+  test_default_config(&cfg);
+  sx126x_t *dev = test_receiver(&cfg);
+  if (!dev)
+    return;
+
+  TEST_CHECK(sx126x_receive_single(dev, &test_ring, 0, 0, test_rx_done, NULL) == SX126X_OK);
+  uint64_t at_ns = sx126x_hal_sim_now_ns(&test_sim) + 1000000;
+  TEST_CHECK(sx126x_hal_sim_schedule_rx(&test_sim, at_ns, test_payload, 32, -90, 3, true));
+  sx126x_hal_sim_advance(&test_sim, 2000000);
+
+  TEST_CHECK(test_done == 1);
+  TEST_CHECK(test_result == SX126X_OK);
+  TEST_CHECK(sx126x_rx_ring_pop(&test_ring, &pkt));
+  TEST_CHECK(pkt.len == 32 && memcmp(pkt.payload, test_payload, 32) == 0);
+  TEST_CHECK(sx126x_is_idle(dev));
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_implicit_header_length(void)
+{
+  sx126x_config_t cfg;
+
+  test_default_config(&cfg);
+  cfg.lora_implicit_header = true;
+  cfg.rx_payload_len = 12;
+  sx126x_t *dev = test_receiver(&cfg);
+  if (!dev)
+    return;
+
+  TEST_CHECK(sx126x_receive_continuous(dev, &test_ring) == SX126X_OK);
+  TEST_CHECK(test_sim.chip.pkt_params[3] == 12);
+
+  sx126x_receive_stop(dev);
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_gfsk_fixed_length(void)
+{
+  sx126x_config_t cfg;
+  sx126x_rx_packet_t pkt;
+
+  test_gfsk_config(&cfg);
+  cfg.gfsk_fixed_length = true;
+  cfg.rx_payload_len = 20;
+  sx126x_t *dev = test_receiver(&cfg);
+  if (!dev)
+    return;
+
+  TEST_CHECK(sx126x_receive_continuous(dev, &test_ring) == SX126X_OK);
+  TEST_CHECK(test_sim.chip.pkt_params[6] == 20);
+
+  TEST_CHECK(sx126x_hal_sim_inject_rx(&test_sim, test_payload, 20, -80, 0, true));
+  sx126x_hal_sim_service_dio1(&test_sim);
+  TEST_CHECK(sx126x_rx_ring_pop(&test_ring, &pkt));
+  TEST_CHECK(pkt.len == 20 && memcmp(pkt.payload, test_payload, 20) == 0);
+
+  sx126x_receive_stop(dev);
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+int main(void)
+{
+  TEST_RUN(test_continuous);
+  TEST_RUN(test_crc_error);
+  TEST_RUN(test_overrun);
+  TEST_RUN(test_rx_complete);
+  TEST_RUN(test_single_timeout);
+  TEST_RUN(test_single_packet);
+  TEST_RUN(test_implicit_header_length);
+  TEST_RUN(test_gfsk_fixed_length);
+
+  return test_failures ? 1 : 0;
+}
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * Transmit paths: asynchronous TX with its completion callback and the blocking transmit built on
+ * it, including how the blocking transmit ends when the bus lock fails under it, and the modem
+ * left behind by an LR-FHSS transmission that failed to start.
+ */
+
+#include "test_util.h"
+#include <stdint.h>
+#include <sx126x/bus.h>
+#include <sx126x/commands.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/lr_fhss.h>
+#include <sx126x/sx126x.h>
+
+static sx126x_hal_t test_sim;
+static uint8_t test_payload[64];
+static sx126x_lr_fhss_hop_t test_hops[4];
+static sx126x_status_t test_result;
+static uint32_t test_done;
+static uint32_t test_lock_calls;
+static uint32_t test_lock_fail_first;
+static uint32_t test_lock_fail_last;
+
+// A bus lock that fails for the calls numbered test_lock_fail_first to test_lock_fail_last.
+static sx126x_status_t test_lock(sx126x_bus_t *bus)
+{
+  (void)bus;
+
+  test_lock_calls++;
+  if (test_lock_calls >= test_lock_fail_first && test_lock_calls <= test_lock_fail_last)
+    return SX126X_ERR_TIMEOUT;
+  return SX126X_OK;
+}
+
+static void test_unlock(sx126x_bus_t *bus)
+{
+  (void)bus;
+}
+
+static void test_fail_locks(sx126x_bus_t *bus, uint32_t first, uint32_t last)
+{
+  bus->lock = test_lock;
+  bus->unlock = test_unlock;
+  test_lock_calls = 0;
+  test_lock_fail_first = first;
+  test_lock_fail_last = last;
+}
+
+static void test_tx_done(sx126x_t *dev, sx126x_status_t result, void *arg)
+{
+  (void)dev;
+  (void)arg;
+
+  test_result = result;
+  test_done++;
+}
+
+static void test_async(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  test_done = 0;
+  TEST_CHECK(sx126x_transmit_async(dev, test_payload, 16, 0, test_tx_done, NULL) == SX126X_OK);
+  TEST_CHECK(!sx126x_is_idle(dev));
+  TEST_CHECK(sx126x_transmit_async(dev, test_payload, 16, 0, test_tx_done, NULL) ==
+             SX126X_ERR_BUSY);
+
+  sx126x_hal_sim_advance(&test_sim, sx126x_hal_sim_airtime_ns(&test_sim, 16) + 1000000);
+  TEST_CHECK(test_done == 1);
+  TEST_CHECK(test_result == SX126X_OK);
+  TEST_CHECK(sx126x_is_idle(dev));
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_blocking(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  uint64_t start_ns = sx126x_hal_sim_now_ns(&test_sim);
+  TEST_CHECK(sx126x_transmit(dev, test_payload, sizeof(test_payload)) == SX126X_OK);
+  TEST_CHECK(sx126x_is_idle(dev));
+  TEST_CHECK(sx126x_hal_sim_now_ns(&test_sim) - start_ns >=
+             sx126x_hal_sim_airtime_ns(&test_sim, sizeof(test_payload)));
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_blocking_not_init(void)
+{
+  sx126x_t dev;
+
+  memset(&dev, 0, sizeof(dev));
+  TEST_CHECK(sx126x_transmit(NULL, test_payload, 16) == SX126X_ERR_INVALID_ARG);
+  TEST_CHECK(sx126x_transmit(&dev, test_payload, 16) == SX126X_ERR_NOT_INIT);
+}
+
+static void test_blocking_lock_error(void)
+{
+  sx126x_config_t cfg;
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  // The lock for the first poll fails: the TX is aborted rather than left running.
+  sx126x_bus_t *bus = sx126x_hal_get_bus(&test_sim);
+  test_fail_locks(bus, 2, 2);
+  TEST_CHECK(sx126x_transmit(dev, test_payload, 16) == SX126X_ERR_TIMEOUT);
+  TEST_CHECK(sx126x_is_idle(dev));
+  TEST_CHECK(sx126x_transmit(dev, test_payload, 16) == SX126X_OK);
+
+  // With no lock to abort under, the TX ends by itself and its completion stays within dev.
+  test_fail_locks(bus, 2, UINT32_MAX);
+  TEST_CHECK(sx126x_transmit(dev, test_payload, 16) == SX126X_ERR_TIMEOUT);
+  TEST_CHECK(!sx126x_is_idle(dev));
+
+  test_fail_locks(bus, 1, 0);
+  sx126x_hal_sim_advance(&test_sim, sx126x_hal_sim_airtime_ns(&test_sim, 16) + 1000000);
+  TEST_CHECK(sx126x_is_idle(dev));
+  TEST_CHECK(dev->transmit_done && dev->transmit_result == SX126X_OK);
+  TEST_CHECK(sx126x_transmit(dev, test_payload, 16) == SX126X_OK);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+static void test_lr_fhss_start_error(void)
+{
+  static const uint32_t hz[] = {868100000, 868150000, 868050000, 868200000};
+  static const uint16_t symbols[] = {64, 64, 48, 48};
+  sx126x_lr_fhss_table_t table;
+  sx126x_config_t cfg;
+
+  TEST_CHECK(sx126x_lr_fhss_build(&table, test_hops, hz, symbols, 4) == SX126X_OK);
+  test_default_config(&cfg);
+  sx126x_t *dev = test_radio(&test_sim, &cfg);
+  if (!dev)
+    return;
+
+  // SetTx fails after the packet type has gone to LR-FHSS; the configured one is put back.
+  sx126x_hal_sim_fault_t fault = {
+      .kind = SX126X_HAL_SIM_FAULT_IO, .opcode = SX126X_OP_SET_TX, .count = 1};
+  sx126x_hal_sim_set_fault(&test_sim, &fault);
+  TEST_CHECK(sx126x_transmit_lr_fhss(dev, &table, test_payload, 16, 0, NULL, NULL) ==
+             SX126X_ERR_IO);
+  TEST_CHECK(sx126x_is_idle(dev));
+  TEST_CHECK(!dev->modem_stale);
+  TEST_CHECK(test_sim.chip.packet_type == SX126X_PACKET_TYPE_LORA);
+
+  // The restore fails too, so the next transmission does it first.
+  fault.opcode = SX126X_OP_SET_MODULATION_PARAMS;
+  fault.count = 2;
+  sx126x_hal_sim_set_fault(&test_sim, &fault);
+  TEST_CHECK(sx126x_transmit_lr_fhss(dev, &table, test_payload, 16, 0, NULL, NULL) ==
+             SX126X_ERR_IO);
+  TEST_CHECK(dev->modem_stale);
+
+  test_done = 0;
+  TEST_CHECK(sx126x_transmit_async(dev, test_payload, 16, 0, test_tx_done, NULL) == SX126X_OK);
+  TEST_CHECK(!dev->modem_stale);
+  TEST_CHECK(test_sim.chip.packet_type == SX126X_PACKET_TYPE_LORA);
+  TEST_CHECK(test_sim.chip.mod_params[0] == SX126X_LORA_SF_7);
+  sx126x_hal_sim_advance(&test_sim, sx126x_hal_sim_airtime_ns(&test_sim, 16) + 1000000);
+  TEST_CHECK(test_done == 1 && test_result == SX126X_OK);
+
+  sx126x_deinit(dev);
+  sx126x_hal_sim_deinit(&test_sim);
+}
+
+int main(void)
+{
+  for (size_t i = 0; i < sizeof(test_payload); i++)
+    test_payload[i] = (uint8_t)i;
+
+  TEST_RUN(test_async);
+  TEST_RUN(test_blocking);
+  TEST_RUN(test_blocking_not_init);
+  TEST_RUN(test_blocking_lock_error);
+  TEST_RUN(test_lr_fhss_start_error);
+
+  return test_failures ? 1 : 0;
+}
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: MIT
+
+/**
+ * @file test_util.h
+ * @brief Shared helpers for the host-side unit tests.
+ */
+
+#ifndef SX126X_TEST_UTIL_H
+#define SX126X_TEST_UTIL_H
+
+#include <stdio.h>
+#include <string.h>
+#include <sx126x/hal_sim.h>
+#include <sx126x/sx126x.h>
+
+// Failed checks so far; main returns non-zero if there were any.
+static int test_failures;
+
+#define TEST_CHECK(cond)                                                                           \
+  do                                                                                               \
+  {                                                                                                \
+    if (!(cond))                                                                                   \
+    {                                                                                              \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);                     \
+      test_failures++;                                                                             \
+    }                                                                                              \
+  } while (0)
+
+#define TEST_RUN(fn)                                                                               \
+  do                                                                                               \
+  {                                                                                                \
+    int failures_before = test_failures;                                                           \
+    fn();                                                                                          \
+    printf("%-40s %s\n", #fn, test_failures == failures_before ? "ok" : "FAILED");                 \
+  } while (0)
+
+// The SX1262 LoRa configuration the tests start from.
+static inline void test_default_config(sx126x_config_t *cfg)
+{
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->chip = SX126X_CHIP_SX1262;
+  cfg->frequency_hz = 868100000;
+  cfg->pa_profile = SX126X_PA_HIGH_POWER;
+  cfg->modem = SX126X_MODEM_LORA;
+  cfg->power_dbm = 14;
+  cfg->power_ramp_time = SX126X_PWR_RAMP_TIME_200U;
+  cfg->lora_sf = SX126X_LORA_SF_7;
+  cfg->lora_bw = SX126X_LORA_BW_125;
+  cfg->lora_cr = SX126X_LORA_CR_4_5;
+  cfg->lora_crc_on = true;
+}
+
+// A GFSK configuration at 50 kbit/s.
+static inline void test_gfsk_config(sx126x_config_t *cfg)
+{
+  test_default_config(cfg);
+  cfg->modem = SX126X_MODEM_FSK;
+  cfg->gfsk_bitrate_bps = 50000;
+  cfg->gfsk_fdev_hz = 25000;
+  cfg->gfsk_shaping = SX126X_GFSK_SHAPING_BT_0_5;
+  cfg->gfsk_bw = SX126X_GFSK_BW_117300;
+  cfg->gfsk_sync_word[0] = 0xC1;
+  cfg->gfsk_sync_word[1] = 0x94;
+  cfg->gfsk_sync_word_len = 2;
+  cfg->gfsk_crc = SX126X_GFSK_CRC_2_BYTE;
+}
+
+// Bring up a simulated radio with cfg; NULL if that fails.
+static inline sx126x_t *test_radio(sx126x_hal_t *sim, sx126x_config_t *cfg)
+{
+  sx126x_hal_sim_init(sim, NULL);
+  sx126x_t *dev = sx126x_hal_get_device(sim);
+  if (sx126x_init(dev, sx126x_hal_get_bus(sim), cfg) != SX126X_OK)
+  {
+    fprintf(stderr, "failed to initialize the radio\n");
+    test_failures++;
+    sx126x_hal_sim_deinit(sim);
+    return NULL;
+  }
+
+  return dev;
+}
+
+#endif // SX126X_TEST_UTIL_H